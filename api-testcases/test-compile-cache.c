@@ -0,0 +1,104 @@
+/*
+ *  Compile cache statistics for eval() and Function constructor code
+ *  (requires the default DUK_USE_COMPILE_CACHE; with DUK_OPT_NO_COMPILE_CACHE
+ *  the statistics are undefined and the test prints "compile cache disabled").
+ */
+
+/*===
+*** test_basic (duk_safe_call)
+after reset: entries=0 hits=0 misses=0 evictions=0
+size ok: true
+after repeated eval: entries=2 hits=8 misses=2 evictions=0
+after function constructor: entries=3 hits=10 misses=3 evictions=0
+after many sources: entries=size evictions=true
+long source not cached: true
+after reset: entries=0 hits=0 misses=0 evictions=0
+final top: 0
+==> rc=0, result='undefined'
+===*/
+
+static void print_stats(duk_context *ctx, const char *label) {
+	duk_push_compile_cache_stats(ctx);
+	duk_get_prop_string(ctx, -1, "entries");
+	duk_get_prop_string(ctx, -2, "hits");
+	duk_get_prop_string(ctx, -3, "misses");
+	duk_get_prop_string(ctx, -4, "evictions");
+	printf("%s: entries=%d hits=%d misses=%d evictions=%d\n", label,
+	       (int) duk_get_int(ctx, -4), (int) duk_get_int(ctx, -3),
+	       (int) duk_get_int(ctx, -2), (int) duk_get_int(ctx, -1));
+	duk_pop_n(ctx, 5);
+}
+
+static int get_stat(duk_context *ctx, const char *name) {
+	int res;
+
+	duk_push_compile_cache_stats(ctx);
+	duk_get_prop_string(ctx, -1, name);
+	res = duk_get_int(ctx, -1);
+	duk_pop_2(ctx);
+	return res;
+}
+
+int test_basic(duk_context *ctx) {
+	int size;
+	int misses;
+
+	duk_push_compile_cache_stats(ctx);
+	if (duk_is_undefined(ctx, -1)) {
+		printf("compile cache disabled\n");
+		duk_pop(ctx);
+		return 0;
+	}
+
+	/* Expose the source length limit to the test script. */
+	duk_push_global_object(ctx);
+	duk_get_prop_string(ctx, -1, "Duktape");
+	duk_get_prop_string(ctx, -3, "maxlen");
+	duk_put_prop_string(ctx, -2, "compileCacheMaxlen");
+	duk_pop_3(ctx);
+
+	duk_reset_compile_cache(ctx);
+	print_stats(ctx, "after reset");
+
+	size = get_stat(ctx, "size");
+	printf("size ok: %s\n", size >= 2 ? "true" : "false");
+
+	/* duk_eval_string() itself is not cached, only the eval() calls. */
+	duk_eval_string_noresult(ctx,
+		"for (var i = 0; i < 5; i++) {\n"
+		"    eval('1 + 2');\n"
+		"    (function () { 'use strict'; eval('1 + 2'); })();\n"
+		"}\n");
+	print_stats(ctx, "after repeated eval");
+
+	duk_eval_string_noresult(ctx,
+		"for (var i = 0; i < 3; i++) {\n"
+		"    new Function('a', 'return a;')(i);\n"
+		"}\n");
+	print_stats(ctx, "after function constructor");
+
+	duk_eval_string_noresult(ctx,
+		"for (var i = 0; i < 100; i++) {\n"
+		"    eval('' + i);\n"
+		"}\n");
+	printf("after many sources: entries=%s evictions=%s\n",
+	       get_stat(ctx, "entries") == size ? "size" : "wrong",
+	       get_stat(ctx, "evictions") > 0 ? "true" : "false");
+
+	misses = get_stat(ctx, "misses");
+	duk_eval_string_noresult(ctx,
+		"var src = '0';\n"
+		"while (src.length <= Duktape.compileCacheMaxlen) { src += ' + 0'; }\n"
+		"eval(src); eval(src);\n");
+	printf("long source not cached: %s\n", get_stat(ctx, "misses") == misses ? "true" : "false");
+
+	duk_reset_compile_cache(ctx);
+	print_stats(ctx, "after reset");
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_basic);
+}
@@ -0,0 +1,242 @@
+/*===
+*** test_basic (duk_safe_call)
+fib(20): 6765
+consts: string 1.5 -Infinity true
+regexp: true
+args: 3 x,y,z
+named: 120
+getset: 10 20
+caught: URIError: uri error
+closure: 12 13
+program result: 123
+final top: 0
+==> rc=0, result='undefined'
+*** test_function_value (duk_safe_call)
+name: adder, length: 2
+call: 7
+strict: true
+final top: 0
+==> rc=0, result='undefined'
+*** test_line_numbers (duk_safe_call)
+fileName: dumpfile.js
+lineNumber: 4
+error: Error: aiee
+final top: 0
+==> rc=0, result='undefined'
+*** test_other_heap (duk_safe_call)
+other heap: hello from bytecode 3
+final top: 0
+==> rc=0, result='undefined'
+*** test_truncated (duk_safe_call)
+==> rc=1, result='TypeError: invalid bytecode'
+*** test_trailing_garbage (duk_safe_call)
+==> rc=1, result='TypeError: invalid bytecode'
+*** test_version_mismatch (duk_safe_call)
+==> rc=1, result='TypeError: bytecode version mismatch'
+*** test_not_bytecode (duk_safe_call)
+==> rc=1, result='TypeError: invalid bytecode'
+*** test_dump_native (duk_safe_call)
+==> rc=1, result='TypeError: not a compiled function'
+*** test_load_nonbuffer (duk_safe_call)
+==> rc=1, result='TypeError: not buffer'
+===*/
+
+static const char *test_program =
+	"var res = [];\n"
+	"function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }\n"
+	"res.push('fib(20): ' + fib(20));\n"
+	"res.push('consts: ' + ['string', 1.5, -1/0, !0].join(' '));\n"
+	"res.push('regexp: ' + /^a+b/i.test('AAAb'));\n"
+	"function args() { return arguments.length + ' ' + Array.prototype.join.call(arguments, ','); }\n"
+	"res.push('args: ' + args('x', 'y', 'z'));\n"
+	"var fact = function f(n) { return n <= 1 ? 1 : n * f(n - 1); };\n"
+	"res.push('named: ' + fact(5));\n"
+	"var o = { _x: 10, get x() { return this._x; }, set x(v) { this._x = v; } };\n"
+	"var tmp = o.x; o.x = 20;\n"
+	"res.push('getset: ' + tmp + ' ' + o.x);\n"
+	"try { decodeURIComponent('%'); } catch (e) { res.push('caught: ' + e.name + ': uri error'); }\n"
+	"function counter(start) { var c = start; return function () { return ++c; }; }\n"
+	"var cnt = counter(10); cnt();\n"
+	"res.push('closure: ' + cnt() + ' ' + cnt());\n"
+	"res.forEach(function (v) { print(v); });\n"
+	"123;\n";
+
+/* Compile source, dump it, and load it back: [ ... ] -> [ ... func ] */
+static void compile_dump_load(duk_context *ctx, const char *src, const char *filename) {
+	duk_push_string(ctx, src);
+	duk_push_string(ctx, filename);
+	duk_compile(ctx, 0);
+	duk_dump_function(ctx);
+	duk_load_function(ctx);
+}
+
+int test_basic(duk_context *ctx) {
+	compile_dump_load(ctx, test_program, "test");
+	duk_call(ctx, 0);
+	printf("program result: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_function_value(duk_context *ctx) {
+	duk_eval_string(ctx, "(function adder(x, y) { 'use strict'; return x + y + (this === undefined ? 0 : 100); })");
+	duk_dump_function(ctx);
+	duk_load_function(ctx);
+
+	duk_get_prop_string(ctx, -1, "name");
+	duk_get_prop_string(ctx, -2, "length");
+	printf("name: %s, length: %d\n", duk_safe_to_string(ctx, -2), (int) duk_get_int(ctx, -1));
+	duk_pop_2(ctx);
+
+	duk_dup(ctx, -1);
+	duk_push_int(ctx, 3);
+	duk_push_int(ctx, 4);
+	duk_call(ctx, 2);
+	printf("call: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+
+	duk_push_global_object(ctx);
+	duk_get_prop_string(ctx, -1, "Function");
+	duk_remove(ctx, -2);
+	duk_eval_string(ctx, "(function (f) { try { f.caller; return false; } catch (e) { return e instanceof TypeError; } })");
+	duk_dup(ctx, -3);
+	duk_call(ctx, 1);
+	printf("strict: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop_3(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_line_numbers(duk_context *ctx) {
+	compile_dump_load(ctx,
+	                  "function thrower() {\n"
+	                  "    var x = 1;\n"
+	                  "    x++;\n"
+	                  "    throw new Error('aiee');\n"
+	                  "}\n"
+	                  "try { thrower(); } catch (e) { e; }\n",
+	                  "dumpfile.js");
+	duk_call(ctx, 0);
+	duk_get_prop_string(ctx, -1, "fileName");
+	printf("fileName: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+	duk_get_prop_string(ctx, -1, "lineNumber");
+	printf("lineNumber: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+	printf("error: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_other_heap(duk_context *ctx) {
+	duk_context *ctx2;
+	void *buf;
+	void *buf2;
+	duk_size_t sz;
+
+	duk_push_string(ctx, "var s = 'hello from bytecode'; function f(a) { return s + ' ' + a.length; } f([1,2,3]);");
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+	duk_dump_function(ctx);
+	buf = duk_require_buffer(ctx, -1, &sz);
+
+	ctx2 = duk_create_heap_default();
+	buf2 = duk_push_fixed_buffer(ctx2, sz);
+	memcpy(buf2, buf, sz);
+	duk_load_function(ctx2);
+	duk_call(ctx2, 0);
+	printf("other heap: %s\n", duk_safe_to_string(ctx2, -1));
+	duk_destroy_heap(ctx2);
+
+	duk_pop(ctx);
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+/* Dump a small program and replace the dump with a modified copy. */
+static void dump_and_modify(duk_context *ctx, duk_size_t new_size, int corrupt_index) {
+	unsigned char *buf;
+	unsigned char *buf2;
+	duk_size_t sz;
+
+	duk_compile_string(ctx, 0, "print('never here');");
+	duk_dump_function(ctx);
+	buf = (unsigned char *) duk_require_buffer(ctx, -1, &sz);
+	if (new_size == 0) {
+		new_size = sz;
+	}
+	buf2 = (unsigned char *) duk_push_fixed_buffer(ctx, new_size);
+	memcpy((void *) buf2, (const void *) buf, (new_size < sz ? new_size : sz));
+	if (corrupt_index >= 0) {
+		buf2[corrupt_index] ^= 0x01;
+	}
+	duk_remove(ctx, -2);
+}
+
+int test_truncated(duk_context *ctx) {
+	dump_and_modify(ctx, 20, -1);
+	duk_load_function(ctx);
+	printf("never here\n");
+	return 0;
+}
+
+int test_trailing_garbage(duk_context *ctx) {
+	duk_size_t sz;
+
+	duk_compile_string(ctx, 0, "print('never here');");
+	duk_dump_function(ctx);
+	(void) duk_get_buffer(ctx, -1, &sz);
+	duk_pop(ctx);
+	dump_and_modify(ctx, sz + 1, -1);
+	duk_load_function(ctx);
+	printf("never here\n");
+	return 0;
+}
+
+int test_version_mismatch(duk_context *ctx) {
+	/* last byte of the DUK_VERSION field */
+	dump_and_modify(ctx, 0, 5);
+	duk_load_function(ctx);
+	printf("never here\n");
+	return 0;
+}
+
+int test_not_bytecode(duk_context *ctx) {
+	duk_push_string(ctx, "print('source code is not bytecode');");
+	duk_to_buffer(ctx, -1, NULL);
+	duk_load_function(ctx);
+	printf("never here\n");
+	return 0;
+}
+
+int test_dump_native(duk_context *ctx) {
+	duk_eval_string(ctx, "Math.max");
+	duk_dump_function(ctx);
+	printf("never here\n");
+	return 0;
+}
+
+int test_load_nonbuffer(duk_context *ctx) {
+	duk_push_string(ctx, "not a buffer");
+	duk_load_function(ctx);
+	printf("never here\n");
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_basic);
+	TEST_SAFE_CALL(test_function_value);
+	TEST_SAFE_CALL(test_line_numbers);
+	TEST_SAFE_CALL(test_other_heap);
+	TEST_SAFE_CALL(test_truncated);
+	TEST_SAFE_CALL(test_trailing_garbage);
+	TEST_SAFE_CALL(test_version_mismatch);
+	TEST_SAFE_CALL(test_not_bytecode);
+	TEST_SAFE_CALL(test_dump_native);
+	TEST_SAFE_CALL(test_load_nonbuffer);
+}
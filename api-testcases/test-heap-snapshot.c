@@ -0,0 +1,241 @@
+/*===
+*** test_basic (duk_safe_call)
+snapshot created
+heap restored
+counter: 11 12
+getset: 10 20
+array: 4 1,,3,4
+string object: 3 b
+buffer: 3 abc
+regexp: true
+proto: true true
+extended builtin: hello world
+json: {"a":[1,2],"b":"x"}
+error: RangeError: aiee
+native: adder 5
+global stash: stashed value
+new code: 123
+final top: 0
+==> rc=0, result='undefined'
+*** test_restore_twice (duk_safe_call)
+heap 1: 1
+heap 2: 1
+heap 1: 2
+final top: 0
+==> rc=0, result='undefined'
+*** test_unregistered_native (duk_safe_call)
+==> rc=1, result='TypeError: cannot snapshot unregistered native function'
+*** test_thread (duk_safe_call)
+==> rc=1, result='TypeError: cannot snapshot thread'
+*** test_running (duk_safe_call)
+==> rc=0, result='TypeError: cannot snapshot a running heap'
+*** test_invalid (duk_safe_call)
+null snapshot: NULL
+truncated snapshot: NULL
+version mismatch: NULL
+missing natives: NULL
+final top: 0
+==> rc=0, result='undefined'
+===*/
+
+static int my_adder(duk_context *ctx) {
+	duk_push_number(ctx, duk_require_number(ctx, 0) + duk_require_number(ctx, 1));
+	return 1;
+}
+
+static int my_name(duk_context *ctx) {
+	duk_push_string(ctx, "adder");
+	return 1;
+}
+
+static const duk_c_function my_natives[] = {
+	my_adder,
+	my_name,
+	NULL
+};
+
+static const char *setup_program =
+	"var counter = (function () { var c = 10; return function () { return ++c; }; })();\n"
+	"var obj = { _x: 10, get x() { return this._x; }, set x(v) { this._x = v; } };\n"
+	"var arr = [ 1, , 3 ];\n"
+	"var strobj = new String('abc');\n"
+	"var buf = Duktape.Buffer('abc');\n"
+	"var re = /^a+b/i;\n"
+	"function Base() {}\n"
+	"function Derived() {}\n"
+	"Derived.prototype = Object.create(Base.prototype);\n"
+	"var inst = new Derived();\n"
+	"String.prototype.greet = function () { return 'hello ' + this; };\n";
+
+static const char *check_program =
+	"print('counter: ' + counter() + ' ' + counter());\n"
+	"var tmp = obj.x; obj.x = 20;\n"
+	"print('getset: ' + tmp + ' ' + obj.x);\n"
+	"arr.push(4);\n"
+	"print('array: ' + arr.length + ' ' + arr.join(','));\n"
+	"print('string object: ' + strobj.length + ' ' + strobj[1]);\n"
+	"print('buffer: ' + buf.length + ' ' + String(buf));\n"
+	"print('regexp: ' + re.test('AAAb'));\n"
+	"print('proto: ' + (inst instanceof Derived) + ' ' + (inst instanceof Base));\n"
+	"print('extended builtin: ' + 'world'.greet());\n"
+	"print('json: ' + JSON.stringify({ a: [1, 2], b: 'x' }));\n"
+	"try { throw new RangeError('aiee'); } catch (e) { print('error: ' + e); }\n"
+	"print('native: ' + myName() + ' ' + myAdder(2, 3));\n";
+
+/* Create a heap with some state and snapshot it: [ ... ] -> [ ... snapshot ] */
+static void create_snapshot(duk_context *ctx) {
+	duk_context *ctx_src;
+	void *src;
+	void *dst;
+	duk_size_t sz;
+
+	ctx_src = duk_create_heap_default();
+
+	duk_eval_string_noresult(ctx_src, setup_program);
+
+	duk_push_global_object(ctx_src);
+	duk_push_c_function(ctx_src, my_adder, 2);
+	duk_put_prop_string(ctx_src, -2, "myAdder");
+	duk_push_c_function(ctx_src, my_name, 0);
+	duk_put_prop_string(ctx_src, -2, "myName");
+	duk_pop(ctx_src);
+
+	duk_push_global_stash(ctx_src);
+	duk_push_string(ctx_src, "stashed value");
+	duk_put_prop_string(ctx_src, -2, "myValue");
+	duk_pop(ctx_src);
+
+	duk_snapshot_heap(ctx_src, my_natives);
+	src = duk_require_buffer(ctx_src, -1, &sz);
+	dst = duk_push_fixed_buffer(ctx, sz);
+	memcpy(dst, src, sz);
+
+	duk_destroy_heap(ctx_src);
+}
+
+int test_basic(duk_context *ctx) {
+	duk_context *ctx2;
+	void *buf;
+	duk_size_t sz;
+
+	create_snapshot(ctx);
+	printf("snapshot created\n");
+	buf = duk_require_buffer(ctx, -1, &sz);
+
+	ctx2 = duk_create_heap_from_snapshot_default(buf, sz, my_natives);
+	printf("heap restored\n");
+	duk_pop(ctx);
+
+	duk_eval_string_noresult(ctx2, check_program);
+
+	duk_push_global_stash(ctx2);
+	duk_get_prop_string(ctx2, -1, "myValue");
+	printf("global stash: %s\n", duk_safe_to_string(ctx2, -1));
+	duk_pop_2(ctx2);
+
+	duk_eval_string(ctx2, "(function (x) { return x * 41; })(3) - 0");
+	printf("new code: %s\n", duk_safe_to_string(ctx2, -1));
+	duk_pop(ctx2);
+
+	duk_destroy_heap(ctx2);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+/* Heaps created from the same snapshot are independent. */
+int test_restore_twice(duk_context *ctx) {
+	duk_context *ctx2;
+	duk_context *ctx3;
+	void *buf;
+	duk_size_t sz;
+
+	duk_eval_string_noresult(ctx, "var snapCounter = 0;");
+	duk_snapshot_heap(ctx, NULL);
+	buf = duk_require_buffer(ctx, -1, &sz);
+
+	ctx2 = duk_create_heap_from_snapshot_default(buf, sz, NULL);
+	ctx3 = duk_create_heap_from_snapshot_default(buf, sz, NULL);
+	duk_pop(ctx);
+
+	duk_eval_string(ctx2, "++snapCounter");
+	printf("heap 1: %s\n", duk_safe_to_string(ctx2, -1));
+	duk_eval_string(ctx3, "++snapCounter");
+	printf("heap 2: %s\n", duk_safe_to_string(ctx3, -1));
+	duk_eval_string(ctx2, "++snapCounter");
+	printf("heap 1: %s\n", duk_safe_to_string(ctx2, -1));
+
+	duk_destroy_heap(ctx2);
+	duk_destroy_heap(ctx3);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_unregistered_native(duk_context *ctx) {
+	duk_push_global_object(ctx);
+	duk_push_c_function(ctx, my_adder, 2);
+	duk_put_prop_string(ctx, -2, "unregistered");
+	duk_pop(ctx);
+
+	duk_snapshot_heap(ctx, NULL);
+	printf("never here\n");
+	return 0;
+}
+
+int test_thread(duk_context *ctx) {
+	duk_eval_string_noresult(ctx, "delete this.unregistered; var thr = new Duktape.Thread(function () {});");
+	duk_snapshot_heap(ctx, NULL);
+	printf("never here\n");
+	return 0;
+}
+
+static int snapshot_from_call(duk_context *ctx) {
+	duk_snapshot_heap(ctx, NULL);
+	printf("never here\n");
+	return 0;
+}
+
+int test_running(duk_context *ctx) {
+	duk_eval_string_noresult(ctx, "delete this.thr;");
+	duk_push_c_function(ctx, snapshot_from_call, 0);
+	duk_pcall(ctx, 0);
+	return 1;
+}
+
+int test_invalid(duk_context *ctx) {
+	duk_context *ctx2;
+	unsigned char *buf;
+	duk_size_t sz;
+
+	ctx2 = duk_create_heap_from_snapshot_default(NULL, 0, NULL);
+	printf("null snapshot: %s\n", ctx2 ? "non-NULL" : "NULL");
+
+	create_snapshot(ctx);
+	buf = (unsigned char *) duk_require_buffer(ctx, -1, &sz);
+
+	ctx2 = duk_create_heap_from_snapshot_default(buf, sz - 1, my_natives);
+	printf("truncated snapshot: %s\n", ctx2 ? "non-NULL" : "NULL");
+
+	buf[5] ^= 0xff;  /* version */
+	ctx2 = duk_create_heap_from_snapshot_default(buf, sz, my_natives);
+	printf("version mismatch: %s\n", ctx2 ? "non-NULL" : "NULL");
+	buf[5] ^= 0xff;
+
+	ctx2 = duk_create_heap_from_snapshot_default(buf, sz, NULL);
+	printf("missing natives: %s\n", ctx2 ? "non-NULL" : "NULL");
+
+	duk_pop(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_basic);
+	TEST_SAFE_CALL(test_restore_twice);
+	TEST_SAFE_CALL(test_unregistered_native);
+	TEST_SAFE_CALL(test_thread);
+	TEST_SAFE_CALL(test_running);
+	TEST_SAFE_CALL(test_invalid);
+}
@@ -0,0 +1,94 @@
+/*
+ *  Opcode statistics through duk_push_opcode_stats() and
+ *  duk_reset_opcode_stats().  Without DUK_OPT_OPCODE_STATS the statistics
+ *  are undefined and only that is checked; checks print a line only when
+ *  they fail, so the expected output is the same for both builds.  See also
+ *  ecmascript-testcases/test-dev-opcode-stats.js.
+ */
+
+/*===
+*** test_basic (duk_safe_call)
+final top: 0
+==> rc=0, result='undefined'
+===*/
+
+static void check(const char *what, int ok) {
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+	}
+}
+
+static double sum_array(duk_context *ctx, duk_idx_t idx) {
+	double sum = 0.0;
+	duk_size_t i, n;
+
+	n = duk_get_length(ctx, idx);
+	for (i = 0; i < n; i++) {
+		duk_get_prop_index(ctx, idx, (unsigned int) i);
+		sum += duk_get_number(ctx, -1);
+		duk_pop(ctx);
+	}
+	return sum;
+}
+
+static void test_enabled(duk_context *ctx) {
+	double ops, extras, pairs;
+
+	duk_reset_opcode_stats(ctx);
+	duk_push_opcode_stats(ctx);
+	duk_get_prop_string(ctx, -1, "opcodes");
+	duk_get_prop_string(ctx, -2, "extraops");
+	duk_get_prop_string(ctx, -3, "pairs");
+	check("opcodes zero after reset", sum_array(ctx, -3) == 0.0);
+	check("extraops zero after reset", sum_array(ctx, -2) == 0.0);
+	check("pairs zero after reset", sum_array(ctx, -1) == 0.0);
+	duk_pop_n(ctx, 4);
+
+	duk_eval_string_noresult(ctx,
+		"var t = 0;\n"
+		"for (var i = 0; i < 1000; i++) { t += i; }\n");
+
+	duk_push_opcode_stats(ctx);
+	duk_get_prop_string(ctx, -1, "opcodes");
+	duk_get_prop_string(ctx, -2, "extraops");
+	duk_get_prop_string(ctx, -3, "pairs");
+	check("opcodes length", duk_get_length(ctx, -3) == 64);
+	check("extraops length", duk_get_length(ctx, -2) == 256);
+	check("pairs length", duk_get_length(ctx, -1) == 64 * 64);
+	ops = sum_array(ctx, -3);
+	extras = sum_array(ctx, -2);
+	pairs = sum_array(ctx, -1);
+	check("loop executed", ops >= 1000.0);
+	check("pairs match opcodes", pairs == ops);
+	check("extraops counted", extras > 0.0 && extras < ops);
+	duk_pop_n(ctx, 4);
+}
+
+static void test_disabled(duk_context *ctx) {
+	duk_reset_opcode_stats(ctx);  /* no-op */
+	duk_eval_string_noresult(ctx, "var t = 0; for (var i = 0; i < 10; i++) { t += i; }");
+	duk_push_opcode_stats(ctx);
+	check("stats undefined when disabled", duk_is_undefined(ctx, -1));
+	duk_pop(ctx);
+}
+
+int test_basic(duk_context *ctx) {
+	int enabled;
+
+	duk_push_opcode_stats(ctx);
+	enabled = duk_is_object(ctx, -1);
+	duk_pop(ctx);
+
+	if (enabled) {
+		test_enabled(ctx);
+	} else {
+		test_disabled(ctx);
+	}
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_basic);
+}
@@ -0,0 +1,232 @@
+/*===
+*** test_steps (duk_safe_call)
+rc=1, result=RangeError: execution budget exceeded
+rc=1, result=RangeError: execution budget exceeded
+rc=0, result=4950
+after budget: 6
+final top: 0
+==> rc=0, result='undefined'
+*** test_deadline (duk_safe_call)
+rc=1, result=RangeError: execution budget exceeded
+after budget: ok
+final top: 0
+==> rc=0, result='undefined'
+*** test_nested (duk_safe_call)
+inner rc=1
+rc=1, result=RangeError: execution budget exceeded
+inner rc=0, result=done
+rc=0, result=done
+final top: 0
+==> rc=0, result='undefined'
+*** test_accounting (duk_safe_call)
+steps ok: true
+one step less fails: true
+budgeted calls: same steps as plain calls
+nested budgeted calls: same steps as plain calls
+final top: 0
+==> rc=0, result='undefined'
+*** test_no_budget (duk_safe_call)
+rc=0, result=123
+final top: 0
+==> rc=0, result='undefined'
+*** test_invalid (duk_safe_call)
+==> rc=1, result='Error: invalid call args'
+===*/
+
+static void compile_and_budget_call(duk_context *ctx, const char *src, duk_int_t max_steps, duk_int_t max_msec) {
+	int rc;
+
+	duk_push_string(ctx, src);
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+	rc = duk_pcall_budget(ctx, 0, max_steps, max_msec);
+	printf("rc=%d, result=%s\n", rc, duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+}
+
+int test_steps(duk_context *ctx) {
+	/* Infinite loop. */
+	compile_and_budget_call(ctx, "for (;;) {}", 10000, 0);
+
+	/* The script cannot swallow the error and keep running. */
+	compile_and_budget_call(ctx, "try { for (;;) {} } catch (e) { for (;;) {} } finally { for (;;) {} }", 10000, 0);
+
+	/* Enough budget. */
+	compile_and_budget_call(ctx, "var t = 0; for (var i = 0; i < 100; i++) { t += i; } t;", 100000, 0);
+
+	/* Heap is usable and unlimited afterwards. */
+	duk_eval_string(ctx, "var t = 0; for (var i = 0; i < 100000; i++) { t++; } 1 + 2 + 3;");
+	printf("after budget: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_deadline(duk_context *ctx) {
+	compile_and_budget_call(ctx, "for (;;) {}", 0, 100);
+
+	duk_eval_string(ctx, "'ok'");
+	printf("after budget: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+static int nested_call(duk_context *ctx) {
+	int rc;
+
+	/* [ src ] */
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+
+	/* A nested budget cannot extend the outer one. */
+	rc = duk_pcall_budget(ctx, 0, 1000000000L, 0);
+	if (rc != 0) {
+		printf("inner rc=%d\n", rc);
+		duk_throw(ctx);
+	}
+	printf("inner rc=%d, result=%s\n", rc, duk_safe_to_string(ctx, -1));
+	return 1;
+}
+
+int test_nested(duk_context *ctx) {
+	duk_push_global_object(ctx);
+	duk_push_c_function(ctx, nested_call, 1);
+	duk_put_prop_string(ctx, -2, "nested");
+	duk_pop(ctx);
+
+	compile_and_budget_call(ctx, "nested('for (;;) {}'); for (;;) {}", 10000, 0);
+	compile_and_budget_call(ctx, "nested('\"done\"');", 10000, 0);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+/* Call the source given as argument with plain duk_pcall() or with a
+ * (non-limiting) nested budget; errors are rethrown.
+ */
+static int accounting_call(duk_context *ctx, int use_budget) {
+	int rc;
+
+	/* [ src ] */
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+	if (use_budget) {
+		rc = duk_pcall_budget(ctx, 0, 1000000000L, 0);
+	} else {
+		rc = duk_pcall(ctx, 0);
+	}
+	if (rc != 0) {
+		duk_throw(ctx);
+	}
+	return 1;
+}
+
+static int accounting_plain(duk_context *ctx) {
+	return accounting_call(ctx, 0);
+}
+
+static int accounting_budget(duk_context *ctx) {
+	return accounting_call(ctx, 1);
+}
+
+static int budget_call_ok(duk_context *ctx, const char *src, duk_int_t max_steps) {
+	int rc;
+
+	duk_push_string(ctx, src);
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+	rc = duk_pcall_budget(ctx, 0, max_steps, 0);
+	duk_pop(ctx);
+	return rc == 0;
+}
+
+/* Smallest instruction budget 'src' runs to completion with. */
+static duk_int_t min_steps(duk_context *ctx, const char *src) {
+	duk_int_t lo = 1, hi = 1000000L, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (budget_call_ok(ctx, src, mid)) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+int test_accounting(duk_context *ctx) {
+	duk_int_t n, n_plain, n_budget;
+
+	duk_push_global_object(ctx);
+	duk_push_c_function(ctx, accounting_plain, 1);
+	duk_put_prop_string(ctx, -2, "plain");
+	duk_push_c_function(ctx, accounting_budget, 1);
+	duk_put_prop_string(ctx, -2, "budgeted");
+	duk_pop(ctx);
+
+	/* Steps are counted exactly: the minimum budget is sufficient and
+	 * one step less isn't.
+	 */
+	n = min_steps(ctx, "var t = 0; for (var i = 0; i < 100; i++) { t += i; }");
+	printf("steps ok: %s\n", n > 100 && budget_call_ok(ctx, "var t = 0; for (var i = 0; i < 100; i++) { t += i; }", n) ? "true" : "false");
+	printf("one step less fails: %s\n", !budget_call_ok(ctx, "var t = 0; for (var i = 0; i < 100; i++) { t += i; }", n - 1) ? "true" : "false");
+
+	/* Instructions executed under a nested budget are charged to the
+	 * outer budget exactly, so arming and restoring nested budgets
+	 * repeatedly must not change the outer step count.
+	 */
+	n_plain = min_steps(ctx,
+		"for (var i = 0; i < 5; i++) {\n"
+		"    plain('var t = 0; for (var j = 0; j < 10; j++) { t += j; }');\n"
+		"}\n");
+	n_budget = min_steps(ctx,
+		"for (var i = 0; i < 5; i++) {\n"
+		"    budgeted('var t = 0; for (var j = 0; j < 10; j++) { t += j; }');\n"
+		"}\n");
+	printf("budgeted calls: %s\n", n_plain == n_budget ? "same steps as plain calls" : "different steps");
+	if (n_plain != n_budget) {
+		printf("plain=%ld, budgeted=%ld\n", (long) n_plain, (long) n_budget);
+	}
+
+	n_plain = min_steps(ctx,
+		"for (var i = 0; i < 3; i++) {\n"
+		"    plain(\"for (var k = 0; k < 2; k++) { plain('var t = 0; for (var j = 0; j < 10; j++) { t += j; }'); }\");\n"
+		"}\n");
+	n_budget = min_steps(ctx,
+		"for (var i = 0; i < 3; i++) {\n"
+		"    budgeted(\"for (var k = 0; k < 2; k++) { budgeted('var t = 0; for (var j = 0; j < 10; j++) { t += j; }'); }\");\n"
+		"}\n");
+	printf("nested budgeted calls: %s\n", n_plain == n_budget ? "same steps as plain calls" : "different steps");
+	if (n_plain != n_budget) {
+		printf("plain=%ld, budgeted=%ld\n", (long) n_plain, (long) n_budget);
+	}
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_no_budget(duk_context *ctx) {
+	compile_and_budget_call(ctx, "123", 0, 0);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_invalid(duk_context *ctx) {
+	duk_pcall_budget(ctx, 1, 1000, 0);
+	printf("never here\n");
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_steps);
+	TEST_SAFE_CALL(test_deadline);
+	TEST_SAFE_CALL(test_nested);
+	TEST_SAFE_CALL(test_accounting);
+	TEST_SAFE_CALL(test_no_budget);
+	TEST_SAFE_CALL(test_invalid);
+}
@@ -0,0 +1,166 @@
+/*===
+*** test_basic (duk_safe_call)
+samples before start: ''
+all lines valid: true
+total samples > 0: true
+hot function sampled: true
+outermost frame first: true
+samples stable after stop: true
+final top: 0
+==> rc=0, result='undefined'
+*** test_interval (duk_safe_call)
+samples per interval: true
+final top: 0
+==> rc=0, result='undefined'
+*** test_invalid (duk_safe_call)
+==> rc=1, result='Error: invalid argument(s)'
+===*/
+
+int test_basic(duk_context *ctx) {
+	duk_push_profiler_dump(ctx);
+	printf("samples before start: '%s'\n", duk_get_string(ctx, -1));
+	duk_pop(ctx);
+
+	duk_profiler_start(ctx, 100);
+	duk_eval_string_noresult(ctx,
+		"function hot(n) {\n"
+		"    var i, res = 0;\n"
+		"    for (i = 0; i < n; i++) {\n"
+		"        res += i * i;\n"
+		"    }\n"
+		"    return res;\n"
+		"}\n"
+		"function outer() {\n"
+		"    var res = hot(100000);  /* not a tail call */\n"
+		"    return res;\n"
+		"}\n"
+		"outer();\n");
+	duk_profiler_stop(ctx);
+
+	duk_push_global_object(ctx);
+	duk_push_profiler_dump(ctx);
+	duk_put_prop_string(ctx, -2, "dump");
+	duk_pop(ctx);
+
+	duk_eval_string_noresult(ctx,
+		"var lines = dump.split('\\n');\n"
+		"var total = 0, valid = true, hot = false, order = true;\n"
+		"if (lines.pop() !== '') { valid = false; }\n"
+		"lines.forEach(function (line) {\n"
+		"    var m = /^(.*) (\\d+)$/.exec(line);\n"
+		"    if (!m) { valid = false; return; }\n"
+		"    total += Number(m[2]);\n"
+		"    var frames = m[1].split(';');\n"
+		"    if (/^hot \\(.*:4\\)$/.test(frames[frames.length - 1])) { hot = true; }\n"
+		"    if (frames.length >= 2 && /^hot /.test(frames[frames.length - 1]) &&\n"
+		"        !/^outer /.test(frames[frames.length - 2])) { order = false; }\n"
+		"});\n"
+		"print('all lines valid:', valid);\n"
+		"print('total samples > 0:', total > 0);\n"
+		"print('hot function sampled:', hot);\n"
+		"print('outermost frame first:', order);\n");
+
+	/* No more samples after stopping. */
+	duk_eval_string_noresult(ctx, "for (var i = 0; i < 100000; i++) {}");
+	duk_push_global_object(ctx);
+	duk_get_prop_string(ctx, -1, "dump");
+	duk_push_profiler_dump(ctx);
+	printf("samples stable after stop: %s\n", duk_equals(ctx, -1, -2) ? "true" : "false");
+	duk_pop_3(ctx);
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+/* Run the source given as argument under a (non-limiting) nested budget;
+ * arming and restoring the budget forces early executor interrupts.
+ */
+static int interval_budgeted(duk_context *ctx) {
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+	if (duk_pcall_budget(ctx, 0, 1000000000L, 0) != 0) {
+		duk_throw(ctx);
+	}
+	return 1;
+}
+
+static int interval_run_ok(duk_context *ctx, const char *src, duk_int_t max_steps) {
+	int rc;
+
+	duk_push_string(ctx, src);
+	duk_push_string(ctx, "test");
+	duk_compile(ctx, 0);
+	rc = duk_pcall_budget(ctx, 0, max_steps, 0);
+	duk_pop(ctx);
+	return rc == 0;
+}
+
+int test_interval(duk_context *ctx) {
+	const char *src =
+		"for (var i = 0; i < 200; i++) {\n"
+		"    budgeted('var t = 0; for (var j = 0; j < 20; j++) { t += j; }');\n"
+		"}\n";
+	duk_int_t lo = 1, hi = 10000000L, mid;
+	double steps, samples;
+
+	duk_push_global_object(ctx);
+	duk_push_c_function(ctx, interval_budgeted, 1);
+	duk_put_prop_string(ctx, -2, "budgeted");
+	duk_pop(ctx);
+
+	/* Exact instruction count of the script: the smallest sufficient
+	 * step budget.
+	 */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (interval_run_ok(ctx, src, mid)) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	steps = (double) lo;
+
+	/* Early interrupts caused by the nested budgets must not cause extra
+	 * samples: one sample per 1000 instructions.
+	 */
+	duk_profiler_start(ctx, 1000);
+	duk_push_string(ctx, src);
+	duk_eval(ctx);
+	duk_pop(ctx);
+	duk_profiler_stop(ctx);
+
+	duk_push_profiler_dump(ctx);
+	duk_push_global_object(ctx);
+	duk_dup(ctx, -2);
+	duk_put_prop_string(ctx, -2, "dump");
+	duk_pop_2(ctx);
+	duk_eval_string(ctx,
+		"dump.split('\\n').reduce(function (acc, line) {\n"
+		"    var m = /^(.*) (\\d+)$/.exec(line);\n"
+		"    return m ? acc + Number(m[2]) : acc;\n"
+		"}, 0);\n");
+	samples = duk_get_number(ctx, -1);
+	duk_pop(ctx);
+
+	printf("samples per interval: %s\n",
+	       (samples >= steps / 1000.0 - 1.0 && samples <= steps / 1000.0 + 1.0) ? "true" : "false");
+	if (!(samples >= steps / 1000.0 - 1.0 && samples <= steps / 1000.0 + 1.0)) {
+		printf("steps=%.0lf, samples=%.0lf\n", steps, samples);
+	}
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_invalid(duk_context *ctx) {
+	duk_profiler_start(ctx, 0);
+	printf("never here\n");
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_basic);
+	TEST_SAFE_CALL(test_interval);
+	TEST_SAFE_CALL(test_invalid);
+}
@@ -0,0 +1,166 @@
+/*===
+*** test_basic (duk_safe_call)
+type: 9
+is_lightfunc: 1
+is_function: 1
+is_c_function: 1
+is_callable: 1
+is_object: 0
+is_primitive: 0
+is_object_coercible: 1
+get_c_function ok: 1
+get_length: 3
+typeof: function
+length: 3
+name ok: true
+toString ok: true
+call: 2 1 2 -5
+call: 2 10 20 -5
+call: 2 3 undefined -5
+new: object call: 2 4 5 -5
+bound: 2 7 8 -5
+bound length: 2
+varargs: 4
+strict equals: true false
+object coerced: function function
+coerced call: 2 1 2 -5
+coerced length: 3
+'length' in lf: true
+'call' in lf: true
+'foo' in lf: false
+delete length: false
+delete foo: true
+getPrototypeOf: true
+json: {}
+jx: {a:{_func:true}}
+bool: true
+error from lightfunc: RangeError true
+final top: 0
+==> rc=0, result='undefined'
+*** test_invalid (duk_safe_call)
+nargs 15: Error: invalid argument(s)
+length 16: Error: invalid argument(s)
+magic 128: Error: invalid argument(s)
+final top: 0
+==> rc=0, result='undefined'
+===*/
+
+int my_lfunc(duk_context *ctx) {
+	duk_idx_t i, n;
+
+	/* [ arg1 ... argN ] -> "call: N arg1 ... argN magic" */
+	n = duk_get_top(ctx);
+	duk_push_string(ctx, " ");
+	duk_push_string(ctx, "call:");
+	duk_push_int(ctx, n);
+	for (i = 0; i < n; i++) {
+		duk_dup(ctx, i);
+	}
+	duk_push_int(ctx, duk_get_magic(ctx));
+	duk_join(ctx, n + 3);
+	return 1;
+}
+
+int my_varargs(duk_context *ctx) {
+	duk_push_int(ctx, duk_get_top(ctx));
+	return 1;
+}
+
+int my_thrower(duk_context *ctx) {
+	duk_error(ctx, DUK_ERR_RANGE_ERROR, "aiee");
+	return 0;
+}
+
+int test_basic(duk_context *ctx) {
+	duk_push_c_lightfunc(ctx, my_lfunc, 2 /*nargs*/, 3 /*length*/, -5 /*magic*/);
+
+	printf("type: %d\n", (int) duk_get_type(ctx, -1));
+	printf("is_lightfunc: %d\n", (int) duk_is_lightfunc(ctx, -1));
+	printf("is_function: %d\n", (int) duk_is_function(ctx, -1));
+	printf("is_c_function: %d\n", (int) duk_is_c_function(ctx, -1));
+	printf("is_callable: %d\n", (int) duk_is_callable(ctx, -1));
+	printf("is_object: %d\n", (int) duk_is_object(ctx, -1));
+	printf("is_primitive: %d\n", (int) duk_is_primitive(ctx, -1));
+	printf("is_object_coercible: %d\n", (int) duk_is_object_coercible(ctx, -1));
+	printf("get_c_function ok: %d\n", (int) (duk_get_c_function(ctx, -1) == my_lfunc));
+	printf("get_length: %d\n", (int) duk_get_length(ctx, -1));
+
+	duk_push_global_object(ctx);
+	duk_insert(ctx, -2);
+	duk_put_prop_string(ctx, -2, "lf");
+	duk_push_c_lightfunc(ctx, my_varargs, DUK_VARARGS, 0, 0);
+	duk_put_prop_string(ctx, -2, "lfv");
+	duk_push_c_lightfunc(ctx, my_thrower, 0, 0, 0);
+	duk_put_prop_string(ctx, -2, "lft");
+	duk_pop(ctx);
+
+	duk_eval_string_noresult(ctx,
+		"print('typeof:', typeof lf);\n"
+		"print('length:', lf.length);\n"
+		"print('name ok:', /^light_[0-9a-f]+_fb32$/.test(lf.name));\n"
+		"print('toString ok:', /^function light_[0-9a-f]+_fb32\\(\\) \\{\\/\\* light \\*\\/\\}$/.test(String(lf)));\n"
+		"print(lf(1, 2, 3));\n"
+		"print(lf.call(null, 10, 20));\n"
+		"print(lf.apply(null, [ 3 ]));\n"
+		"print('new:', typeof new lf(4, 5), lf(4, 5));\n"
+		"var bf = lf.bind(null, 7);\n"
+		"print('bound:', bf(8).substring(6));\n"
+		"print('bound length:', bf.length);\n"
+		"print('varargs:', lfv(1, 2, 3, 4));\n"
+		"print('strict equals:', lf === lf, lf === lfv);\n"
+		"var obj = Object(lf);\n"
+		"print('object coerced:', typeof obj, typeof lf);\n"
+		"print('coerced ' + obj(1, 2));\n"
+		"print('coerced length:', obj.length);\n"
+		"print(\"'length' in lf:\", 'length' in lf);\n"
+		"print(\"'call' in lf:\", 'call' in lf);\n"
+		"print(\"'foo' in lf:\", 'foo' in lf);\n"
+		"print('delete length:', delete lf.length);\n"
+		"print('delete foo:', delete lf.foo);\n"
+		"print('getPrototypeOf:', Object.getPrototypeOf(lf) === Function.prototype);\n"
+		"print('json:', JSON.stringify({ a: lf }));\n"
+		"print('jx:', Duktape.enc('jx', { a: lf }));\n"
+		"print('bool:', !!lf);\n"
+		"try { lft(); } catch (e) { print('error from lightfunc:', e.name, /light_/.test(e.stack)); }\n");
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+int test_invalid_nargs(duk_context *ctx) {
+	duk_push_c_lightfunc(ctx, my_varargs, 15, 0, 0);
+	return 0;
+}
+
+int test_invalid_length(duk_context *ctx) {
+	duk_push_c_lightfunc(ctx, my_varargs, 0, 16, 0);
+	return 0;
+}
+
+int test_invalid_magic(duk_context *ctx) {
+	duk_push_c_lightfunc(ctx, my_varargs, 0, 0, 128);
+	return 0;
+}
+
+int test_invalid(duk_context *ctx) {
+	int rc;
+
+	rc = duk_safe_call(ctx, test_invalid_nargs, 0, 1);
+	printf("nargs 15: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+	rc = duk_safe_call(ctx, test_invalid_length, 0, 1);
+	printf("length 16: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+	rc = duk_safe_call(ctx, test_invalid_magic, 0, 1);
+	printf("magic 128: %s\n", duk_safe_to_string(ctx, -1));
+	duk_pop(ctx);
+	(void) rc;
+
+	printf("final top: %d\n", (int) duk_get_top(ctx));
+	return 0;
+}
+
+void test(duk_context *ctx) {
+	TEST_SAFE_CALL(test_basic);
+	TEST_SAFE_CALL(test_invalid);
+}
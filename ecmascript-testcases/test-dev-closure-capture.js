@@ -0,0 +1,117 @@
+/*
+ *  Closures only capture the variables they actually reference: other
+ *  variables stay in registers and an inner function which references
+ *  nothing in its enclosing function doesn't need the enclosing function's
+ *  environment record.  Semantics must be unaffected.
+ */
+
+/*===
+partial capture
+1 8 12
+2 3
+no capture
+2,2,2
+grandparent
+gp gp2
+eval
+5 7 undefined
+with and catch
+9 3 10
+named function expression
+120
+arguments
+2 4
+late binding
+before after
+===*/
+
+function partialTest(a, b) {
+    var x = 1, y = 2, unused = 3;
+    var f = function () { return x; };
+    var g = function (q) { return q * 2; };
+    var h = function () { var t = 10; return function () { return t + y; }; };
+    print(f(), g(4), h()());
+    x = 2;
+    y = 3;
+    print(f(), y);
+}
+
+function noCaptureTest() {
+    var fs = [], i;
+    for (i = 0; i < 3; i++) {
+        fs.push(function (z) { return z + 1; });
+    }
+    print(fs.map(function (f) { return f(1); }));
+}
+
+function grandTest() {
+    var gp = 'gp';
+    var res = function () { return function () { return gp; }; };
+    var first = res()();
+    gp = 'gp2';
+    print(first, res()());
+}
+
+function evalTest() {
+    var k = 5;
+    var f1 = function () { return eval('k'); };
+    eval('var zz = 7');
+    var f2 = function () { return zz; };
+    var f3 = function () { return typeof nonexistent; };
+    print(f1(), f2(), f3() === 'undefined' ? undefined : 'bad');
+}
+
+function withCatchTest() {
+    var o = { w: 9 };
+    var f, g, h;
+    with (o) {
+        f = function () { return w; };
+    }
+    try {
+        throw 3;
+    } catch (e) {
+        g = function () { return e; };
+    }
+    h = function () { var w = 10; return w; };
+    print(f(), g(), h());
+}
+
+function namedTest() {
+    var n = function fact(v) { return v <= 1 ? 1 : v * fact(v - 1); };
+    print(n(5));
+}
+
+function argumentsTest(a) {
+    var f = function () { return arguments.length; };
+    a = 4;
+    print(f(1, 2), arguments[0]);
+}
+
+function lateTest() {
+    var f = function () { return v; };
+    var v = 'before';
+    var r1 = f();
+    v = 'after';
+    print(r1, f());
+}
+
+try {
+    print('partial capture');
+    partialTest(1, 2);
+    print('no capture');
+    noCaptureTest();
+    print('grandparent');
+    grandTest();
+    print('eval');
+    evalTest();
+    print('with and catch');
+    withCatchTest();
+    print('named function expression');
+    namedTest();
+    print('arguments');
+    argumentsTest(1);
+    print('late binding');
+    lateTest();
+} catch (e) {
+    print(e);
+}
@@ -0,0 +1,164 @@
+/*
+ *  Recurring eval() and Function constructor sources reuse a cached
+ *  function template.  Every evaluation must still get its own closure,
+ *  environment and 'this' binding, and strict and non-strict code with
+ *  the same source must not be mixed up.
+ */
+
+/*===
+direct eval
+0 2 4 6
+1 2 3 4
+own environment
+10 11 undefined
+strictness
+non-strict 1 undefined
+strict undefined undefined
+non-strict 1 undefined
+indirect eval
+global global 3
+this binding
+obj global
+function constructor
+false false 3 7
+false
+inner closures
+1 2 1
+syntax error
+SyntaxError SyntaxError SyntaxError
+many sources
+3600
+===*/
+
+function directEval() {
+    var res;
+    var i;
+
+    function dbl(x) { return eval('x * 2'); }
+    function inc(x) { 'use strict'; return eval('var y = x + 1; y'); }
+
+    print('direct eval');
+    res = [];
+    for (i = 0; i < 4; i++) {
+        res.push(dbl(i));
+    }
+    print(res.join(' '));
+    res = [];
+    for (i = 0; i < 4; i++) {
+        res.push(inc(i));
+    }
+    print(res.join(' '));
+}
+
+function ownEnvironment() {
+    function declare(v) {
+        eval('var z = v');
+        return z;
+    }
+
+    print('own environment');
+    print(declare(10), declare(11), typeof z);
+}
+
+function strictness() {
+    var src = 'var sv = 1; typeof this === "undefined" ? "strict" : "non-strict"';
+
+    function nonStrict() {
+        var r = eval(src);
+        return r + ' ' + sv;
+    }
+    function strict() {
+        'use strict';
+        var r = eval(src);
+        return r + ' ' + typeof sv;
+    }
+
+    print('strictness');
+    print(nonStrict.call(undefined), typeof sv);
+    print(strict.call(undefined), typeof sv);
+    print(nonStrict.call(undefined), typeof sv);
+}
+
+function indirectEval() {
+    var ie = eval;
+    var gvar = 'local';
+
+    print('indirect eval');
+    ie('var gvar = "global"; this.gcount = (this.gcount || 0) + 1;');
+    ie('var gvar = "global"; this.gcount = (this.gcount || 0) + 1;');
+    ie('var gvar = "global"; this.gcount = (this.gcount || 0) + 1;');
+    print(ie('gvar'), this.gvar, ie('gcount'));
+}
+
+function thisBinding() {
+    var obj = { name: 'obj', get: function () { return eval('this.name'); } };
+    var ie = eval;
+
+    this.name = 'global';
+    print('this binding');
+    print(obj.get(), ie('this.name'));
+}
+
+function functionConstructor() {
+    var f1, f2, f3;
+
+    print('function constructor');
+    f1 = new Function('a', 'b', 'return a + b;');
+    f2 = new Function('a', 'b', 'return a + b;');
+    f3 = Function('a', 'b', 'return a + b;');
+    print(f1 === f2, f2 === f3, f1(1, 2), f3(3, 4));
+
+    f1.prototype.marker = 1;
+    print('marker' in f2.prototype);
+}
+
+function innerClosures() {
+    var src = '(function () { var n = 0; return function () { return ++n; }; })()';
+    var c1 = eval(src);
+    var c2 = eval(src);
+
+    print('inner closures');
+    c1();
+    print(c1() - 1, c1() - 1, c2());
+}
+
+function syntaxError() {
+    var res = [];
+    var i;
+
+    print('syntax error');
+    for (i = 0; i < 3; i++) {
+        try {
+            eval('1 +');
+        } catch (e) {
+            res.push(e.name);
+        }
+    }
+    print(res.join(' '));
+}
+
+function manySources() {
+    var i;
+    var sum = 0;
+
+    /* More distinct sources than fit into the cache, evicting entries. */
+    print('many sources');
+    for (i = 0; i < 300; i++) {
+        sum += eval('(' + (i % 40) + ') - ' + (i % 40) + ' + 12');
+    }
+    print(sum);
+}
+
+try {
+    directEval();
+    ownEnvironment();
+    strictness();
+    indirectEval();
+    thisBinding();
+    functionConstructor();
+    innerClosures();
+    syntaxError();
+    manySources();
+} catch (e) {
+    print(e.stack || e);
+}
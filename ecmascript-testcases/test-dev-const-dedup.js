@@ -0,0 +1,60 @@
+/*
+ *  Constant deduplication must follow SameValue semantics: +0 and -0 are
+ *  different constants, all NaNs are the same constant, and strings are
+ *  never confused with numbers having the same string form.  Functions
+ *  with many constants use a hashed lookup, so test both small and large
+ *  constant counts.
+ */
+
+function describe(v) {
+    if (typeof v === 'number' && v === 0) {
+        return (1 / v < 0 ? '-0' : '+0');
+    }
+    return typeof v + ':' + String(v);
+}
+
+/*===
+small
++0 -0 number:NaN number:NaN string:0 string:-0 number:1 string:1 number:1
+===*/
+
+print('small');
+try {
+    print([ 0, -0, 0/0, NaN, '0', '-0', 1, '1', 1 ].map(describe).join(' '));
+} catch (e) {
+    print(e);
+}
+
+/*===
+large
+618
+string:str0 number:0.25 string:str1 number:1.25
++0 -0 number:NaN number:NaN string:0 string:-0 string:NaN number:1e+21 string:1e+21 -0 +0 number:NaN string:str5 number:5.25 string:5.25 number:Infinity number:-Infinity string:Infinity
+===*/
+
+/* Generate a function with enough distinct literals so that constant
+ * lookups go through the const maps, then repeat the tricky values.
+ */
+
+print('large');
+try {
+    (function () {
+        var lits = [];
+        var i, fn, res;
+
+        for (i = 0; i < 300; i++) {
+            lits.push('"str' + i + '"');
+            lits.push(String(i + 0.25));
+        }
+        lits.push('0', '-0', '0/0', 'NaN', '"0"', '"-0"', '"NaN"', '1e21', '"1e+21"',
+                  '-0', '0', 'NaN', '"str5"', '5.25', '"5.25"', 'Infinity', '-Infinity', '"Infinity"');
+        fn = new Function('return [' + lits.join(',') + '];');
+        res = fn();
+
+        print(res.length);
+        print(res.slice(0, 4).map(describe).join(' '));
+        print(res.slice(600).map(describe).join(' '));
+    })();
+} catch (e) {
+    print(e);
+}
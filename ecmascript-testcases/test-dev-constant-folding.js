@@ -0,0 +1,244 @@
+/*
+ *  Constant folding and dead code elimination in the compiler
+ *  (development test, semantics must be unchanged).
+ */
+
+function f(x) { print('f called', x); return x; }
+
+/*===
+arith
+3 -1 6 0.5 1 Infinity -Infinity NaN
+12 1null 1undefined truefalse NaN 2 1
+5 -5 -6 false true 0
+number string boolean undefined object
+-3 1 0 2 4294967295 -1 4294967294
+===*/
+
+print('arith');
+try {
+    print(1 + 2, 1 - 2, 2 * 3, 1 / 2, 7 % 3, 1 / 0, -1 / 0, 0 / 0);
+    print('1' + 2, 1 + 'null', '1' + undefined, true + 'false', 1 + undefined, true + 1, null + 1);
+    print(+'5', -'5', ~5, !1, !'', -(-0));
+    print(typeof 1, typeof 'x', typeof !0, typeof undefined, typeof null);
+    print(~2, 1 & 3, 1 ^ 1, 1 << 1, -1 >>> 0, -1 >> 0, -2 >>> 0);
+} catch (e) {
+    print(e);
+}
+
+/*===
+compare
+true false true true false
+true false true false
+false true false false
+true true false true
+true
+===*/
+
+print('compare');
+try {
+    print(1 < 2, 2 < 1, 'a' < 'b', '10' < 9 === false, NaN < 1);
+    print(1 == '1', 1 === '1', null == undefined, null === undefined);
+    print(NaN == NaN, 1 != '2', 'x' !== 'x', 0 > 0);
+    print(1 <= 1, '2' >= 2, undefined <= 0, null >= 0);
+    print(1 / 0 === 1 / 0);
+} catch (e) {
+    print(e);
+}
+
+/*===
+conditions
+else 1
+then 2
+f called 1
+after 3
+f called 0
+else 4
+===*/
+
+print('conditions');
+try {
+    if (false) { print('then 1'); } else { print('else 1'); }
+    if (!0) { print('then 2'); } else { print('else 2'); }
+    if ((f(1), false)) { print('then 3'); }
+    print('after 3');
+    if (f(0) || (1 > 2)) { print('then 4'); } else { print('else 4'); }
+} catch (e) {
+    print(e);
+}
+
+/*===
+logical
+false 0 true 1
+f called 2
+2
+f called 3
+3
+yes no
+===*/
+
+print('logical');
+try {
+    print(false && f(1), 0 && f(1), true || f(1), 1 || f(1));
+    print(true && f(2));
+    print(false || f(3));
+    print(true ? 'yes' : f('x'), 0 ? f('y') : 'no');
+} catch (e) {
+    print(e);
+}
+
+/*===
+loops
+while true 0
+while true 1
+while true 2
+do once
+for false done
+===*/
+
+print('loops');
+try {
+    var i = 0;
+    while (false) { print('never'); }
+    while (true) { print('while true', i); if (++i >= 3) { break; } }
+    do { print('do once'); } while (0);
+    for (; false; ) { print('never'); }
+    print('for false done');
+} catch (e) {
+    print(e);
+}
+
+/*===
+dead code
+1
+function undefined
+thrown
+2 3
+10 11 20
+===*/
+
+print('dead code');
+
+function deadAfterReturn() {
+    return inner();
+    print('never');
+    var x = 1;
+    function inner() { return 1; }
+}
+
+function deadHoisting() {
+    return typeof g + ' ' + y;
+    var y = 123;
+    function g() {}
+}
+
+function deadAfterThrow() {
+    throw 'thrown';
+    print('never');
+}
+
+function deadInLoop() {
+    var res = [];
+    for (var i = 0; i < 4; i++) {
+        if (i === 0) { continue; print('never'); }
+        if (i === 1) { { continue; } print('never'); }
+        res.push(i);
+        if (i === 3) { break; print('never'); }
+    }
+    return res.join(' ');
+}
+
+function deadLabelled() {
+    var r = [];
+    outer:
+    for (var i = 0; i < 2; i++) {
+        for (;;) {
+            r.push(10 + i);
+            continue outer;
+            r.push(15);
+        }
+    }
+    r.push(20);
+    return r.join(' ');
+}
+
+try {
+    print(deadAfterReturn());
+    print(deadHoisting());
+    try { deadAfterThrow(); } catch (e) { print(e); }
+    print(deadInLoop());
+    print(deadLabelled());
+} catch (e) {
+    print(e);
+}
+
+/*===
+switch
+case 1
+case 2
+case 3
+default
+default
+===*/
+
+print('switch');
+
+function sw(x) {
+    switch (x) {
+    case 1:
+        print('case 1');
+        break;
+        print('never');
+    case 2:
+        print('case 2');
+        return;
+    case 3:
+        print('case 3');
+    default:
+        print('default');
+    }
+}
+
+try {
+    sw(1);
+    sw(2);
+    sw(3);
+    sw(4);
+} catch (e) {
+    print(e);
+}
+
+/*===
+eval
+3
+undefined
+4
+x
+5
+===*/
+
+print('eval');
+try {
+    print(eval('1 + 2'));
+    print(eval('if (false) { 1; }'));
+    print(eval('if (false) { 1; } else { 4; }'));
+    print(eval('"x"; while (false) { 2; }'));
+    print(eval('do { 5; } while (0);'));
+} catch (e) {
+    print(e);
+}
+
+/*===
+implicit return
+undefined
+1
+undefined
+===*/
+
+print('implicit return');
+try {
+    print((function () { if (true) { } })());
+    print((function () { if (true) { return 1; } else { return 2; } })());
+    print((function () { { } })());
+} catch (e) {
+    print(e);
+}
@@ -0,0 +1,112 @@
+/*
+ *  When a non-strict function gets at most as many arguments as it has
+ *  formals, its 'arguments' object is only created when its environment
+ *  record is (e.g. on first 'arguments' lookup).  The object must be
+ *  indistinguishable from one created on function entry.
+ */
+
+/*===
+formals modified before access
+3 2 changed 30 undefined
+3 2 changed 30
+missing arguments
+1 1 undefined
+0 undefined
+conditional access
+no arguments
+2 1,2
+extra arguments
+4 1,2,3,4
+duplicate formals
+2 1 3
+assignment and typeof
+object
+replaced
+closure before access
+2 11 21
+eval
+2 1 2
+strict
+3 1 2 3 100
+===*/
+
+function formalsTest(a, b, c, d) {
+    var x = 1;
+    a = 'changed';
+    c = c * 10;
+    print(arguments.length, x + 1, arguments[0], arguments[2], arguments[3]);
+    arguments[1] = 'mapped';
+    print(arguments.length, arguments[1] === b ? 2 : 'no', a, c);
+}
+
+function missingTest(a, b) {
+    if (arguments.length === 1) {
+        print(arguments.length, a, arguments[1]);
+    } else {
+        print(arguments.length, arguments[0]);
+    }
+}
+
+function conditionalTest(flag, a) {
+    if (!flag) {
+        print('no arguments');
+        return;
+    }
+    print(arguments.length, Array.prototype.slice.call(arguments).join(','));
+}
+
+function extraTest(a, b) {
+    print(arguments.length, Array.prototype.join.call(arguments, ','));
+}
+
+function duplicateTest(a, a) {
+    a = 3;
+    print(arguments.length, arguments[0], arguments[1]);
+}
+
+function assignTest(a) {
+    print(typeof arguments);
+    arguments = 'replaced';
+    print(arguments);
+}
+
+function closureTest(a, b) {
+    var f = function () { return a + 10; };
+    b = b + 10;
+    print(arguments.length, f(), arguments[1]);
+}
+
+function evalTest(a, b) {
+    print(eval('arguments.length'), eval('arguments[0]'), b);
+}
+
+function strictTest(a, b, c) {
+    'use strict';
+    a = 100;
+    print(arguments.length, arguments[0], arguments[1], arguments[2], a);
+}
+
+try {
+    print('formals modified before access');
+    formalsTest(1, 2, 3);
+    print('missing arguments');
+    missingTest(1);
+    missingTest();
+    print('conditional access');
+    conditionalTest(false, 2);
+    conditionalTest(1, 2);
+    print('extra arguments');
+    extraTest(1, 2, 3, 4);
+    print('duplicate formals');
+    duplicateTest(1, 2);
+    print('assignment and typeof');
+    assignTest();
+    print('closure before access');
+    closureTest(1, 11);
+    print('eval');
+    evalTest(1, 2);
+    print('strict');
+    strictTest(1, 2, 3);
+} catch (e) {
+    print(e);
+}
@@ -0,0 +1,174 @@
+/*
+ *  Integer arithmetic may use an internal 32-bit integer representation
+ *  (DUK_USE_FASTINT).  Results must be identical to IEEE double
+ *  arithmetic, including overflow, negative zero, and fractions.
+ */
+
+function fmt(x) {
+    if (x === 0 && 1 / x < 0) {
+        return '-0';
+    }
+    return String(x);
+}
+
+/*===
+overflow
+2147483648 -2147483649 4294967294 -4294967296
+4611686014132420600 -4611686016279904000
+2147483648 -2147483649
+-2147483648 2147483647
+===*/
+
+print('overflow');
+
+function overflowTest() {
+    var max = 2147483647;
+    var min = -2147483648;
+    var one = 1;
+    var a, b;
+
+    print(max + one, min - one, max + max, min + min);
+    print(max * max, min * max);
+
+    a = max; a++;
+    b = min; b--;
+    print(a, b);
+
+    a = max; a++; a--;
+    b = min; b--; b++;
+    print(b, a);
+}
+
+try {
+    overflowTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+negative zero
+-0 -0 -0 0
+-0 -0 -0
+-0 0
+-0 -0
+-Infinity Infinity
+===*/
+
+print('negative zero');
+
+function negativeZeroTest() {
+    var zero = 0;
+    var one = 1;
+    var mone = -1;
+    var five = 5;
+
+    print(fmt(zero * mone), fmt(mone * zero), fmt(-zero), fmt(zero * one));
+    print(fmt(zero / mone), fmt(-five % five), fmt(-five % one));
+    print(fmt(-five % -five), fmt(five % -five));
+    print(fmt(-(zero)), fmt(mone * zero + zero * mone));
+    print(one / (zero * mone), one / (zero * one));
+}
+
+try {
+    negativeZeroTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+division and modulo
+3 2.5 -2.5 2147483648 -2147483648
+1 -1 1 -1 0 NaN NaN
+Infinity -Infinity NaN
+===*/
+
+print('division and modulo');
+
+function divModTest() {
+    var a = 6, b = 2, c = 5, d = -5, min = -2147483648, mone = -1, zero = 0;
+
+    print(a / b, c / b, d / b, min / mone, min / 1);
+    print(c % b, d % b, c % -b, d % -b, min % mone === 0 ? 0 : 'x', c % zero, zero % zero);
+    print(c / zero, d / zero, zero / zero);
+}
+
+try {
+    divModTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+bitwise
+-1 4294967295 2147483647 1073741823
+-2147483648 -1 0 -2
+4294967295 -1 2147483648
+0 1 -2147483648
+===*/
+
+print('bitwise');
+
+function bitwiseTest() {
+    var m1 = -1, one = 1, big = 4294967295, min = -2147483648;
+
+    print(m1 | 0, m1 >>> 0, m1 >>> 1, m1 >>> 2);
+    print(one << 31, m1 >> 31, ~m1, big << 1);
+    print(big >>> 0, big | 0, min >>> 0);
+    print(one << 32 >> 1 & 0, one << 32, (one << 31) | 0);
+}
+
+try {
+    bitwiseTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+mixed
+1.5 0.5 3 2 true false
+0.30000000000000004 2 2
+true true false true
+===*/
+
+print('mixed');
+
+function mixedTest() {
+    var one = 1, half = 0.5, three = 3;
+    var d = 0.1, e = 0.2;
+    var arr = [ 1, 2, 3 ];
+
+    print(one + half, one - half, three, half * 4, half * 4 === 2, one === half * 2 + 1);
+    print(d + e, arr[half * 2 - 1 + 1], arr[one]);
+    print(one < three, half < one, three < half * 6, half * 4 <= 2);
+}
+
+try {
+    mixedTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+loop
+49995000 333283335000 16383 -537731848
+===*/
+
+print('loop');
+
+function loopTest() {
+    var i, sum = 0, sumsq = 0, bits = 0, wrap = 0;
+
+    for (i = 0; i < 10000; i++) {
+        sum += i;
+        sumsq += i * i;
+        bits |= i;
+        wrap = (wrap + i * 65537) | 0;
+    }
+    print(sum, sumsq, bits, wrap);
+}
+
+try {
+    loopTest();
+} catch (e) {
+    print(e);
+}
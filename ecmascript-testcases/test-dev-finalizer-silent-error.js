@@ -10,9 +10,14 @@
 }
 ---*/
 
+/* The finalizers don't capture test()'s variables, so the objects are
+ * only referenced from registers and are freed in reverse register order
+ * when test() returns.
+ */
+
 /*===
-obj1 finalizer
 WARNING: finalizer failed: ReferenceError
+obj1 finalizer
 ===*/
 
 function test() {
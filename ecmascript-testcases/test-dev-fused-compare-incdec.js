@@ -0,0 +1,129 @@
+/*
+ *  Conditions of if/for/while/do-while statements which are comparisons
+ *  compile to a fused compare-and-jump, and '++'/'--' on a register bound
+ *  variable to an in-place increment/decrement.  Semantics must match the
+ *  unfused sequences, including coercion order, NaN and large registers.
+ */
+
+/*===
+compare
+if: T F T F F T T F
+if: F T F T F F F F
+if: T F T F F T T F
+if: F T F T F F T T
+loops
+for 5 while 5 do 5 down 5
+for 0 while 0 do 1
+strings 3 objects 2
+coercion
+valueOf x
+valueOf y
+x < y false
+valueOf x
+valueOf y
+x > y false
+incdec
+1 3 3 1
+2 3
+NaN NaN number number
+abc NaN 1 2
+valueOf z
+3 4
+2147483647 2147483648 -2147483648 -2147483649
+0 1 0
+Infinity -Infinity
+many registers
+299 298 5
+===*/
+
+function cmp(x, y) {
+    var r = [];
+    if (x == y) { r.push('T'); } else { r.push('F'); }
+    if (x != y) { r.push('T'); } else { r.push('F'); }
+    if (x === y) { r.push('T'); } else { r.push('F'); }
+    if (x !== y) { r.push('T'); } else { r.push('F'); }
+    if (x < y) { r.push('T'); } else { r.push('F'); }
+    if (x <= y) { r.push('T'); } else { r.push('F'); }
+    if (x >= y) { r.push('T'); } else { r.push('F'); }
+    if (x > y) { r.push('T'); } else { r.push('F'); }
+    print('if:', r.join(' '));
+}
+
+function compareTest() {
+    cmp(1, 1);
+    cmp(NaN, NaN);
+    cmp(-0, 0);
+    cmp('10', 9);
+}
+
+function loopTest() {
+    var i, n, c;
+
+    n = 0; for (i = 0; i < 5; i++) { n++; }
+    c = 0; i = 0; while (i !== 5) { c++; i++; }
+    print('for', n, 'while', c, 'do', (function () { var k = 0; do { k++; } while (k <= 4); return k; })(),
+          'down', (function () { var k = 5, m = 0; while (k > 0) { k--; m++; } return m; })());
+
+    n = 0; for (i = 0; i < NaN; i++) { n++; }
+    c = 0; while (NaN >= 0) { c++; }
+    print('for', n, 'while', c, 'do', (function () { var k = 0; do { k++; } while (k < NaN); return k; })());
+
+    n = 0; for (i = 'a'; i < 'aaaa'; i += 'a') { n++; }
+    c = 0; i = { valueOf: function () { return c; } }; while (i < 2) { c++; }
+    print('strings', n, 'objects', c);
+}
+
+function coercionTest() {
+    var x = { valueOf: function () { print('valueOf x'); return NaN; } };
+    var y = { valueOf: function () { print('valueOf y'); return 1; } };
+
+    if (x < y) { print('x < y true'); } else { print('x < y false'); }
+    if (x > y) { print('x > y true'); } else { print('x > y false'); }
+}
+
+function incdecTest() {
+    var a = 1, b, c, d, s = 'abc', u, big = 2147483647, small = -2147483648, nz = -0;
+    var z = { valueOf: function () { print('valueOf z'); return 3; } };
+    var inf = Infinity, ninf = -Infinity;
+
+    b = a++; c = ++a; d = a--;
+    print(b, c, d, --a);
+    b = ++a; print(b, ++a);
+    b = u++; c = u--;
+    print(b, c, typeof b, typeof u);
+    b = s++;
+    print('abc', b, (s = '0', ++s), (s = '1', ++s));
+    b = z++;
+    print(b, z);
+    print(big, ++big, small, --small);
+    b = nz--; print(b, ++b, 1 / nz < 0 ? 0 : 0);
+    print(++inf, --ninf);
+}
+
+function manyRegistersTest() {
+    /* more than 256 register bound variables, loop variable last */
+    var src = [], i;
+
+    for (i = 0; i < 300; i++) {
+        src.push('var v' + i + ' = ' + i + ';');
+    }
+    src.push('var n = 0, j;');
+    src.push('for (j = 0; j < v299; j++) { n++; }');
+    src.push('v299++; v298--; return [n, v298 + 1, v299 - v5 - 290];');
+    print(new Function(src.join('\n'))().join(' '));
+}
+
+try {
+    print('compare');
+    compareTest();
+    print('loops');
+    loopTest();
+    print('coercion');
+    coercionTest();
+    print('incdec');
+    incdecTest();
+    print('many registers');
+    manyRegistersTest();
+} catch (e) {
+    print(e.stack || e);
+}
@@ -0,0 +1,127 @@
+/*
+ *  Global variable reads and writes from hot loops use the instruction
+ *  inline caches.  Declaring, deleting, redefining and shadowing globals
+ *  must behave exactly as without caching.
+ */
+
+/*===
+read and write
+10 20
+redefine as accessor
+getter getter
+setter 5
+delete
+ReferenceError
+redeclare
+7
+inherited
+from prototype own
+non-writable
+NaN undefined
+TypeError
+shadowing
+1 1 shadowed
+with
+global from-with global
+arguments
+2
+===*/
+
+gv1 = 1;  /* configurable, unlike a declared global */
+var gv2 = 2;
+
+function readLoop(n) {
+    var i, res;
+    for (i = 0; i < n; i++) {
+        res = gv1;
+    }
+    return res;
+}
+
+function writeLoop(n, v) {
+    var i;
+    for (i = 0; i < n; i++) {
+        gv2 = v;
+    }
+}
+
+print('read and write');
+gv1 = 10;
+writeLoop(10, 20);
+print(readLoop(10), gv2);
+
+print('redefine as accessor');
+Object.defineProperty(this, 'gv1', {
+    get: function () { return 'getter'; },
+    set: function (v) { print('setter', v); },
+    configurable: true
+});
+print(readLoop(10), readLoop(1));
+function writeGv1(v) { gv1 = v; }
+writeGv1(5);
+
+print('delete');
+delete gv1;  /* configurable accessor */
+try {
+    readLoop(10);
+} catch (e) {
+    print(e.name);
+}
+
+print('redeclare');
+eval('var gv1 = 7');
+print(readLoop(10));
+
+print('inherited');
+Object.prototype.protoVar = 'from prototype';
+function readProto() { return protoVar; }
+print(readProto() + (readProto() === 'from prototype' ? '' : 'bad'), (function () {
+    this.protoVar = 'own';
+    return readProto();
+})());
+
+print('non-writable');
+function readBuiltins() { return String(NaN) + ' ' + String(undefined); }
+print(readBuiltins());
+function writeNaNStrict() { 'use strict'; NaN = 1; }
+try {
+    writeNaNStrict();
+} catch (e) {
+    print(e.name);
+}
+
+print('shadowing');
+var gv3 = 1;
+function shadowTest(code) {
+    var f = function () { return gv3; };
+    var before = f();
+    eval(code);
+    return [ before, f() ];
+}
+print(shadowTest('').join(' '), shadowTest('var gv3 = "shadowed"')[1]);
+
+print('with');
+var gv4 = 'global';
+function withTest() {
+    var res = [];
+    var o = {};
+    var i;
+    for (i = 0; i < 3; i++) {
+        with (o) {
+            res.push(gv4);
+        }
+        o.gv4 = 'from-with';
+        if (i === 1) {
+            delete o.gv4;
+        }
+    }
+    return res;
+}
+print(withTest().join(' '));
+
+print('arguments');
+var arguments = 'global arguments';
+function argsTest(a, b) {
+    return arguments.length;
+}
+print(argsTest(1, 2));
@@ -0,0 +1,214 @@
+/*
+ *  Objects created the same way may share property layout internally
+ *  (DUK_USE_HOBJECT_SHAPES).  Changes to the keys or attributes of one
+ *  object must never be visible through another object.
+ */
+
+/*===
+same layout
+0 0 x,y
+1 2 x,y
+999 1998 x,y
+===*/
+
+print('same layout');
+
+function sameLayoutTest() {
+    function Point(x, y) {
+        this.x = x;
+        this.y = y;
+    }
+    var pts = [];
+    var i;
+
+    for (i = 0; i < 1000; i++) {
+        pts.push(new Point(i, i * 2));
+    }
+
+    [ 0, 1, 999 ].forEach(function (i) {
+        print(pts[i].x, pts[i].y, Object.keys(pts[i]));
+    });
+}
+
+try {
+    sameLayoutTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+key order
+a,b
+b,a
+a,b,c
+a,b
+===*/
+
+print('key order');
+
+function keyOrderTest() {
+    var o1 = { a: 1, b: 2 };
+    var o2 = { b: 1, a: 2 };
+    var o3 = { a: 1, b: 2 };
+    var o4 = { a: 1, b: 2 };
+
+    o3.c = 3;
+    print(Object.keys(o1));
+    print(Object.keys(o2));
+    print(Object.keys(o3));
+    print(Object.keys(o4));
+}
+
+try {
+    keyOrderTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+delete
+{"a":1,"c":3}
+{"a":1,"b":2,"c":3}
+{"a":1,"c":3,"b":4}
+{"a":1,"b":2,"c":3}
+===*/
+
+print('delete');
+
+function deleteTest() {
+    var o1 = { a: 1, b: 2, c: 3 };
+    var o2 = { a: 1, b: 2, c: 3 };
+
+    delete o1.b;
+    print(JSON.stringify(o1));
+    print(JSON.stringify(o2));
+    o1.b = 4;
+    print(JSON.stringify(o1));
+    print(JSON.stringify(o2));
+}
+
+try {
+    deleteTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+attributes
+{"value":1,"writable":false,"enumerable":true,"configurable":true}
+{"value":1,"writable":true,"enumerable":true,"configurable":true}
+foo
+foo,bar
+1 2
+true false
+accessor 1
+===*/
+
+print('attributes');
+
+function attributesTest() {
+    var o1 = { foo: 1 };
+    var o2 = { foo: 1 };
+    var o3 = { foo: 1 };
+    var o4 = { foo: 1 };
+
+    Object.defineProperty(o1, 'foo', { writable: false });
+    print(JSON.stringify(Object.getOwnPropertyDescriptor(o1, 'foo')));
+    print(JSON.stringify(Object.getOwnPropertyDescriptor(o2, 'foo')));
+
+    // Same key with different attributes must not share layout.
+    Object.defineProperty(o1, 'bar', { value: 2, enumerable: false });
+    o2.bar = 2;
+    print(Object.keys(o1));
+    print(Object.keys(o2));
+
+    Object.freeze(o3);
+    o3.foo = 2;
+    o4.foo = 2;
+    print(o3.foo, o4.foo);
+    print(Object.isFrozen(o3), Object.isFrozen(o4));
+
+    Object.defineProperty(o4, 'foo', { get: function () { return 'accessor'; } });
+    print(o4.foo, o2.foo);
+}
+
+try {
+    attributesTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+many keys
+100 0 99
+99 undefined 99
+100 0 99
+===*/
+
+print('many keys');
+
+function manyKeysTest() {
+    var o1 = {};
+    var o2 = {};
+    var i;
+
+    for (i = 0; i < 100; i++) {
+        o1['key' + i] = i;
+        o2['key' + i] = i;
+    }
+    print(Object.keys(o1).length, o1.key0, o1.key99);
+    delete o1.key0;
+    print(Object.keys(o1).length, o1.key0, o1.key99);
+    print(Object.keys(o2).length, o2.key0, o2.key99);
+}
+
+try {
+    manyKeysTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+gc
+200 200
+===*/
+
+print('gc');
+
+function gcTest() {
+    var keep = [];
+    var i, j, o;
+
+    for (i = 0; i < 2000; i++) {
+        o = {};
+        o['k' + (i % 7)] = i;
+        if (i % 5 === 0) {
+            delete o['k' + (i % 7)];
+            o.readded = true;
+        }
+        if (i % 10 === 0) {
+            keep.push(o);
+        }
+    }
+    if (typeof Duktape === 'object') {
+        Duktape.gc();
+    }
+    for (i = 0; i < 2000; i++) {
+        o = {};
+        o['k' + (i % 7)] = i;
+    }
+
+    j = 0;
+    keep.forEach(function (o) {
+        if (o.readded === true) {
+            j++;
+        }
+    });
+    print(keep.length, j);
+}
+
+try {
+    gcTest();
+} catch (e) {
+    print(e);
+}
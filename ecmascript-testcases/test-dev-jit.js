@@ -0,0 +1,182 @@
+/*
+ *  Hot loops which get compiled by the baseline JIT (DUK_USE_JIT) when
+ *  enabled.  Results must be identical to interpreted execution, also
+ *  when operand types change after compilation.
+ */
+
+/*===
+arithmetic
+4999950000 2499975000 0.5 -99999
+NaN Infinity -Infinity -0
+===*/
+
+print('arithmetic');
+
+function arithTest() {
+    var i, s = 0, h = 0, p = 1, d = 0;
+    var nan, inf, ninf, nz;
+
+    for (i = 0; i < 100000; i++) {
+        s = s + i;
+        h += i / 2;
+        p = p * 1;
+        d = d - 1;
+    }
+    print(s, h, p / 2, d + 1);
+
+    for (i = 0; i < 2000; i++) {
+        nan = (i - i) / 0;
+        inf = (i + 1) / 0;
+        ninf = -(i + 1) / 0;
+        nz = 0 * -1;
+    }
+    print(nan, inf, ninf, 1 / nz < 0 ? '-0' : '0');
+}
+
+arithTest();
+
+/*===
+compare
+2000 2000 0 0
+1999 1999 1 1
+0 0 0 0
+===*/
+
+print('compare');
+
+function compareTest(a) {
+    var i, lt = 0, le = 0, gt = 0, ge = 0;
+
+    for (i = 0; i < 2000; i++) {
+        if (i < a) { lt++; }
+        if (i <= a) { le++; }
+        if (i > a) { gt++; }
+        if (i >= a) { ge++; }
+    }
+    print(lt, le, gt, ge);
+}
+
+compareTest(1e9);
+compareTest(1998.5);
+compareTest(NaN);
+
+/*===
+types
+2999abcabc 1500
+true false null undefined
+===*/
+
+print('types');
+
+function typeTest() {
+    var i, x, s = 0, n = 0, t, f, nl, u;
+
+    for (i = 0; i < 3000; i++) {
+        /* switch to string concatenation halfway through */
+        x = (i < 2999 ? 1 : 'abcabc');
+        s = s + x;
+        if (i % 2) { n++; }
+        t = true; f = false; nl = null; u = undefined;
+    }
+    print(s, n);
+    print(t, f, nl, u);
+}
+
+typeTest();
+
+/*===
+objects
+10000 10000 foofoofoo
+===*/
+
+print('objects');
+
+function objectTest() {
+    var i, o = { count: 0 }, arr = [], str = '';
+
+    for (i = 0; i < 10000; i++) {
+        o.count = o.count + 1;
+        arr[i] = i;
+        if (i % 5000 === 0) {
+            str = str + 'foo';
+        }
+    }
+    str += 'foo';
+    print(o.count, arr.length, str);
+}
+
+objectTest();
+
+/*===
+calls and errors
+1000000
+caught: RangeError 1234
+===*/
+
+print('calls and errors');
+
+function add(a, b) {
+    return a + b;
+}
+
+function callTest() {
+    var i, s = 0;
+
+    for (i = 0; i < 1000; i++) {
+        s = add(s, 1000);
+    }
+    print(s);
+}
+
+callTest();
+
+function errorTest() {
+    var i;
+
+    try {
+        for (i = 0; i < 100000; i++) {
+            if (i === 1234) {
+                throw new RangeError('at ' + i);
+            }
+        }
+    } catch (e) {
+        print('caught:', e.name, i);
+    }
+}
+
+errorTest();
+
+/*===
+closures
+399980000 20000
+===*/
+
+/* Closures of the same function share the hotness counter and compiled
+ * code: no single closure below gets hot on its own, but together they
+ * do.  Each closure still sees its own captured variable.
+ */
+
+print('closures');
+
+function closureTest() {
+    var i, f, s = 0, n = 0;
+
+    function make(k) {
+        return function (x) {
+            var j, t = 0;
+            for (j = 0; j < 2; j++) {
+                t += x;
+            }
+            return t / 2 + k;
+        };
+    }
+
+    for (i = 0; i < 20000; i++) {
+        f = make(i);
+        s += f(i);
+        n++;
+    }
+    print(s, n);
+}
+
+closureTest();
@@ -0,0 +1,296 @@
+/*
+ *  Inner functions are compiled lazily when first called.  The laziness
+ *  must not be observable from Ecmascript code.
+ */
+
+/*===
+basic
+13 1 inner
+0 0 2
+getter 10
+getter 5
+===*/
+
+print('basic');
+
+function outer(a) {
+    var x = 10;
+    function inner(b) { return a + b + x; }
+    var unused = function () { return 'never called'; };
+    var obj = {
+        get foo() { return 'getter ' + x; },
+        set foo(v) { x = v; }
+    };
+    return [ inner, obj, unused ];
+}
+
+try {
+    var r = outer(1);
+    print(r[0](2), r[0].length, r[0].name);
+    print(r[2].length, outer(2)[2].length, outer.length + 1);
+    print(r[1].foo);
+    r[1].foo = 5;
+    print(r[1].foo);
+} catch (e) {
+    print(e);
+}
+
+/*===
+strict
+undefined
+object
+===*/
+
+print('strict');
+
+function strictOuter() {
+    'use strict';
+    return function () { return typeof this; };
+}
+function nonStrictOuter() {
+    return function () { return typeof this; };
+}
+
+try {
+    print(strictOuter()());
+    print(nonStrictOuter()());
+} catch (e) {
+    print(e);
+}
+
+/*===
+early errors
+SyntaxError
+SyntaxError
+SyntaxError
+===*/
+
+/* Syntax errors inside never-called inner functions are still detected
+ * when the outer function is compiled.
+ */
+
+print('early errors');
+
+[ 'function f() { function g() { var = 1; } }',
+  'function f() { function eval() { "use strict"; } }',
+  'function f() { return function () { "use strict"; var x = 010; }; }'
+].forEach(function (src) {
+    try {
+        eval(src);
+        print('no error');
+    } catch (e) {
+        print(e.name);
+    }
+});
+
+/*===
+shared template
+0,2,4
+0,2,4
+===*/
+
+/* Multiple closures created from the same template before and after the
+ * template has been compiled.
+ */
+
+print('shared template');
+
+try {
+    var fns = [];
+    var i;
+    for (i = 0; i < 3; i++) {
+        fns.push(function (k) { return function () { return k * 2; }; }(i));
+    }
+    print(fns.map(function (f) { return f(); }).join(','));
+    fns = [];
+    for (i = 0; i < 3; i++) {
+        fns.push(function (k) { return function () { return k * 2; }; }(i));
+    }
+    print(fns.map(function (f) { return f(); }).join(','));
+} catch (e) {
+    print(e);
+}
+
+/*===
+frozen
+true 3 frozen
+===*/
+
+print('frozen');
+
+try {
+    var frozenFn = Object.freeze(function frozen(a, b, c) { return 'frozen'; });
+    print(Object.isFrozen(frozenFn), frozenFn.length, frozenFn());
+} catch (e) {
+    print(e);
+}
+
+/*===
+thread
+yielded 1
+yielded 2
+===*/
+
+print('thread');
+
+try {
+    var thr = new Duktape.Thread(function (v) {
+        var res = Duktape.Thread.yield(v);
+        Duktape.Thread.yield(res + 1);
+    });
+    print('yielded', Duktape.Thread.resume(thr, 1));
+    print('yielded', Duktape.Thread.resume(thr, 1));
+} catch (e) {
+    print(e);
+}
+
+/*===
+misc
+3
+deep
+Error 164
+===*/
+
+print('misc');
+
+function argsTest() {
+    return function () { return arguments.length; };
+}
+function deep() {
+    return function () { return function () { return function () { return 'deep'; }; }; };
+}
+function thrower() {
+    return function () {
+        throw new Error('line number');
+    };
+}
+
+try {
+    print(argsTest()(1, 2, 3));
+    print(deep()()()());
+    try {
+        thrower()();
+    } catch (e) {
+        print(e.name, e.lineNumber);
+    }
+} catch (e) {
+    print(e);
+}
+
+/*===
+nested
+4 5
+eval 1 2
+args 2
+strict undefined
+NaN true
+getter 7
+fact 120
+shadow inner global
+Error 272
+===*/
+
+/* Functions nested several levels deep: when an outer function is compiled,
+ * its inner functions are not parsed again, so the information needed from
+ * them (where they end, strictness, free identifiers etc) must be preserved.
+ */
+
+print('nested');
+
+var globalName = 'global';
+
+function nestOuter() {
+    var a = 1;
+    return function () {
+        var b = 2;
+        return function () {
+            return function () {
+                a++;
+                return a + b;
+            };
+        };
+    };
+}
+function nestEval() {
+    var x = 1;
+    return function () {
+        var y = 2;
+        return function () {
+            return eval('x + " " + y');
+        };
+    };
+}
+function nestArgs() {
+    return function () {
+        return function () {
+            return function () { return arguments.length; };
+        };
+    };
+}
+function nestStrict() {
+    return function () {
+        return function () {
+            'use strict';
+            return function () { return this; };
+        };
+    };
+}
+function nestTokens() {
+    return function () {
+        var t = function () {} / 2;
+        var u = function () { return 1; }
+        (2);
+        return [ t, typeof u ];
+    };
+}
+function nestGetter() {
+    var v = 7;
+    return function () {
+        return { get g() { return function () { return 'getter ' + v; }; } };
+    };
+}
+function nestNamed() {
+    return function () {
+        return function fact(n) { return n <= 1 ? 1 : n * fact(n - 1); };
+    };
+}
+function nestShadow() {
+    var globalName = 'outer';
+    return function () {
+        var globalName = 'inner';
+        return function () {
+            return function () {
+                return [ 'shadow', globalName, this.globalName ].join(' ');
+            };
+        };
+    };
+}
+function nestThrow() {
+    return function () {
+        return function () {
+            return function () {
+                throw new Error('line number');
+            };
+        };
+    };
+}
+
+try {
+    var nf = nestOuter()()();
+    print(nf(), nf());
+    print('eval', nestEval()()());
+    print('args', nestArgs()()()(1, 2));
+    print('strict', nestStrict()()()());
+    var tk = nestTokens()();
+    print(tk[0], tk[1] === 'number');
+    print(nestGetter()().g());
+    print('fact', nestNamed()()(5));
+    print(nestShadow()()()());
+    try {
+        nestThrow()()()();
+    } catch (e) {
+        print(e.name, e.lineNumber);
+    }
+} catch (e) {
+    print(e);
+}
@@ -0,0 +1,176 @@
+/*
+ *  The lexer scans identifiers, string literals, simple integer literals
+ *  and comments directly from ASCII input bytes, and falls back to decoded
+ *  characters for non-ASCII characters, escapes and other special cases.
+ *  Tokens and line numbers must come out the same either way.
+ */
+
+/*---
+{
+    "custom": true
+}
+---*/
+
+/*===
+identifiers
+abc $x _y a1 z9$_
+äbc aä abcä
+iff
+SyntaxError
+escaped: 1 2
+long: 300 true
+strings
+ / hello / double / it's / say "hi"
+nonascii: 4 8364
+escapes: 7 10
+long: 250 true
+numbers
+0 7 123 999999999999999 1000000000000000000
+1.5 0.25 1000 0.01 31 8
+toString: 5
+SyntaxError
+SyntaxError
+SyntaxError
+comments
+1 2 3 4
+5 6
+7 8
+comment asi: 2
+SyntaxError
+SyntaxError
+line numbers
+line 2
+line 3
+line 3
+line 4
+line 5
+line 4
+line 6
+===*/
+
+function identifiers() {
+    var abc = 'abc', $x = '$x', _y = '_y', a1 = 'a1', z9$_ = 'z9$_';
+    var äbc = 'äbc', aä = 'aä', abcä = 'abcä';
+    var i;
+    var src;
+    var name;
+
+    print('identifiers');
+    print(abc, $x, _y, a1, z9$_);
+    print(äbc, aä, abcä);
+    print(eval('var iff = "iff"; iff'));
+    try {
+        eval('var if = 1;');
+        print('never here');
+    } catch (e) {
+        print(e.name);
+    }
+    print('escaped:', eval('var ab\\u0063 = 1; abc'), eval('var \\u0069f = 2; \\u0069f'));
+
+    /* Identifier longer than the lexer lookahead buffer. */
+    name = '';
+    for (i = 0; i < 300; i++) {
+        name += String.fromCharCode(97 + i % 26);
+    }
+    src = 'var ' + name + ' = 300; ' + name;
+    print('long:', eval(src), eval('"' + name + '"') === name);
+}
+
+function strings() {
+    var s;
+    var i;
+
+    print('strings');
+    print('' + "" + ' / hello / ' + "double" + ' / ' + "it's" + ' / ' + 'say "hi"');
+    s = 'aäb€';
+    print('nonascii:', s.length, s.charCodeAt(3));
+    s = 'a\tb\'c\x41B';
+    print('escapes:', s.length, 'a\nb'.charCodeAt(1));
+
+    s = '';
+    for (i = 0; i < 250; i++) {
+        s += 'x';
+    }
+    print('long:', eval("'" + s + "'").length, eval('"' + s + '"') === s);
+}
+
+function numbers() {
+    var srcs = [ '3in []', '0x', '1_' ];
+    var i;
+
+    print('numbers');
+    print(0, 7, 123, 999999999999999, 1000000000000000000);
+    print(1.5, .25, 1e3, 1e-2, 0x1f, eval('010'));
+    print('toString:', eval('5..toString()'));
+    for (i = 0; i < srcs.length; i++) {
+        try {
+            eval(srcs[i]);
+            print('never here');
+        } catch (e) {
+            print(e.name);
+        }
+    }
+}
+
+function comments() {
+    var srcs = [ 'var a = 1 /* */ var b = 2', '/* unterminated *' ];
+    var i;
+
+    print('comments');
+    print(1, // comment
+          2, /* comment */ 3, /**/ 4 /***/);
+    print(5, // kommentti ää
+          6 /* ää */);
+    print(7, /* ä *ä/ */ 8 /* ä **/);
+    print('comment asi:', eval('var a = 1 /*\n*/ var b = 2; b'));
+    for (i = 0; i < srcs.length; i++) {
+        try {
+            eval(srcs[i]);
+            print('never here');
+        } catch (e) {
+            print(e.name);
+        }
+    }
+}
+
+function lineNumbers() {
+    var srcs = [
+        '\n"foo',
+        '1;\n\n"foo',
+        '1; // ää\r\n/* x\r */ "foo',
+        '1;\r\n/* ä\u2028 */\r"foo',
+        '1;\n/* x\n\n*/\n"foo',
+        '1;\u2028// x\u2029"ää"\n"foo'
+    ];
+    var src;
+    var i;
+    var res;
+
+    /* Line continuation, and a comment longer than the lookahead buffer. */
+    src = '"a\\\nb";\n/*';
+    for (i = 0; i < 100; i++) {
+        src += 'x';
+    }
+    srcs.push(src + '*/\n\n\n@');
+
+    print('line numbers');
+    for (i = 0; i < srcs.length; i++) {
+        try {
+            eval(srcs[i]);
+            print('never here');
+        } catch (e) {
+            res = /^.*\(line (\d+)\)$/.exec(e.message);
+            print('line', res ? res[1] : 'n/a');
+        }
+    }
+}
+
+try {
+    identifiers();
+    strings();
+    numbers();
+    comments();
+    lineNumbers();
+} catch (e) {
+    print(e.stack || e);
+}
@@ -0,0 +1,135 @@
+/*
+ *  The lexer skips comment and string literal bodies several bytes at a
+ *  time, looking for the next quote, backslash, asterisk, line terminator
+ *  or non-ASCII byte.  Exercise such bytes at all positions relative to
+ *  the scan block size, and at the end of the input.
+ */
+
+/*---
+{
+    "custom": true
+}
+---*/
+
+/*===
+strings
+ok 328
+line comments
+ok 246
+block comments
+ok 328
+unterminated
+ok 164
+===*/
+
+function fill(n) {
+    var res = '';
+    var i;
+
+    for (i = 0; i < n; i++) {
+        res += String.fromCharCode(0x61 + i % 26);
+    }
+    return res;
+}
+
+function errorLine(src) {
+    var m;
+
+    try {
+        eval(src);
+    } catch (e) {
+        m = /^.*\(line (\d+)\)$/.exec(e.message);
+        return m ? Number(m[1]) : e.name;
+    }
+    return 'no error';
+}
+
+function check(state, what, got, expect) {
+    if (got === expect) {
+        state.ok++;
+    } else {
+        print('FAIL', what, JSON.stringify(got), JSON.stringify(expect));
+    }
+}
+
+function strings() {
+    var state = { ok: 0 };
+    var n, a, b;
+
+    print('strings');
+    for (n = 0; n <= 40; n++) {
+        a = fill(n);
+        b = fill(40 - n);
+        check(state, 'plain ' + n, eval('"' + a + '"'), a);
+        check(state, 'plain single ' + n, eval("'" + a + "'"), a);
+        check(state, 'other quote ' + n, eval('"' + a + "'" + b + '"'), a + "'" + b);
+        check(state, 'escape ' + n, eval('"' + a + '\\t' + b + '"'), a + '\t' + b);
+        check(state, 'escaped quote ' + n, eval('"' + a + '\\"' + b + '"'), a + '"' + b);
+        check(state, 'non-ascii ' + n, eval('"' + a + 'ä' + b + '"'), a + 'ä' + b);
+        check(state, 'non-bmp-ish ' + n, eval('"' + a + '€' + b + '"'), a + '€' + b);
+        check(state, 'continuation ' + n, eval('"' + a + '\\\n' + b + '"'), a + b);
+    }
+    print('ok', state.ok);
+}
+
+function lineComments() {
+    var state = { ok: 0 };
+    var n, a;
+
+    print('line comments');
+    for (n = 0; n <= 40; n++) {
+        a = fill(n);
+        check(state, 'lf ' + n, errorLine('//' + a + '\n@'), 2);
+        check(state, 'crlf ' + n, errorLine('//' + a + '\r\n@'), 2);
+        check(state, 'cr ' + n, errorLine('//' + a + '\r@'), 2);
+        check(state, 'ls ' + n, errorLine('//' + a + '\u2028@'), 2);
+        check(state, 'non-ascii ' + n, errorLine('//' + a + 'ä*/"\n\n@'), 3);
+        check(state, 'eof ' + n, eval('1; //' + a), 1);
+    }
+    print('ok', state.ok);
+}
+
+function blockComments() {
+    var state = { ok: 0 };
+    var n, a, b;
+
+    print('block comments');
+    for (n = 0; n <= 40; n++) {
+        a = fill(n);
+        b = fill(40 - n);
+        check(state, 'plain ' + n, eval('1 + /*' + a + '*/ 2'), 3);
+        check(state, 'asterisks ' + n, eval('1 + /*' + a + '*' + b + '**/ 2'), 3);
+        check(state, 'slash ' + n, eval('1 + /*' + a + '/' + b + '*/ 2'), 3);
+        check(state, 'non-ascii ' + n, eval('1 + /*' + a + '*ä/' + b + '*/ 2'), 3);
+        check(state, 'lineterm asi ' + n, eval('var x = 1 /*' + a + '\n' + b + '*/ x = 2; x'), 2);
+        check(state, 'lines ' + n, errorLine('/*' + a + '\r\n' + b + '\r-' + a + '\n*/\n@'), 5);
+        check(state, 'ls ' + n, errorLine('/*' + a + '\u2029' + b + '*/@'), 2);
+        check(state, 'no lineterm ' + n, errorLine('var x = 1 /*' + a + '*/ x = 2'), 1);
+    }
+    print('ok', state.ok);
+}
+
+function unterminated() {
+    var state = { ok: 0 };
+    var n, a;
+
+    print('unterminated');
+    for (n = 0; n <= 40; n++) {
+        a = fill(n);
+        check(state, 'string ' + n, errorLine('"' + a), 1);
+        check(state, 'string lf ' + n, errorLine('\n"' + a + '\n"'), 2);
+        check(state, 'comment ' + n, errorLine('/*' + a + '*'), 1);
+        /* comment errors are reported at the comment start */
+        check(state, 'comment lf ' + n, errorLine('\n/*' + a + '\n'), 2);
+    }
+    print('ok', state.ok);
+}
+
+try {
+    strings();
+    lineComments();
+    blockComments();
+    unterminated();
+} catch (e) {
+    print(e.stack || e);
+}
@@ -0,0 +1,93 @@
+/*
+ *  Arithmetic and comparison opcodes have inline fast paths for number
+ *  operands.  Results must match the generic coercion paths, including
+ *  NaN, negative zero and overwriting a register holding an object.
+ */
+
+/*===
+arithmetic
+3 -1 2 0.5 0
+NaN NaN Infinity -Infinity
+-0 -0 -0 0
+-1 1 NaN 0.5
+2147483648 -2147483649 4611686014132420600
+mixed
+12 -1 2 0.5 0 ab 2
+comparison
+true false true false
+false false false false
+false false false false
+true true false false
+true false false false
+true true
+equality
+true true false false
+false false true true
+true false true false
+finalizer
+finalized
+7
+===*/
+
+function negZero(x) {
+    return (x === 0 && 1 / x < 0) ? '-0' : String(x);
+}
+
+function arithTest() {
+    var one = 1, two = 2, zero = 0, nz = -0, nan = NaN;
+    var big = 2147483647, small = -2147483648;
+
+    print(one + two, one - two, one * two, one / two, 7 % 3 - one);
+    print(nan + one, one % zero, one / zero, one / nz);
+    print(negZero(nz + nz), negZero(zero * -one), negZero(-one % one), negZero(nz - nz));
+    print(-3 % two, 3 % -two, Infinity % two, one / two % one);
+    print(big + one, small - one, big * big);
+}
+
+function mixedTest() {
+    var one = 1, two = 2;
+
+    print('1' + two, one - '2', '1' * two, one / '2', '7' % 3 - one, 'a' + 'b', one + true);
+}
+
+function compareTest() {
+    var one = 1, two = 2, nan = NaN, nz = -0, zero = 0;
+
+    print(one < two, one > two, one <= two, one >= two);
+    print(nan < one, nan > one, nan <= one, nan >= one);
+    print(one < nan, one > nan, one <= nan, one >= nan);
+    print(nz <= zero, nz >= zero, nz < zero, nz > zero);
+    print('10' < '9', 10 < 9, '10' < 9, 10 < '9');
+    print(-Infinity < -1e308, 1e308 < Infinity);
+}
+
+function equalityTest() {
+    var one = 1, nan = NaN, nz = -0, zero = 0;
+
+    print(nz == zero, nz === zero, nan == nan, nan === nan);
+    print(nz != zero, nz !== zero, nan != nan, nan !== nan);
+    print(one == '1', one === '1', one == 1.0, one === 1.5);
+}
+
+function finalizerTest() {
+    var x = {};
+
+    Duktape.fin(x, function () { print('finalized'); });
+    x = 3 + 4;  /* old register value is released by the fast path */
+    print(x);
+}
+
+try {
+    print('arithmetic');
+    arithTest();
+    print('mixed');
+    mixedTest();
+    print('comparison');
+    compareTest();
+    print('equality');
+    equalityTest();
+    print('finalizer');
+    finalizerTest();
+} catch (e) {
+    print(e);
+}
@@ -0,0 +1,170 @@
+/*
+ *  Opcode statistics through Duktape.opstats().  The binding only exists
+ *  with DUK_OPT_OPCODE_STATS; without it the checks are skipped and only
+ *  the absence of the binding is checked, so the expected output is the
+ *  same for both builds.
+ *
+ *  Counts are measured as differences between opstats() snapshots taken
+ *  around a known loop run with different iteration counts.  The fixed
+ *  overhead (calls, opstats() itself) cancels out so that per-iteration
+ *  counts are exact.
+ */
+
+/*---
+{
+    "custom": true
+}
+---*/
+
+/*===
+opstats
+loop counts
+pair counts
+big counts
+done
+===*/
+
+var OP_ADD = 26;  /* duk_js_bytecode.h */
+var OP_MUL = 28;
+
+function loopAdd(n) {
+    var t = 0;
+    for (var i = 0; i < n; i++) {
+        t += i;
+    }
+    return t;
+}
+
+function loopAddMul(n) {
+    var t = 0;
+    for (var i = 0; i < n; i++) {
+        t += i * 2;
+    }
+    return t;
+}
+
+function diff(a, b) {
+    var res = [];
+    var i;
+
+    for (i = 0; i < a.length; i++) {
+        res.push(b[i] - a[i]);
+    }
+    return res;
+}
+
+function sum(arr) {
+    return arr.reduce(function (a, b) { return a + b; }, 0);
+}
+
+/* Delta counts for one call of fn(n); 'key' selects opcodes/pairs/extraops. */
+function measure(fn, n, key) {
+    var before, after;
+
+    before = Duktape.opstats()[key];
+    fn(n);
+    after = Duktape.opstats()[key];
+    return diff(before, after);
+}
+
+/* Per-iteration counts: delta(fn(2n)) - delta(fn(n)), divided by n. */
+function perIteration(fn, n, key) {
+    var d1 = measure(fn, n, key);
+    var d2 = measure(fn, 2 * n, key);
+    var res = [];
+    var i, v;
+
+    for (i = 0; i < d1.length; i++) {
+        v = d2[i] - d1[i];
+        if (v % n !== 0) {
+            print('FAIL', key, i, 'not a multiple of the iteration count:', v);
+        }
+        res.push(v / n);
+    }
+    return res;
+}
+
+function checkEqual(what, got, expect) {
+    if (got !== expect) {
+        print('FAIL', what, got, expect);
+    }
+}
+
+function loopCounts() {
+    var add = perIteration(loopAdd, 1000, 'opcodes');
+    var mul = perIteration(loopAddMul, 1000, 'opcodes');
+    var i;
+
+    print('loop counts');
+    checkEqual('opcodes length', add.length, 64);
+    checkEqual('ADD per iteration', add[OP_ADD], 1);
+    checkEqual('MUL per iteration', add[OP_MUL], 0);
+    checkEqual('ADD per iteration (mul loop)', mul[OP_ADD], 1);
+    checkEqual('MUL per iteration (mul loop)', mul[OP_MUL], 1);
+
+    /* The loops only differ by the multiplication. */
+    checkEqual('total difference', sum(mul) - sum(add), 1);
+    for (i = 0; i < add.length; i++) {
+        if (i !== OP_MUL) {
+            checkEqual('opcode ' + i + ' same in both loops', mul[i], add[i]);
+        }
+    }
+
+    /* Nothing in the loop body uses EXTRA opcodes. */
+    checkEqual('extraops per iteration', sum(perIteration(loopAdd, 1000, 'extraops')), 0);
+}
+
+function pairCounts() {
+    var ops = perIteration(loopAddMul, 500, 'opcodes');
+    var pairs = perIteration(loopAddMul, 500, 'pairs');
+    var i;
+
+    print('pair counts');
+    checkEqual('pairs length', pairs.length, 64 * 64);
+    checkEqual('pair total equals opcode total', sum(pairs), sum(ops));
+
+    /* 'i * 2' is always followed by the addition. */
+    checkEqual('MUL -> ADD per iteration', pairs[OP_MUL * 64 + OP_ADD], 1);
+    for (i = 0; i < 64; i++) {
+        if (i !== OP_ADD) {
+            checkEqual('MUL -> ' + i + ' per iteration', pairs[OP_MUL * 64 + i], 0);
+        }
+    }
+}
+
+function bigCounts() {
+    var before, after;
+
+    /* More than 2^32 dispatches would take too long; just check that the
+     * counts are plain non-negative integer numbers and grow monotonically.
+     */
+    print('big counts');
+    before = Duktape.opstats().opcodes;
+    loopAdd(100000);
+    after = Duktape.opstats().opcodes;
+    checkEqual('ADD grew', after[OP_ADD] - before[OP_ADD] >= 100000, true);
+    after.forEach(function (v, i) {
+        if (typeof v !== 'number' || v < 0 || Math.floor(v) !== v || v < before[i]) {
+            print('FAIL', 'count for opcode', i, v);
+        }
+    });
+}
+
+try {
+    print('opstats');
+    if (typeof Duktape.opstats === 'function') {
+        loopCounts();
+        pairCounts();
+        bigCounts();
+    } else {
+        /* Disabled build: binding must not be present at all. */
+        checkEqual('opstats in Duktape', 'opstats' in Duktape, false);
+        checkEqual('info() unaffected', typeof Duktape.info(), 'object');
+        print('loop counts');
+        print('pair counts');
+        print('big counts');
+    }
+    print('done');
+} catch (e) {
+    print(e.stack || e);
+}
@@ -0,0 +1,268 @@
+/*
+ *  Property accesses in loops exercise the executor property inline
+ *  caches.  Object changes between iterations must be reflected in the
+ *  results, i.e. cached lookups must never return stale values.
+ */
+
+/*===
+shadowing
+proto 1
+own 2
+own 3
+proto 4
+===*/
+
+print('shadowing');
+
+function shadowingTest() {
+    var proto = { foo: 'proto' };
+    var obj = Object.create(proto);
+    var i;
+
+    for (i = 1; i <= 4; i++) {
+        print(obj.foo, i);
+        if (i === 1) {
+            obj.foo = 'own';
+        } else if (i === 3) {
+            delete obj.foo;
+        }
+    }
+}
+
+try {
+    shadowingTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+delete and re-add
+1 undefined
+undefined 2
+3 2
+===*/
+
+print('delete and re-add');
+
+function deleteTest() {
+    var obj = { foo: 1 };
+    var i;
+
+    for (i = 0; i < 3; i++) {
+        print(obj.foo, obj.bar);
+        if (i === 0) {
+            delete obj.foo;
+            obj.bar = 2;
+        } else if (i === 1) {
+            obj.foo = 3;
+        }
+    }
+}
+
+try {
+    deleteTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+reconfigure
+plain 1
+getter 2
+setter called: 3
+value 4
+write ignored value
+===*/
+
+print('reconfigure');
+
+function reconfigureTest() {
+    var obj = { foo: 'plain' };
+    var i;
+
+    for (i = 1; i <= 5; i++) {
+        if (i === 3) {
+            obj.foo = i;
+        } else if (i === 5) {
+            obj.foo = 'ignored';
+            print('write ignored', obj.foo);
+        } else {
+            print(obj.foo, i);
+        }
+
+        if (i === 1) {
+            Object.defineProperty(obj, 'foo', {
+                get: function () { return 'getter'; },
+                set: function (v) { print('setter called:', v); },
+                configurable: true
+            });
+        } else if (i === 3) {
+            Object.defineProperty(obj, 'foo', { value: 'value', writable: true });
+        } else if (i === 4) {
+            Object.freeze(obj);
+        }
+    }
+}
+
+try {
+    reconfigureTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+strict write to frozen
+TypeError
+===*/
+
+print('strict write to frozen');
+
+function strictFrozenTest() {
+    'use strict';
+    var obj = { foo: 1 };
+    var i;
+
+    for (i = 0; i < 2; i++) {
+        obj.foo = i;
+        Object.freeze(obj);
+    }
+}
+
+try {
+    strictFrozenTest();
+} catch (e) {
+    print(e.name);
+}
+
+/*===
+prototype change
+A
+B
+own
+===*/
+
+print('prototype change');
+
+function protoChangeTest() {
+    var A = { name: 'A' };
+    var B = { name: 'B' };
+    var obj = Object.create(A);
+    var i;
+
+    for (i = 0; i < 3; i++) {
+        print(obj.name);
+        if (i === 0) {
+            Object.setPrototypeOf(obj, B);
+        } else if (i === 1) {
+            obj.name = 'own';
+        }
+    }
+}
+
+try {
+    protoChangeTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+polymorphic
+0 x0 y0
+1 x1 y1
+2 x2 y2
+3 x3 y3
+4 x4 y4
+5 x5 y5
+===*/
+
+print('polymorphic');
+
+function polymorphicTest() {
+    var shapes = [
+        { x: 'x0', y: 'y0' },
+        { y: 'y1', x: 'x1' },
+        { a: 1, x: 'x2', y: 'y2' },
+        { x: 'x3', b: 2, y: 'y3' }
+    ];
+    var i, o;
+
+    shapes.push(Object.create({ x: 'x4', y: 'y4' }));
+    shapes.push(Object.create(shapes[1]));
+    shapes[5].x = 'x5';
+    shapes[5].y = 'y5';
+
+    for (i = 0; i < shapes.length; i++) {
+        o = shapes[i];
+        print(i, o.x, o.y);
+    }
+}
+
+try {
+    polymorphicTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+many properties
+0 1 2
+0 1 2
+0 1 2
+===*/
+
+print('many properties');
+
+function manyPropsTest() {
+    var obj = { a: 0, b: 1, c: 2 };
+    var i, j;
+
+    for (i = 0; i < 3; i++) {
+        print(obj.a, obj.b, obj.c);
+
+        // Grow into a hash part and force a props reallocation.
+        for (j = 0; j < 100; j++) {
+            obj['key' + j] = j;
+        }
+        delete obj.a;
+        obj.a = 0;
+    }
+}
+
+try {
+    manyPropsTest();
+} catch (e) {
+    print(e);
+}
+
+/*===
+special objects
+3 3
+2 2
+1 1
+2
+3
+plain
+===*/
+
+print('special objects');
+
+function specialObjectsTest() {
+    var arr = [ 1, 2, 3 ];
+    var objs = [ [ 1, 2 ], new String('foo'), { length: 'plain' } ];
+    var i;
+
+    for (i = 0; i < 3; i++) {
+        print(arr.length, arr.length);
+        arr.length = arr.length - 1;
+    }
+
+    for (i = 0; i < objs.length; i++) {
+        print(objs[i].length);
+    }
+}
+
+try {
+    specialObjectsTest();
+} catch (e) {
+    print(e);
+}
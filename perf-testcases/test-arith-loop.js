@@ -0,0 +1,26 @@
+/*
+ *  Numeric arithmetic and comparisons in a tight loop.
+ */
+
+function test() {
+    var i;
+    var x = 0;
+    var y = 1;
+
+    for (i = 0; i < 1e7; i++) {
+        x = (x + i * 3 - y) % 65536;
+        y = (y * 7 + x) & 0xffff;
+        if (x > y) {
+            x = x - y;
+        }
+    }
+
+    print(x, y);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,25 @@
+/*
+ *  Ecmascript-to-Ecmascript call overhead.
+ */
+
+function add(a, b) {
+    return a + b;
+}
+
+function test() {
+    var i;
+    var t = 0;
+
+    for (i = 0; i < 3e6; i++) {
+        t = add(t, i);
+    }
+
+    print(t);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
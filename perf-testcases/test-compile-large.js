@@ -0,0 +1,51 @@
+/*
+ *  Lexing throughput for a large, mostly ASCII source with typical token
+ *  mix: indented code with comments, identifiers, string and integer
+ *  literals.  The source is larger than the compile cache source limit so
+ *  that it is compiled (and lexed) on every round.
+ */
+
+function buildSource(count) {
+    var parts = [];
+    var i;
+
+    parts.push('/*\n *  Generated module bundle.\n */\nvar modules = [];\n');
+    for (i = 0; i < count; i++) {
+        parts.push(
+            '/**\n' +
+            ' *  Module ' + i + ': computes a value from its arguments.\n' +
+            ' *  Returns a number; the label is only used for debugging.\n' +
+            ' */\n' +
+            'modules.push(function module_' + i + '(first, second) {\n' +
+            '    var result = 0, counter = ' + (i * 37) + ', label = "module_' + i + '";\n' +
+            '    // loop a few times\n' +
+            '    for (var index = 0; index < first; index++) {\n' +
+            '        result += index * second + label.length;  // accumulate\n' +
+            '        if (result > 100000) { result = result % 65536; }\n' +
+            '    }\n' +
+            '    return { name: \'value\', result: result + counter, flag: true };\n' +
+            '});\n');
+    }
+    parts.push('return modules[0](2, 3).result;\n');
+
+    return parts.join('');
+}
+
+function test() {
+    var src = buildSource(400);
+    var i;
+    var res = 0;
+
+    for (i = 0; i < 100; i++) {
+        res += new Function(src)();
+    }
+
+    return res + ' ' + src.length;
+}
+
+try {
+    print(test());
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,38 @@
+/*
+ *  Compile time for a function with a large number of string and number
+ *  literals (e.g. generated templates or i18n tables).  Constant dedup
+ *  uses a hashed lookup so compile time should grow linearly with the
+ *  number of literals.
+ */
+
+function buildSource(n) {
+    var parts = [ 'var t = {};' ];
+    var i;
+
+    for (i = 0; i < n; i++) {
+        parts.push('t["msg_' + i + '"] = "Message text number ' + i + '" + ' + (i + 0.5) + ';');
+        parts.push('t["alias_' + i + '"] = "Message text number ' + i + '";');  /* duplicate literal */
+    }
+    parts.push('return t;');
+
+    return parts.join('\n');
+}
+
+function test() {
+    var src = buildSource(20000);
+    var i, fn, res;
+
+    for (i = 0; i < 5; i++) {
+        fn = new Function(src);
+    }
+    res = fn();
+
+    return Object.keys(res).length;
+}
+
+try {
+    print(test());
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
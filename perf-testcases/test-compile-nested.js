@@ -0,0 +1,66 @@
+/*
+ *  Compile throughput for sources with nested functions: a module bundle
+ *  style source (many wrappers with a few levels of inner functions) and
+ *  a deeply nested one.  Every function is called so that lazily compiled
+ *  functions get compiled too.  Pass 2 replays the tokens lexed on pass 1,
+ *  and a lazily compiled function skips its already pre-parsed inner
+ *  functions, so compile time should grow with source size rather than
+ *  with nesting depth.
+ */
+
+function buildLevel(name, depth, width) {
+    var parts = [];
+    var i;
+
+    parts.push('function ' + name + '(a, b) {');
+    parts.push('var s = 0, t = "' + name + '";');
+    parts.push('for (var i = 0; i < a; i++) { s += i * b + t.length; if (s > 1000) { s = s % 7; } }');
+    if (depth > 0) {
+        for (i = 0; i < width; i++) {
+            parts.push(buildLevel(name + '_' + i, depth - 1, width));
+            parts.push('s += ' + name + '_' + i + '(a, b);');
+        }
+    }
+    parts.push('return s;');
+    parts.push('}');
+
+    return parts.join('\n');
+}
+
+function buildBundle(modules) {
+    var parts = [ 'var res = 0;' ];
+    var i;
+
+    for (i = 0; i < modules; i++) {
+        parts.push(buildLevel('m' + i, 3, 2));
+        parts.push('res += m' + i + '(2, ' + i + ');');
+    }
+    parts.push('return res;');
+
+    return parts.join('\n');
+}
+
+function buildDeep(depth) {
+    return buildLevel('d', depth, 1) + '\nreturn d(2, 3);';
+}
+
+function test() {
+    var bundle = buildBundle(300);
+    var deep = buildDeep(40);
+    var i;
+    var res = 0;
+
+    for (i = 0; i < 10; i++) {
+        res += new Function(bundle)();
+        res += new Function(deep)();
+    }
+
+    return res;
+}
+
+try {
+    print(test());
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,37 @@
+/*
+ *  Template style code: a small set of recurring eval() and Function
+ *  constructor sources, each evaluated many times.
+ */
+
+var templates = [
+    'var out = []; for (var k in data) { out.push(k + "=" + data[k]); } out.join("&")',
+    'data.name.toUpperCase() + " (" + data.count + ")"',
+    '(function (d) { var s = 0; for (var i = 0; i < d.count; i++) { s += i; } return s; })(data)',
+    'data.items.map(function (x) { return "<li>" + x + "</li>"; }).join("")'
+];
+
+function render(data, idx) {
+    return eval(templates[idx]);
+}
+
+function test() {
+    var data = { name: 'test', count: 10, items: [ 'a', 'b', 'c' ] };
+    var i;
+    var len = 0;
+    var fn;
+
+    for (i = 0; i < 2e5; i++) {
+        len += String(render(data, i % templates.length)).length;
+        fn = new Function('data', 'return data.count * ' + (i % 8) + ';');
+        len += fn(data);
+    }
+
+    print(len);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,32 @@
+/*
+ *  Floating point arithmetic, comparisons and equality in a tight loop
+ *  (non-integer values so that fastints don't apply).
+ */
+
+function test() {
+    var i;
+    var price = 100.5;
+    var rate = 0.0125;
+    var total = 0;
+    var hits = 0;
+
+    for (i = 0; i < 5e6; i++) {
+        price = price * (1 + rate) - price / 80.25;
+        if (price >= 150.75) {
+            price = price - 50.5;
+        }
+        if (price < 101.5 || price === 99.5) {
+            hits++;
+        }
+        total = total + price % 3.5;
+    }
+
+    print(Math.round(price * 1000), Math.round(total), hits);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,32 @@
+/*
+ *  Global variable reads, writes and calls from a hot loop.
+ */
+
+var LIMIT = 2;
+var counter = 0;
+
+function helper(x) {
+    return x + LIMIT;
+}
+
+function test() {
+    var i;
+    var t = 0;
+
+    for (i = 0; i < 3e6; i++) {
+        t = helper(t) - LIMIT;
+        counter = counter + 1;
+        if (Math.floor(t) !== t) {
+            break;
+        }
+    }
+
+    print(t, counter);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
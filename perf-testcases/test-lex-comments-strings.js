@@ -0,0 +1,49 @@
+/*
+ *  Lexing throughput for sources dominated by long comments and string
+ *  literals: license headers, documentation comments and long (minified
+ *  template style) strings.  The source is larger than the compile cache
+ *  source limit so that it is lexed on every round.
+ */
+
+function buildSource(count) {
+    var license = [];
+    var text = [];
+    var parts = [];
+    var i;
+
+    for (i = 0; i < 20; i++) {
+        license.push(' *  Permission is hereby granted, free of charge, to any person obtaining a copy');
+    }
+    for (i = 0; i < 30; i++) {
+        text.push('<div class=item><span>lorem ipsum dolor sit amet</span></div>');
+    }
+    text = text.join('');
+
+    for (i = 0; i < count; i++) {
+        parts.push('/*\n' + license.join('\n') + '\n */\n');
+        parts.push('var tmpl_' + i + ' = "' + text + '";  // ' + text.substring(0, 60) + '\n');
+        parts.push('var other_' + i + ' = \'' + text + '\';\n');
+    }
+    parts.push('return tmpl_0.length + other_0.length;\n');
+
+    return parts.join('');
+}
+
+function test() {
+    var src = buildSource(100);
+    var i;
+    var res = 0;
+
+    for (i = 0; i < 200; i++) {
+        res += new Function(src)();
+    }
+
+    return res + ' ' + src.length;
+}
+
+try {
+    print(test());
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,49 @@
+/*
+ *  Loop control overhead: comparisons in loop and if conditions, and
+ *  '++'/'--' on loop variables.  With DUK_OPT_OPCODE_STATS the number of
+ *  dispatched instructions per loop iteration is printed as well.
+ */
+
+function test() {
+    var i, j;
+    var n = 0;
+    var m = 0;
+
+    for (i = 0; i < 1e7; i++) {
+        if (i < 5e6) {
+            n++;
+        }
+        j = 3;
+        while (j > 0) {
+            j--;
+        }
+        m++;
+    }
+
+    return n + m;
+}
+
+function countDispatches() {
+    var stats = Duktape.info();
+    var i, total = 0;
+
+    if (typeof stats !== 'object' || !stats.opcodes) {
+        return undefined;
+    }
+    for (i = 0; i < stats.opcodes.length; i++) {
+        total += stats.opcodes[i];
+    }
+    return total;
+}
+
+try {
+    var before = countDispatches();
+    print(test());
+    var after = countDispatches();
+    if (typeof before === 'number') {
+        print('instructions per iteration: ' + ((after - before) / 1e7).toFixed(2));
+    }
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
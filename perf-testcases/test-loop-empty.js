@@ -0,0 +1,17 @@
+/*
+ *  Empty loop: loop control and comparison overhead only.
+ */
+
+function test() {
+    var i;
+
+    for (i = 0; i < 1e7; i++) {
+    }
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,29 @@
+/*
+ *  Property reads from a small object, own and inherited properties.
+ */
+
+function Point(x, y) {
+    this.x = x;
+    this.y = y;
+}
+Point.prototype.scale = 2;
+
+function test() {
+    var i;
+    var p = new Point(1, 2);
+    var q = { a: 1, b: 2, c: 3, d: 4, e: 5 };
+    var t = 0;
+
+    for (i = 0; i < 1e7; i++) {
+        t = p.x + p.y + q.e + p.scale;
+    }
+
+    print(t);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -0,0 +1,22 @@
+/*
+ *  Property writes to existing properties of a small object.
+ */
+
+function test() {
+    var i;
+    var obj = { a: 0, b: 0, c: 0 };
+
+    for (i = 0; i < 1e7; i++) {
+        obj.a = i;
+        obj.c = obj.a;
+    }
+
+    print(obj.a, obj.b, obj.c);
+}
+
+try {
+    test();
+} catch (e) {
+    print(e.stack || e);
+    throw e;
+}
@@ -1221,6 +1221,9 @@ duk_c_function duk_get_c_function(duk_context *ctx, int index) {
 	if (!tv) {
 		return NULL;
 	}
+	if (DUK_TVAL_IS_LIGHTFUNC(tv)) {
+		return DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv);
+	}
 	if (!DUK_TVAL_IS_OBJECT(tv)) {
 		return NULL;
 	}
@@ -1295,6 +1298,10 @@ size_t duk_get_length(duk_context *ctx, int index) {
 		DUK_ASSERT(h != NULL);
 		return (size_t) DUK_HBUFFER_GET_SIZE(h);
 	}
+	case DUK_TAG_LIGHTFUNC: {
+		duk_small_uint_t lf_flags = DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv);
+		return (size_t) DUK_LFUNC_FLAGS_GET_LENGTH(lf_flags);
+	}
 	default:
 		/* number */
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
@@ -1359,14 +1366,16 @@ void duk_to_defaultvalue(duk_context *ctx, int index, int hint) {
 
 	index = duk_require_normalize_index(ctx, index);
 
-	if (!duk_is_object(ctx, index)) {
+	/* Lightfuncs are coerced like function objects: their valueOf()
+	 * and toString() are looked up from Function.prototype.
+	 */
+	if (!duk_check_type_mask(ctx, index, DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_LIGHTFUNC)) {
 		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "not object");
 	}
-	obj = duk_get_hobject(ctx, index);
-	DUK_ASSERT(obj != NULL);
+	obj = duk_get_hobject(ctx, index);  /* NULL for lightfunc */
 
 	if (hint == DUK_HINT_NONE) {
-		if (DUK_HOBJECT_GET_CLASS_NUMBER(obj) == DUK_HOBJECT_CLASS_DATE) {
+		if (obj != NULL && DUK_HOBJECT_GET_CLASS_NUMBER(obj) == DUK_HOBJECT_CLASS_DATE) {
 			hint = DUK_HINT_STRING;
 		} else {
 			hint = DUK_HINT_NUMBER;
@@ -1431,11 +1440,10 @@ void duk_to_primitive(duk_context *ctx, int index, int hint) {
 	tv = duk_require_tval(ctx, index);
 	DUK_ASSERT(tv != NULL);
 
-	if (DUK_TVAL_GET_TAG(tv) != DUK_TAG_OBJECT) {
-		/* everything except object stay as is */
+	if (!DUK_TVAL_IS_OBJECT(tv) && !DUK_TVAL_IS_LIGHTFUNC(tv)) {
+		/* everything except object and lightfunc stay as is */
 		return;
 	}
-	DUK_ASSERT(DUK_TVAL_IS_OBJECT(tv));
 
 	duk_to_defaultvalue(ctx, index, hint);
 }
@@ -1539,11 +1547,14 @@ duk_int32_t duk_to_int32(duk_context *ctx, duk_idx_t index) {
 	DUK_ASSERT(tv != NULL);
 	ret = duk_js_toint32(thr, tv);
 
-	/* XXX: avoid double coercion with fastints */
 	/* Relookup in case coerce_func() has side effects, e.g. ends up coercing an object */
 	tv = duk_require_tval(ctx, index);
 	DUK_TVAL_SET_TVAL(&tv_temp, tv);
+#if defined(DUK_USE_FASTINT)
+	DUK_TVAL_SET_FASTINT(tv, ret);  /* no need to incref */
+#else
 	DUK_TVAL_SET_NUMBER(tv, (duk_double_t) ret);  /* no need to incref */
+#endif
 	DUK_TVAL_DECREF(thr, &tv_temp);
 
 	return ret;
@@ -1561,11 +1572,18 @@ duk_uint32_t duk_to_uint32(duk_context *ctx, duk_idx_t index) {
 	DUK_ASSERT(tv != NULL);
 	ret = duk_js_touint32(thr, tv);
 
-	/* XXX: avoid double coercion with fastints */
 	/* Relookup in case coerce_func() has side effects, e.g. ends up coercing an object */
 	tv = duk_require_tval(ctx, index);
 	DUK_TVAL_SET_TVAL(&tv_temp, tv);
+#if defined(DUK_USE_FASTINT)
+	if (ret <= (duk_uint32_t) DUK_INT32_MAX) {
+		DUK_TVAL_SET_FASTINT(tv, (duk_int32_t) ret);  /* no need to incref */
+	} else {
+		DUK_TVAL_SET_NUMBER(tv, (duk_double_t) ret);
+	}
+#else
 	DUK_TVAL_SET_NUMBER(tv, (duk_double_t) ret);  /* no need to incref */
+#endif
 	DUK_TVAL_DECREF(thr, &tv_temp);
 
 	return ret;
@@ -1583,11 +1601,14 @@ duk_uint16_t duk_to_uint16(duk_context *ctx, duk_idx_t index) {
 	DUK_ASSERT(tv != NULL);
 	ret = duk_js_touint16(thr, tv);
 
-	/* XXX: avoid double coercion with fastints */
 	/* Relookup in case coerce_func() has side effects, e.g. ends up coercing an object */
 	tv = duk_require_tval(ctx, index);
 	DUK_TVAL_SET_TVAL(&tv_temp, tv);
+#if defined(DUK_USE_FASTINT)
+	DUK_TVAL_SET_FASTINT(tv, (duk_int32_t) ret);  /* no need to incref */
+#else
 	DUK_TVAL_SET_NUMBER(tv, (duk_double_t) ret);  /* no need to incref */
+#endif
 	DUK_TVAL_DECREF(thr, &tv_temp);
 
 	return ret;
@@ -1712,7 +1733,8 @@ const char *duk_to_string(duk_context *ctx, int index) {
 		/* nop */
 		goto skip_replace;
 	}
-	case DUK_TAG_OBJECT: {
+	case DUK_TAG_OBJECT:
+	case DUK_TAG_LIGHTFUNC: {
 		duk_to_primitive(ctx, index, DUK_HINT_STRING);
 		return duk_to_string(ctx, index);  /* Note: recursive call */
 	}
@@ -1860,6 +1882,10 @@ void *duk_to_pointer(duk_context *ctx, int index) {
 		 */
 		res = (void *) DUK_TVAL_GET_HEAPHDR(tv);
 		break;
+	case DUK_TAG_LIGHTFUNC:
+		/* function pointers cannot be portably cast to void * */
+		res = NULL;
+		break;
 	default:
 		/* number */
 		res = NULL;
@@ -1920,6 +1946,39 @@ void duk_to_object(duk_context *ctx, int index) {
 		shared_proto = DUK_BIDX_POINTER_PROTOTYPE;
 		goto create_object;
 	}
+	case DUK_TAG_LIGHTFUNC: {
+		/* Coerce into an equivalent Duktape/C function object.  The
+		 * virtual 'length' and 'name' of the lightfunc become concrete
+		 * properties of the new object.
+		 */
+		duk_c_function func;
+		duk_small_uint_t lf_flags;
+		duk_small_int_t nargs;
+		duk_small_int_t lf_len;
+		duk_hnativefunction *nf;
+
+		func = DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv);
+		lf_flags = DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv);
+
+		nargs = (duk_small_int_t) DUK_LFUNC_FLAGS_GET_NARGS(lf_flags);
+		if (nargs == DUK_LFUNC_NARGS_VARARGS) {
+			nargs = DUK_VARARGS;
+		}
+		(void) duk_push_c_function_noexotic(ctx, func, nargs);
+		nf = duk_get_hnativefunction(ctx, -1);
+		DUK_ASSERT(nf != NULL);
+		nf->magic = (duk_int16_t) DUK_LFUNC_FLAGS_GET_MAGIC(lf_flags);
+
+		lf_len = (duk_small_int_t) DUK_LFUNC_FLAGS_GET_LENGTH(lf_flags);
+		duk_push_int(ctx, lf_len);
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_LENGTH, DUK_PROPDESC_FLAGS_NONE);
+
+		duk_push_lightfunc_name(ctx, duk_get_tval(ctx, index));
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_NAME, DUK_PROPDESC_FLAGS_NONE);
+
+		duk_replace(ctx, index);
+		return;
+	}
 	default: {
 		shared_flags = DUK_HOBJECT_FLAG_EXTENSIBLE |
 		               DUK_HOBJECT_CLASS_AS_FLAGS(DUK_HOBJECT_CLASS_NUMBER);
@@ -1993,6 +2052,8 @@ int duk_get_type(duk_context *ctx, int index) {
 		return DUK_TYPE_BUFFER;
 	case DUK_TAG_POINTER:
 		return DUK_TYPE_POINTER;
+	case DUK_TAG_LIGHTFUNC:
+		return DUK_TYPE_LIGHTFUNC;
 	default:
 		/* Note: number has no explicit tag (in 8-byte representation) */
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
@@ -2027,6 +2088,8 @@ int duk_get_type_mask(duk_context *ctx, int index) {
 		return DUK_TYPE_MASK_BUFFER;
 	case DUK_TAG_POINTER:
 		return DUK_TYPE_MASK_POINTER;
+	case DUK_TAG_LIGHTFUNC:
+		return DUK_TYPE_MASK_LIGHTFUNC;
 	default:
 		/* Note: number has no explicit tag (in 8-byte representation) */
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
@@ -2129,6 +2192,11 @@ int duk_is_pointer(duk_context *ctx, int index) {
 	return duk__tag_check(ctx, index, DUK_TAG_POINTER);
 }
 
+int duk_is_lightfunc(duk_context *ctx, int index) {
+	DUK_ASSERT(ctx != NULL);
+	return duk__tag_check(ctx, index, DUK_TAG_LIGHTFUNC);
+}
+
 int duk_is_array(duk_context *ctx, int index) {
 	duk_hobject *obj;
 
@@ -2142,6 +2210,9 @@ int duk_is_array(duk_context *ctx, int index) {
 }
 
 int duk_is_function(duk_context *ctx, int index) {
+	if (duk_is_lightfunc(ctx, index)) {
+		return 1;
+	}
 	return duk__obj_flag_any_default_false(ctx,
 	                                       index,
 	                                       DUK_HOBJECT_FLAG_COMPILEDFUNCTION |
@@ -2150,6 +2221,9 @@ int duk_is_function(duk_context *ctx, int index) {
 }
 
 int duk_is_c_function(duk_context *ctx, int index) {
+	if (duk_is_lightfunc(ctx, index)) {
+		return 1;
+	}
 	return duk__obj_flag_any_default_false(ctx,
 	                                       index,
 	                                       DUK_HOBJECT_FLAG_NATIVEFUNCTION);
@@ -2175,6 +2249,9 @@ int duk_is_thread(duk_context *ctx, int index) {
 
 int duk_is_callable(duk_context *ctx, int index) {
 	/* XXX: currently same as duk_is_function() */
+	if (duk_is_lightfunc(ctx, index)) {
+		return 1;
+	}
 	return duk__obj_flag_any_default_false(ctx,
 	                                       index,
 	                                       DUK_HOBJECT_FLAG_COMPILEDFUNCTION |
@@ -2211,7 +2288,8 @@ int duk_is_fixed(duk_context *ctx, int index) {
 }
 
 int duk_is_primitive(duk_context *ctx, int index) {
-	return !duk_is_object(ctx, index);
+	/* lightfuncs are functions and thus not primitive values */
+	return !duk_check_type_mask(ctx, index, DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_LIGHTFUNC);
 }
 
 /*
@@ -2288,10 +2366,28 @@ void duk_push_number(duk_context *ctx, double val) {
 }
 
 void duk_push_int(duk_context *ctx, duk_int_t val) {
+#if defined(DUK_USE_FASTINT)
+	duk_tval tv;
+
+	if (val >= DUK_INT32_MIN && val <= DUK_INT32_MAX) {
+		DUK_TVAL_SET_FASTINT(&tv, (duk_int32_t) val);
+		duk_push_tval(ctx, &tv);
+		return;
+	}
+#endif
 	duk_push_number(ctx, (double) val);
 }
 
 void duk_push_uint(duk_context *ctx, duk_uint_t val) {
+#if defined(DUK_USE_FASTINT)
+	duk_tval tv;
+
+	if (val <= (duk_uint_t) DUK_INT32_MAX) {
+		DUK_TVAL_SET_FASTINT(&tv, (duk_int32_t) val);
+		duk_push_tval(ctx, &tv);
+		return;
+	}
+#endif
 	duk_push_number(ctx, (double) val);
 }
 
@@ -2494,8 +2590,8 @@ void duk_push_current_function(duk_context *ctx) {
 		duk_push_undefined(ctx);
 	} else {
 		duk_activation *act = thr->callstack + thr->callstack_top - 1;
-		DUK_ASSERT(act->func != NULL);
-		duk_push_hobject(ctx, act->func);
+		DUK_ASSERT(act->func != NULL || DUK_TVAL_IS_LIGHTFUNC(&act->tv_func));
+		duk_push_tval(ctx, &act->tv_func);
 	}
 }
 
@@ -2929,6 +3025,63 @@ void duk_push_c_function_noconstruct_noexotic(duk_context *ctx, duk_c_function f
 	(void) duk__push_c_function_raw(ctx, func, nargs, flags);
 }
 
+int duk_push_c_lightfunc(duk_context *ctx, duk_c_function func, int nargs, int length, int magic) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_tval tv;
+	duk_small_uint_t lf_flags;
+
+	DUK_ASSERT(ctx != NULL);
+
+	if (func == NULL) {
+		goto api_error;
+	}
+	if (nargs >= DUK_LFUNC_NARGS_MIN && nargs <= DUK_LFUNC_NARGS_MAX) {
+		;
+	} else if (nargs == DUK_VARARGS) {
+		nargs = DUK_LFUNC_NARGS_VARARGS;
+	} else {
+		goto api_error;
+	}
+	if (length < DUK_LFUNC_LENGTH_MIN || length > DUK_LFUNC_LENGTH_MAX) {
+		goto api_error;
+	}
+	if (magic < DUK_LFUNC_MAGIC_MIN || magic > DUK_LFUNC_MAGIC_MAX) {
+		goto api_error;
+	}
+
+	lf_flags = DUK_LFUNC_FLAGS_PACK(magic, length, nargs);
+	DUK_TVAL_SET_LIGHTFUNC(&tv, func, lf_flags);
+	duk_push_tval(ctx, &tv);  /* XXX: direct valstack write */
+	return duk_get_top(ctx) - 1;
+
+ api_error:
+	DUK_ERROR(thr, DUK_ERR_API_ERROR, "invalid argument(s)");
+	return 0;  /* not reached */
+}
+
+/* internal: push the virtual 'name' of a lightfunc, e.g. "light_<ptr>_<flags>";
+ * function pointer bytes are printed in memory order as they cannot be
+ * portably formatted with '%p'.
+ */
+void duk_push_lightfunc_name(duk_context *ctx, duk_tval *tv) {
+	duk_c_function func;
+	duk_small_uint_t lf_flags;
+	duk_uint8_t *p;
+	duk_size_t i;
+
+	DUK_ASSERT(tv != NULL && DUK_TVAL_IS_LIGHTFUNC(tv));
+	func = DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv);
+	lf_flags = DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv);
+
+	duk_push_string(ctx, "light_");
+	p = (duk_uint8_t *) &func;
+	for (i = 0; i < sizeof(func); i++) {
+		duk_push_sprintf(ctx, "%02x", (int) p[i]);
+	}
+	duk_push_sprintf(ctx, "_%04x", (int) lf_flags);
+	duk_concat(ctx, (unsigned int) (sizeof(func) + 2));
+}
+
 static int duk__push_error_object_vsprintf(duk_context *ctx, int err_code, const char *filename, int line, const char *fmt, va_list ap) {
 	duk_hthread *thr = (duk_hthread *) ctx;
 	int retval;
@@ -3282,11 +3435,14 @@ int duk_strict_equals(duk_context *ctx, int index1, int index2) {
  *  Heap creation
  */
 
-duk_context *duk_create_heap(duk_alloc_function alloc_func,
-                             duk_realloc_function realloc_func,
-                             duk_free_function free_func,
-                             void *alloc_udata,
-                             duk_fatal_function fatal_handler) {
+static duk_context *duk__create_heap_raw(duk_alloc_function alloc_func,
+                                         duk_realloc_function realloc_func,
+                                         duk_free_function free_func,
+                                         void *alloc_udata,
+                                         duk_fatal_function fatal_handler,
+                                         const void *snapshot,
+                                         duk_size_t snapshot_size,
+                                         const duk_c_function *natives) {
 	duk_heap *heap = NULL;
 	duk_context *ctx;
 
@@ -3318,7 +3474,8 @@ duk_context *duk_create_heap(duk_alloc_function alloc_func,
 	DUK_ASSERT(free_func != NULL);
 	DUK_ASSERT(fatal_handler != NULL);
 
-	heap = duk_heap_alloc(alloc_func, realloc_func, free_func, alloc_udata, fatal_handler);
+	heap = duk_heap_alloc(alloc_func, realloc_func, free_func, alloc_udata, fatal_handler,
+	                      snapshot, snapshot_size, natives);
 	if (!heap) {
 		return NULL;
 	}
@@ -3328,6 +3485,30 @@ duk_context *duk_create_heap(duk_alloc_function alloc_func,
 	return ctx;
 }
 
+duk_context *duk_create_heap(duk_alloc_function alloc_func,
+                             duk_realloc_function realloc_func,
+                             duk_free_function free_func,
+                             void *alloc_udata,
+                             duk_fatal_function fatal_handler) {
+	return duk__create_heap_raw(alloc_func, realloc_func, free_func, alloc_udata, fatal_handler,
+	                            NULL, 0, NULL);
+}
+
+duk_context *duk_create_heap_from_snapshot(duk_alloc_function alloc_func,
+                                           duk_realloc_function realloc_func,
+                                           duk_free_function free_func,
+                                           void *alloc_udata,
+                                           duk_fatal_function fatal_handler,
+                                           const void *snapshot,
+                                           duk_size_t snapshot_size,
+                                           const duk_c_function *natives) {
+	if (!snapshot) {
+		return NULL;
+	}
+	return duk__create_heap_raw(alloc_func, realloc_func, free_func, alloc_udata, fatal_handler,
+	                            snapshot, snapshot_size, natives);
+}
+
 void duk_destroy_heap(duk_context *ctx) {
 	duk_hthread *thr = (duk_hthread *) ctx;
 	duk_heap *heap;
@@ -3341,3 +3522,9 @@ void duk_destroy_heap(duk_context *ctx) {
 	duk_heap_free(heap);
 }
 
+void duk_snapshot_heap(duk_context *ctx, const duk_c_function *natives) {
+	DUK_ASSERT(ctx != NULL);
+
+	duk_heap_snapshot_write((duk_hthread *) ctx, natives);
+}
+
@@ -0,0 +1,610 @@
+/*
+ *  Bytecode dump/load
+ *
+ *  A compiled function (and its inner function templates) can be dumped
+ *  into a buffer and loaded back later, possibly in another heap, without
+ *  going through the lexer and the compiler.
+ *
+ *  Dump format, all integers in big endian byte order:
+ *
+ *    header:
+ *      u8   DUK__BC_MARKER (0xff, never an initial byte of valid UTF-8/CESU-8)
+ *      u8   DUK__BC_FORMAT_VERSION
+ *      u32  DUK_VERSION of the dumping Duktape
+ *      <function>
+ *
+ *    function:
+ *      u32  number of instructions
+ *      u32  number of constants
+ *      u32  number of inner functions
+ *      u16  nregs
+ *      u16  nargs
+ *      u32  function flags (DUK__BC_FUNC_FLAGS_MASK of duk_hobject flags)
+ *      u32  instructions (count times)
+ *      constants (count times):
+ *        u8   DUK__BC_CONST_STRING, u32 byte length, bytes
+ *        u8   DUK__BC_CONST_NUMBER, u32 high, u32 low (IEEE double)
+ *      <function> (count times, inner function templates)
+ *      u8   property mask (DUK__BC_PROP_xxx), followed by the properties
+ *           present, in bit order:
+ *        name:      string (u32 byte length, bytes)
+ *        fileName:  string
+ *        _pc2line:  u32 byte length, bytes
+ *        _varmap:   u32 count, count times (string name, u32 register)
+ *        _formals:  u32 count, count times string
+ *
+ *  Inline caches and JIT state are not dumped; they start out empty.  The
+ *  dump depends on the opcode format so it's only accepted by the exact
+ *  Duktape version which created it (format version and DUK_VERSION are
+ *  both checked).
+ *
+ *  The loader checks that it never reads outside the input buffer, but it
+ *  does NOT validate the bytecode itself.  Loading a corrupted or hand
+ *  crafted dump may crash or otherwise compromise the process, so only
+ *  dumps from trusted sources may be loaded.
+ */
+
+#include "duk_internal.h"
+
+#define DUK__BC_MARKER                0xffU
+#define DUK__BC_FORMAT_VERSION        0x01U
+
+#define DUK__BC_CONST_STRING          0x00U
+#define DUK__BC_CONST_NUMBER          0x01U
+
+#define DUK__BC_PROP_NAME             (1U << 0)
+#define DUK__BC_PROP_FILENAME         (1U << 1)
+#define DUK__BC_PROP_PC2LINE          (1U << 2)
+#define DUK__BC_PROP_VARMAP           (1U << 3)
+#define DUK__BC_PROP_FORMALS          (1U << 4)
+
+/* Function flags which are part of the dump; the remaining flags are
+ * either implied by the object type or set when the loaded template is
+ * instantiated into a closure.
+ */
+#define DUK__BC_FUNC_FLAGS_MASK  \
+	(DUK_HOBJECT_FLAG_STRICT | \
+	 DUK_HOBJECT_FLAG_NOTAIL | \
+	 DUK_HOBJECT_FLAG_NEWENV | \
+	 DUK_HOBJECT_FLAG_NAMEBINDING | \
+	 DUK_HOBJECT_FLAG_CREATEARGS | \
+	 DUK_HOBJECT_FLAG_NOCAPTURE)
+
+/*
+ *  Dump
+ */
+
+static void duk__dump_u16(duk_hthread *thr, duk_hbuffer_dynamic *h_buf, duk_uint16_t val) {
+	duk_uint8_t tmp[2];
+
+	tmp[0] = (duk_uint8_t) (val >> 8);
+	tmp[1] = (duk_uint8_t) val;
+	duk_hbuffer_append_bytes(thr, h_buf, tmp, sizeof(tmp));
+}
+
+static void duk__dump_u32(duk_hthread *thr, duk_hbuffer_dynamic *h_buf, duk_uint32_t val) {
+	duk_uint8_t tmp[4];
+
+	tmp[0] = (duk_uint8_t) (val >> 24);
+	tmp[1] = (duk_uint8_t) (val >> 16);
+	tmp[2] = (duk_uint8_t) (val >> 8);
+	tmp[3] = (duk_uint8_t) val;
+	duk_hbuffer_append_bytes(thr, h_buf, tmp, sizeof(tmp));
+}
+
+static void duk__dump_hstring(duk_hthread *thr, duk_hbuffer_dynamic *h_buf, duk_hstring *h_str) {
+	DUK_ASSERT(h_str != NULL);
+
+	duk__dump_u32(thr, h_buf, (duk_uint32_t) DUK_HSTRING_GET_BYTELEN(h_str));
+	duk_hbuffer_append_bytes(thr, h_buf, DUK_HSTRING_GET_DATA(h_str), DUK_HSTRING_GET_BYTELEN(h_str));
+}
+
+/* Own property lookup, properties inherited from Function.prototype must
+ * not end up in the dump.
+ */
+static duk_tval *duk__dump_get_own_prop(duk_hthread *thr, duk_hobject *h_fun, int stridx) {
+	return duk_hobject_find_existing_entry_tval_ptr(h_fun, DUK_HTHREAD_GET_STRING(thr, stridx));
+}
+
+static void duk__dump_func(duk_hthread *thr, duk_hbuffer_dynamic *h_buf, duk_hcompiledfunction *h_fun) {
+	duk_tval *tv;
+	duk_hstring *h_name;
+	duk_hstring *h_filename;
+	duk_hbuffer *h_pc2line;
+	duk_hobject *h_varmap;
+	duk_hobject *h_formals;
+	duk_instr *p_instr;
+	duk_hobject **p_func;
+	duk_hobject *h_obj;
+	duk_double_union du;
+	size_t n_instr, n_const, n_func;
+	size_t i;
+	duk_uint32_t count;
+	duk_uint8_t prop_mask;
+
+	DUK_ASSERT(h_fun != NULL);
+	DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) h_fun));
+	DUK_ASSERT(h_fun->data != NULL);
+
+#if defined(DUK_USE_LAZY_COMPILE)
+	/* Inner function templates which haven't been needed yet are compiled
+	 * now, so that a loaded function never needs the source code.
+	 */
+	if (DUK_HCOMPILEDFUNCTION_IS_LAZY(h_fun)) {
+		duk_js_compile_lazy(thr, h_fun);
+	}
+#endif
+
+	n_instr = DUK_HCOMPILEDFUNCTION_GET_CODE_COUNT(h_fun);
+	n_const = DUK_HCOMPILEDFUNCTION_GET_CONSTS_COUNT(h_fun);
+	n_func = DUK_HCOMPILEDFUNCTION_GET_FUNCS_COUNT(h_fun);
+
+	DUK_DDD(DUK_DDDPRINT("dump function %p: n_instr=%d, n_const=%d, n_func=%d",
+	                     (void *) h_fun, (int) n_instr, (int) n_const, (int) n_func));
+
+	duk__dump_u32(thr, h_buf, (duk_uint32_t) n_instr);
+	duk__dump_u32(thr, h_buf, (duk_uint32_t) n_const);
+	duk__dump_u32(thr, h_buf, (duk_uint32_t) n_func);
+	duk__dump_u16(thr, h_buf, h_fun->nregs);
+	duk__dump_u16(thr, h_buf, h_fun->nargs);
+	duk__dump_u32(thr, h_buf, (duk_uint32_t) (DUK_HEAPHDR_GET_FLAGS(&h_fun->obj.hdr) & DUK__BC_FUNC_FLAGS_MASK));
+
+	p_instr = DUK_HCOMPILEDFUNCTION_GET_CODE_BASE(h_fun);
+	for (i = 0; i < n_instr; i++) {
+		duk__dump_u32(thr, h_buf, (duk_uint32_t) p_instr[i]);
+	}
+
+	tv = DUK_HCOMPILEDFUNCTION_GET_CONSTS_BASE(h_fun);
+	for (i = 0; i < n_const; i++, tv++) {
+		if (DUK_TVAL_IS_STRING(tv)) {
+			duk_hbuffer_append_byte(thr, h_buf, DUK__BC_CONST_STRING);
+			duk__dump_hstring(thr, h_buf, DUK_TVAL_GET_STRING(tv));
+		} else {
+			/* constants are only strings and numbers */
+			DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
+			DUK_DBLUNION_SET_DOUBLE(&du, DUK_TVAL_GET_NUMBER(tv));
+			duk_hbuffer_append_byte(thr, h_buf, DUK__BC_CONST_NUMBER);
+			duk__dump_u32(thr, h_buf, du.ui[DUK_DBL_IDX_UI0]);
+			duk__dump_u32(thr, h_buf, du.ui[DUK_DBL_IDX_UI1]);
+		}
+	}
+
+	p_func = DUK_HCOMPILEDFUNCTION_GET_FUNCS_BASE(h_fun);
+	for (i = 0; i < n_func; i++) {
+		DUK_ASSERT(p_func[i] != NULL);
+		DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION(p_func[i]));
+		duk__dump_func(thr, h_buf, (duk_hcompiledfunction *) p_func[i]);
+	}
+
+	/*
+	 *  Properties: only values of the type written by the compiler are
+	 *  dumped, anything else (e.g. a 'name' written by user code) is
+	 *  ignored.
+	 */
+
+	/* Resolve heap pointers before appending anything: an emergency GC
+	 * triggered by a buffer resize may compact the function's property
+	 * table and invalidate tval pointers into it.
+	 */
+	h_name = NULL;
+	h_filename = NULL;
+	h_pc2line = NULL;
+	h_varmap = NULL;
+	h_formals = NULL;
+
+	tv = duk__dump_get_own_prop(thr, (duk_hobject *) h_fun, DUK_STRIDX_NAME);
+	if (tv != NULL && DUK_TVAL_IS_STRING(tv)) {
+		h_name = DUK_TVAL_GET_STRING(tv);
+	}
+	tv = duk__dump_get_own_prop(thr, (duk_hobject *) h_fun, DUK_STRIDX_FILE_NAME);
+	if (tv != NULL && DUK_TVAL_IS_STRING(tv)) {
+		h_filename = DUK_TVAL_GET_STRING(tv);
+	}
+	tv = duk__dump_get_own_prop(thr, (duk_hobject *) h_fun, DUK_STRIDX_INT_PC2LINE);
+	if (tv != NULL && DUK_TVAL_IS_BUFFER(tv)) {
+		h_pc2line = DUK_TVAL_GET_BUFFER(tv);
+	}
+	tv = duk__dump_get_own_prop(thr, (duk_hobject *) h_fun, DUK_STRIDX_INT_VARMAP);
+	if (tv != NULL && DUK_TVAL_IS_OBJECT(tv)) {
+		h_varmap = DUK_TVAL_GET_OBJECT(tv);
+	}
+	tv = duk__dump_get_own_prop(thr, (duk_hobject *) h_fun, DUK_STRIDX_INT_FORMALS);
+	if (tv != NULL && DUK_TVAL_IS_OBJECT(tv)) {
+		h_formals = DUK_TVAL_GET_OBJECT(tv);
+	}
+
+	prop_mask = (h_name != NULL ? DUK__BC_PROP_NAME : 0) |
+	            (h_filename != NULL ? DUK__BC_PROP_FILENAME : 0) |
+	            (h_pc2line != NULL ? DUK__BC_PROP_PC2LINE : 0) |
+	            (h_varmap != NULL ? DUK__BC_PROP_VARMAP : 0) |
+	            (h_formals != NULL ? DUK__BC_PROP_FORMALS : 0);
+	duk_hbuffer_append_byte(thr, h_buf, prop_mask);
+
+	if (h_name != NULL) {
+		duk__dump_hstring(thr, h_buf, h_name);
+	}
+	if (h_filename != NULL) {
+		duk__dump_hstring(thr, h_buf, h_filename);
+	}
+	if (h_pc2line != NULL) {
+		duk__dump_u32(thr, h_buf, (duk_uint32_t) DUK_HBUFFER_GET_SIZE(h_pc2line));
+		duk_hbuffer_append_bytes(thr, h_buf,
+		                         (duk_uint8_t *) DUK_HBUFFER_GET_DATA_PTR(h_pc2line),
+		                         DUK_HBUFFER_GET_SIZE(h_pc2line));
+	}
+	if (h_varmap != NULL) {
+		/* Varmap values are register numbers; the compiler removes
+		 * other entries when the template is finalized.  Count first
+		 * because deleted entries may leave holes.  Entry pointers
+		 * are re-read on every round: compaction keeps entry order.
+		 */
+		h_obj = h_varmap;
+		count = 0;
+		for (i = 0; i < h_obj->e_used; i++) {
+			if (DUK_HOBJECT_E_GET_KEY(h_obj, i) != NULL &&
+			    !DUK_HOBJECT_E_SLOT_IS_ACCESSOR(h_obj, i) &&
+			    DUK_TVAL_IS_NUMBER(DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(h_obj, i))) {
+				count++;
+			}
+		}
+		duk__dump_u32(thr, h_buf, count);
+		for (i = 0; i < h_obj->e_used; i++) {
+			duk_hstring *h_key = DUK_HOBJECT_E_GET_KEY(h_obj, i);
+			if (h_key == NULL || DUK_HOBJECT_E_SLOT_IS_ACCESSOR(h_obj, i)) {
+				continue;
+			}
+			tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(h_obj, i);
+			if (!DUK_TVAL_IS_NUMBER(tv)) {
+				continue;
+			}
+			duk__dump_hstring(thr, h_buf, h_key);
+			duk__dump_u32(thr, h_buf, (duk_uint32_t) DUK_TVAL_GET_NUMBER(tv));
+		}
+	}
+	if (h_formals != NULL) {
+		h_obj = h_formals;
+		count = duk_hobject_get_length(thr, h_obj);
+		duk__dump_u32(thr, h_buf, count);
+		for (i = 0; i < count; i++) {
+			tv = duk_hobject_find_existing_array_entry_tval_ptr(h_obj, (duk_uint32_t) i);
+			if (tv == NULL || !DUK_TVAL_IS_STRING(tv)) {
+				DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "invalid _formals");
+			}
+			duk__dump_hstring(thr, h_buf, DUK_TVAL_GET_STRING(tv));
+		}
+	}
+}
+
+/*
+ *  Load
+ */
+
+typedef struct {
+	duk_hthread *thr;
+	const duk_uint8_t *p;
+	const duk_uint8_t *p_end;
+	int recursion_depth;
+} duk__bc_reader;
+
+static void duk__load_error(duk__bc_reader *rd) {
+	DUK_ERROR(rd->thr, DUK_ERR_TYPE_ERROR, "invalid bytecode");
+}
+
+static const duk_uint8_t *duk__load_bytes(duk__bc_reader *rd, size_t len) {
+	const duk_uint8_t *p = rd->p;
+
+	if ((size_t) (rd->p_end - p) < len) {
+		duk__load_error(rd);
+	}
+	rd->p = p + len;
+	return p;
+}
+
+static duk_uint8_t duk__load_u8(duk__bc_reader *rd) {
+	return *duk__load_bytes(rd, 1);
+}
+
+static duk_uint16_t duk__load_u16(duk__bc_reader *rd) {
+	const duk_uint8_t *p = duk__load_bytes(rd, 2);
+
+	return (duk_uint16_t) (((duk_uint16_t) p[0] << 8) | (duk_uint16_t) p[1]);
+}
+
+static duk_uint32_t duk__load_u32(duk__bc_reader *rd) {
+	const duk_uint8_t *p = duk__load_bytes(rd, 4);
+
+	return ((duk_uint32_t) p[0] << 24) |
+	       ((duk_uint32_t) p[1] << 16) |
+	       ((duk_uint32_t) p[2] << 8) |
+	       (duk_uint32_t) p[3];
+}
+
+/* Push a string value. */
+static void duk__load_string(duk__bc_reader *rd) {
+	duk_uint32_t len = duk__load_u32(rd);
+	const duk_uint8_t *p = duk__load_bytes(rd, (size_t) len);
+
+	duk_push_lstring((duk_context *) rd->thr, (const char *) p, (duk_size_t) len);
+}
+
+/* Push a function template. */
+static void duk__load_func(duk__bc_reader *rd) {
+	duk_hthread *thr = rd->thr;
+	duk_context *ctx = (duk_context *) thr;
+	duk_hcompiledfunction *h_res;
+	duk_hbuffer_fixed *h_data;
+	const duk_uint8_t *p_instr_src;
+	duk_tval *p_const;
+	duk_hobject **p_func;
+	duk_instr *p_instr;
+	duk_double_union du;
+	duk_uint32_t n_instr, n_const, n_func;
+	duk_uint16_t nregs, nargs;
+	duk_uint32_t flags;
+	duk_uint32_t count;
+	duk_uint32_t i;
+	duk_uint8_t prop_mask;
+	size_t data_size;
+	int idx_base;
+
+	if (rd->recursion_depth >= DUK_COMPILER_RECURSION_LIMIT) {
+		duk__load_error(rd);
+	}
+	rd->recursion_depth++;
+
+	n_instr = duk__load_u32(rd);
+	n_const = duk__load_u32(rd);
+	n_func = duk__load_u32(rd);
+
+	/* Check counts against bytecode limits before using them in size
+	 * computations, so that the computations cannot overflow.
+	 */
+	if (n_instr == 0 ||
+	    n_instr > DUK_COMPILER_MAX_BYTECODE_LENGTH ||
+	    n_const > DUK_BC_BC_MAX + 1 ||
+	    n_func > DUK_BC_BC_MAX + 1) {
+		duk__load_error(rd);
+	}
+
+	DUK_DDD(DUK_DDDPRINT("load function: n_instr=%d, n_const=%d, n_func=%d",
+	                     (int) n_instr, (int) n_const, (int) n_func));
+
+	duk_require_stack(ctx, (duk_idx_t) (n_const + n_func + 4));
+	idx_base = duk_get_top(ctx);
+
+	nregs = duk__load_u16(rd);
+	nargs = duk__load_u16(rd);
+	flags = duk__load_u32(rd);
+
+	/* Instructions are decoded directly into the data area below. */
+	p_instr_src = duk__load_bytes(rd, (size_t) n_instr * sizeof(duk_uint32_t));
+
+	/* Constants and inner functions are kept reachable in the value stack
+	 * until the data area has been built.  The function object itself is
+	 * only created once the data area is complete: compiled functions
+	 * must be created atomically (see duk__convert_to_func_template()),
+	 * and a load error may occur at any point before that.
+	 */
+	for (i = 0; i < n_const; i++) {
+		switch (duk__load_u8(rd)) {
+		case DUK__BC_CONST_STRING:
+			duk__load_string(rd);
+			break;
+		case DUK__BC_CONST_NUMBER:
+			du.ui[DUK_DBL_IDX_UI0] = duk__load_u32(rd);
+			du.ui[DUK_DBL_IDX_UI1] = duk__load_u32(rd);
+			duk_push_number(ctx, du.d);
+			break;
+		default:
+			duk__load_error(rd);
+		}
+	}
+
+	for (i = 0; i < n_func; i++) {
+		duk__load_func(rd);
+	}
+
+	/*
+	 *  Build the function 'data' buffer, see duk__convert_to_func_template()
+	 *  in the compiler.
+	 */
+
+	data_size = (size_t) n_const * sizeof(duk_tval) +
+	            (size_t) n_func * sizeof(duk_hobject *) +
+	            (size_t) n_instr * DUK_HCOMPILEDFUNCTION_CODE_ENTRY_SIZE;
+	duk_push_fixed_buffer(ctx, data_size);
+	h_data = (duk_hbuffer_fixed *) duk_get_hbuffer(ctx, -1);
+	DUK_ASSERT(h_data != NULL);
+
+	p_const = (duk_tval *) DUK_HBUFFER_FIXED_GET_DATA_PTR(h_data);
+	for (i = 0; i < n_const; i++) {
+		duk_tval *tv = duk_get_tval(ctx, idx_base + (int) i);
+		DUK_ASSERT(tv != NULL);
+		DUK_TVAL_SET_TVAL(p_const, tv);
+#if defined(DUK_USE_FASTINT)
+		if (DUK_TVAL_IS_NUMBER(tv)) {
+			/* whole number constants are used as fastints by the executor */
+			DUK_TVAL_SET_NUMBER_CHKFAST(p_const, DUK_TVAL_GET_NUMBER(tv));
+		}
+#endif
+		DUK_TVAL_INCREF(thr, p_const);
+		p_const++;
+	}
+
+	p_func = (duk_hobject **) p_const;
+	for (i = 0; i < n_func; i++) {
+		duk_hobject *h = duk_get_hobject(ctx, idx_base + (int) (n_const + i));
+		DUK_ASSERT(h != NULL);
+		DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION(h));
+		p_func[i] = h;
+		DUK_HOBJECT_INCREF(thr, h);
+	}
+
+	p_instr = (duk_instr *) (p_func + n_func);
+	for (i = 0; i < n_instr; i++) {
+		p_instr[i] = (duk_instr) (((duk_uint32_t) p_instr_src[0] << 24) |
+		                          ((duk_uint32_t) p_instr_src[1] << 16) |
+		                          ((duk_uint32_t) p_instr_src[2] << 8) |
+		                          (duk_uint32_t) p_instr_src[3]);
+		p_instr_src += 4;
+	}
+
+#if defined(DUK_USE_PROPERTY_IC)
+	/* inline caches start out empty */
+	DUK_MEMSET((void *) (p_instr + n_instr),
+	           0xff,
+	           (size_t) n_instr * DUK_HCOMPILEDFUNCTION_IC_WAYS * sizeof(duk_uint16_t));
+#endif
+
+	(void) duk_push_compiledfunction(ctx);
+	h_res = (duk_hcompiledfunction *) duk_get_hobject(ctx, -1);
+	DUK_ASSERT(h_res != NULL);
+
+	h_res->data = (duk_hbuffer *) h_data;
+	DUK_HBUFFER_INCREF(thr, h_data);
+	h_res->funcs = p_func;
+	h_res->bytecode = p_instr;
+	h_res->nregs = nregs;
+	h_res->nargs = nargs;
+	DUK_HEAPHDR_SET_FLAG_BITS(&h_res->obj.hdr, flags & DUK__BC_FUNC_FLAGS_MASK);
+
+	/* [ ... consts funcs data res ] -> [ ... res ] */
+	duk_replace(ctx, idx_base);
+	duk_set_top(ctx, idx_base + 1);
+
+	/*
+	 *  Properties, defined the same way as by the compiler.
+	 */
+
+	prop_mask = duk__load_u8(rd);
+
+	if (prop_mask & DUK__BC_PROP_NAME) {
+		duk__load_string(rd);
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_NAME, DUK_PROPDESC_FLAGS_NONE);
+	}
+	if (prop_mask & DUK__BC_PROP_FILENAME) {
+		duk__load_string(rd);
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_FILE_NAME, DUK_PROPDESC_FLAGS_NONE);
+	}
+	if (prop_mask & DUK__BC_PROP_PC2LINE) {
+		const duk_uint8_t *p;
+		void *buf;
+
+		count = duk__load_u32(rd);
+		p = duk__load_bytes(rd, (size_t) count);
+#if defined(DUK_USE_PC2LINE)
+		buf = duk_push_fixed_buffer(ctx, (duk_size_t) count);
+		DUK_MEMCPY(buf, (const void *) p, (size_t) count);
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_INT_PC2LINE, DUK_PROPDESC_FLAGS_NONE);
+#else
+		DUK_UNREF(p);
+		DUK_UNREF(buf);
+#endif
+	}
+	if (prop_mask & DUK__BC_PROP_VARMAP) {
+		duk_push_object_internal(ctx);
+		count = duk__load_u32(rd);
+		for (i = 0; i < count; i++) {
+			duk__load_string(rd);
+			duk_push_uint(ctx, (duk_uint_t) duk__load_u32(rd));
+			duk_put_prop(ctx, -3);
+		}
+		duk_compact(ctx, -1);
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_INT_VARMAP, DUK_PROPDESC_FLAGS_NONE);
+	}
+	if (prop_mask & DUK__BC_PROP_FORMALS) {
+		duk_push_array(ctx);
+		count = duk__load_u32(rd);
+		for (i = 0; i < count; i++) {
+			duk__load_string(rd);
+			duk_put_prop_index(ctx, -2, (duk_uint32_t) i);
+		}
+		duk_def_prop_stridx(ctx, -2, DUK_STRIDX_INT_FORMALS, DUK_PROPDESC_FLAGS_NONE);
+	}
+
+	rd->recursion_depth--;
+}
+
+/*
+ *  Public API
+ */
+
+void duk_dump_function(duk_context *ctx) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_hobject *h_fun;
+	duk_hbuffer_dynamic *h_buf;
+
+	DUK_ASSERT(ctx != NULL);
+
+	/* [ ... func ] */
+
+	h_fun = duk_require_hobject(ctx, -1);
+	if (!DUK_HOBJECT_IS_COMPILEDFUNCTION(h_fun)) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "not a compiled function");
+	}
+#if defined(DUK_USE_LAZY_COMPILE)
+	if (DUK_HCOMPILEDFUNCTION_IS_LAZY((duk_hcompiledfunction *) h_fun)) {
+		duk_js_compile_lazy_closure(thr, (duk_hcompiledfunction *) h_fun);
+	}
+#endif
+
+	duk_push_dynamic_buffer(ctx, 0);
+	h_buf = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, -1);
+	DUK_ASSERT(h_buf != NULL);
+
+	duk_hbuffer_append_byte(thr, h_buf, DUK__BC_MARKER);
+	duk_hbuffer_append_byte(thr, h_buf, DUK__BC_FORMAT_VERSION);
+	duk__dump_u32(thr, h_buf, (duk_uint32_t) DUK_VERSION);
+	duk__dump_func(thr, h_buf, (duk_hcompiledfunction *) h_fun);
+
+	/* [ ... func buf ] -> [ ... buf ] */
+
+	(void) duk_to_fixed_buffer(ctx, -1, NULL);
+	duk_remove(ctx, -2);
+}
+
+void duk_load_function(duk_context *ctx) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk__bc_reader rd;
+	duk_size_t sz;
+	const duk_uint8_t *p;
+
+	DUK_ASSERT(ctx != NULL);
+
+	/* [ ... buf ] */
+
+	p = (const duk_uint8_t *) duk_require_buffer(ctx, -1, &sz);
+	rd.thr = thr;
+	rd.p = p;
+	rd.p_end = p + sz;
+	rd.recursion_depth = 0;
+
+	if (sz < 6 || p[0] != DUK__BC_MARKER) {
+		duk__load_error(&rd);
+	}
+	(void) duk__load_u8(&rd);
+	if (duk__load_u8(&rd) != DUK__BC_FORMAT_VERSION ||
+	    duk__load_u32(&rd) != (duk_uint32_t) DUK_VERSION) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "bytecode version mismatch");
+	}
+
+	/* The input buffer stays in the value stack (and its data pointer
+	 * stays stable) while loading.
+	 */
+	duk__load_func(&rd);
+	if (rd.p != rd.p_end) {
+		duk__load_error(&rd);
+	}
+
+	/* [ ... buf func_template ] */
+
+	duk_js_push_closure(thr,
+	                    (duk_hcompiledfunction *) duk_get_hobject(ctx, -1),
+	                    thr->builtins[DUK_BIDX_GLOBAL_ENV],
+	                    thr->builtins[DUK_BIDX_GLOBAL_ENV]);
+
+	/* [ ... buf func_template closure ] -> [ ... closure ] */
+
+	duk_replace(ctx, -3);
+	duk_pop(ctx);
+}
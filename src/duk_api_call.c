@@ -195,6 +195,85 @@ int duk_pcall_prop(duk_context *ctx, int obj_index, int nargs) {
 	return duk_safe_call(ctx, duk__pcall_prop_raw, nargs + 1 + 2 /*nargs*/, 1 /*nrets*/);
 }
 
+/*
+ *  Protected call with an execution budget
+ *
+ *  The budget of the innermost duk_pcall_budget() lives in the heap and
+ *  is charged by the executor interrupt handler.  When a budget is armed
+ *  or the outer budget is restored, instructions executed so far in the
+ *  current interrupt window are charged to the budget being replaced (see
+ *  duk_heap_interrupt_sync()), and the next instruction triggers an
+ *  interrupt which then schedules the next one against the new budget.
+ */
+
+int duk_pcall_budget(duk_context *ctx, int nargs, duk_int_t max_steps, duk_int_t max_msec) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+#if defined(DUK_USE_EXEC_BUDGET)
+	duk_heap *heap;
+	duk_int_t outer_steps;
+	duk_int_t inner_steps;
+	duk_double_t outer_deadline;
+	duk_double_t deadline;
+	int rc;
+#endif
+
+	DUK_ASSERT(ctx != NULL);
+	DUK_ASSERT(thr != NULL);
+
+	if (max_steps <= 0 && max_msec <= 0) {
+		return duk_pcall(ctx, nargs);
+	}
+
+#if defined(DUK_USE_EXEC_BUDGET)
+	/* Argument errors must be thrown before the budget is armed. */
+	if (duk_get_top(ctx) - nargs - 1 < 0 || nargs < 0) {
+		/* See comments in duk_pcall(). */
+		DUK_ERROR(thr, DUK_ERR_API_ERROR, "invalid call args");
+		return DUK_EXEC_ERROR;  /* unreachable */
+	}
+
+	heap = thr->heap;
+	duk_heap_interrupt_sync(heap);
+	outer_steps = heap->budget_steps;
+	outer_deadline = heap->budget_deadline;
+
+	/* A nested budget can only be stricter than the outer one. */
+	if (max_steps > 0 && (outer_steps < 0 || max_steps < outer_steps)) {
+		heap->budget_steps = max_steps;
+	}
+	if (max_msec > 0) {
+		deadline = duk_bi_date_get_now(ctx) + (duk_double_t) max_msec;
+		if (outer_deadline <= 0.0 || deadline < outer_deadline) {
+			heap->budget_deadline = deadline;
+		}
+	}
+
+	inner_steps = heap->budget_steps;
+
+	DUK_DD(DUK_DDPRINT("budget armed: steps=%ld, deadline=%lf (outer steps=%ld, deadline=%lf)",
+	                   (long) heap->budget_steps, (double) heap->budget_deadline,
+	                   (long) outer_steps, (double) outer_deadline));
+
+	rc = duk_pcall(ctx, nargs);
+
+	/* Charge the instructions executed under this budget to the outer one. */
+	duk_heap_interrupt_sync(heap);
+	if (outer_steps >= 0) {
+		DUK_ASSERT(inner_steps >= 0 && inner_steps <= outer_steps);
+		outer_steps -= inner_steps - heap->budget_steps;
+		DUK_ASSERT(outer_steps >= 0);
+	}
+	heap->budget_steps = outer_steps;
+	heap->budget_deadline = outer_deadline;
+
+	return rc;
+#else
+	DUK_UNREF(nargs);
+	DUK_ERROR(thr, DUK_ERR_UNSUPPORTED_ERROR, "execution budget not supported");
+	return DUK_EXEC_ERROR;  /* unreachable */
+#endif
+}
+
 int duk_safe_call(duk_context *ctx, duk_safe_call_function func, int nargs, int nrets) {
 	duk_hthread *thr = (duk_hthread *) ctx;
 	int rc;
@@ -276,6 +355,13 @@ void duk_new(duk_context *ctx, int nargs) {
 
 	duk_dup(ctx, idx_cons);
 	for (;;) {
+		if (duk_is_lightfunc(ctx, -1)) {
+			/* Lightfuncs are constructable like Duktape/C
+			 * functions, and can never be bound.
+			 */
+			cons = NULL;
+			break;
+		}
 		cons = duk_get_hobject(ctx, -1);
 		if (cons == NULL || !DUK_HOBJECT_HAS_CONSTRUCTABLE(cons)) {
 			/* Checking constructability from anything else than the
@@ -290,7 +376,8 @@ void duk_new(duk_context *ctx, int nargs) {
 		duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_TARGET);  /* -> [... cons target] */
 		duk_remove(ctx, -2);                                  /* -> [... target] */
 	}
-	DUK_ASSERT(cons != NULL && !DUK_HOBJECT_HAS_BOUND(cons));
+	DUK_ASSERT(cons == NULL || !DUK_HOBJECT_HAS_BOUND(cons));
+	DUK_UNREF(cons);
 
 	/* [... constructor arg1 ... argN final_cons] */
 
@@ -438,7 +525,10 @@ int duk_get_magic(duk_context *ctx) {
 
 	act = thr->callstack + thr->callstack_top - 1;
 	func = act->func;
-	DUK_ASSERT(func != NULL);
+	if (func == NULL) {
+		DUK_ASSERT(DUK_TVAL_IS_LIGHTFUNC(&act->tv_func));
+		return (int) DUK_LFUNC_FLAGS_GET_MAGIC(DUK_TVAL_GET_LIGHTFUNC_FLAGS(&act->tv_func));
+	}
 
 	if (DUK_HOBJECT_IS_NATIVEFUNCTION(func)) {
 		duk_hnativefunction *nf = (duk_hnativefunction *) func;
@@ -99,3 +99,59 @@ int duk_compile_raw(duk_context *ctx, int flags) {
 	return DUK_EXEC_SUCCESS;
 }
 
+
+/*
+ *  Compile cache for eval() and Function constructor code
+ */
+
+void duk_push_compile_cache_stats(duk_context *ctx) {
+#if defined(DUK_USE_COMPILE_CACHE)
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_heap *heap;
+	int i;
+	int used;
+
+	DUK_ASSERT(ctx != NULL);
+	heap = thr->heap;
+
+	used = 0;
+	for (i = 0; i < DUK_USE_COMPILE_CACHE_SIZE; i++) {
+		if (heap->compcache[i].h_source != NULL) {
+			used++;
+		}
+	}
+
+	duk_push_object(ctx);
+	duk_push_int(ctx, DUK_USE_COMPILE_CACHE_SIZE);
+	duk_put_prop_string(ctx, -2, "size");
+	duk_push_int(ctx, DUK_USE_COMPILE_CACHE_MAXLEN);
+	duk_put_prop_string(ctx, -2, "maxlen");
+	duk_push_int(ctx, used);
+	duk_put_prop_string(ctx, -2, "entries");
+	duk_push_number(ctx, (duk_double_t) heap->compcache_hits);
+	duk_put_prop_string(ctx, -2, "hits");
+	duk_push_number(ctx, (duk_double_t) heap->compcache_misses);
+	duk_put_prop_string(ctx, -2, "misses");
+	duk_push_number(ctx, (duk_double_t) heap->compcache_evictions);
+	duk_put_prop_string(ctx, -2, "evictions");
+#else
+	duk_push_undefined(ctx);
+#endif
+}
+
+void duk_reset_compile_cache(duk_context *ctx) {
+#if defined(DUK_USE_COMPILE_CACHE)
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_heap *heap;
+
+	DUK_ASSERT(ctx != NULL);
+	heap = thr->heap;
+
+	duk_heap_compcache_clear(thr);
+	heap->compcache_hits = 0;
+	heap->compcache_misses = 0;
+	heap->compcache_evictions = 0;
+#else
+	DUK_UNREF(ctx);
+#endif
+}
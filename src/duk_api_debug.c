@@ -35,3 +35,270 @@ void duk_push_context_dump(duk_context *ctx) {
 	duk_pop(ctx);
 	DUK_ASSERT(duk_is_string(ctx, -1));
 }
+
+/*
+ *  Sampling profiler
+ *
+ *  While a profiling run is active, the executor interrupt is triggered
+ *  at least every 'prof_interval' bytecode instructions, and whenever
+ *  'prof_interval' instructions have been executed since the previous
+ *  sample a snapshot of the current thread's call stack is recorded.  Samples are accumulated into
+ *  an internal object of the heap object, mapping a folded stack string
+ *  (outermost frame first, frames separated by ';') into a sample count.
+ *  This is the "folded stacks" format accepted by e.g. flamegraph.pl.
+ */
+
+#if defined(DUK_USE_PROFILER)
+/* Maximum length of a single frame label; longer labels are truncated. */
+#define DUK__PROF_FRAME_MAXLEN  256
+
+static const char *duk__prof_get_own_string(duk_hthread *thr, duk_hobject *h, duk_hstring *key) {
+	duk_tval *tv;
+	duk_hstring *h_str;
+
+	/* Raw lookup, no side effects: the sampler must not run getters. */
+	tv = duk_hobject_find_existing_entry_tval_ptr(h, key);
+	if (tv == NULL || !DUK_TVAL_IS_STRING(tv)) {
+		return NULL;
+	}
+	h_str = DUK_TVAL_GET_STRING(tv);
+	if (h_str == DUK_HTHREAD_STRING_EMPTY_STRING(thr)) {
+		return NULL;
+	}
+	return (const char *) DUK_HSTRING_GET_DATA(h_str);
+}
+
+/* Push a label for callstack entry 'act_idx': "name (fileName:line)" for
+ * Ecmascript functions, "name (native)" for Duktape/C functions.
+ */
+static void duk__prof_push_frame(duk_context *ctx, duk_size_t act_idx) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_activation *act;
+	duk_hobject *func;
+	duk_int_t pc;
+	duk_uint_fast32_t line = 0;
+	const char *name;
+	const char *filename;
+	char buf[DUK__PROF_FRAME_MAXLEN];
+	char *p;
+
+	act = thr->callstack + act_idx;
+	if (DUK_TVAL_IS_LIGHTFUNC(&act->tv_func)) {
+		duk_push_lightfunc_name(ctx, &act->tv_func);
+		return;
+	}
+	func = act->func;
+	DUK_ASSERT(func != NULL);
+	pc = act->pc;
+
+	name = duk__prof_get_own_string(thr, func, DUK_HTHREAD_STRING_NAME(thr));
+	if (name == NULL) {
+		name = "anon";
+	}
+
+	if (DUK_HOBJECT_IS_COMPILEDFUNCTION(func)) {
+		filename = duk__prof_get_own_string(thr, func, DUK_HTHREAD_STRING_FILE_NAME(thr));
+#if defined(DUK_USE_PC2LINE)
+		/* PC points to the next instruction. */
+		if (pc > 0) {
+			pc--;
+		}
+		duk_push_hobject(ctx, func);
+		line = duk_hobject_pc2line_query(ctx, -1, (duk_uint_fast32_t) pc);
+		duk_pop(ctx);
+#else
+		DUK_UNREF(pc);
+#endif
+		DUK_SNPRINTF(buf, sizeof(buf), "%s (%s:%ld)", name,
+		             (filename != NULL ? filename : "anon"), (long) line);
+	} else {
+		DUK_SNPRINTF(buf, sizeof(buf), "%s (native)", name);
+	}
+	buf[sizeof(buf) - 1] = (char) 0;
+
+	/* Frame separator and line terminators must not appear in a label. */
+	for (p = buf; *p != (char) 0; p++) {
+		if (*p == ';' || *p == '\n' || *p == '\r') {
+			*p = '_';
+		}
+	}
+	duk_push_string(ctx, buf);
+}
+
+static duk_ret_t duk__prof_sample_raw(duk_context *ctx) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_size_t i, n;
+	duk_int_t count;
+
+	n = thr->callstack_top;
+	duk_require_stack(ctx, (duk_idx_t) n + 4);
+
+	duk_push_hobject(ctx, thr->heap->heap_object);
+	if (!duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_PROFILE)) {
+		return 0;
+	}
+
+	/* [ heap_object samples ] */
+
+	duk_push_lstring(ctx, ";", 1);
+	for (i = 0; i < n; i++) {
+		duk__prof_push_frame(ctx, i);
+	}
+	duk_join(ctx, (unsigned int) n);
+
+	/* [ heap_object samples key ] */
+
+	duk_dup_top(ctx);
+	duk_get_prop(ctx, -3);
+	count = duk_get_int(ctx, -1);  /* 0 if missing */
+	duk_pop(ctx);
+	duk_push_int(ctx, count + 1);
+	duk_put_prop(ctx, -3);
+	return 0;
+}
+
+void duk_profiler_sample(duk_hthread *thr) {
+	duk_context *ctx = (duk_context *) thr;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(thr->heap->prof_interval > 0);
+
+	/* Errors (e.g. out of memory) cause the sample to be dropped, they
+	 * must not propagate into the executing code.
+	 */
+	(void) duk_safe_call(ctx, duk__prof_sample_raw, 0 /*nargs*/, 1 /*nrets*/);
+	duk_pop(ctx);
+}
+#endif  /* DUK_USE_PROFILER */
+
+void duk_profiler_start(duk_context *ctx, duk_int_t interval) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+
+	DUK_ASSERT(ctx != NULL);
+
+#if defined(DUK_USE_PROFILER)
+	if (interval <= 0) {
+		DUK_ERROR(thr, DUK_ERR_API_ERROR, "invalid argument(s)");
+	}
+
+	/* Start from an empty set of samples. */
+	duk_push_hobject(ctx, thr->heap->heap_object);
+	duk_push_object_internal(ctx);
+	duk_def_prop_stridx(ctx, -2, DUK_STRIDX_INT_PROFILE, DUK_PROPDESC_FLAGS_W);
+	duk_pop(ctx);
+
+	/* Instructions executed before the start are not counted towards the
+	 * first sample; the next instruction schedules the first interval.
+	 */
+	duk_heap_interrupt_sync(thr->heap);
+	thr->heap->prof_interval = interval;
+	thr->heap->prof_remaining = interval;
+#else
+	DUK_UNREF(interval);
+	DUK_ERROR(thr, DUK_ERR_UNSUPPORTED_ERROR, "profiler not supported");
+#endif
+}
+
+void duk_profiler_stop(duk_context *ctx) {
+#if defined(DUK_USE_PROFILER)
+	duk_hthread *thr = (duk_hthread *) ctx;
+
+	DUK_ASSERT(ctx != NULL);
+
+	/* Samples are kept until the next duk_profiler_start(). */
+	thr->heap->prof_interval = 0;
+#else
+	DUK_UNREF(ctx);
+#endif
+}
+
+void duk_push_profiler_dump(duk_context *ctx) {
+#if defined(DUK_USE_PROFILER)
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_hbuffer_dynamic *h_buf;
+	char buf[32];
+
+	DUK_ASSERT(ctx != NULL);
+
+	duk_push_dynamic_buffer(ctx, 0);
+	h_buf = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, -1);
+	DUK_ASSERT(h_buf != NULL);
+
+	duk_push_hobject(ctx, thr->heap->heap_object);
+	if (duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_PROFILE)) {
+		/* [ ... buf heap_object samples ] */
+		duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+		while (duk_next(ctx, -1, 1 /*get_value*/)) {
+			DUK_SNPRINTF(buf, sizeof(buf), " %ld\n", (long) duk_get_int(ctx, -1));
+			buf[sizeof(buf) - 1] = (char) 0;
+			duk_hbuffer_append_hstring(thr, h_buf, duk_get_hstring(ctx, -2));
+			duk_hbuffer_append_cstring(thr, h_buf, buf);
+			duk_pop_2(ctx);
+		}
+		duk_pop(ctx);  /* enum */
+	}
+	duk_pop_2(ctx);
+
+	duk_to_string(ctx, -1);
+#else
+	duk_push_hstring_stridx(ctx, DUK_STRIDX_EMPTY_STRING);
+#endif
+}
+
+/*
+ *  Opcode statistics
+ *
+ *  Counts are pushed as plain arrays indexed by opcode / extraop number
+ *  (see duk_js_bytecode.h).  Opcode pair counts are flattened so that the
+ *  count for 'prev' followed by 'op' is at index prev * 64 + op.
+ */
+
+#if defined(DUK_USE_OPCODE_STATS)
+static void duk__push_count_array(duk_context *ctx, duk_opcode_count *counts, duk_uint_t n) {
+	duk_uint_t i;
+
+	duk_push_array(ctx);
+	for (i = 0; i < n; i++) {
+		duk_push_number(ctx, (duk_double_t) counts[i]);
+		duk_put_prop_index(ctx, -2, (unsigned int) i);
+	}
+}
+#endif  /* DUK_USE_OPCODE_STATS */
+
+void duk_push_opcode_stats(duk_context *ctx) {
+#if defined(DUK_USE_OPCODE_STATS)
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_heap *heap;
+
+	DUK_ASSERT(ctx != NULL);
+	heap = thr->heap;
+
+	duk_push_object(ctx);
+	duk__push_count_array(ctx, heap->opcode_counts, DUK_HEAP_OPCODE_STATS_NUM_OPS);
+	duk_put_prop_string(ctx, -2, "opcodes");
+	duk__push_count_array(ctx, heap->extraop_counts, DUK_HEAP_OPCODE_STATS_NUM_EXTRAOPS);
+	duk_put_prop_string(ctx, -2, "extraops");
+	duk__push_count_array(ctx, &heap->opcode_pair_counts[0][0],
+	                       DUK_HEAP_OPCODE_STATS_NUM_OPS * DUK_HEAP_OPCODE_STATS_NUM_OPS);
+	duk_put_prop_string(ctx, -2, "pairs");
+#else
+	duk_push_undefined(ctx);
+#endif
+}
+
+void duk_reset_opcode_stats(duk_context *ctx) {
+#if defined(DUK_USE_OPCODE_STATS)
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_heap *heap;
+
+	DUK_ASSERT(ctx != NULL);
+	heap = thr->heap;
+
+	DUK_MEMZERO((void *) heap->opcode_counts, sizeof(heap->opcode_counts));
+	DUK_MEMZERO((void *) heap->extraop_counts, sizeof(heap->extraop_counts));
+	DUK_MEMZERO((void *) heap->opcode_pair_counts, sizeof(heap->opcode_pair_counts));
+	heap->opcode_prev = 0;
+#else
+	DUK_UNREF(ctx);
+#endif
+}
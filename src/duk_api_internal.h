@@ -93,6 +93,11 @@ int duk_push_object_internal(duk_context *ctx);
 int duk_push_compiledfunction(duk_context *ctx);
 void duk_push_c_function_noexotic(duk_context *ctx, duk_c_function func, int nargs);
 void duk_push_c_function_noconstruct_noexotic(duk_context *ctx, duk_c_function func, int nargs);
+void duk_push_lightfunc_name(duk_context *ctx, duk_tval *tv);
+
+#if defined(DUK_USE_PROFILER)
+void duk_profiler_sample(duk_hthread *thr);
+#endif
 
 int duk_get_prop_stridx(duk_context *ctx, int obj_index, unsigned int stridx);     /* [] -> [val] */
 int duk_put_prop_stridx(duk_context *ctx, int obj_index, unsigned int stridx);     /* [val] -> [] */
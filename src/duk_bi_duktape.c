@@ -115,7 +115,6 @@ duk_ret_t duk_bi_duktape_object_info(duk_context *ctx) {
 duk_ret_t duk_bi_duktape_object_act(duk_context *ctx) {
 	duk_hthread *thr = (duk_hthread *) ctx;
 	duk_activation *act;
-	duk_hobject *h_func;
 	duk_uint_fast32_t pc;
 	duk_uint_fast32_t line;
 	duk_int_t level;
@@ -132,9 +131,7 @@ duk_ret_t duk_bi_duktape_object_act(duk_context *ctx) {
 
 	duk_push_object(ctx);
 
-	h_func = act->func;
-	DUK_ASSERT(h_func != NULL);
-	duk_push_hobject(ctx, h_func);
+	duk_push_tval(ctx, &act->tv_func);  /* object or lightfunc */
 
 	pc = (duk_uint_fast32_t) act->pc;
 	duk_push_int(ctx, (int) pc);  /* FIXME: typing */
@@ -287,3 +284,9 @@ duk_ret_t duk_bi_duktape_object_compact(duk_context *ctx) {
 	return 1;  /* return the argument object */
 }
 
+/* Only present in the Duktape object with DUK_USE_OPCODE_STATS. */
+duk_ret_t duk_bi_duktape_object_opstats(duk_context *ctx) {
+	duk_push_opcode_stats(ctx);
+	return 1;
+}
+
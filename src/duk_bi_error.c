@@ -165,15 +165,14 @@ static int duk__traceback_getter_helper(duk_context *ctx, int output_type) {
 			flags = (int) DUK_FLOOR(d / DUK_DOUBLE_2TO32);
 			t = duk_get_type(ctx, -2);
 
-			if (t == DUK_TYPE_OBJECT) {
+			if (t == DUK_TYPE_OBJECT || t == DUK_TYPE_LIGHTFUNC) {
 				/*
-				 *  Ecmascript/native function call
+				 *  Ecmascript/native function call or lightfunc call
 				 */
 
 				/* [ ... v1(func) v2(pc+flags) ] */
 
-				h_func = duk_get_hobject(ctx, -2);
-				DUK_ASSERT(h_func != NULL);
+				h_func = duk_get_hobject(ctx, -2);  /* NULL for lightfunc */
 
 				duk_get_prop_stridx(ctx, -2, DUK_STRIDX_NAME);
 				duk_get_prop_stridx(ctx, -3, DUK_STRIDX_FILE_NAME);
@@ -196,7 +195,7 @@ static int duk__traceback_getter_helper(duk_context *ctx, int output_type) {
 				h_name = duk_get_hstring(ctx, -2);  /* may be NULL */
 				funcname = (h_name == NULL || h_name == DUK_HTHREAD_STRING_EMPTY_STRING(thr)) ?
 				           "anon" : (const char *) DUK_HSTRING_GET_DATA(h_name);
-				if (DUK_HOBJECT_HAS_NATIVEFUNCTION(h_func)) {
+				if (h_func == NULL || DUK_HOBJECT_HAS_NATIVEFUNCTION(h_func)) {
 					duk_push_sprintf(ctx, "%s %s native%s%s%s%s%s",
 					                 funcname,
 					                 duk_get_string(ctx, -1),
@@ -55,7 +55,7 @@ int duk_bi_function_constructor(duk_context *ctx) {
 	comp_flags = DUK_JS_COMPILE_FLAG_FUNCEXPR;
 
 	duk_push_hstring_stridx(ctx, DUK_STRIDX_COMPILE);  /* XXX: copy from caller? */
-	duk_js_compile(thr, comp_flags);
+	duk_js_compile_cached(thr, comp_flags);
 	func = (duk_hcompiledfunction *) duk_get_hobject(ctx, -1);
 	DUK_ASSERT(func != NULL);
 	DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) func));
@@ -131,6 +131,9 @@ int duk_bi_function_prototype_to_string(duk_context *ctx) {
 		} else {
 			goto type_error;
 		}
+	} else if (DUK_TVAL_IS_LIGHTFUNC(tv)) {
+		duk_push_lightfunc_name(ctx, tv);
+		duk_push_sprintf(ctx, "function %s() {/* light */}", duk_get_string(ctx, -1));
 	} else {
 		goto type_error;
 	}
@@ -250,6 +253,12 @@ int duk_bi_function_prototype_bind(duk_context *ctx) {
 		DUK_DDD(DUK_DDDPRINT("func is not callable"));
 		goto type_error;
 	}
+	if (duk_is_lightfunc(ctx, -1)) {
+		/* Bind to the object coerced version of the lightfunc so that
+		 * the bound function has an ordinary function as its target.
+		 */
+		duk_to_object(ctx, -1);
+	}
 
 	/* [ thisArg arg1 ... argN func ]  (thisArg+args == nargs total) */
 	DUK_ASSERT_TOP(ctx, nargs + 1);
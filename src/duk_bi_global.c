@@ -446,7 +446,7 @@ duk_ret_t duk_bi_global_object_eval(duk_context *ctx) {
 	act_eval = NULL;
 
 	duk_push_hstring_stridx(ctx, DUK_STRIDX_INPUT);  /* XXX: copy from caller? */
-	duk_js_compile(thr, comp_flags);
+	duk_js_compile_cached(thr, comp_flags);
 	func = (duk_hcompiledfunction *) duk_get_hobject(ctx, -1);
 	DUK_ASSERT(func != NULL);
 	DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) func));
@@ -1475,6 +1475,15 @@ static void duk__enc_value2(duk_json_enc_ctx *js_ctx) {
 		DUK__EMIT_CSTR(js_ctx, buf);
 		break;
 	}
+#endif  /* DUK_USE_JX || DUK_USE_JC */
+#if defined(DUK_USE_JX) || defined(DUK_USE_JC)
+	/* When JX/JC not in use, duk__enc_value1 will block lightfunc values. */
+	case DUK_TAG_LIGHTFUNC: {
+		/* We only get here when doing non-standard JSON encoding */
+		DUK_ASSERT(js_ctx->flag_ext_custom || js_ctx->flag_ext_compatible);
+		DUK__EMIT_STRIDX(js_ctx, js_ctx->stridx_custom_function);
+		break;
+	}
 #endif  /* DUK_USE_JX || DUK_USE_JC */
 	case DUK_TAG_STRING: {
 		duk_hstring *h = DUK_TVAL_GET_STRING(tv);
@@ -1813,7 +1822,8 @@ void duk_bi_json_stringify_helper(duk_context *ctx,
 	{
 		js_ctx->mask_for_undefined = DUK_TYPE_MASK_UNDEFINED |
 		                             DUK_TYPE_MASK_POINTER |
-		                             DUK_TYPE_MASK_BUFFER;
+		                             DUK_TYPE_MASK_BUFFER |
+		                             DUK_TYPE_MASK_LIGHTFUNC;
 	}
 
 	(void) duk_push_dynamic_buffer(ctx, 0);
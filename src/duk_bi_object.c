@@ -49,6 +49,13 @@ duk_ret_t duk_bi_object_getprototype_shared(duk_context *ctx) {
 		duk_insert(ctx, 0);
 	}
 
+	if (duk_is_lightfunc(ctx, 0)) {
+		/* Lightfunc inherits from Function.prototype like its
+		 * object coerced counterpart.
+		 */
+		duk_push_hobject_bidx(ctx, DUK_BIDX_FUNCTION_PROTOTYPE);
+		return 1;
+	}
 	h = duk_require_hobject(ctx, 0);
 	DUK_ASSERT(h != NULL);
 
@@ -115,6 +122,9 @@ duk_ret_t duk_bi_object_setprototype_shared(duk_context *ctx) {
 	if (!DUK_HOBJECT_HAS_EXTENSIBLE(h_obj)) {
 		goto fail_nonextensible;
 	}
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h_obj)) {
+		goto fail_readonly;
+	}
 	for (h_curr = h_new_proto; h_curr != NULL; h_curr = h_curr->prototype) {
 		/* Loop prevention */
 		if (h_curr == h_obj) {
@@ -130,6 +140,7 @@ duk_ret_t duk_bi_object_setprototype_shared(duk_context *ctx) {
 
  fail_nonextensible:
  fail_loop:
+ fail_readonly:
 	return DUK_RET_TYPE_ERROR;
 }
 
@@ -215,6 +226,10 @@ duk_ret_t duk_bi_object_constructor_prevent_extensions(duk_context *ctx) {
 	h = duk_require_hobject(ctx, 0);
 	DUK_ASSERT(h != NULL);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h)) {
+		return DUK_RET_TYPE_ERROR;
+	}
+
 	DUK_HOBJECT_CLEAR_EXTENSIBLE(h);
 
 	/* A non-extensible object cannot gain any more properties,
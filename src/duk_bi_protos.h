@@ -70,6 +70,7 @@ duk_ret_t duk_bi_duktape_object_fin(duk_context *ctx);
 duk_ret_t duk_bi_duktape_object_enc(duk_context *ctx);
 duk_ret_t duk_bi_duktape_object_dec(duk_context *ctx);
 duk_ret_t duk_bi_duktape_object_compact(duk_context *ctx);
+duk_ret_t duk_bi_duktape_object_opstats(duk_context *ctx);
 
 duk_ret_t duk_bi_error_constructor_shared(duk_context *ctx);
 duk_ret_t duk_bi_error_prototype_to_string(duk_context *ctx);
@@ -78,9 +78,10 @@ duk_ret_t duk_bi_thread_resume(duk_context *ctx) {
 	}
 	DUK_ASSERT((thr->callstack + thr->callstack_top - 1)->func != NULL);  /* us */
 	DUK_ASSERT(DUK_HOBJECT_IS_NATIVEFUNCTION((thr->callstack + thr->callstack_top - 1)->func));
-	DUK_ASSERT((thr->callstack + thr->callstack_top - 2)->func != NULL);  /* caller */
+	/* caller may be a lightfunc, in which case func is NULL */
 
-	if (!DUK_HOBJECT_IS_COMPILEDFUNCTION((thr->callstack + thr->callstack_top - 2)->func)) {
+	if ((thr->callstack + thr->callstack_top - 2)->func == NULL ||
+	    !DUK_HOBJECT_IS_COMPILEDFUNCTION((thr->callstack + thr->callstack_top - 2)->func)) {
 		DUK_DD(DUK_DDPRINT("resume state invalid: caller must be Ecmascript code"));
 		goto state_error;
 	}
@@ -125,6 +126,14 @@ duk_ret_t duk_bi_thread_resume(duk_context *ctx) {
 			goto state_invalid_initial;
 		}
 
+#if defined(DUK_USE_LAZY_COMPILE)
+		/* Compile here while the thread states are still intact;
+		 * 'func' is reachable through the resumee's value stack.
+		 */
+		if (DUK_HCOMPILEDFUNCTION_IS_LAZY((duk_hcompiledfunction *) func)) {
+			duk_js_compile_lazy_closure(thr, (duk_hcompiledfunction *) func);
+		}
+#endif
 	}
 
 	/*
@@ -237,9 +246,10 @@ duk_ret_t duk_bi_thread_yield(duk_context *ctx) {
 	}
 	DUK_ASSERT((thr->callstack + thr->callstack_top - 1)->func != NULL);  /* us */
 	DUK_ASSERT(DUK_HOBJECT_IS_NATIVEFUNCTION((thr->callstack + thr->callstack_top - 1)->func));
-	DUK_ASSERT((thr->callstack + thr->callstack_top - 2)->func != NULL);  /* caller */
+	/* caller may be a lightfunc, in which case func is NULL */
 
-	if (!DUK_HOBJECT_IS_COMPILEDFUNCTION((thr->callstack + thr->callstack_top - 2)->func)) {
+	if ((thr->callstack + thr->callstack_top - 2)->func == NULL ||
+	    !DUK_HOBJECT_IS_COMPILEDFUNCTION((thr->callstack + thr->callstack_top - 2)->func)) {
 		DUK_DD(DUK_DDPRINT("yield state invalid: caller must be Ecmascript code"));
 		goto state_error;
 	}
@@ -93,6 +93,9 @@ static char duk__get_tval_summary_char(duk_tval *tv) {
 	case DUK_TAG_POINTER: {
 		return 'P';
 	}
+	case DUK_TAG_LIGHTFUNC: {
+		return 'L';
+	}
 	default:
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
 		return 'd';
@@ -347,14 +350,15 @@ void duk_debug_dump_hobject(duk_hobject *obj) {
 		duk_hstring *k;
 		duk_propvalue *v;
 
-		k = DUK_HOBJECT_E_GET_KEY(obj, i);
-		v = DUK_HOBJECT_E_GET_VALUE_PTR(obj, i);
-
 		if (i >= obj->e_used) {
 			DUK_D(DUK_DPRINT("    [%d]: UNUSED", i));
 			continue;
 		}
 
+		/* keys may be stored in a shape which has no slots beyond e_used */
+		k = DUK_HOBJECT_E_GET_KEY(obj, i);
+		v = DUK_HOBJECT_E_GET_VALUE_PTR(obj, i);
+
 		if (!k) {
 			DUK_D(DUK_DPRINT("    [%d]: NULL", i));
 			continue;
@@ -79,8 +79,8 @@ static const char *duk__bc_optab[] = {
 	"CLOSURE",  "GETPROP", 	"PUTPROP",  "DELPROP",  "CSPROP",   "CSPROPI",  "ADD",      "SUB",      "MUL",      "DIV",
 	"MOD",      "BAND",     "BOR",      "BXOR",     "BASL",     "BLSR", 	"BASR",     "BNOT", 	"LNOT",     "EQ",
 	"NEQ",      "SEQ",      "SNEQ",     "GT",       "GE",       "LT",       "LE",       "IF", 	"INSTOF",   "IN",
-	"JUMP",     "RETURN",   "CALL",     "CALLI",    "LABEL",    "ENDLABEL", "BREAK",    "CONTINUE", "TRYCATCH", "UNUSED59",
-	"UNUSED60", "EXTRA",    "DEBUG",    "INVALID",
+	"JUMP",     "RETURN",   "CALL",     "CALLI",    "LABEL",    "ENDLABEL", "BREAK",    "CONTINUE", "TRYCATCH", "IFCMP",
+	"INCDEC",   "UNUSED61", "EXTRA",    "INVALID",
 };
 
 static const char *duk__bc_extraoptab[] = {
@@ -725,6 +725,17 @@ static void duk__print_tval(duk__dprint_state *st, duk_tval *tv) {
 		duk_fb_sprintf(fb, "pointer:%p", DUK_TVAL_GET_POINTER(tv));
 		break;
 	}
+	case DUK_TAG_LIGHTFUNC: {
+		duk_c_function func;
+		duk_small_int_t lf_flags;
+		char buf[64];
+
+		func = DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv);
+		lf_flags = DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv);
+		duk_debug_format_funcptr(buf, sizeof(buf), (unsigned char *) &func, sizeof(func));
+		duk_fb_sprintf(fb, "lightfunc:%s:%04x", buf, (int) lf_flags);
+		break;
+	}
 	default: {
 		/* IEEE double is approximately 16 decimal digits; print a couple extra */
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
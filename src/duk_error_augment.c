@@ -230,11 +230,12 @@ static void duk__add_traceback(duk_hthread *thr, duk_hthread *thr_callstack, con
 
 		/* [... arr] */
 
-		DUK_ASSERT(thr_callstack->callstack[i].func != NULL);
+		DUK_ASSERT(thr_callstack->callstack[i].func != NULL ||
+		           DUK_TVAL_IS_LIGHTFUNC(&thr_callstack->callstack[i].tv_func));
 		DUK_ASSERT(thr_callstack->callstack[i].pc >= 0);
 
-		/* add function */
-		duk_push_hobject(ctx, thr_callstack->callstack[i].func);  /* -> [... arr func] */
+		/* add function (object or lightfunc) */
+		duk_push_tval(ctx, &thr_callstack->callstack[i].tv_func);  /* -> [... arr func] */
 		duk_def_prop_index_wec(ctx, -2, arr_idx);
 		arr_idx++;
 
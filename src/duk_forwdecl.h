@@ -26,12 +26,19 @@ struct duk_hbuffer_dynamic;
 struct duk_propaccessor;
 union duk_propvalue;
 struct duk_propdesc;
+struct duk_hshape;
+union duk_rom_propvalue_number;
+union duk_rom_propvalue_int;
+union duk_rom_propvalue_ptr;
+union duk_rom_propvalue_accessor;
 
 struct duk_heap;
 
 struct duk_activation;
 struct duk_catcher;
 struct duk_strcache;
+struct duk_compcache;
+struct duk_jitcode;
 struct duk_ljstate;
 
 #ifdef DUK_USE_DEBUG
@@ -44,6 +51,7 @@ struct duk_bitencoder_ctx;
 struct duk_token;
 struct duk_re_token;
 struct duk_lexer_point;
+struct duk_lexer_codepoint;
 struct duk_lexer_ctx;
 
 struct duk_compiler_instr;
@@ -70,12 +78,19 @@ typedef struct duk_hbuffer_dynamic duk_hbuffer_dynamic;
 typedef struct duk_propaccessor duk_propaccessor;
 typedef union duk_propvalue duk_propvalue;
 typedef struct duk_propdesc duk_propdesc;
+typedef struct duk_hshape duk_hshape;
+typedef union duk_rom_propvalue_number duk_rom_propvalue_number;
+typedef union duk_rom_propvalue_int duk_rom_propvalue_int;
+typedef union duk_rom_propvalue_ptr duk_rom_propvalue_ptr;
+typedef union duk_rom_propvalue_accessor duk_rom_propvalue_accessor;
  
 typedef struct duk_heap duk_heap;
 
 typedef struct duk_activation duk_activation;
 typedef struct duk_catcher duk_catcher;
 typedef struct duk_strcache duk_strcache;
+typedef struct duk_compcache duk_compcache;
+typedef struct duk_jitcode duk_jitcode;
 typedef struct duk_ljstate duk_ljstate;
 
 #ifdef DUK_USE_DEBUG
@@ -88,6 +103,7 @@ typedef struct duk_bitencoder_ctx duk_bitencoder_ctx;
 typedef struct duk_token duk_token;
 typedef struct duk_re_token duk_re_token;
 typedef struct duk_lexer_point duk_lexer_point;
+typedef struct duk_lexer_codepoint duk_lexer_codepoint;
 typedef struct duk_lexer_ctx duk_lexer_ctx;
 
 typedef struct duk_compiler_instr duk_compiler_instr;
@@ -32,8 +32,46 @@
 	((duk_hobject **) DUK_HCOMPILEDFUNCTION_GET_CODE_BASE((h)))
 
 #define DUK_HCOMPILEDFUNCTION_GET_CODE_END(h)  \
-	((duk_instr *) (DUK_HBUFFER_FIXED_GET_DATA_PTR((duk_hbuffer_fixed *) (h)->data) + \
-	                DUK_HBUFFER_GET_SIZE((h)->data)))
+	(DUK_HCOMPILEDFUNCTION_GET_CODE_BASE((h)) + DUK_HCOMPILEDFUNCTION_GET_CODE_COUNT((h)))
+
+#define DUK_HCOMPILEDFUNCTION_GET_BUFFER_END(h)  \
+	((duk_uint8_t *) (DUK_HBUFFER_FIXED_GET_DATA_PTR((duk_hbuffer_fixed *) (h)->data) + \
+	                  DUK_HBUFFER_GET_SIZE((h)->data)))
+
+/* Inline cache area: IC_WAYS 16-bit cache entries for every instruction,
+ * indexed by pc, following the bytecode.  Only property access opcodes
+ * use their entries.  See duk_hobject_getprop_ic().
+ */
+#if defined(DUK_USE_PROPERTY_IC)
+#define DUK_HCOMPILEDFUNCTION_IC_WAYS  2
+#define DUK_HCOMPILEDFUNCTION_CODE_ENTRY_SIZE  \
+	(sizeof(duk_instr) + DUK_HCOMPILEDFUNCTION_IC_WAYS * sizeof(duk_uint16_t))
+#define DUK_HCOMPILEDFUNCTION_GET_IC_BASE(h)  \
+	((duk_uint16_t *) DUK_HCOMPILEDFUNCTION_GET_CODE_END((h)))
+#else
+#define DUK_HCOMPILEDFUNCTION_CODE_ENTRY_SIZE  (sizeof(duk_instr))
+#endif
+
+/* A lazily compiled function template (DUK_USE_LAZY_COMPILE) has no
+ * bytecode and no inner functions yet; its constants describe where to
+ * compile it from: [ source, offset, line, compile flags, preparse ].
+ * The last one is a (binary) string summarizing the inner functions, so
+ * that they need not be parsed again when the function is compiled.  A
+ * compiled function always has at least one instruction.
+ */
+#define DUK_HCOMPILEDFUNCTION_LAZY_CONST_SOURCE    0
+#define DUK_HCOMPILEDFUNCTION_LAZY_CONST_OFFSET    1
+#define DUK_HCOMPILEDFUNCTION_LAZY_CONST_LINE      2
+#define DUK_HCOMPILEDFUNCTION_LAZY_CONST_FLAGS     3
+#define DUK_HCOMPILEDFUNCTION_LAZY_CONST_PREPARSE  4
+#define DUK_HCOMPILEDFUNCTION_LAZY_CONST_COUNT     5
+
+#if defined(DUK_USE_LAZY_COMPILE)
+#define DUK_HCOMPILEDFUNCTION_IS_LAZY(h)  \
+	((duk_uint8_t *) DUK_HCOMPILEDFUNCTION_GET_CODE_BASE((h)) == DUK_HCOMPILEDFUNCTION_GET_BUFFER_END((h)))
+#else
+#define DUK_HCOMPILEDFUNCTION_IS_LAZY(h)  0
+#endif
 
 #define DUK_HCOMPILEDFUNCTION_GET_CONSTS_SIZE(h)  \
 	( \
@@ -69,7 +107,9 @@
 	((size_t) (DUK_HCOMPILEDFUNCTION_GET_FUNCS_SIZE((h)) / sizeof(duk_hobject *)))
 
 #define DUK_HCOMPILEDFUNCTION_GET_CODE_COUNT(h)  \
-	((size_t) (DUK_HCOMPILEDFUNCTION_GET_CODE_SIZE((h)) / sizeof(duk_instr)))
+	((size_t) ((DUK_HCOMPILEDFUNCTION_GET_BUFFER_END((h)) - \
+	            ((duk_uint8_t *) DUK_HCOMPILEDFUNCTION_GET_CODE_BASE((h)))) / \
+	           DUK_HCOMPILEDFUNCTION_CODE_ENTRY_SIZE))
 
 
 /*
@@ -89,9 +129,10 @@ struct duk_hcompiledfunction {
 	 *    constants (duk_tval)
 	 *    inner functions (duk_hobject *)
 	 *    bytecode (duk_instr)
+	 *    inline caches (duk_uint16_t), if DUK_USE_PROPERTY_IC
 	 *
 	 *  Note: bytecode end address can be computed from 'data' buffer
-	 *  size.  It is not strictly necessary functionally, assuming
+	 *  size (the inline cache area has a fixed size per instruction).  It is not strictly necessary functionally, assuming
 	 *  bytecode never jumps outside its allocated area.  However,
 	 *  it's a safety/robustness feature for avoiding the chance of
 	 *  executing random data as bytecode due to a compiler error.
@@ -132,6 +173,17 @@ struct duk_hcompiledfunction {
 	duk_uint16_t nregs;                /* regs to allocate */
 	duk_uint16_t nargs;                /* number of arguments allocated to regs */
 
+	/*
+	 *  Baseline JIT state: hotness counter and machine code (see
+	 *  duk_js.h), NULL until first needed.  Closures share the state of
+	 *  their template because they share its bytecode, so a function
+	 *  is compiled once no matter how many closures are created of it.
+	 */
+
+#if defined(DUK_USE_JIT)
+	duk_jitcode *jit;
+#endif
+
 	/*
 	 *  Additional control information is placed into the object itself
 	 *  as internal properties to avoid unnecessary fields for the
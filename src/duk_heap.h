@@ -18,6 +18,7 @@
 #define DUK_HEAP_FLAG_MARKANDSWEEP_RECLIMIT_REACHED            (1 << 1)  /* mark-and-sweep marking reached a recursion limit and must use multi-pass marking */
 #define DUK_HEAP_FLAG_REFZERO_FREE_RUNNING                     (1 << 2)  /* refcount code is processing refzero list */
 #define DUK_HEAP_FLAG_ERRHANDLER_RUNNING                       (1 << 3)  /* an error handler (user callback to augment/replace error) is running */
+#define DUK_HEAP_FLAG_INIT_FAILED                              (1 << 4)  /* heap init failed, built-ins may be missing */
 
 #define DUK__HEAP_HAS_FLAGS(heap,bits)               ((heap)->flags & (bits))
 #define DUK__HEAP_SET_FLAGS(heap,bits)  do { \
@@ -31,11 +32,13 @@
 #define DUK_HEAP_HAS_MARKANDSWEEP_RECLIMIT_REACHED(heap)   DUK__HEAP_HAS_FLAGS((heap), DUK_HEAP_FLAG_MARKANDSWEEP_RECLIMIT_REACHED)
 #define DUK_HEAP_HAS_REFZERO_FREE_RUNNING(heap)            DUK__HEAP_HAS_FLAGS((heap), DUK_HEAP_FLAG_REFZERO_FREE_RUNNING)
 #define DUK_HEAP_HAS_ERRHANDLER_RUNNING(heap)              DUK__HEAP_HAS_FLAGS((heap), DUK_HEAP_FLAG_ERRHANDLER_RUNNING)
+#define DUK_HEAP_HAS_INIT_FAILED(heap)                     DUK__HEAP_HAS_FLAGS((heap), DUK_HEAP_FLAG_INIT_FAILED)
 
 #define DUK_HEAP_SET_MARKANDSWEEP_RUNNING(heap)            DUK__HEAP_SET_FLAGS((heap), DUK_HEAP_FLAG_MARKANDSWEEP_RUNNING)
 #define DUK_HEAP_SET_MARKANDSWEEP_RECLIMIT_REACHED(heap)   DUK__HEAP_SET_FLAGS((heap), DUK_HEAP_FLAG_MARKANDSWEEP_RECLIMIT_REACHED)
 #define DUK_HEAP_SET_REFZERO_FREE_RUNNING(heap)            DUK__HEAP_SET_FLAGS((heap), DUK_HEAP_FLAG_REFZERO_FREE_RUNNING)
 #define DUK_HEAP_SET_ERRHANDLER_RUNNING(heap)              DUK__HEAP_SET_FLAGS((heap), DUK_HEAP_FLAG_ERRHANDLER_RUNNING)
+#define DUK_HEAP_SET_INIT_FAILED(heap)                     DUK__HEAP_SET_FLAGS((heap), DUK_HEAP_FLAG_INIT_FAILED)
 
 #define DUK_HEAP_CLEAR_MARKANDSWEEP_RUNNING(heap)          DUK__HEAP_CLEAR_FLAGS((heap), DUK_HEAP_FLAG_MARKANDSWEEP_RUNNING)
 #define DUK_HEAP_CLEAR_MARKANDSWEEP_RECLIMIT_REACHED(heap) DUK__HEAP_CLEAR_FLAGS((heap), DUK_HEAP_FLAG_MARKANDSWEEP_RECLIMIT_REACHED)
@@ -144,6 +147,21 @@
 #define DUK_HEAP_STRCACHE_SIZE                            4
 #define DUK_HEAP_STRINGCACHE_NOCACHE_LIMIT                16  /* strings up to the this length are not cached */
 
+/* Opcode statistics table sizes (DUK_USE_OPCODE_STATS). */
+#define DUK_HEAP_OPCODE_STATS_NUM_OPS                     (DUK_BC_OP_MAX + 1)
+#define DUK_HEAP_OPCODE_STATS_NUM_EXTRAOPS                (DUK_BC_EXTRAOP_MAX + 1)
+
+/* Opcode statistics counter; 32-bit counters would wrap within seconds
+ * for hot opcodes, so use 64-bit integers or doubles if not available.
+ */
+#if defined(DUK_USE_OPCODE_STATS)
+#if defined(DUK_USE_64BIT_OPS)
+typedef duk_uint64_t duk_opcode_count;
+#else
+typedef duk_double_t duk_opcode_count;
+#endif
+#endif
+
 /* helper to insert a (non-string) heap object into heap allocated list */
 #define DUK_HEAP_INSERT_INTO_HEAP_ALLOCATED(heap,hdr)     duk_heap_insert_into_heap_allocated((heap),(hdr))
 
@@ -284,6 +302,22 @@ struct duk_strcache {
 	duk_uint32_t cidx;
 };
 
+/*
+ *  Compile cache entry: a compiled eval() or Function constructor template
+ *  keyed by its source, filename and compile flags.  Unlike the string
+ *  cache, the references are 'strong': they are counted in reference counts
+ *  and marked as roots by mark-and-sweep.  An unused entry has NULL source.
+ */
+
+#if defined(DUK_USE_COMPILE_CACHE)
+struct duk_compcache {
+	duk_hstring *h_source;
+	duk_hstring *h_filename;
+	duk_hcompiledfunction *h_func;
+	duk_small_int_t flags;     /* DUK_JS_COMPILE_FLAG_xxx */
+};
+#endif
+
 /*
  *  Longjmp state, contains the information needed to perform a longjmp.
  *  Longjmp related values are written to value1, value2, and iserror.
@@ -361,6 +395,11 @@ struct duk_heap {
 	/* heap level temporary log formatting buffer */
 	duk_hbuffer_dynamic *log_buffer;
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* root of the property shape transition tree (empty shape) */
+	duk_hshape *shape_root;
+#endif
+
 	/* duk_handle_call / duk_handle_safe_call recursion depth limiting */
 	int call_recursion_depth;
 	int call_recursion_limit;
@@ -377,6 +416,35 @@ struct duk_heap {
 	duk_int_t interrupt_counter;  /* countdown state (mirrored in current thread state) */
 #endif
 
+	/* sampling profiler interval in bytecode instructions, 0 = not running,
+	 * and instructions remaining until the next sample (interrupts are also
+	 * triggered for other reasons); samples are kept in an internal property
+	 * of heap_object
+	 */
+#if defined(DUK_USE_PROFILER)
+	duk_int_t prof_interval;
+	duk_int_t prof_remaining;
+#endif
+
+	/* execution budget of the innermost duk_pcall_budget(): remaining
+	 * bytecode instructions (< 0 = unlimited) and a deadline in
+	 * duk_bi_date_get_now() time (0.0 = none)
+	 */
+#if defined(DUK_USE_EXEC_BUDGET)
+	duk_int_t budget_steps;
+	duk_double_t budget_deadline;
+#endif
+
+	/* executed opcode counters, indexed by opcode / extraop; opcode pair
+	 * counters are indexed by [previous opcode][opcode]
+	 */
+#if defined(DUK_USE_OPCODE_STATS)
+	duk_opcode_count opcode_counts[DUK_HEAP_OPCODE_STATS_NUM_OPS];
+	duk_opcode_count extraop_counts[DUK_HEAP_OPCODE_STATS_NUM_EXTRAOPS];
+	duk_opcode_count opcode_pair_counts[DUK_HEAP_OPCODE_STATS_NUM_OPS][DUK_HEAP_OPCODE_STATS_NUM_OPS];
+	duk_small_uint_t opcode_prev;
+#endif
+
 	/* string intern table (weak refs) */
 	duk_hstring **st;
 	duk_uint32_t st_size;     /* alloc size in elements */
@@ -387,6 +455,16 @@ struct duk_heap {
 	 */
 	duk_strcache strcache[DUK_HEAP_STRCACHE_SIZE];
 
+	/* compiled eval() and Function constructor code, most recently used
+	 * entry first; 'strong' references
+	 */
+#if defined(DUK_USE_COMPILE_CACHE)
+	duk_compcache compcache[DUK_USE_COMPILE_CACHE_SIZE];
+	duk_uint32_t compcache_hits;
+	duk_uint32_t compcache_misses;
+	duk_uint32_t compcache_evictions;
+#endif
+
 	/* built-in strings */
 	duk_hstring *strs[DUK_HEAP_NUM_STRINGS];
 };
@@ -399,7 +477,10 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
                          duk_realloc_function realloc_func,
                          duk_free_function free_func,
                          void *alloc_udata,
-                         duk_fatal_function fatal_func);
+                         duk_fatal_function fatal_func,
+                         const void *snapshot,
+                         duk_size_t snapshot_size,
+                         const duk_c_function *natives);
 void duk_heap_free(duk_heap *heap);
 void duk_heap_free_heaphdr_raw(duk_heap *heap, duk_heaphdr *hdr);
 
@@ -409,6 +490,7 @@ void duk_heap_remove_any_from_heap_allocated(duk_heap *heap, duk_heaphdr *hdr);
 #endif
 #ifdef DUK_USE_INTERRUPT_COUNTER
 void duk_heap_switch_thread(duk_heap *heap, duk_hthread *new_thr);
+void duk_heap_interrupt_sync(duk_heap *heap);
 #endif
 
 duk_hstring *duk_heap_string_lookup(duk_heap *heap, duk_uint8_t *str, duk_uint32_t blen);
@@ -425,6 +507,12 @@ void duk_heap_force_stringtable_resize(duk_heap *heap);
 void duk_heap_strcache_string_remove(duk_heap *heap, duk_hstring *h);
 duk_uint32_t duk_heap_strcache_offset_char2byte(duk_hthread *thr, duk_hstring *h, duk_uint32_t char_offset);
 
+#if defined(DUK_USE_COMPILE_CACHE)
+duk_hcompiledfunction *duk_heap_compcache_lookup(duk_heap *heap, duk_hstring *h_source, duk_hstring *h_filename, duk_small_int_t flags);
+void duk_heap_compcache_insert(duk_hthread *thr, duk_hstring *h_source, duk_hstring *h_filename, duk_small_int_t flags, duk_hcompiledfunction *h_func);
+void duk_heap_compcache_clear(duk_hthread *thr);
+#endif
+
 #ifdef DUK_USE_PROVIDE_DEFAULT_ALLOC_FUNCTIONS
 void *duk_default_alloc_function(void *udata, size_t size);
 void *duk_default_realloc_function(void *udata, void *ptr, size_t newsize);
@@ -465,5 +553,8 @@ int duk_heap_mark_and_sweep(duk_heap *heap, int flags);
 
 duk_uint32_t duk_heap_hashstring(duk_heap *heap, duk_uint8_t *str, duk_size_t len);
 
+void duk_heap_snapshot_write(duk_hthread *thr, const duk_c_function *natives);
+int duk_heap_snapshot_restore(duk_heap *heap, const duk_uint8_t *p, duk_size_t len, const duk_c_function *natives);
+
 #endif  /* DUK_HEAP_H_INCLUDED */
 
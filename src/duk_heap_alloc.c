@@ -26,11 +26,22 @@ static void duk__free_hobject_inner(duk_heap *heap, duk_hobject *h) {
 	DUK_ASSERT(h != NULL);
 
 	DUK_FREE(heap, h->p);
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* NULL if already released by refcount finalization */
+	if (h->shape != NULL) {
+		duk_hshape_free_raw(heap, h->shape);
+	}
+#endif
 
 	if (DUK_HOBJECT_IS_COMPILEDFUNCTION(h)) {
 		duk_hcompiledfunction *f = (duk_hcompiledfunction *) h;
 		DUK_UNREF(f);
-		/* Currently nothing to free; 'data' is a heap object */
+		/* 'data' is a heap object */
+#if defined(DUK_USE_JIT)
+		if (f->jit != NULL) {
+			duk_js_jit_release(heap, f->jit);
+		}
+#endif
 	} else if (DUK_HOBJECT_IS_NATIVEFUNCTION(h)) {
 		duk_hnativefunction *f = (duk_hnativefunction *) h;
 		DUK_UNREF(f);
@@ -220,16 +231,22 @@ void duk_heap_free(duk_heap *heap) {
 	 * etc.
 	 *
 	 * FIXME: this perhaps requires an execution time limit.
+	 *
+	 * If heap init failed (e.g. a heap snapshot was rejected half way),
+	 * built-in strings and objects needed for finalizer lookups may be
+	 * missing and there's nothing to finalize anyway.
 	 */
-	DUK_D(DUK_DPRINT("execute finalizers before freeing heap"));
+	if (!DUK_HEAP_HAS_INIT_FAILED(heap)) {
+		DUK_D(DUK_DPRINT("execute finalizers before freeing heap"));
 #ifdef DUK_USE_MARK_AND_SWEEP
-	/* run mark-and-sweep a few times just in case (unreachable
-	 * object finalizers run already here)
-	 */
-	duk_heap_mark_and_sweep(heap, 0);
-	duk_heap_mark_and_sweep(heap, 0);
+		/* run mark-and-sweep a few times just in case (unreachable
+		 * object finalizers run already here)
+		 */
+		duk_heap_mark_and_sweep(heap, 0);
+		duk_heap_mark_and_sweep(heap, 0);
 #endif
-	duk__free_run_finalizers(heap);
+		duk__free_run_finalizers(heap);
+	}
 
 	/* Note: heap->heap_thread, heap->curr_thread, heap->heap_object,
 	 * and heap->log_buffer are on the heap allocated list.
@@ -248,6 +265,16 @@ void duk_heap_free(duk_heap *heap) {
 	duk__free_markandsweep_finalize_list(heap);
 #endif
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* all objects are freed, so this frees the whole shape tree */
+	if (heap->shape_root) {
+		DUK_D(DUK_DPRINT("freeing root shape of heap: %p", heap));
+		DUK_ASSERT(heap->shape_root->refcount == 1);
+		DUK_ASSERT(heap->shape_root->child == NULL);
+		duk_hshape_free_raw(heap, heap->shape_root);
+	}
+#endif
+
 	DUK_D(DUK_DPRINT("freeing string table of heap: %p", heap));
 	duk__free_stringtable(heap);
 
@@ -262,6 +289,24 @@ void duk_heap_free(duk_heap *heap) {
  */
 
 /* intern built-in strings from precooked data (genstrings.py) */
+#if defined(DUK_USE_ROM_STRINGS)
+static int duk__init_heap_strings(duk_heap *heap) {
+	int i;
+
+	/* Built-in strings are shared read-only data: nothing to intern,
+	 * and the flags and hashes were computed by genbuiltins.py.
+	 */
+	for (i = 0; i < DUK_HEAP_NUM_STRINGS; i++) {
+		duk_hstring *h = (duk_hstring *) duk_rom_strings[i];
+
+		DUK_ASSERT(DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h));
+		DUK_ASSERT(DUK_HSTRING_GET_HASH(h) == duk_heap_hashstring(heap, DUK_HSTRING_GET_DATA(h), DUK_HSTRING_GET_BYTELEN(h)));
+		heap->strs[i] = h;
+	}
+
+	return 1;
+}
+#else  /* DUK_USE_ROM_STRINGS */
 static int duk__init_heap_strings(duk_heap *heap) {
 	duk_bitdecoder_ctx bd_ctx;
 	duk_bitdecoder_ctx *bd = &bd_ctx;  /* convenience */
@@ -342,6 +387,7 @@ static int duk__init_heap_strings(duk_heap *heap) {
  error:
 	return 0;
 }
+#endif  /* DUK_USE_ROM_STRINGS */
 
 static int duk__init_heap_thread(duk_heap *heap) {
 	duk_hthread *thr;
@@ -367,13 +413,17 @@ static int duk__init_heap_thread(duk_heap *heap) {
 		return 0;
 	}
 
+	return 1;
+}
+
+static void duk__init_heap_builtins(duk_heap *heap) {
+	duk_hthread *thr = heap->heap_thread;
+
 	/* FIXME: this may now fail, and is not handled correctly */
 	duk_hthread_create_builtin_objects(thr);
 
 	/* default prototype (Note: 'thr' must be reachable) */
 	DUK_HOBJECT_SET_PROTOTYPE_UPDREF(thr, (duk_hobject *) thr, thr->builtins[DUK_BIDX_THREAD_PROTOTYPE]);
-
-	return 1;
 }
 
 #ifdef DUK_USE_DEBUG
@@ -451,6 +501,9 @@ static void duk__dump_type_sizes(void) {
 	DUK__DUMPSZ(duk_activation);
 	DUK__DUMPSZ(duk_catcher);
 	DUK__DUMPSZ(duk_strcache);
+#if defined(DUK_USE_COMPILE_CACHE)
+	DUK__DUMPSZ(duk_compcache);
+#endif
 	DUK__DUMPSZ(duk_ljstate);
 	DUK__DUMPSZ(duk_fixedbuffer);
 	DUK__DUMPSZ(duk_bitdecoder_ctx);
@@ -472,7 +525,10 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
                          duk_realloc_function realloc_func,
                          duk_free_function free_func,
                          void *alloc_udata,
-                         duk_fatal_function fatal_func) {
+                         duk_fatal_function fatal_func,
+                         const void *snapshot,
+                         duk_size_t snapshot_size,
+                         const duk_c_function *natives) {
 	duk_heap *res = NULL;
 
 	DUK_D(DUK_DPRINT("allocate heap"));
@@ -538,6 +594,9 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	res->curr_thread = NULL;
 	res->heap_object = NULL;
 	res->log_buffer = NULL;
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	res->shape_root = NULL;
+#endif
 	res->st = NULL;
 	{
 		int i;
@@ -565,7 +624,12 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	 *
 	 *   warning: cast from pointer to integer of different size [-Wpointer-to-int-cast]
 	 */
+#if defined(DUK_USE_ROM_STRINGS)
+	/* ROM string hashes are computed at build time with a fixed seed */
+	res->hash_seed = (duk_uint32_t) DUK_ROM_STRINGS_HASH_SEED;
+#else
 	res->hash_seed = (duk_uint32_t) (duk_intptr_t) res;
+#endif
 	res->rnd_state = (duk_uint32_t) (duk_intptr_t) res;
 
 #ifdef DUK_USE_INTERRUPT_COUNTER
@@ -573,6 +637,10 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	DUK_ASSERT(res->interrupt_counter == 0);
 	DUK_ASSERT(res->interrupt_init == 0);
 #endif
+#if defined(DUK_USE_EXEC_BUDGET)
+	res->budget_steps = -1;
+	res->budget_deadline = 0.0;
+#endif
 
 #ifdef DUK_USE_EXPLICIT_NULL_INIT
 	res->lj.jmpbuf_ptr = NULL;
@@ -612,33 +680,70 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	}
 #endif
 
+	/* compcache init */
+#if defined(DUK_USE_COMPILE_CACHE) && defined(DUK_USE_EXPLICIT_NULL_INIT)
+	{
+		int i;
+		for (i = 0; i < DUK_USE_COMPILE_CACHE_SIZE; i++) {
+			res->compcache[i].h_source = NULL;
+			res->compcache[i].h_filename = NULL;
+			res->compcache[i].h_func = NULL;
+		}
+	}
+#endif
+
 	/* FIXME: error handling is incomplete.  It would be cleanest if
 	 * there was a setjmp catchpoint, so that all init code could
 	 * freely throw errors.  If that were the case, the return code
 	 * passing here could be removed.
 	 */
 
-	/* built-in strings */
-	DUK_DD(DUK_DDPRINT("HEAP: INIT STRINGS"));
-	if (!duk__init_heap_strings(res)) {
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* root shape, must exist before any objects are created */
+	DUK_DD(DUK_DDPRINT("HEAP: INIT ROOT SHAPE"));
+	res->shape_root = duk_hshape_alloc(res, 0, 0, 0);
+	if (!res->shape_root) {
 		goto error;
 	}
+#endif
 
-	/* heap thread */
-	DUK_DD(DUK_DDPRINT("HEAP: INIT HEAP THREAD"));
-	if (!duk__init_heap_thread(res)) {
-		goto error;
-	}
+	if (snapshot != NULL) {
+		/* Built-in strings, built-in objects, the heap object and the
+		 * heap thread's properties all come from the snapshot.
+		 */
+		DUK_DD(DUK_DDPRINT("HEAP: INIT HEAP THREAD"));
+		if (!duk__init_heap_thread(res)) {
+			goto error;
+		}
 
-	/* heap object */
-	DUK_DD(DUK_DDPRINT("HEAP: INIT HEAP OBJECT"));
-	DUK_ASSERT(res->heap_thread != NULL);
-	res->heap_object = duk_hobject_alloc(res, DUK_HOBJECT_FLAG_EXTENSIBLE |
-	                                          DUK_HOBJECT_CLASS_AS_FLAGS(DUK_HOBJECT_CLASS_OBJECT));
-	if (!res->heap_object) {
-		goto error;
+		DUK_DD(DUK_DDPRINT("HEAP: RESTORE SNAPSHOT"));
+		if (!duk_heap_snapshot_restore(res, (const duk_uint8_t *) snapshot, snapshot_size, natives)) {
+			goto error;
+		}
+	} else {
+		/* built-in strings */
+		DUK_DD(DUK_DDPRINT("HEAP: INIT STRINGS"));
+		if (!duk__init_heap_strings(res)) {
+			goto error;
+		}
+
+		/* heap thread */
+		DUK_DD(DUK_DDPRINT("HEAP: INIT HEAP THREAD"));
+		if (!duk__init_heap_thread(res)) {
+			goto error;
+		}
+		duk__init_heap_builtins(res);
+
+		/* heap object */
+		DUK_DD(DUK_DDPRINT("HEAP: INIT HEAP OBJECT"));
+		DUK_ASSERT(res->heap_thread != NULL);
+		res->heap_object = duk_hobject_alloc(res, DUK_HOBJECT_FLAG_EXTENSIBLE |
+		                                          DUK_HOBJECT_CLASS_AS_FLAGS(DUK_HOBJECT_CLASS_OBJECT));
+		if (!res->heap_object) {
+			goto error;
+		}
+		DUK_HOBJECT_INCREF(res->heap_thread, res->heap_object);
 	}
-	DUK_HOBJECT_INCREF(res->heap_thread, res->heap_object);
 
 	/* log buffer */
 	DUK_DD(DUK_DDPRINT("HEAP: INIT LOG BUFFER"));
@@ -663,6 +768,7 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 		DUK_ASSERT(res->alloc_func != NULL);
 		DUK_ASSERT(res->realloc_func != NULL);
 		DUK_ASSERT(res->free_func != NULL);
+		DUK_HEAP_SET_INIT_FAILED(res);
 		duk_heap_free(res);
 	}
 	return NULL;
@@ -0,0 +1,161 @@
+/*
+ *  Compile cache.
+ *
+ *  Caches compiled function templates of eval() and Function constructor
+ *  code so that recurring source strings are only compiled once; a cache
+ *  hit only needs a new closure.  Entries are keyed by the source and
+ *  filename strings and the compile flags.  Because strings are interned,
+ *  string keys can be compared by pointer.
+ *
+ *  The cache is a small fixed size array in LRU order (most recently used
+ *  entry first), maintained like the string cache.  Unlike string cache
+ *  references, compile cache references are 'strong': the entries keep
+ *  their strings and templates reachable.  When an entry is replaced its
+ *  references are decreased only after the cache has been updated, because
+ *  a decref may run finalizers which may in turn use the cache.
+ */
+
+#include "duk_internal.h"
+
+#if defined(DUK_USE_COMPILE_CACHE)
+
+/*
+ *  Find a cached template and move its entry first.  Returns NULL (and
+ *  counts a miss) if there is no matching entry.
+ */
+
+duk_hcompiledfunction *duk_heap_compcache_lookup(duk_heap *heap, duk_hstring *h_source, duk_hstring *h_filename, duk_small_int_t flags) {
+	duk_compcache *cce;
+	duk_compcache tmp;
+	int i;
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(h_source != NULL);
+
+	for (i = 0; i < DUK_USE_COMPILE_CACHE_SIZE; i++) {
+		cce = &heap->compcache[i];
+		if (cce->h_source == h_source &&
+		    cce->h_filename == h_filename &&
+		    cce->flags == flags) {
+			goto found;
+		}
+	}
+
+	DUK_DDD(DUK_DDDPRINT("compcache miss: source=%p, flags=0x%08x",
+	                     (void *) h_source, (int) flags));
+	heap->compcache_misses++;
+	return NULL;
+
+ found:
+	DUK_DDD(DUK_DDDPRINT("compcache hit: source=%p, flags=0x%08x, entry %d -> func=%p",
+	                     (void *) h_source, (int) flags, i, (void *) cce->h_func));
+	heap->compcache_hits++;
+
+	/* LRU: move our entry to first */
+	if (cce > &heap->compcache[0]) {
+		tmp = *cce;
+		DUK_MEMMOVE((void *) (&heap->compcache[1]),
+		            (void *) (&heap->compcache[0]),
+		            (size_t) (((char *) cce) - ((char *) &heap->compcache[0])));
+		heap->compcache[0] = tmp;
+	}
+
+	DUK_ASSERT(heap->compcache[0].h_func != NULL);
+	return heap->compcache[0].h_func;
+}
+
+/*
+ *  Insert a compiled template as the most recently used entry, evicting
+ *  the least recently used entry if the cache is full.
+ */
+
+void duk_heap_compcache_insert(duk_hthread *thr, duk_hstring *h_source, duk_hstring *h_filename, duk_small_int_t flags, duk_hcompiledfunction *h_func) {
+	duk_heap *heap;
+	duk_compcache *cce;
+	duk_compcache old;
+	int i;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(h_source != NULL);
+	DUK_ASSERT(h_func != NULL);
+	heap = thr->heap;
+
+	/* Compilation may run finalizers (through mark-and-sweep), and
+	 * they may have compiled and inserted the same code already.
+	 */
+	for (i = 0; i < DUK_USE_COMPILE_CACHE_SIZE; i++) {
+		cce = &heap->compcache[i];
+		if (cce->h_source == h_source &&
+		    cce->h_filename == h_filename &&
+		    cce->flags == flags) {
+			DUK_DDD(DUK_DDDPRINT("compcache insert: already cached, keep existing entry"));
+			return;
+		}
+	}
+
+	/* take last entry */
+	old = heap->compcache[DUK_USE_COMPILE_CACHE_SIZE - 1];
+	if (old.h_source != NULL) {
+		DUK_DDD(DUK_DDDPRINT("compcache insert: evict source=%p, func=%p",
+		                     (void *) old.h_source, (void *) old.h_func));
+		heap->compcache_evictions++;
+	}
+
+	DUK_MEMMOVE((void *) (&heap->compcache[1]),
+	            (void *) (&heap->compcache[0]),
+	            sizeof(duk_compcache) * (DUK_USE_COMPILE_CACHE_SIZE - 1));
+	cce = &heap->compcache[0];
+	cce->h_source = h_source;
+	cce->h_filename = h_filename;
+	cce->h_func = h_func;
+	cce->flags = flags;
+	DUK_HSTRING_INCREF(thr, h_source);
+	if (h_filename) {
+		DUK_HSTRING_INCREF(thr, h_filename);
+	}
+	DUK_HCOMPILEDFUNCTION_INCREF(thr, h_func);
+
+	DUK_DDD(DUK_DDDPRINT("compcache insert: source=%p, flags=0x%08x -> func=%p",
+	                     (void *) h_source, (int) flags, (void *) h_func));
+
+	/* Cache is consistent, decref may now have side effects. */
+	if (old.h_source != NULL) {
+		DUK_HSTRING_DECREF(thr, old.h_source);
+		if (old.h_filename) {
+			DUK_HSTRING_DECREF(thr, old.h_filename);
+		}
+		DUK_HCOMPILEDFUNCTION_DECREF(thr, old.h_func);
+	}
+}
+
+/*
+ *  Drop all entries.
+ */
+
+void duk_heap_compcache_clear(duk_hthread *thr) {
+	duk_heap *heap;
+	duk_compcache old;
+	int i;
+
+	DUK_ASSERT(thr != NULL);
+	heap = thr->heap;
+
+	for (i = 0; i < DUK_USE_COMPILE_CACHE_SIZE; i++) {
+		old = heap->compcache[i];
+		if (old.h_source == NULL) {
+			continue;
+		}
+		heap->compcache[i].h_source = NULL;
+		heap->compcache[i].h_filename = NULL;
+		heap->compcache[i].h_func = NULL;
+		heap->compcache[i].flags = 0;
+
+		DUK_HSTRING_DECREF(thr, old.h_source);
+		if (old.h_filename) {
+			DUK_HSTRING_DECREF(thr, old.h_filename);
+		}
+		DUK_HCOMPILEDFUNCTION_DECREF(thr, old.h_func);
+	}
+}
+
+#endif  /* DUK_USE_COMPILE_CACHE */
@@ -139,6 +139,13 @@ static void duk__mark_heaphdr(duk_heap *heap, duk_heaphdr *h) {
 	if (!h) {
 		return;
 	}
+#if defined(DUK_USE_ROM_STRINGS)
+	if (DUK_HEAPHDR_HAS_READONLY(h)) {
+		/* ROM objects are never swept and only refer to other ROM objects */
+		DUK_DDD(DUK_DDDPRINT("read-only object, skip"));
+		return;
+	}
+#endif
 
 	if (DUK_HEAPHDR_HAS_REACHABLE(h)) {
 		DUK_DDD(DUK_DDDPRINT("already marked reachable, skip"));
@@ -202,6 +209,15 @@ static void duk__mark_roots_heap(duk_heap *heap) {
 		duk__mark_heaphdr(heap, (duk_heaphdr *) h);
 	}
 
+#if defined(DUK_USE_COMPILE_CACHE)
+	for (i = 0; i < DUK_USE_COMPILE_CACHE_SIZE; i++) {
+		duk_compcache *cce = &heap->compcache[i];
+		duk__mark_heaphdr(heap, (duk_heaphdr *) cce->h_source);
+		duk__mark_heaphdr(heap, (duk_heaphdr *) cce->h_filename);
+		duk__mark_heaphdr(heap, (duk_heaphdr *) cce->h_func);
+	}
+#endif
+
 	duk__mark_tval(heap, &heap->lj.value1);
 	duk__mark_tval(heap, &heap->lj.value2);
 }
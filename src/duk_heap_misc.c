@@ -50,4 +50,43 @@ void duk_heap_switch_thread(duk_heap *heap, duk_hthread *new_thr) {
 	}
 	heap->curr_thread = new_thr;  /* may be NULL */
 }
+
+/* End the current interrupt window early: charge the instructions executed
+ * so far in the window to the execution budget and the profiler interval,
+ * and zero the counters so that the next instruction triggers an interrupt
+ * which schedules the next window against the current settings.  Used when
+ * a budget or the profiler is started or stopped.
+ */
+void duk_heap_interrupt_sync(duk_heap *heap) {
+	duk_int_t ctr;
+	duk_int_t executed;
+
+	/* The instruction being executed (e.g. the CALL which led here) has
+	 * already been counted, so after k instructions of an interrupt
+	 * window the counter is 'init - k'.
+	 */
+	ctr = (heap->curr_thread != NULL ? heap->curr_thread->interrupt_counter : heap->interrupt_counter);
+	executed = heap->interrupt_init - ctr;
+	if (executed > 0) {
+#if defined(DUK_USE_EXEC_BUDGET)
+		if (heap->budget_steps >= 0) {
+			heap->budget_steps -= executed;
+			if (heap->budget_steps < 0) {
+				heap->budget_steps = 0;
+			}
+		}
+#endif
+#if defined(DUK_USE_PROFILER)
+		if (heap->prof_interval > 0) {
+			heap->prof_remaining -= executed;
+		}
+#endif
+	}
+
+	heap->interrupt_init = 0;
+	heap->interrupt_counter = 0;
+	if (heap->curr_thread != NULL) {
+		heap->curr_thread->interrupt_counter = 0;
+	}
+}
 #endif  /* DUK_USE_INTERRUPT_COUNTER */
@@ -64,7 +64,9 @@ static void duk__refcount_finalize_hobject(duk_hthread *thr, duk_hobject *h) {
 		if (!key) {
 			continue;
 		}
+#if !defined(DUK_USE_HOBJECT_SHAPES)
 		duk_heap_heaphdr_decref(thr, (duk_heaphdr *) key);
+#endif
 		if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(h, i)) {
 			duk_heap_heaphdr_decref(thr, (duk_heaphdr *) DUK_HOBJECT_E_GET_VALUE_GETTER(h, i));
 			duk_heap_heaphdr_decref(thr, (duk_heaphdr *) DUK_HOBJECT_E_GET_VALUE_SETTER(h, i));
@@ -79,6 +81,16 @@ static void duk__refcount_finalize_hobject(duk_hthread *thr, duk_hobject *h) {
 
 	/* hash part is a 'weak reference' and does not contribute */
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* Keys are owned by the shape.  The object is about to be freed
+	 * so it is left without a shape (and without entries).
+	 */
+	duk_hshape_decref(thr, h->shape);
+	h->shape = NULL;
+	h->e_used = 0;
+	h->h_size = 0;
+#endif
+
 	duk_heap_heaphdr_decref(thr, (duk_heaphdr *) h->prototype);
 
 	if (DUK_HOBJECT_IS_COMPILEDFUNCTION(h)) {
@@ -336,6 +348,11 @@ void duk_heap_tval_incref(duk_tval *tv) {
 		if (h) {
 			DUK_ASSERT(DUK_HEAPHDR_HTYPE_VALID(h));
 			DUK_ASSERT_DISABLE(h->h_refcount >= 0);
+#if defined(DUK_USE_ROM_STRINGS)
+			if (DUK_HEAPHDR_HAS_READONLY(h)) {
+				return;
+			}
+#endif
 			h->h_refcount++;
 		}
 	}
@@ -373,6 +390,12 @@ void duk_heap_heaphdr_incref(duk_heaphdr *h) {
 	}
 	DUK_ASSERT(DUK_HEAPHDR_HTYPE_VALID(h));
 	DUK_ASSERT_DISABLE(h->h_refcount >= 0);
+#if defined(DUK_USE_ROM_STRINGS)
+	if (DUK_HEAPHDR_HAS_READONLY(h)) {
+		/* ROM objects are never freed, their refcount is not tracked */
+		return;
+	}
+#endif
 
 	h->h_refcount++;
 }
@@ -396,6 +419,11 @@ void duk_heap_heaphdr_decref(duk_hthread *thr, duk_heaphdr *h) {
 	}
 	DUK_ASSERT(DUK_HEAPHDR_HTYPE_VALID(h));
 	DUK_ASSERT(h->h_refcount >= 1);
+#if defined(DUK_USE_ROM_STRINGS)
+	if (DUK_HEAPHDR_HAS_READONLY(h)) {
+		return;
+	}
+#endif
 
 	if (--h->h_refcount != 0) {
 		return;
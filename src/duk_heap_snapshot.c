@@ -0,0 +1,1346 @@
+/*
+ *  Heap snapshots
+ *
+ *  A snapshot is a serialized copy of the object graph reachable from the
+ *  heap roots: the built-in strings, the heap object (stashes), the heap
+ *  thread and its built-in objects.  Creating a heap from a snapshot skips
+ *  built-in string and object initialization (and any init code run after
+ *  it) and recreates the graph directly, which is much cheaper than a normal
+ *  heap init when the embedding has set up a lot of state.
+ *
+ *  The snapshot is logical and relocatable: references between heap
+ *  elements are item indices, strings are re-interned and property tables,
+ *  shapes and inline caches are rebuilt when restoring.  Native functions
+ *  are stored as indices into the built-in native function table and an
+ *  optional NULL terminated table of user functions given by the caller
+ *  (the same table must be given when restoring).
+ *
+ *  Snapshot format, all integers in big endian byte order:
+ *
+ *    header:
+ *      u8   DUK__SNAP_MARKER (0xff)
+ *      u8   DUK__SNAP_FORMAT_VERSION
+ *      u32  DUK_VERSION
+ *      u32  DUK_HEAP_NUM_STRINGS
+ *      u32  DUK_NUM_BUILTINS
+ *      u32  DUK_NUM_BI_NATIVE_FUNCTIONS
+ *      u32  number of items
+ *
+ *    items (count times), each item may only refer to earlier items:
+ *      u8   DUK__SNAP_ITEM_STRING, u32 byte length, bytes, u32 string flags
+ *      u8   DUK__SNAP_ITEM_BUFFER, u8 dynamic, u32 byte length, bytes
+ *      u8   DUK__SNAP_ITEM_FUNCDATA, u32 n_const, u32 n_func, u32 n_instr,
+ *           <value> (n_const times, string or number), u32 compiled
+ *           function item (n_func times), u32 instruction (n_instr times);
+ *           n_instr is zero for a lazily compiled function template
+ *      u8   DUK__SNAP_ITEM_OBJECT, u32 object flags
+ *      u8   DUK__SNAP_ITEM_COMPFUNC, u32 object flags, u32 function data
+ *           item, u16 nregs, u16 nargs
+ *      u8   DUK__SNAP_ITEM_NATFUNC, u32 object flags, u32 native function
+ *           reference, u16 nargs, u16 magic
+ *      u8   DUK__SNAP_ITEM_THREAD, u32 object flags (the heap thread)
+ *      u8   DUK__SNAP_ITEM_ROMOBJ, u32 index into duk_rom_objects
+ *
+ *    roots:
+ *      u32  heap object item
+ *      u32  built-in string item (DUK_HEAP_NUM_STRINGS times)
+ *      u32  built-in object item or DUK__SNAP_NONE (DUK_NUM_BUILTINS times)
+ *
+ *    properties, for every object item except ROM objects in item order:
+ *      u32  exotic behavior flags (DUK__SNAP_EXOTIC_FLAGS)
+ *      u32  prototype item or DUK__SNAP_NONE
+ *      u32  number of entry part properties
+ *      u32  array part size
+ *      entry part properties (count times):
+ *        u32  key item
+ *        u8   property flags
+ *        <value>, or u32 getter item + u32 setter item for accessors
+ *      array part values (count times): <value>
+ *
+ *    value:
+ *      u8   DUK__SNAP_TAG_xxx, followed by u32 high + u32 low (IEEE double)
+ *           for numbers, u32 item for strings/objects/buffers, and u32
+ *           native function reference + u16 flags for lightfuncs
+ *
+ *  Object exotic behavior flags are applied only after the properties have
+ *  been defined so that plain internal property definitions can be used.
+ *
+ *  Limitations: only the heap thread may be reachable (other threads have
+ *  native state which can't be serialized), pointer values other than NULL
+ *  are rejected, and value stack contents are not part of the snapshot.
+ *  ROM strings are re-interned like any other string (which finds the ROM
+ *  copy) while ROM objects are referenced by index and never serialized.
+ *  Like bytecode dumps, snapshots are only accepted by the exact Duktape
+ *  build which created them, and the bytecode in them is NOT validated:
+ *  only snapshots from trusted sources may be restored.
+ */
+
+#include "duk_internal.h"
+
+#define DUK__SNAP_MARKER              0xffU
+#define DUK__SNAP_FORMAT_VERSION      0x01U
+
+#define DUK__SNAP_NONE                0xffffffffUL
+
+#define DUK__SNAP_ITEM_STRING         0x00U
+#define DUK__SNAP_ITEM_BUFFER         0x01U
+#define DUK__SNAP_ITEM_FUNCDATA       0x02U
+#define DUK__SNAP_ITEM_OBJECT         0x03U
+#define DUK__SNAP_ITEM_COMPFUNC       0x04U
+#define DUK__SNAP_ITEM_NATFUNC        0x05U
+#define DUK__SNAP_ITEM_THREAD         0x06U
+#define DUK__SNAP_ITEM_ROMOBJ         0x07U
+
+#define DUK__SNAP_ITEM_IS_OBJECT(kind)  ((kind) >= DUK__SNAP_ITEM_OBJECT)
+
+#define DUK__SNAP_TAG_UNDEFINED       0x00U
+#define DUK__SNAP_TAG_UNUSED          0x01U
+#define DUK__SNAP_TAG_NULL            0x02U
+#define DUK__SNAP_TAG_TRUE            0x03U
+#define DUK__SNAP_TAG_FALSE           0x04U
+#define DUK__SNAP_TAG_NUMBER          0x05U
+#define DUK__SNAP_TAG_STRING          0x06U
+#define DUK__SNAP_TAG_OBJECT          0x07U
+#define DUK__SNAP_TAG_BUFFER          0x08U
+#define DUK__SNAP_TAG_NULLPTR         0x09U
+#define DUK__SNAP_TAG_LIGHTFUNC       0x0aU
+
+/* Heap header flags other than the type and the mark-and-sweep flags. */
+#define DUK__SNAP_USER_FLAGS_MASK \
+	(~((duk_uint32_t) ((1UL << DUK_HEAPHDR_FLAGS_USER_START) - 1UL)))
+
+/* String flags which are not recomputed when the string is interned. */
+#define DUK__SNAP_STRING_FLAGS \
+	(DUK_HSTRING_FLAG_INTERNAL | \
+	 DUK_HSTRING_FLAG_RESERVED_WORD | \
+	 DUK_HSTRING_FLAG_STRICT_RESERVED_WORD | \
+	 DUK_HSTRING_FLAG_EVAL_OR_ARGUMENTS)
+
+#define DUK__SNAP_KIND_FLAGS \
+	(DUK_HOBJECT_FLAG_COMPILEDFUNCTION | \
+	 DUK_HOBJECT_FLAG_NATIVEFUNCTION | \
+	 DUK_HOBJECT_FLAG_THREAD)
+
+#define DUK__SNAP_EXOTIC_FLAGS \
+	(DUK_HOBJECT_FLAG_EXOTIC_ARRAY | \
+	 DUK_HOBJECT_FLAG_EXOTIC_STRINGOBJ | \
+	 DUK_HOBJECT_FLAG_EXOTIC_ARGUMENTS | \
+	 DUK_HOBJECT_FLAG_EXOTIC_DUKFUNC | \
+	 DUK_HOBJECT_FLAG_EXOTIC_BUFFEROBJ | \
+	 DUK_HOBJECT_FLAG_EXOTIC_PROXYOBJ)
+
+/*
+ *  Snapshot
+ */
+
+typedef struct {
+	duk_hthread *thr;
+	const duk_c_function *natives;
+	duk_hbuffer_dynamic *h_out;     /* snapshot being written */
+	duk_hbuffer_dynamic *h_items;   /* duk_heaphdr pointer for every item */
+	duk_hbuffer_dynamic *h_map;     /* open addressing hash, pointer -> item index + 1 (0 = empty) */
+	duk_uint32_t n_items;
+	duk_uint32_t map_size;          /* power of two */
+} duk__snap_writer;
+
+static void duk__snap_write_u8(duk__snap_writer *wr, duk_uint8_t val) {
+	duk_hbuffer_append_byte(wr->thr, wr->h_out, val);
+}
+
+static void duk__snap_write_u16(duk__snap_writer *wr, duk_uint16_t val) {
+	duk_uint8_t tmp[2];
+
+	tmp[0] = (duk_uint8_t) (val >> 8);
+	tmp[1] = (duk_uint8_t) val;
+	duk_hbuffer_append_bytes(wr->thr, wr->h_out, tmp, sizeof(tmp));
+}
+
+static void duk__snap_write_u32(duk__snap_writer *wr, duk_uint32_t val) {
+	duk_uint8_t tmp[4];
+
+	tmp[0] = (duk_uint8_t) (val >> 24);
+	tmp[1] = (duk_uint8_t) (val >> 16);
+	tmp[2] = (duk_uint8_t) (val >> 8);
+	tmp[3] = (duk_uint8_t) val;
+	duk_hbuffer_append_bytes(wr->thr, wr->h_out, tmp, sizeof(tmp));
+}
+
+static duk_heaphdr **duk__snap_get_items(duk__snap_writer *wr) {
+	return (duk_heaphdr **) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(wr->h_items);
+}
+
+static duk_uint32_t duk__snap_hash_ptr(duk_heaphdr *h) {
+	/* Low bits of heap pointers are mostly zero, mix the high bits in. */
+	duk_uint32_t t = (duk_uint32_t) ((duk_uintptr_t) h >> 3) * 2654435761UL;
+	return t ^ (t >> 15);
+}
+
+/* Item index of 'h', or DUK__SNAP_NONE if 'h' has no item yet. */
+static duk_uint32_t duk__snap_lookup(duk__snap_writer *wr, duk_heaphdr *h) {
+	duk_heaphdr **items = duk__snap_get_items(wr);
+	duk_uint32_t *map = (duk_uint32_t *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(wr->h_map);
+	duk_uint32_t mask = wr->map_size - 1;
+	duk_uint32_t i = duk__snap_hash_ptr(h) & mask;
+
+	for (;;) {
+		duk_uint32_t t = map[i];
+		if (t == 0) {
+			return DUK__SNAP_NONE;
+		}
+		if (items[t - 1] == h) {
+			return t - 1;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+static void duk__snap_map_insert(duk__snap_writer *wr, duk_heaphdr *h, duk_uint32_t idx) {
+	duk_uint32_t *map = (duk_uint32_t *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(wr->h_map);
+	duk_uint32_t mask = wr->map_size - 1;
+	duk_uint32_t i = duk__snap_hash_ptr(h) & mask;
+
+	while (map[i] != 0) {
+		i = (i + 1) & mask;
+	}
+	map[i] = idx + 1;
+}
+
+/* Add 'h' as the next item and write its item kind. */
+static duk_uint32_t duk__snap_add_item(duk__snap_writer *wr, duk_heaphdr *h, duk_uint8_t kind) {
+	duk_uint32_t idx = wr->n_items;
+
+	DUK_ASSERT(duk__snap_lookup(wr, h) == DUK__SNAP_NONE);
+
+	if (idx >= DUK__SNAP_NONE - 1) {
+		DUK_ERROR(wr->thr, DUK_ERR_RANGE_ERROR, "snapshot too large");
+	}
+
+	duk_hbuffer_append_bytes(wr->thr, wr->h_items, (duk_uint8_t *) &h, sizeof(h));
+	wr->n_items++;
+
+	/* keep the load factor below 50% */
+	if (wr->n_items * 2 > wr->map_size) {
+		duk_uint32_t i;
+
+		wr->map_size *= 2;
+		duk_hbuffer_resize(wr->thr, wr->h_map,
+		                   (size_t) wr->map_size * sizeof(duk_uint32_t),
+		                   (size_t) wr->map_size * sizeof(duk_uint32_t));
+		DUK_MEMZERO(DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(wr->h_map), (size_t) wr->map_size * sizeof(duk_uint32_t));
+		for (i = 0; i < wr->n_items; i++) {
+			duk__snap_map_insert(wr, duk__snap_get_items(wr)[i], i);
+		}
+	} else {
+		duk__snap_map_insert(wr, h, idx);
+	}
+
+	duk__snap_write_u8(wr, kind);
+	return idx;
+}
+
+static duk_uint32_t duk__snap_native_ref(duk__snap_writer *wr, duk_c_function func) {
+	duk_uint32_t i;
+
+	for (i = 0; i < DUK_NUM_BI_NATIVE_FUNCTIONS; i++) {
+		if (duk_bi_native_functions[i] == func) {
+			return i;
+		}
+	}
+	if (wr->natives) {
+		for (i = 0; wr->natives[i] != NULL; i++) {
+			if (wr->natives[i] == func) {
+				return DUK_NUM_BI_NATIVE_FUNCTIONS + i;
+			}
+		}
+	}
+	DUK_ERROR(wr->thr, DUK_ERR_TYPE_ERROR, "cannot snapshot unregistered native function");
+	return 0;  /* not reachable */
+}
+
+static duk_uint32_t duk__snap_visit(duk__snap_writer *wr, duk_heaphdr *h);
+
+static void duk__snap_visit_tval(duk__snap_writer *wr, duk_tval *tv) {
+	if (DUK_TVAL_IS_HEAP_ALLOCATED(tv)) {
+		(void) duk__snap_visit(wr, DUK_TVAL_GET_HEAPHDR(tv));
+	}
+}
+
+static void duk__snap_write_number(duk__snap_writer *wr, duk_double_t d) {
+	duk_double_union du;
+
+	du.d = d;
+	duk__snap_write_u32(wr, du.ui[DUK_DBL_IDX_UI0]);
+	duk__snap_write_u32(wr, du.ui[DUK_DBL_IDX_UI1]);
+}
+
+static void duk__snap_write_ref(duk__snap_writer *wr, duk_heaphdr *h) {
+	duk_uint32_t idx;
+
+	if (h == NULL) {
+		duk__snap_write_u32(wr, DUK__SNAP_NONE);
+		return;
+	}
+	idx = duk__snap_lookup(wr, h);
+	DUK_ASSERT(idx != DUK__SNAP_NONE);
+	duk__snap_write_u32(wr, idx);
+}
+
+/* The referenced heap element must already have an item. */
+static void duk__snap_write_tval(duk__snap_writer *wr, duk_tval *tv) {
+	switch (DUK_TVAL_GET_TAG(tv)) {
+	case DUK_TAG_UNDEFINED:
+		duk__snap_write_u8(wr, DUK_TVAL_IS_UNDEFINED_UNUSED(tv) ? DUK__SNAP_TAG_UNUSED : DUK__SNAP_TAG_UNDEFINED);
+		break;
+	case DUK_TAG_NULL:
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_NULL);
+		break;
+	case DUK_TAG_BOOLEAN:
+		duk__snap_write_u8(wr, DUK_TVAL_GET_BOOLEAN(tv) ? DUK__SNAP_TAG_TRUE : DUK__SNAP_TAG_FALSE);
+		break;
+	case DUK_TAG_STRING:
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_STRING);
+		duk__snap_write_ref(wr, DUK_TVAL_GET_HEAPHDR(tv));
+		break;
+	case DUK_TAG_OBJECT:
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_OBJECT);
+		duk__snap_write_ref(wr, DUK_TVAL_GET_HEAPHDR(tv));
+		break;
+	case DUK_TAG_BUFFER:
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_BUFFER);
+		duk__snap_write_ref(wr, DUK_TVAL_GET_HEAPHDR(tv));
+		break;
+	case DUK_TAG_POINTER:
+		if (DUK_TVAL_GET_POINTER(tv) != NULL) {
+			DUK_ERROR(wr->thr, DUK_ERR_TYPE_ERROR, "cannot snapshot pointer value");
+		}
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_NULLPTR);
+		break;
+	case DUK_TAG_LIGHTFUNC:
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_LIGHTFUNC);
+		duk__snap_write_u32(wr, duk__snap_native_ref(wr, DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv)));
+		duk__snap_write_u16(wr, (duk_uint16_t) DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv));
+		break;
+	default:
+		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
+		duk__snap_write_u8(wr, DUK__SNAP_TAG_NUMBER);
+		duk__snap_write_number(wr, DUK_TVAL_GET_NUMBER(tv));
+		break;
+	}
+}
+
+/* Function data is written before any closure referring to it; its
+ * constants and inner function templates are written before it.
+ */
+static duk_uint32_t duk__snap_visit_funcdata(duk__snap_writer *wr, duk_hcompiledfunction *f) {
+	duk_hbuffer *h_data = f->data;
+	duk_uint32_t idx;
+	duk_tval *tv;
+	duk_hobject **funcs;
+	duk_instr *p_instr;
+	duk_uint32_t n_const, n_func, n_instr;
+	duk_uint32_t i;
+
+	DUK_ASSERT(h_data != NULL);
+
+	idx = duk__snap_lookup(wr, (duk_heaphdr *) h_data);
+	if (idx != DUK__SNAP_NONE) {
+		return idx;
+	}
+
+	n_const = (duk_uint32_t) DUK_HCOMPILEDFUNCTION_GET_CONSTS_COUNT(f);
+	n_func = (duk_uint32_t) DUK_HCOMPILEDFUNCTION_GET_FUNCS_COUNT(f);
+	n_instr = (duk_uint32_t) DUK_HCOMPILEDFUNCTION_GET_CODE_COUNT(f);
+
+	/* The data buffer is stable, so pointers into it remain valid. */
+	tv = DUK_HCOMPILEDFUNCTION_GET_CONSTS_BASE(f);
+	for (i = 0; i < n_const; i++) {
+		duk__snap_visit_tval(wr, tv + i);
+	}
+	funcs = DUK_HCOMPILEDFUNCTION_GET_FUNCS_BASE(f);
+	for (i = 0; i < n_func; i++) {
+		(void) duk__snap_visit(wr, (duk_heaphdr *) funcs[i]);
+	}
+
+	idx = duk__snap_add_item(wr, (duk_heaphdr *) h_data, DUK__SNAP_ITEM_FUNCDATA);
+	duk__snap_write_u32(wr, n_const);
+	duk__snap_write_u32(wr, n_func);
+	duk__snap_write_u32(wr, n_instr);
+	for (i = 0; i < n_const; i++) {
+		duk__snap_write_tval(wr, tv + i);
+	}
+	for (i = 0; i < n_func; i++) {
+		duk__snap_write_ref(wr, (duk_heaphdr *) funcs[i]);
+	}
+	p_instr = DUK_HCOMPILEDFUNCTION_GET_CODE_BASE(f);
+	for (i = 0; i < n_instr; i++) {
+		duk__snap_write_u32(wr, (duk_uint32_t) p_instr[i]);
+	}
+
+	return idx;
+}
+
+/* Get or create the item for 'h'.  Only references needed to create the
+ * item are followed here; properties are followed by the scan loop in
+ * duk__snapshot_raw().
+ */
+static duk_uint32_t duk__snap_visit(duk__snap_writer *wr, duk_heaphdr *h) {
+	duk_uint32_t idx;
+
+	DUK_ASSERT(h != NULL);
+
+	idx = duk__snap_lookup(wr, h);
+	if (idx != DUK__SNAP_NONE) {
+		return idx;
+	}
+
+	switch (DUK_HEAPHDR_GET_TYPE(h)) {
+	case DUK_HTYPE_STRING: {
+		duk_hstring *h_str = (duk_hstring *) h;
+
+		idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_STRING);
+		duk__snap_write_u32(wr, (duk_uint32_t) DUK_HSTRING_GET_BYTELEN(h_str));
+		duk_hbuffer_append_bytes(wr->thr, wr->h_out, DUK_HSTRING_GET_DATA(h_str), DUK_HSTRING_GET_BYTELEN(h_str));
+		duk__snap_write_u32(wr, (duk_uint32_t) (DUK_HEAPHDR_GET_FLAGS(h) & DUK__SNAP_STRING_FLAGS));
+		break;
+	}
+	case DUK_HTYPE_BUFFER: {
+		duk_hbuffer *h_buf = (duk_hbuffer *) h;
+
+		idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_BUFFER);
+		duk__snap_write_u8(wr, DUK_HBUFFER_HAS_DYNAMIC(h_buf) ? 1 : 0);
+		duk__snap_write_u32(wr, (duk_uint32_t) DUK_HBUFFER_GET_SIZE(h_buf));
+		duk_hbuffer_append_bytes(wr->thr, wr->h_out, (duk_uint8_t *) DUK_HBUFFER_GET_DATA_PTR(h_buf), DUK_HBUFFER_GET_SIZE(h_buf));
+		break;
+	}
+	default: {
+		duk_hobject *h_obj = (duk_hobject *) h;
+		duk_uint32_t flags = (duk_uint32_t) (DUK_HEAPHDR_GET_FLAGS(h) & DUK__SNAP_USER_FLAGS_MASK);
+
+		DUK_ASSERT(DUK_HEAPHDR_GET_TYPE(h) == DUK_HTYPE_OBJECT);
+
+#if defined(DUK_USE_ROM_OBJECTS)
+		if (DUK_HEAPHDR_HAS_READONLY(h)) {
+			duk_uint32_t i;
+
+			for (i = 0; i < DUK_NUM_ROM_OBJECTS; i++) {
+				if ((const duk_hobject *) h_obj == duk_rom_objects[i]) {
+					break;
+				}
+			}
+			DUK_ASSERT(i < DUK_NUM_ROM_OBJECTS);
+			idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_ROMOBJ);
+			duk__snap_write_u32(wr, i);
+			break;
+		}
+#endif
+
+		if (DUK_HOBJECT_IS_COMPILEDFUNCTION(h_obj)) {
+			duk_hcompiledfunction *f = (duk_hcompiledfunction *) h_obj;
+			duk_uint32_t idx_data;
+
+			idx_data = duk__snap_visit_funcdata(wr, f);
+			idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_COMPFUNC);
+			duk__snap_write_u32(wr, flags);
+			duk__snap_write_u32(wr, idx_data);
+			duk__snap_write_u16(wr, f->nregs);
+			duk__snap_write_u16(wr, f->nargs);
+		} else if (DUK_HOBJECT_IS_NATIVEFUNCTION(h_obj)) {
+			duk_hnativefunction *f = (duk_hnativefunction *) h_obj;
+			duk_uint32_t ref;
+
+			ref = duk__snap_native_ref(wr, f->func);
+			idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_NATFUNC);
+			duk__snap_write_u32(wr, flags);
+			duk__snap_write_u32(wr, ref);
+			duk__snap_write_u16(wr, (duk_uint16_t) f->nargs);
+			duk__snap_write_u16(wr, (duk_uint16_t) f->magic);
+		} else if (DUK_HOBJECT_IS_THREAD(h_obj)) {
+			if ((duk_hthread *) h_obj != wr->thr->heap->heap_thread) {
+				DUK_ERROR(wr->thr, DUK_ERR_TYPE_ERROR, "cannot snapshot thread");
+			}
+			idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_THREAD);
+			duk__snap_write_u32(wr, flags);
+		} else {
+			idx = duk__snap_add_item(wr, h, DUK__SNAP_ITEM_OBJECT);
+			duk__snap_write_u32(wr, flags);
+		}
+		break;
+	}
+	}
+
+	return idx;
+}
+
+static void duk__snap_scan_object(duk__snap_writer *wr, duk_hobject *h) {
+	duk_uint32_t i;
+
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h)) {
+		/* ROM objects only refer to other ROM objects and strings. */
+		return;
+	}
+
+	if (h->prototype) {
+		(void) duk__snap_visit(wr, (duk_heaphdr *) h->prototype);
+	}
+
+	/* Objects can't be resized by side effects here: finalizers and
+	 * object compaction are disabled while snapshotting.
+	 */
+	for (i = 0; i < h->e_used; i++) {
+		duk_hstring *key = DUK_HOBJECT_E_GET_KEY(h, i);
+		if (!key) {
+			continue;
+		}
+		(void) duk__snap_visit(wr, (duk_heaphdr *) key);
+		if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(h, i)) {
+			duk_hobject *getter = DUK_HOBJECT_E_GET_VALUE_GETTER(h, i);
+			duk_hobject *setter = DUK_HOBJECT_E_GET_VALUE_SETTER(h, i);
+			if (getter) {
+				(void) duk__snap_visit(wr, (duk_heaphdr *) getter);
+			}
+			if (setter) {
+				(void) duk__snap_visit(wr, (duk_heaphdr *) setter);
+			}
+		} else {
+			duk__snap_visit_tval(wr, DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(h, i));
+		}
+	}
+
+	for (i = 0; i < h->a_size; i++) {
+		duk__snap_visit_tval(wr, DUK_HOBJECT_A_GET_VALUE_PTR(h, i));
+	}
+
+	if (DUK_HOBJECT_IS_THREAD(h)) {
+		duk_hthread *t = (duk_hthread *) h;
+		for (i = 0; i < DUK_NUM_BUILTINS; i++) {
+			if (t->builtins[i]) {
+				(void) duk__snap_visit(wr, (duk_heaphdr *) t->builtins[i]);
+			}
+		}
+	}
+}
+
+static void duk__snap_write_props(duk__snap_writer *wr, duk_hobject *h) {
+	duk_uint32_t i;
+	duk_uint32_t count;
+
+	duk__snap_write_u32(wr, (duk_uint32_t) (DUK_HEAPHDR_GET_FLAGS(&h->hdr) & DUK__SNAP_EXOTIC_FLAGS));
+	duk__snap_write_ref(wr, (duk_heaphdr *) h->prototype);
+
+	count = 0;
+	for (i = 0; i < h->e_used; i++) {
+		if (DUK_HOBJECT_E_GET_KEY(h, i)) {
+			count++;
+		}
+	}
+	duk__snap_write_u32(wr, count);
+	duk__snap_write_u32(wr, h->a_size);
+
+	for (i = 0; i < h->e_used; i++) {
+		duk_hstring *key = DUK_HOBJECT_E_GET_KEY(h, i);
+		if (!key) {
+			continue;
+		}
+		duk__snap_write_ref(wr, (duk_heaphdr *) key);
+		duk__snap_write_u8(wr, (duk_uint8_t) DUK_HOBJECT_E_GET_FLAGS(h, i));
+		if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(h, i)) {
+			duk__snap_write_ref(wr, (duk_heaphdr *) DUK_HOBJECT_E_GET_VALUE_GETTER(h, i));
+			duk__snap_write_ref(wr, (duk_heaphdr *) DUK_HOBJECT_E_GET_VALUE_SETTER(h, i));
+		} else {
+			duk__snap_write_tval(wr, DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(h, i));
+		}
+	}
+
+	for (i = 0; i < h->a_size; i++) {
+		duk__snap_write_tval(wr, DUK_HOBJECT_A_GET_VALUE_PTR(h, i));
+	}
+}
+
+static int duk__snapshot_raw(duk_context *ctx) {
+	duk_hthread *thr = (duk_hthread *) ctx;
+	duk_heap *heap = thr->heap;
+	duk__snap_writer wr;
+	duk_uint32_t i;
+	duk_uint8_t *p;
+	size_t off_count;
+
+	/* [ natives ] */
+
+	wr.thr = thr;
+	wr.natives = (const duk_c_function *) duk_get_pointer(ctx, 0);
+	wr.n_items = 0;
+	wr.map_size = 256;
+
+	duk_push_dynamic_buffer(ctx, 0);
+	wr.h_out = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, -1);
+	duk_push_dynamic_buffer(ctx, 0);
+	wr.h_items = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, -1);
+	duk_push_dynamic_buffer(ctx, (duk_size_t) wr.map_size * sizeof(duk_uint32_t));
+	wr.h_map = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, -1);
+	DUK_ASSERT(wr.h_out != NULL && wr.h_items != NULL && wr.h_map != NULL);
+	DUK_MEMZERO(DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(wr.h_map), (size_t) wr.map_size * sizeof(duk_uint32_t));
+
+	/* [ natives out items map ] */
+
+	duk__snap_write_u8(&wr, DUK__SNAP_MARKER);
+	duk__snap_write_u8(&wr, DUK__SNAP_FORMAT_VERSION);
+	duk__snap_write_u32(&wr, (duk_uint32_t) DUK_VERSION);
+	duk__snap_write_u32(&wr, (duk_uint32_t) DUK_HEAP_NUM_STRINGS);
+	duk__snap_write_u32(&wr, (duk_uint32_t) DUK_NUM_BUILTINS);
+	duk__snap_write_u32(&wr, (duk_uint32_t) DUK_NUM_BI_NATIVE_FUNCTIONS);
+	off_count = DUK_HBUFFER_GET_SIZE(wr.h_out);
+	duk__snap_write_u32(&wr, 0);  /* item count, patched below */
+
+	/*
+	 *  Items: roots first, then everything reachable from them.
+	 */
+
+	for (i = 0; i < DUK_HEAP_NUM_STRINGS; i++) {
+		(void) duk__snap_visit(&wr, (duk_heaphdr *) heap->strs[i]);
+	}
+	(void) duk__snap_visit(&wr, (duk_heaphdr *) heap->heap_thread);
+	(void) duk__snap_visit(&wr, (duk_heaphdr *) heap->heap_object);
+
+	for (i = 0; i < wr.n_items; i++) {
+		duk_heaphdr *h = duk__snap_get_items(&wr)[i];
+		if (DUK_HEAPHDR_GET_TYPE(h) == DUK_HTYPE_OBJECT) {
+			duk__snap_scan_object(&wr, (duk_hobject *) h);
+		}
+	}
+
+	DUK_DD(DUK_DDPRINT("heap snapshot: %ld items", (long) wr.n_items));
+
+	p = (duk_uint8_t *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(wr.h_out) + off_count;
+	p[0] = (duk_uint8_t) (wr.n_items >> 24);
+	p[1] = (duk_uint8_t) (wr.n_items >> 16);
+	p[2] = (duk_uint8_t) (wr.n_items >> 8);
+	p[3] = (duk_uint8_t) wr.n_items;
+
+	/*
+	 *  Roots and properties.
+	 */
+
+	duk__snap_write_ref(&wr, (duk_heaphdr *) heap->heap_object);
+	for (i = 0; i < DUK_HEAP_NUM_STRINGS; i++) {
+		duk__snap_write_ref(&wr, (duk_heaphdr *) heap->strs[i]);
+	}
+	for (i = 0; i < DUK_NUM_BUILTINS; i++) {
+		duk__snap_write_ref(&wr, (duk_heaphdr *) heap->heap_thread->builtins[i]);
+	}
+
+	for (i = 0; i < wr.n_items; i++) {
+		duk_heaphdr *h = duk__snap_get_items(&wr)[i];
+		if (DUK_HEAPHDR_GET_TYPE(h) == DUK_HTYPE_OBJECT && !DUK_HEAPHDR_HAS_READONLY(h)) {
+			duk__snap_write_props(&wr, (duk_hobject *) h);
+		}
+	}
+
+	duk_pop_2(ctx);
+	(void) duk_to_fixed_buffer(ctx, -1, NULL);
+
+	/* [ natives snapshot ] */
+
+	return 1;
+}
+
+void duk_heap_snapshot_write(duk_hthread *thr, const duk_c_function *natives) {
+	duk_context *ctx = (duk_context *) thr;
+	duk_heap *heap;
+#ifdef DUK_USE_MARK_AND_SWEEP
+	int saved_ms_base_flags;
+#endif
+	int rc;
+
+	DUK_ASSERT(thr != NULL);
+	heap = thr->heap;
+	DUK_ASSERT(heap != NULL);
+
+	/* With calls in progress, the graph would include activation state
+	 * (e.g. open environment records) which can't be restored.  Other
+	 * threads are rejected when they're encountered.
+	 */
+	if (heap->heap_thread->callstack_top != 0) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "cannot snapshot a running heap");
+	}
+
+	/* Objects must not be compacted or finalized while the snapshot is
+	 * being written, see duk_hshape_alloc() for the same pattern.
+	 */
+#ifdef DUK_USE_MARK_AND_SWEEP
+	saved_ms_base_flags = heap->mark_and_sweep_base_flags;
+	heap->mark_and_sweep_base_flags |= DUK_MS_FLAG_NO_FINALIZERS |
+	                                   DUK_MS_FLAG_NO_OBJECT_COMPACTION;
+#endif
+
+	duk_push_pointer(ctx, (void *) natives);
+	rc = duk_safe_call(ctx, duk__snapshot_raw, 1 /*nargs*/, 1 /*nrets*/);
+
+#ifdef DUK_USE_MARK_AND_SWEEP
+	heap->mark_and_sweep_base_flags = saved_ms_base_flags;
+#endif
+
+	if (rc != DUK_EXEC_SUCCESS) {
+		duk_throw(ctx);
+	}
+
+	/* [ ... snapshot ] */
+}
+
+/*
+ *  Restore
+ *
+ *  There's no catchpoint during heap init, so malformed input is reported
+ *  with an error flag and a zero return value.  Allocation failures are
+ *  handled like for a normal heap init.
+ *
+ *  Items are kept reachable in the heap thread value stack: item i is at
+ *  index i + 1, index 0 has the per-item metadata.
+ */
+
+typedef struct {
+	duk_uint8_t kind;
+	duk_uint32_t n_const;   /* function data only */
+	duk_uint32_t n_func;
+} duk__snap_meta;
+
+typedef struct {
+	duk_hthread *thr;
+	const duk_uint8_t *p;
+	const duk_uint8_t *p_end;
+	const duk_c_function *natives;
+	duk_uint32_t n_natives;
+	duk__snap_meta *meta;
+	duk_uint32_t n_items;   /* items created so far */
+	int error;
+} duk__snap_reader;
+
+static const duk_uint8_t *duk__snap_read_bytes(duk__snap_reader *rd, size_t len) {
+	const duk_uint8_t *p = rd->p;
+
+	if ((size_t) (rd->p_end - p) < len) {
+		rd->error = 1;
+		rd->p = rd->p_end;
+		return NULL;
+	}
+	rd->p = p + len;
+	return p;
+}
+
+static duk_uint8_t duk__snap_read_u8(duk__snap_reader *rd) {
+	const duk_uint8_t *p = duk__snap_read_bytes(rd, 1);
+
+	return (p ? p[0] : 0);
+}
+
+static duk_uint16_t duk__snap_read_u16(duk__snap_reader *rd) {
+	const duk_uint8_t *p = duk__snap_read_bytes(rd, 2);
+
+	if (!p) {
+		return 0;
+	}
+	return (duk_uint16_t) (((duk_uint16_t) p[0] << 8) | (duk_uint16_t) p[1]);
+}
+
+static duk_uint32_t duk__snap_read_u32(duk__snap_reader *rd) {
+	const duk_uint8_t *p = duk__snap_read_bytes(rd, 4);
+
+	if (!p) {
+		return 0;
+	}
+	return ((duk_uint32_t) p[0] << 24) |
+	       ((duk_uint32_t) p[1] << 16) |
+	       ((duk_uint32_t) p[2] << 8) |
+	       (duk_uint32_t) p[3];
+}
+
+/* Read an item reference, checking that it refers to an existing item
+ * of the expected kind; DUK__SNAP_NONE is returned as is if allowed.
+ */
+static duk_uint32_t duk__snap_read_ref(duk__snap_reader *rd, int want_object, duk_uint8_t want_kind, int allow_none) {
+	duk_uint32_t idx = duk__snap_read_u32(rd);
+	duk_uint8_t kind;
+
+	if (idx == DUK__SNAP_NONE && allow_none) {
+		return idx;
+	}
+	if (idx >= rd->n_items) {
+		rd->error = 1;
+		return DUK__SNAP_NONE;
+	}
+	kind = rd->meta[idx].kind;
+	if (want_object ? !DUK__SNAP_ITEM_IS_OBJECT(kind) : (kind != want_kind)) {
+		rd->error = 1;
+		return DUK__SNAP_NONE;
+	}
+	return idx;
+}
+
+static duk_c_function duk__snap_read_native(duk__snap_reader *rd) {
+	duk_uint32_t ref = duk__snap_read_u32(rd);
+
+	if (ref < DUK_NUM_BI_NATIVE_FUNCTIONS) {
+		return duk_bi_native_functions[ref];
+	}
+	ref -= DUK_NUM_BI_NATIVE_FUNCTIONS;
+	if (ref < rd->n_natives) {
+		return rd->natives[ref];
+	}
+	rd->error = 1;
+	return NULL;
+}
+
+/* Read a value into 'tv' without touching its refcount. */
+static void duk__snap_read_tval(duk__snap_reader *rd, duk_tval *tv) {
+	duk_context *ctx = (duk_context *) rd->thr;
+	duk_uint32_t idx;
+
+	DUK_TVAL_SET_UNDEFINED_ACTUAL(tv);
+
+	switch (duk__snap_read_u8(rd)) {
+	case DUK__SNAP_TAG_UNDEFINED:
+		break;
+	case DUK__SNAP_TAG_UNUSED:
+		DUK_TVAL_SET_UNDEFINED_UNUSED(tv);
+		break;
+	case DUK__SNAP_TAG_NULL:
+		DUK_TVAL_SET_NULL(tv);
+		break;
+	case DUK__SNAP_TAG_TRUE:
+		DUK_TVAL_SET_BOOLEAN(tv, 1);
+		break;
+	case DUK__SNAP_TAG_FALSE:
+		DUK_TVAL_SET_BOOLEAN(tv, 0);
+		break;
+	case DUK__SNAP_TAG_NUMBER: {
+		duk_double_union du;
+		du.ui[DUK_DBL_IDX_UI0] = duk__snap_read_u32(rd);
+		du.ui[DUK_DBL_IDX_UI1] = duk__snap_read_u32(rd);
+		DUK_TVAL_SET_NUMBER_CHKFAST(tv, du.d);
+		break;
+	}
+	case DUK__SNAP_TAG_STRING:
+		idx = duk__snap_read_ref(rd, 0, DUK__SNAP_ITEM_STRING, 0);
+		if (!rd->error) {
+			DUK_TVAL_SET_TVAL(tv, duk_get_tval(ctx, (duk_idx_t) idx + 1));
+		}
+		break;
+	case DUK__SNAP_TAG_OBJECT:
+		idx = duk__snap_read_ref(rd, 1, 0, 0);
+		if (!rd->error) {
+			DUK_TVAL_SET_TVAL(tv, duk_get_tval(ctx, (duk_idx_t) idx + 1));
+		}
+		break;
+	case DUK__SNAP_TAG_BUFFER:
+		idx = duk__snap_read_ref(rd, 0, DUK__SNAP_ITEM_BUFFER, 0);
+		if (!rd->error) {
+			DUK_TVAL_SET_TVAL(tv, duk_get_tval(ctx, (duk_idx_t) idx + 1));
+		}
+		break;
+	case DUK__SNAP_TAG_NULLPTR:
+		DUK_TVAL_SET_POINTER(tv, NULL);
+		break;
+	case DUK__SNAP_TAG_LIGHTFUNC: {
+		duk_c_function func = duk__snap_read_native(rd);
+		duk_small_uint_t lf_flags = (duk_small_uint_t) duk__snap_read_u16(rd);
+		if (!rd->error) {
+			DUK_TVAL_SET_LIGHTFUNC(tv, func, lf_flags);
+		}
+		break;
+	}
+	default:
+		rd->error = 1;
+		break;
+	}
+}
+
+static duk_hobject *duk__snap_get_item_hobject(duk__snap_reader *rd, duk_uint32_t idx) {
+	if (idx == DUK__SNAP_NONE) {
+		return NULL;
+	}
+	return duk_get_hobject((duk_context *) rd->thr, (duk_idx_t) idx + 1);
+}
+
+/* Read the object flags of an object item and check them against the
+ * item kind.  Exotic behavior flags are applied later.
+ */
+static duk_uint32_t duk__snap_read_object_flags(duk__snap_reader *rd, duk_uint32_t kind_flag) {
+	duk_uint32_t flags = duk__snap_read_u32(rd);
+
+	if ((flags & ~DUK__SNAP_USER_FLAGS_MASK) != 0 ||
+	    (flags & DUK__SNAP_KIND_FLAGS) != kind_flag) {
+		rd->error = 1;
+	}
+	return flags & ~DUK__SNAP_EXOTIC_FLAGS;
+}
+
+/* Function data without bytecode is only valid for a lazily compiled
+ * function template, see DUK_HCOMPILEDFUNCTION_IS_LAZY().
+ */
+static int duk__snap_lazy_funcdata_counts(duk_uint32_t n_const, duk_uint32_t n_func) {
+#if defined(DUK_USE_LAZY_COMPILE)
+	return (n_const == DUK_HCOMPILEDFUNCTION_LAZY_CONST_COUNT && n_func == 0);
+#else
+	DUK_UNREF(n_const);
+	DUK_UNREF(n_func);
+	return 0;
+#endif
+}
+
+static void duk__snap_read_funcdata(duk__snap_reader *rd) {
+	duk_context *ctx = (duk_context *) rd->thr;
+	duk__snap_meta *meta = rd->meta + rd->n_items;
+	duk_uint32_t n_const, n_func, n_instr;
+	duk_uint32_t i;
+	duk_tval *p_const;
+	duk_hobject **p_func;
+	duk_instr *p_instr;
+	size_t data_size;
+
+	n_const = duk__snap_read_u32(rd);
+	n_func = duk__snap_read_u32(rd);
+	n_instr = duk__snap_read_u32(rd);
+	if (rd->error ||
+	    (n_instr == 0 && !duk__snap_lazy_funcdata_counts(n_const, n_func)) ||
+	    n_instr > DUK_COMPILER_MAX_BYTECODE_LENGTH ||
+	    n_const > DUK_BC_BC_MAX + 1 ||
+	    n_func > DUK_BC_BC_MAX + 1) {
+		rd->error = 1;
+		return;
+	}
+
+	/* Same layout as created by duk__convert_to_func_template().  The
+	 * constants and inner functions are not INCREF'd here: each closure
+	 * referring to the data INCREFs them.
+	 */
+	data_size = (size_t) n_const * sizeof(duk_tval) +
+	            (size_t) n_func * sizeof(duk_hobject *) +
+	            (size_t) n_instr * DUK_HCOMPILEDFUNCTION_CODE_ENTRY_SIZE;
+	p_const = (duk_tval *) duk_push_fixed_buffer(ctx, data_size);
+
+	for (i = 0; i < n_const && !rd->error; i++) {
+		duk__snap_read_tval(rd, p_const + i);
+		if (!DUK_TVAL_IS_NUMBER(p_const + i) && !DUK_TVAL_IS_STRING(p_const + i)) {
+			rd->error = 1;
+		}
+	}
+#if defined(DUK_USE_LAZY_COMPILE)
+	if (n_instr == 0 && !rd->error &&
+	    (!DUK_TVAL_IS_STRING(p_const + DUK_HCOMPILEDFUNCTION_LAZY_CONST_SOURCE) ||
+	     !DUK_TVAL_IS_STRING(p_const + DUK_HCOMPILEDFUNCTION_LAZY_CONST_PREPARSE))) {
+		rd->error = 1;
+	}
+#endif
+
+	p_func = (duk_hobject **) (p_const + n_const);
+	for (i = 0; i < n_func && !rd->error; i++) {
+		duk_uint32_t idx = duk__snap_read_ref(rd, 0, DUK__SNAP_ITEM_COMPFUNC, 0);
+		p_func[i] = duk__snap_get_item_hobject(rd, idx);
+	}
+
+	p_instr = (duk_instr *) (p_func + n_func);
+	for (i = 0; i < n_instr && !rd->error; i++) {
+		p_instr[i] = (duk_instr) duk__snap_read_u32(rd);
+	}
+
+#if defined(DUK_USE_PROPERTY_IC)
+	/* inline caches start out empty */
+	DUK_MEMSET((void *) (p_instr + n_instr),
+	           0xff,
+	           (size_t) n_instr * DUK_HCOMPILEDFUNCTION_IC_WAYS * sizeof(duk_uint16_t));
+#endif
+
+	meta->n_const = n_const;
+	meta->n_func = n_func;
+}
+
+static void duk__snap_read_compfunc(duk__snap_reader *rd) {
+	duk_context *ctx = (duk_context *) rd->thr;
+	duk_heap *heap = rd->thr->heap;
+	duk_hcompiledfunction *res;
+	duk_hbuffer *h_data;
+	duk__snap_meta *meta;
+	duk_tval *tv;
+	duk_hobject **funcs;
+	duk_uint32_t flags;
+	duk_uint32_t idx_data;
+	duk_uint16_t nregs, nargs;
+	duk_uint32_t i;
+
+	flags = duk__snap_read_object_flags(rd, DUK_HOBJECT_FLAG_COMPILEDFUNCTION);
+	idx_data = duk__snap_read_ref(rd, 0, DUK__SNAP_ITEM_FUNCDATA, 0);
+	nregs = duk__snap_read_u16(rd);
+	nargs = duk__snap_read_u16(rd);
+	if (rd->error) {
+		return;
+	}
+
+	h_data = duk_get_hbuffer(ctx, (duk_idx_t) idx_data + 1);
+	meta = rd->meta + idx_data;
+	DUK_ASSERT(h_data != NULL);
+
+	/* Compiled functions must be created atomically: the data pointers
+	 * are set before anything may trigger a GC.
+	 */
+	res = duk_hcompiledfunction_alloc(heap, (int) flags);
+	if (!res) {
+		rd->error = 1;
+		return;
+	}
+	res->data = h_data;
+	res->funcs = (duk_hobject **) (DUK_HCOMPILEDFUNCTION_GET_CONSTS_BASE(res) + meta->n_const);
+	res->bytecode = (duk_instr *) (res->funcs + meta->n_func);
+	res->nregs = nregs;
+	res->nargs = nargs;
+
+	duk_push_hobject(ctx, (duk_hobject *) res);
+	DUK_HBUFFER_INCREF(rd->thr, h_data);
+
+	tv = DUK_HCOMPILEDFUNCTION_GET_CONSTS_BASE(res);
+	for (i = 0; i < meta->n_const; i++) {
+		DUK_TVAL_INCREF(rd->thr, tv + i);
+	}
+	funcs = DUK_HCOMPILEDFUNCTION_GET_FUNCS_BASE(res);
+	for (i = 0; i < meta->n_func; i++) {
+		DUK_HOBJECT_INCREF(rd->thr, funcs[i]);
+	}
+}
+
+static void duk__snap_read_item(duk__snap_reader *rd) {
+	duk_context *ctx = (duk_context *) rd->thr;
+	duk_heap *heap = rd->thr->heap;
+	duk_uint8_t kind;
+	duk_uint32_t flags;
+
+	kind = duk__snap_read_u8(rd);
+	rd->meta[rd->n_items].kind = kind;
+
+	switch (kind) {
+	case DUK__SNAP_ITEM_STRING: {
+		duk_uint32_t len = duk__snap_read_u32(rd);
+		const duk_uint8_t *p = duk__snap_read_bytes(rd, (size_t) len);
+		duk_hstring *h;
+
+		flags = duk__snap_read_u32(rd);
+		if (rd->error || (flags & ~DUK__SNAP_STRING_FLAGS) != 0) {
+			rd->error = 1;
+			return;
+		}
+		h = duk_heap_string_intern(heap, (duk_uint8_t *) p, len);
+		if (!h) {
+			rd->error = 1;
+			return;
+		}
+		if (!DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h)) {
+			DUK_HEAPHDR_SET_FLAG_BITS(&h->hdr, flags);
+		}
+		duk_push_hstring(ctx, h);
+		break;
+	}
+	case DUK__SNAP_ITEM_BUFFER: {
+		duk_uint8_t dynamic = duk__snap_read_u8(rd);
+		duk_uint32_t len = duk__snap_read_u32(rd);
+		const duk_uint8_t *p = duk__snap_read_bytes(rd, (size_t) len);
+		void *buf;
+
+		if (rd->error) {
+			return;
+		}
+		buf = duk_push_buffer(ctx, (duk_size_t) len, (int) dynamic);
+		if (len > 0) {
+			DUK_MEMCPY(buf, (const void *) p, (size_t) len);
+		}
+		break;
+	}
+	case DUK__SNAP_ITEM_FUNCDATA:
+		duk__snap_read_funcdata(rd);
+		break;
+	case DUK__SNAP_ITEM_OBJECT: {
+		duk_hobject *res;
+
+		flags = duk__snap_read_object_flags(rd, 0);
+		if (rd->error) {
+			return;
+		}
+		res = duk_hobject_alloc(heap, (int) flags);
+		if (!res) {
+			rd->error = 1;
+			return;
+		}
+		duk_push_hobject(ctx, res);
+		break;
+	}
+	case DUK__SNAP_ITEM_COMPFUNC:
+		duk__snap_read_compfunc(rd);
+		break;
+	case DUK__SNAP_ITEM_NATFUNC: {
+		duk_hnativefunction *res;
+		duk_c_function func;
+		duk_int16_t nargs, magic;
+
+		flags = duk__snap_read_object_flags(rd, DUK_HOBJECT_FLAG_NATIVEFUNCTION);
+		func = duk__snap_read_native(rd);
+		nargs = (duk_int16_t) duk__snap_read_u16(rd);
+		magic = (duk_int16_t) duk__snap_read_u16(rd);
+		if (rd->error) {
+			return;
+		}
+		res = duk_hnativefunction_alloc(heap, (int) flags);
+		if (!res) {
+			rd->error = 1;
+			return;
+		}
+		res->func = func;
+		res->nargs = nargs;
+		res->magic = magic;
+		duk_push_hobject(ctx, (duk_hobject *) res);
+		break;
+	}
+	case DUK__SNAP_ITEM_THREAD: {
+		duk_uint32_t i;
+
+		/* The heap thread already exists, its flags are kept. */
+		(void) duk__snap_read_object_flags(rd, DUK_HOBJECT_FLAG_THREAD);
+		for (i = 0; i < rd->n_items; i++) {
+			if (rd->meta[i].kind == DUK__SNAP_ITEM_THREAD) {
+				rd->error = 1;
+			}
+		}
+		if (rd->error) {
+			return;
+		}
+		duk_push_hobject(ctx, (duk_hobject *) heap->heap_thread);
+		break;
+	}
+#if defined(DUK_USE_ROM_OBJECTS)
+	case DUK__SNAP_ITEM_ROMOBJ: {
+		duk_uint32_t rom_idx = duk__snap_read_u32(rd);
+
+		if (rd->error || rom_idx >= DUK_NUM_ROM_OBJECTS) {
+			rd->error = 1;
+			return;
+		}
+		duk_push_hobject(ctx, (duk_hobject *) duk_rom_objects[rom_idx]);
+		break;
+	}
+#endif
+	default:
+		rd->error = 1;
+		return;
+	}
+
+	if (!rd->error) {
+		rd->n_items++;
+	}
+}
+
+static void duk__snap_read_props(duk__snap_reader *rd, duk_hobject *obj) {
+	duk_context *ctx = (duk_context *) rd->thr;
+	duk_uint32_t exotic_flags;
+	duk_uint32_t idx;
+	duk_uint32_t n_entries, a_size;
+	duk_uint32_t i;
+
+	exotic_flags = duk__snap_read_u32(rd);
+	if ((exotic_flags & ~DUK__SNAP_EXOTIC_FLAGS) != 0) {
+		rd->error = 1;
+	}
+	idx = duk__snap_read_ref(rd, 1, 0, 1);
+	if (rd->error) {
+		return;
+	}
+	DUK_HOBJECT_SET_PROTOTYPE_UPDREF(rd->thr, obj, duk__snap_get_item_hobject(rd, idx));
+
+	/* Every entry takes at least 6 bytes and every array value 1 byte,
+	 * so the checks keep corrupted counts from causing huge allocations.
+	 */
+	n_entries = duk__snap_read_u32(rd);
+	a_size = duk__snap_read_u32(rd);
+	if (rd->error ||
+	    n_entries > (duk_uint32_t) (rd->p_end - rd->p) / 6 ||
+	    a_size > (duk_uint32_t) (rd->p_end - rd->p) ||
+	    (a_size > 0 && !DUK_HOBJECT_HAS_ARRAY_PART(obj))) {
+		rd->error = 1;
+		return;
+	}
+
+	if (n_entries > 0 || a_size > 0) {
+		duk_hobject_prealloc_props(rd->thr, obj, n_entries, a_size);
+	}
+
+	for (i = 0; i < n_entries; i++) {
+		duk_hstring *key;
+		duk_uint8_t propflags;
+
+		idx = duk__snap_read_ref(rd, 0, DUK__SNAP_ITEM_STRING, 0);
+		propflags = duk__snap_read_u8(rd);
+		if (rd->error || (propflags & ~DUK_PROPDESC_FLAGS_MASK) != 0) {
+			rd->error = 1;
+			return;
+		}
+		key = duk_get_hstring(ctx, (duk_idx_t) idx + 1);
+		DUK_ASSERT(key != NULL);
+
+		if (propflags & DUK_PROPDESC_FLAG_ACCESSOR) {
+			duk_uint32_t idx_get = duk__snap_read_ref(rd, 1, 0, 1);
+			duk_uint32_t idx_set = duk__snap_read_ref(rd, 1, 0, 1);
+			if (rd->error) {
+				return;
+			}
+			duk_hobject_define_accessor_internal(rd->thr,
+			                                     obj,
+			                                     key,
+			                                     duk__snap_get_item_hobject(rd, idx_get),
+			                                     duk__snap_get_item_hobject(rd, idx_set),
+			                                     propflags & ~DUK_PROPDESC_FLAG_ACCESSOR);
+		} else {
+			duk_tval tv;
+			duk__snap_read_tval(rd, &tv);
+			if (rd->error) {
+				return;
+			}
+			duk_push_tval(ctx, &tv);
+			duk_hobject_define_property_internal(rd->thr, obj, key, propflags);
+		}
+	}
+
+	for (i = 0; i < a_size; i++) {
+		duk_tval tv;
+		duk__snap_read_tval(rd, &tv);
+		if (rd->error) {
+			return;
+		}
+		if (DUK_TVAL_IS_UNDEFINED_UNUSED(&tv)) {
+			continue;
+		}
+		duk_push_tval(ctx, &tv);
+		duk_hobject_define_property_internal_arridx(rd->thr, obj, i, DUK_PROPDESC_FLAGS_WEC);
+	}
+
+	DUK_HEAPHDR_SET_FLAG_BITS(&obj->hdr, exotic_flags);
+}
+
+int duk_heap_snapshot_restore(duk_heap *heap, const duk_uint8_t *p, duk_size_t len, const duk_c_function *natives) {
+	duk_hthread *thr;
+	duk_context *ctx;
+	duk__snap_reader rd;
+	duk_uint32_t n_items;
+	duk_uint32_t idx;
+	duk_uint32_t i;
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(heap->heap_thread != NULL);
+	DUK_ASSERT(p != NULL);
+
+	thr = heap->heap_thread;
+	ctx = (duk_context *) thr;
+	DUK_ASSERT(duk_get_top(ctx) == 0);
+
+	rd.thr = thr;
+	rd.p = p;
+	rd.p_end = p + len;
+	rd.natives = natives;
+	rd.n_natives = 0;
+	if (natives) {
+		while (natives[rd.n_natives] != NULL) {
+			rd.n_natives++;
+		}
+	}
+	rd.meta = NULL;
+	rd.n_items = 0;
+	rd.error = 0;
+
+	if (duk__snap_read_u8(&rd) != DUK__SNAP_MARKER ||
+	    duk__snap_read_u8(&rd) != DUK__SNAP_FORMAT_VERSION ||
+	    duk__snap_read_u32(&rd) != (duk_uint32_t) DUK_VERSION ||
+	    duk__snap_read_u32(&rd) != (duk_uint32_t) DUK_HEAP_NUM_STRINGS ||
+	    duk__snap_read_u32(&rd) != (duk_uint32_t) DUK_NUM_BUILTINS ||
+	    duk__snap_read_u32(&rd) != (duk_uint32_t) DUK_NUM_BI_NATIVE_FUNCTIONS) {
+		DUK_D(DUK_DPRINT("snapshot header mismatch"));
+		goto error;
+	}
+
+	/* Every item takes at least 5 bytes. */
+	n_items = duk__snap_read_u32(&rd);
+	if (rd.error || n_items > (duk_uint32_t) (rd.p_end - rd.p) / 5) {
+		goto error;
+	}
+
+	if (!duk_check_stack(ctx, (duk_idx_t) n_items + 16)) {
+		goto error;
+	}
+	rd.meta = (duk__snap_meta *) duk_push_fixed_buffer(ctx, (duk_size_t) n_items * sizeof(duk__snap_meta));
+
+	/*
+	 *  Items
+	 */
+
+	while (rd.n_items < n_items) {
+		duk__snap_read_item(&rd);
+		if (rd.error) {
+			DUK_D(DUK_DPRINT("invalid snapshot item %ld", (long) rd.n_items));
+			goto error;
+		}
+	}
+
+	/*
+	 *  Roots
+	 */
+
+	idx = duk__snap_read_ref(&rd, 0, DUK__SNAP_ITEM_OBJECT, 0);
+	if (rd.error) {
+		goto error;
+	}
+	heap->heap_object = duk__snap_get_item_hobject(&rd, idx);
+	DUK_HOBJECT_INCREF(thr, heap->heap_object);
+
+	for (i = 0; i < DUK_HEAP_NUM_STRINGS; i++) {
+		duk_hstring *h;
+
+		idx = duk__snap_read_ref(&rd, 0, DUK__SNAP_ITEM_STRING, 0);
+		if (rd.error) {
+			goto error;
+		}
+		h = duk_get_hstring(ctx, (duk_idx_t) idx + 1);
+		DUK_ASSERT(h != NULL);
+		heap->strs[i] = h;
+		DUK_HSTRING_INCREF(thr, h);
+	}
+
+	for (i = 0; i < DUK_NUM_BUILTINS; i++) {
+		idx = duk__snap_read_ref(&rd, 1, 0, 1);
+		if (rd.error) {
+			goto error;
+		}
+		thr->builtins[i] = duk__snap_get_item_hobject(&rd, idx);
+		DUK_HOBJECT_INCREF(thr, thr->builtins[i]);
+	}
+
+	/*
+	 *  Properties
+	 */
+
+	for (i = 0; i < n_items; i++) {
+		if (!DUK__SNAP_ITEM_IS_OBJECT(rd.meta[i].kind) ||
+		    rd.meta[i].kind == DUK__SNAP_ITEM_ROMOBJ) {
+			continue;
+		}
+		duk__snap_read_props(&rd, duk_get_hobject(ctx, (duk_idx_t) i + 1));
+		if (rd.error) {
+			DUK_D(DUK_DPRINT("invalid snapshot properties for item %ld", (long) i));
+			goto error;
+		}
+	}
+
+	if (rd.p != rd.p_end) {
+		goto error;
+	}
+
+	DUK_DD(DUK_DDPRINT("restored heap snapshot: %ld items", (long) n_items));
+
+	duk_set_top(ctx, 0);
+	return 1;
+
+ error:
+	DUK_D(DUK_DPRINT("heap snapshot restore failed"));
+	return 0;
+}
@@ -348,12 +348,44 @@ static duk_hstring *duk__do_intern(duk_heap *heap, duk_uint8_t *str, duk_uint32_
 	return res;
 }
 
+#if defined(DUK_USE_ROM_STRINGS)
+/* ROM strings are never added to the stringtable.  They're looked up from
+ * a constant table generated by genbuiltins.py which groups the strings
+ * into buckets by their low hash bits.
+ */
+static duk_hstring *duk__find_matching_rom_string(duk_uint8_t *str, duk_uint32_t blen, duk_uint32_t strhash) {
+	duk_uint_fast32_t i, i_end;
+	duk_uint32_t bucket;
+
+	bucket = strhash & (DUK_ROM_STRINGS_LOOKUP_BUCKETS - 1);
+	i = (duk_uint_fast32_t) duk_rom_strings_lookup_index[bucket];
+	i_end = (duk_uint_fast32_t) duk_rom_strings_lookup_index[bucket + 1];
+	for (; i < i_end; i++) {
+		duk_hstring *e = (duk_hstring *) duk_rom_strings_lookup[i];
+
+		if (DUK_HSTRING_GET_HASH(e) == strhash &&
+		    DUK_HSTRING_GET_BYTELEN(e) == blen &&
+		    DUK_MEMCMP(str, DUK_HSTRING_GET_DATA(e), blen) == 0) {
+			DUK_DDD(DUK_DDDPRINT("find matching rom string hit: %d", (int) i));
+			return e;
+		}
+	}
+	return NULL;
+}
+#endif  /* DUK_USE_ROM_STRINGS */
+
 static duk_hstring *duk__do_lookup(duk_heap *heap, duk_uint8_t *str, duk_uint32_t blen, duk_uint32_t *out_strhash) {
 	duk_hstring *res;
 
 	DUK_ASSERT(out_strhash);
 
 	*out_strhash = duk_heap_hashstring(heap, str, (duk_size_t) blen);  /* FIXME: change blen to duk_size_t */
+#if defined(DUK_USE_ROM_STRINGS)
+	res = duk__find_matching_rom_string(str, blen, *out_strhash);
+	if (res) {
+		return res;
+	}
+#endif
 	res = duk__find_matching_string(heap, heap->st, heap->st_size, str, blen, *out_strhash);
 	return res;
 }
@@ -48,8 +48,8 @@ struct duk_heaphdr_string {
 #define DUK_HEAPHDR_FLAGS_FLAG_MASK      (~DUK_HEAPHDR_FLAGS_TYPE_MASK)
 
                                              /* 2 bits for heap type */
-#define DUK_HEAPHDR_FLAGS_HEAP_START     2   /* 4 heap flags */
-#define DUK_HEAPHDR_FLAGS_USER_START     6   /* 26 user flags */
+#define DUK_HEAPHDR_FLAGS_HEAP_START     2   /* 5 heap flags */
+#define DUK_HEAPHDR_FLAGS_USER_START     7   /* 25 user flags */
 
 #define DUK_HEAPHDR_HEAP_FLAG_NUMBER(n)  (DUK_HEAPHDR_FLAGS_HEAP_START + (n))
 #define DUK_HEAPHDR_USER_FLAG_NUMBER(n)  (DUK_HEAPHDR_FLAGS_USER_START + (n))
@@ -60,6 +60,7 @@ struct duk_heaphdr_string {
 #define DUK_HEAPHDR_FLAG_TEMPROOT        DUK_HEAPHDR_HEAP_FLAG(1)  /* mark-and-sweep: children not processed */
 #define DUK_HEAPHDR_FLAG_FINALIZABLE     DUK_HEAPHDR_HEAP_FLAG(2)  /* mark-and-sweep: finalizable (on current pass) */
 #define DUK_HEAPHDR_FLAG_FINALIZED       DUK_HEAPHDR_HEAP_FLAG(3)  /* mark-and-sweep: finalized (on previous pass) */
+#define DUK_HEAPHDR_FLAG_READONLY        DUK_HEAPHDR_HEAP_FLAG(4)  /* read-only object (in ROM) */
 
 #define DUK_HTYPE_MIN                    1
 #define DUK_HTYPE_STRING                 1
@@ -141,6 +142,13 @@ struct duk_heaphdr_string {
 #define DUK_HEAPHDR_CLEAR_FINALIZED(h)    DUK_HEAPHDR_CLEAR_FLAG_BITS((h),DUK_HEAPHDR_FLAG_FINALIZED)
 #define DUK_HEAPHDR_HAS_FINALIZED(h)      DUK_HEAPHDR_CHECK_FLAG_BITS((h),DUK_HEAPHDR_FLAG_FINALIZED)
 
+/* ROM objects are never modified, not even their refcount or mark flags */
+#if defined(DUK_USE_ROM_STRINGS)
+#define DUK_HEAPHDR_HAS_READONLY(h)       DUK_HEAPHDR_CHECK_FLAG_BITS((h),DUK_HEAPHDR_FLAG_READONLY)
+#else
+#define DUK_HEAPHDR_HAS_READONLY(h)       0
+#endif
+
 /* get or set a range of flags; m=first bit number, n=number of bits */
 #define DUK_HEAPHDR_GET_FLAG_RANGE(h,m,n)  (((h)->h_flags >> (m)) & ((1 << (n)) - 1))
 
@@ -164,6 +172,26 @@ struct duk_heaphdr_string {
 
 #define DUK_HEAPHDR_STRING_INIT_NULLS(h)  /* currently nop */
 
+/* Static initializers for heap headers of ROM objects and strings (see
+ * genbuiltins.py).  The refcount is never updated so its value doesn't
+ * matter; 1 keeps refcount assertions happy.
+ */
+#if defined(DUK_USE_REFERENCE_COUNTING)
+#if defined(DUK_USE_DOUBLE_LINKED_HEAP)
+#define DUK_HEAPHDR_ROM_INIT(flags)         { (flags) | DUK_HEAPHDR_FLAG_READONLY, 1, NULL, NULL }
+#else
+#define DUK_HEAPHDR_ROM_INIT(flags)         { (flags) | DUK_HEAPHDR_FLAG_READONLY, 1, NULL }
+#endif
+#define DUK_HEAPHDR_STRING_ROM_INIT(flags)  { (flags) | DUK_HEAPHDR_FLAG_READONLY, 1 }
+#else
+#if defined(DUK_USE_DOUBLE_LINKED_HEAP)
+#define DUK_HEAPHDR_ROM_INIT(flags)         { (flags) | DUK_HEAPHDR_FLAG_READONLY, NULL, NULL }
+#else
+#define DUK_HEAPHDR_ROM_INIT(flags)         { (flags) | DUK_HEAPHDR_FLAG_READONLY, NULL }
+#endif
+#define DUK_HEAPHDR_STRING_ROM_INIT(flags)  { (flags) | DUK_HEAPHDR_FLAG_READONLY }
+#endif
+
 /*
  *  Reference counting helper macros.  The macros take a thread argument
  *  and must thus always be executed in a specific thread context.  The
@@ -32,10 +32,11 @@
 #ifndef DUK_HOBJECT_H_INCLUDED
 #define DUK_HOBJECT_H_INCLUDED
 
-/* there are currently 26 flag bits available */
+/* there are currently 25 flag bits available */
 #define DUK_HOBJECT_FLAG_EXTENSIBLE            DUK_HEAPHDR_USER_FLAG(0)   /* object is extensible */
 #define DUK_HOBJECT_FLAG_CONSTRUCTABLE         DUK_HEAPHDR_USER_FLAG(1)   /* object is constructable */
 #define DUK_HOBJECT_FLAG_BOUND                 DUK_HEAPHDR_USER_FLAG(2)   /* object established using Function.prototype.bind() */
+#define DUK_HOBJECT_FLAG_NOCAPTURE             DUK_HEAPHDR_USER_FLAG(3)   /* function: doesn't refer to bindings of the enclosing function (function templates only) */
 #define DUK_HOBJECT_FLAG_COMPILEDFUNCTION      DUK_HEAPHDR_USER_FLAG(4)   /* object is a compiled function (duk_hcompiledfunction) */
 #define DUK_HOBJECT_FLAG_NATIVEFUNCTION        DUK_HEAPHDR_USER_FLAG(5)   /* object is a native function (duk_hnativefunction) */
 #define DUK_HOBJECT_FLAG_THREAD                DUK_HEAPHDR_USER_FLAG(6)   /* object is a thread (duk_hthread) */
@@ -52,9 +53,8 @@
 #define DUK_HOBJECT_FLAG_EXOTIC_DUKFUNC        DUK_HEAPHDR_USER_FLAG(17)  /* Duktape/C (nativefunction) object, exotic 'length' */
 #define DUK_HOBJECT_FLAG_EXOTIC_BUFFEROBJ      DUK_HEAPHDR_USER_FLAG(18)  /* 'Buffer' object, array index exotic behavior, virtual 'length' */
 #define DUK_HOBJECT_FLAG_EXOTIC_PROXYOBJ       DUK_HEAPHDR_USER_FLAG(19)  /* 'Proxy' object */
-/* bit 20 unused */
 
-#define DUK_HOBJECT_FLAG_CLASS_BASE            DUK_HEAPHDR_USER_FLAG_NUMBER(21)
+#define DUK_HOBJECT_FLAG_CLASS_BASE            DUK_HEAPHDR_USER_FLAG_NUMBER(20)
 #define DUK_HOBJECT_FLAG_CLASS_BITS            5
 
 #define DUK_HOBJECT_GET_CLASS_NUMBER(h)        \
@@ -62,8 +62,10 @@
 #define DUK_HOBJECT_SET_CLASS_NUMBER(h,v)      \
 	DUK_HEAPHDR_SET_FLAG_RANGE(&(h)->hdr, DUK_HOBJECT_FLAG_CLASS_BASE, DUK_HOBJECT_FLAG_CLASS_BITS, (v))
 
-/* for creating flag initializers */
-#define DUK_HOBJECT_CLASS_AS_FLAGS(v)          ((v) << DUK_HOBJECT_FLAG_CLASS_BASE)
+/* for creating flag initializers; unsigned shift so that the result is a
+ * constant expression for classes >= 16 too (needed by ROM objects)
+ */
+#define DUK_HOBJECT_CLASS_AS_FLAGS(v)          (((duk_uint32_t) (v)) << DUK_HOBJECT_FLAG_CLASS_BASE)
 
 /* E5 Section 8.6.2 + custom classes */
 #define DUK_HOBJECT_CLASS_UNUSED               0
@@ -137,6 +139,7 @@
 #define DUK_HOBJECT_HAS_EXOTIC_DUKFUNC(h)      DUK_HEAPHDR_CHECK_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_DUKFUNC)
 #define DUK_HOBJECT_HAS_EXOTIC_BUFFEROBJ(h)    DUK_HEAPHDR_CHECK_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_BUFFEROBJ)
 #define DUK_HOBJECT_HAS_EXOTIC_PROXYOBJ(h)     DUK_HEAPHDR_CHECK_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_PROXYOBJ)
+#define DUK_HOBJECT_HAS_NOCAPTURE(h)           DUK_HEAPHDR_CHECK_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_NOCAPTURE)
 
 #define DUK_HOBJECT_SET_EXTENSIBLE(h)          DUK_HEAPHDR_SET_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXTENSIBLE)
 #define DUK_HOBJECT_SET_CONSTRUCTABLE(h)       DUK_HEAPHDR_SET_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_CONSTRUCTABLE)
@@ -157,6 +160,7 @@
 #define DUK_HOBJECT_SET_EXOTIC_DUKFUNC(h)      DUK_HEAPHDR_SET_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_DUKFUNC)
 #define DUK_HOBJECT_SET_EXOTIC_BUFFEROBJ(h)    DUK_HEAPHDR_SET_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_BUFFEROBJ)
 #define DUK_HOBJECT_SET_EXOTIC_PROXYOBJ(h)     DUK_HEAPHDR_SET_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_PROXYOBJ)
+#define DUK_HOBJECT_SET_NOCAPTURE(h)           DUK_HEAPHDR_SET_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_NOCAPTURE)
 
 #define DUK_HOBJECT_CLEAR_EXTENSIBLE(h)        DUK_HEAPHDR_CLEAR_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXTENSIBLE)
 #define DUK_HOBJECT_CLEAR_CONSTRUCTABLE(h)     DUK_HEAPHDR_CLEAR_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_CONSTRUCTABLE)
@@ -177,6 +181,7 @@
 #define DUK_HOBJECT_CLEAR_EXOTIC_DUKFUNC(h)    DUK_HEAPHDR_CLEAR_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_DUKFUNC)
 #define DUK_HOBJECT_CLEAR_EXOTIC_BUFFEROBJ(h)  DUK_HEAPHDR_CLEAR_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_BUFFEROBJ)
 #define DUK_HOBJECT_CLEAR_EXOTIC_PROXYOBJ(h)   DUK_HEAPHDR_CLEAR_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_EXOTIC_PROXYOBJ)
+#define DUK_HOBJECT_CLEAR_NOCAPTURE(h)         DUK_HEAPHDR_CLEAR_FLAG_BITS(&(h)->hdr, DUK_HOBJECT_FLAG_NOCAPTURE)
 
 /* flags used for property attributes in duk_propdesc and packed flags */
 #define DUK_PROPDESC_FLAG_WRITABLE              (1 << 0)    /* E5 Section 8.6.1 */
@@ -212,7 +217,38 @@
  *  Macros to access the 'p' allocation.
  */
 
-#if defined(DUK_USE_HOBJECT_LAYOUT_1)
+#if defined(DUK_USE_HOBJECT_SHAPES)
+/* SHAPES: 'p' only contains entry values and the array part, entry keys,
+ * entry flags, and the hash part live in the (possibly shared) shape.
+ */
+#define DUK_HOBJECT_E_GET_KEY_BASE(h)           \
+	DUK_HSHAPE_GET_KEY_BASE((h)->shape)
+#define DUK_HOBJECT_E_GET_VALUE_BASE(h)         \
+	((duk_propvalue *) ( \
+		(h)->p \
+	))
+#define DUK_HOBJECT_E_GET_FLAGS_BASE(h)         \
+	DUK_HSHAPE_GET_FLAGS_BASE((h)->shape)
+#define DUK_HOBJECT_A_GET_BASE(h)               \
+	((duk_tval *) ( \
+		(h)->p + \
+			(h)->e_size * sizeof(duk_propvalue) \
+	))
+#define DUK_HOBJECT_H_GET_BASE(h)               \
+	DUK_HSHAPE_GET_H_BASE((h)->shape)
+#define DUK_HOBJECT_P_COMPUTE_SIZE(n_ent,n_arr,n_hash) \
+	( \
+		(n_ent) * sizeof(duk_propvalue) + \
+		(n_arr) * sizeof(duk_tval) \
+	)
+#define DUK_HOBJECT_P_SET_REALLOC_PTRS(p_base,set_e_k,set_e_pv,set_e_f,set_a,set_h,n_ent,n_arr,n_hash)  do { \
+		(set_e_pv) = (duk_propvalue *) (p_base); \
+		(set_a) = (duk_tval *) ((set_e_pv) + (n_ent)); \
+		(set_e_k) = NULL; \
+		(set_e_f) = NULL; \
+		(set_h) = NULL; \
+	} while (0)
+#elif defined(DUK_USE_HOBJECT_LAYOUT_1)
 /* LAYOUT 1 */
 #define DUK_HOBJECT_E_GET_KEY_BASE(h)           \
 	((duk_hstring **) ( \
@@ -425,6 +461,65 @@
 #define DUK_HOBJECT_HASHIDX_UNUSED              0xffffffffUL
 #define DUK_HOBJECT_HASHIDX_DELETED             0xfffffffeUL
 
+/*
+ *  Shared property shapes
+ *
+ *  With DUK_USE_HOBJECT_SHAPES entry part keys and flags are stored in a
+ *  shape (duk_hshape).  Shapes are normally shared through a transition
+ *  tree rooted at heap->shape_root: adding a property moves the object to
+ *  the child shape for that (key, flags) pair.  Tree shapes are immutable;
+ *  any in-place modification of keys or flags (delete, attribute change,
+ *  in-place sorting) must first give the object a unique shape of its own
+ *  using DUK_HOBJECT_E_UNSHARE().
+ */
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+#define DUK_HSHAPE_FLAG_UNIQUE                  (1 << 0)  /* owned by a single object, may be modified in place */
+
+#define DUK_HSHAPE_HAS_UNIQUE(s)                (((s)->flags & DUK_HSHAPE_FLAG_UNIQUE) != 0)
+
+#define DUK_HSHAPE_GET_KEY_BASE(s)              \
+	((duk_hstring **) ( \
+		((duk_uint8_t *) (s)) + sizeof(duk_hshape) \
+	))
+#define DUK_HSHAPE_GET_H_BASE(s)                \
+	((duk_uint32_t *) ( \
+		DUK_HSHAPE_GET_KEY_BASE((s)) + (s)->e_size \
+	))
+#define DUK_HSHAPE_GET_FLAGS_BASE(s)            \
+	((duk_uint8_t *) ( \
+		DUK_HSHAPE_GET_H_BASE((s)) + (s)->h_size \
+	))
+#define DUK_HSHAPE_COMPUTE_SIZE(n_ent,n_hash)   \
+	( \
+		sizeof(duk_hshape) + \
+		(n_ent) * (sizeof(duk_hstring *) + sizeof(duk_uint8_t)) + \
+		(n_hash) * sizeof(duk_uint32_t) \
+	)
+
+/* Tree shapes have no hash part, so objects with more keys than this
+ * get a unique shape (with a hash part once large enough).
+ */
+#define DUK_HSHAPE_TREE_MAX_KEYS                DUK_HOBJECT_E_USE_HASH_LIMIT
+
+#define DUK_HOBJECT_E_UNSHARE(thr,h)  do { \
+		if (!DUK_HSHAPE_HAS_UNIQUE((h)->shape)) { \
+			duk_hobject_unshare_shape((thr), (h)); \
+		} \
+	} while (0)
+#define DUK_HOBJECT_E_UPDATE_FLAGS(thr,h,i,f)  do { \
+		if (DUK_HOBJECT_E_GET_FLAGS((h),(i)) != (f)) { \
+			DUK_HOBJECT_E_UNSHARE((thr),(h)); \
+			DUK_HOBJECT_E_SET_FLAGS((h),(i),(f)); \
+		} \
+	} while (0)
+#else  /* DUK_USE_HOBJECT_SHAPES */
+#define DUK_HOBJECT_E_UNSHARE(thr,h)  do { } while (0)
+#define DUK_HOBJECT_E_UPDATE_FLAGS(thr,h,i,f)  do { \
+		DUK_HOBJECT_E_SET_FLAGS((h),(i),(f)); \
+	} while (0)
+#endif  /* DUK_USE_HOBJECT_SHAPES */
+
 /*
  *  Misc
  */
@@ -437,6 +532,26 @@
 /* Maximum traversal depth for "bound function" chains. */
 #define DUK_HOBJECT_BOUND_CHAIN_SANITY          10000L
 
+/*
+ *  Property inline cache entries
+ *
+ *  An inline cache entry is a 16-bit hint: the entry part index of the
+ *  property (12 bits) and the prototype chain depth of the holder object
+ *  relative to the base object (4 bits).  Entries carry no identity of
+ *  their own and are always validated against the object before use, so
+ *  property additions, deletions, reconfiguration, compaction and
+ *  prototype changes never need to invalidate them explicitly.
+ */
+
+#if defined(DUK_USE_PROPERTY_IC)
+#define DUK_HOBJECT_IC_EMPTY                    0xffffU
+#define DUK_HOBJECT_IC_MAX_EIDX                 0x0fffU
+#define DUK_HOBJECT_IC_MAX_DEPTH                0x0eU    /* depth 0x0f reserved for DUK_HOBJECT_IC_EMPTY */
+#define DUK_HOBJECT_IC_ENCODE(depth,e_idx)      ((duk_uint16_t) (((depth) << 12) | (e_idx)))
+#define DUK_HOBJECT_IC_GET_DEPTH(ent)           ((ent) >> 12)
+#define DUK_HOBJECT_IC_GET_EIDX(ent)            ((ent) & 0x0fffU)
+#endif
+
 /*
  *  Ecmascript [[Class]]
  */
@@ -537,6 +652,54 @@ union duk_propvalue {
 	duk_propaccessor a;
 };
 
+#if defined(DUK_USE_ROM_OBJECTS)
+/* Property value initializers for ROM objects (genbuiltins.py).  Only the
+ * first member of a union can be initialized statically, so each value
+ * type has its own variant of the (unpacked) duk_tval.  The 'align' member
+ * gives each variant the size and alignment of duk_propvalue.
+ */
+union duk_rom_propvalue_number {
+	struct {
+		duk_uint16_t t;
+		duk_uint16_t v_extra;
+		union {
+			duk_uint8_t bytes[8];  /* IEEE double in target byte order */
+			double d;
+		} v;
+	} v;
+	duk_propvalue align;
+};
+
+union duk_rom_propvalue_int {
+	struct {
+		duk_uint16_t t;
+		duk_uint16_t v_extra;
+		union {
+			int i;
+			double d;
+		} v;
+	} v;
+	duk_propvalue align;
+};
+
+union duk_rom_propvalue_ptr {
+	struct {
+		duk_uint16_t t;
+		duk_uint16_t v_extra;
+		union {
+			void *ptr;
+			double d;
+		} v;
+	} v;
+	duk_propvalue align;
+};
+
+union duk_rom_propvalue_accessor {
+	duk_propaccessor a;
+	duk_propvalue align;
+};
+#endif  /* DUK_USE_ROM_OBJECTS */
+
 struct duk_propdesc {
 	/* read-only values 'lifted' for ease of use */
 	int flags;
@@ -549,6 +712,41 @@ struct duk_propdesc {
 	int a_idx;	/* prop index in 'array part', < 0 if not there */
 };
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+struct duk_hshape {
+	/* Shapes are not heap objects: they are referenced by objects and
+	 * child shapes only, and freed as soon as the refcount drops to zero
+	 * (also when reference counting is otherwise disabled).
+	 */
+	duk_uint32_t refcount;
+
+	/* Key and flags slots allocated, key slots used, hash part size.
+	 * Tree shapes have e_size == e_used and no hash part.
+	 */
+	duk_uint32_t e_size;
+	duk_uint32_t e_used;
+	duk_uint32_t h_size;
+
+	/* Transition tree: 'parent' is a counted reference, 'child' and
+	 * 'next' (the next sibling) are weak.  Unique shapes are never in
+	 * the tree.
+	 */
+	duk_hshape *parent;
+	duk_hshape *child;
+	duk_hshape *next;
+
+	duk_small_uint_t flags;
+
+	/*
+	 *  Followed by:
+	 *
+	 *    e_size * sizeof(duk_hstring *)         bytes of   entry keys (e_used counted references)
+	 *    h_size * sizeof(duk_uint32_t)          bytes of   (opt) hash indexes to entries
+	 *    e_size * sizeof(duk_uint8_t)           bytes of   entry flags
+	 */
+};
+#endif  /* DUK_USE_HOBJECT_SHAPES */
+
 struct duk_hobject {
 	duk_heaphdr hdr;
 
@@ -624,6 +822,15 @@ struct duk_hobject {
 	duk_uint32_t a_size;
 	duk_uint32_t h_size;
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* With shapes, 'p' contains only entry values and array entries, see
+	 * duk_hshape.  'e_size' is the number of value slots, 'e_used' and
+	 * 'h_size' mirror the shape.  Never NULL (except when the object is
+	 * being freed).
+	 */
+	duk_hshape *shape;
+#endif
+
 	/* prototype: the only internal property lifted outside 'e' as it is so central */
 	duk_hobject *prototype;
 };
@@ -645,6 +852,15 @@ duk_hcompiledfunction *duk_hcompiledfunction_alloc(duk_heap *heap, int hobject_f
 duk_hnativefunction *duk_hnativefunction_alloc(duk_heap *heap, int hobject_flags);
 duk_hthread *duk_hthread_alloc(duk_heap *heap, int hobject_flags);
 
+/* shapes */
+#if defined(DUK_USE_HOBJECT_SHAPES)
+duk_hshape *duk_hshape_alloc(duk_heap *heap, duk_uint32_t e_size, duk_uint32_t h_size, duk_small_uint_t flags);
+duk_hshape *duk_hshape_transition(duk_hthread *thr, duk_hshape *shape, duk_hstring *key, duk_small_uint_t propflags);
+void duk_hshape_decref(duk_hthread *thr, duk_hshape *shape);
+void duk_hshape_free_raw(duk_heap *heap, duk_hshape *shape);
+void duk_hobject_unshare_shape(duk_hthread *thr, duk_hobject *obj);
+#endif
+
 /* low-level property functions */
 void duk_hobject_find_existing_entry(duk_hobject *obj, duk_hstring *key, int *e_idx, int *h_idx);
 duk_tval *duk_hobject_find_existing_entry_tval_ptr(duk_hobject *obj, duk_hstring *key);
@@ -656,6 +872,10 @@ int duk_hobject_getprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key);
 int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, duk_tval *tv_val, int throw_flag);
 int duk_hobject_delprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, int throw_flag);
 int duk_hobject_hasprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key);
+#if defined(DUK_USE_PROPERTY_IC)
+duk_tval *duk_hobject_getprop_ic(duk_hthread *thr, duk_hobject *obj, duk_hstring *key, duk_uint16_t *ic);
+duk_tval *duk_hobject_putprop_ic(duk_hthread *thr, duk_hobject *obj, duk_hstring *key, duk_uint16_t *ic);
+#endif
 
 /* internal property functions */
 int duk_hobject_delprop_raw(duk_hthread *thr, duk_hobject *obj, duk_hstring *key, int throw_flag);
@@ -682,6 +902,7 @@ duk_hbuffer *duk_hobject_get_internal_value_buffer(duk_heap *heap, duk_hobject *
 	
 /* hobject management functions */
 void duk_hobject_compact_props(duk_hthread *thr, duk_hobject *obj);
+void duk_hobject_prealloc_props(duk_hthread *thr, duk_hobject *obj, duk_uint32_t e_size, duk_uint32_t a_size);
 
 /* ES6 proxy */
 #if defined(DUK_USE_ES6_PROXY)
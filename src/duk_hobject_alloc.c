@@ -13,6 +13,13 @@ static void duk__init_object_parts(duk_heap *heap, duk_hobject *obj, int hobject
 	obj->p = NULL;
 #endif
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* all objects start out with the (empty) root shape */
+	DUK_ASSERT(heap->shape_root != NULL);
+	obj->shape = heap->shape_root;
+	obj->shape->refcount++;
+#endif
+
 	/* FIXME: macro? sets both heaphdr and object flags */
 	obj->hdr.h_flags = hobject_flags;
 	DUK_HEAPHDR_SET_TYPE(&obj->hdr, DUK_HTYPE_OBJECT);  /* also goes into flags */
@@ -74,6 +81,9 @@ duk_hcompiledfunction *duk_hcompiledfunction_alloc(duk_heap *heap, int hobject_f
 	res->data = NULL;
 	res->funcs = NULL;
 	res->bytecode = NULL;
+#if defined(DUK_USE_JIT)
+	res->jit = NULL;
+#endif
 #endif
 
 	return res;
@@ -181,6 +181,11 @@ void duk_hobject_enumerator_create(duk_context *ctx, int enum_flags) {
 	duk_push_object_internal(ctx);
 	res = duk_require_hobject(ctx, -1);
 
+	/* Enumerator keys depend on the target and may be sorted in place
+	 * (duk__sort_array_indices()), so don't pollute the shape tree.
+	 */
+	DUK_HOBJECT_E_UNSHARE(thr, res);
+
 	DUK_DDD(DUK_DDDPRINT("created internal object"));
 
 	/* [enum_target res] */
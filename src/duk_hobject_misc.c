@@ -32,12 +32,14 @@ void duk_hobject_set_prototype(duk_hthread *thr, duk_hobject *h, duk_hobject *p)
 	duk_hobject *tmp;
 
 	DUK_ASSERT(h);
+	DUK_ASSERT(!DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h));
 	tmp = h->prototype;
 	h->prototype = p;
 	DUK_HOBJECT_INCREF(thr, p);  /* avoid problems if p == h->prototype */
 	DUK_HOBJECT_DECREF(thr, tmp);
 #else
 	DUK_ASSERT(h);
+	DUK_ASSERT(!DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h));
 	h->prototype = p;
 #endif
 }
@@ -90,6 +90,13 @@ static duk_uint32_t duk__tval_number_to_arr_idx(duk_tval *tv) {
 	DUK_ASSERT(tv != NULL);
 	DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
 
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv)) {
+		duk_int32_t t = DUK_TVAL_GET_FASTINT(tv);
+		return (t >= 0 ? (duk_uint32_t) t : DUK__NO_ARRAY_INDEX);
+	}
+#endif
+
 	dbl = DUK_TVAL_GET_NUMBER(tv);
 	idx = (duk_uint32_t) dbl;
 	if ((duk_double_t) idx == dbl) {
@@ -370,6 +377,47 @@ static duk_small_int_t duk__proxy_check_prop(duk_hthread *thr, duk_hobject *obj,
 }
 #endif  /* DUK_USE_ES6_PROXY */
 
+/*
+ *  Rebuild a hash part from scratch (guaranteed to finish).  All keys
+ *  must be non-NULL.
+ */
+
+static void duk__rebuild_hash(duk_hstring **keys, duk_uint32_t e_used, duk_uint32_t *h, duk_uint32_t h_size) {
+	duk_uint_fast32_t i;
+
+	DUK_ASSERT(keys != NULL);
+	DUK_ASSERT(h != NULL);
+	DUK_ASSERT(h_size > 0);
+
+	/* fill h with u32 0xff = UNUSED */
+	DUK_MEMSET(h, 0xff, sizeof(duk_uint32_t) * h_size);
+
+	DUK_ASSERT(e_used <= h_size);  /* equality not actually possible */
+	for (i = 0; i < e_used; i++) {
+		duk_hstring *key = keys[i];
+		int j;  /* FIXME: typing */
+		int step;
+
+		DUK_ASSERT(key != NULL);
+		j = DUK__HASH_INITIAL(DUK_HSTRING_GET_HASH(key), h_size);
+		step = DUK__HASH_PROBE_STEP(DUK_HSTRING_GET_HASH(key));
+
+		for (;;) {
+			DUK_ASSERT(h[j] != DUK__HASH_DELETED);  /* should never happen */
+			if (h[j] == DUK__HASH_UNUSED) {
+				DUK_DDD(DUK_DDDPRINT("rebuild hit %d -> %d", j, i));
+				h[j] = i;
+				break;
+			}
+			DUK_DDD(DUK_DDDPRINT("rebuild miss %d, step %d", j, step));
+			j = (j + step) % h_size;
+
+			/* guaranteed to finish */
+			DUK_ASSERT(j != (int) DUK__HASH_INITIAL(DUK_HSTRING_GET_HASH(key), h_size));  /* FIXME: typing */
+		}
+	}
+}
+
 /*
  *  Reallocate property allocation, moving properties to the new allocation.
  *
@@ -421,6 +469,9 @@ static void duk__realloc_props(duk_hthread *thr,
 	duk_tval *new_a;
 	duk_uint32_t *new_h;
 	duk_uint32_t new_e_used;
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	duk_hshape *new_shape;
+#endif
 	duk_uint_fast32_t i;
 
 	DUK_ASSERT(thr != NULL);
@@ -441,6 +492,23 @@ static void duk__realloc_props(duk_hthread *thr,
 	/* XXX: pre checks (such as no duplicate keys) */
 #endif
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/*
+	 *  A shared tree shape is kept as is unless the array part is
+	 *  abandoned: only values are reallocated.  Tree shapes have no
+	 *  deleted keys, so compaction never moves entries, and have no
+	 *  hash part.  Otherwise the keys, flags, and hash part move to a
+	 *  new unique shape below.
+	 */
+
+	if (!abandon_array && !DUK_HSHAPE_HAS_UNIQUE(obj->shape)) {
+		DUK_ASSERT(obj->shape->e_used == obj->e_used);
+		DUK_ASSERT(obj->h_size == 0);
+		DUK_ASSERT(new_e_size >= obj->e_used);
+		new_h_size = 0;
+	}
+#endif
+
 	/*
 	 *  For property layout 1, tweak e_size to ensure that the whole entry
 	 *  part (key + val + flags) is a suitable multiple for alignment
@@ -450,7 +518,10 @@ static void duk__realloc_props(duk_hthread *thr,
 	 *  on low RAM platforms requiring alignment.
 	 */
 
-#if defined(DUK_USE_HOBJECT_LAYOUT_2) || defined(DUK_USE_HOBJECT_LAYOUT_3)
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	DUK_DDD(DUK_DDDPRINT("using shapes, no need to pad e_size: %d", (int) new_e_size));
+	new_e_size_adjusted = new_e_size;
+#elif defined(DUK_USE_HOBJECT_LAYOUT_2) || defined(DUK_USE_HOBJECT_LAYOUT_3)
 	DUK_DDD(DUK_DDDPRINT("using layout 2 or 3, no need to pad e_size: %d", (int) new_e_size));
 	new_e_size_adjusted = new_e_size;
 #elif defined(DUK_USE_HOBJECT_LAYOUT_1) && (DUK_HOBJECT_ALIGN_TARGET == 1)
@@ -556,6 +627,27 @@ static void duk__realloc_props(duk_hthread *thr,
 	           (new_e_k == NULL && new_e_pv == NULL && new_e_f == NULL &&
 	            new_a == NULL && new_h == NULL));
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* Keys, flags, and hash part go to a new unique shape (if any), which
+	 * holds its own key references.
+	 */
+	if (!abandon_array && !DUK_HSHAPE_HAS_UNIQUE(obj->shape)) {
+		new_shape = NULL;
+	} else {
+		new_shape = duk_hshape_alloc(thr->heap, new_e_size_adjusted, new_h_size, DUK_HSHAPE_FLAG_UNIQUE);
+		if (!new_shape) {
+			DUK_D(DUK_DPRINT("hobject resize failed, cannot allocate shape"));
+#ifdef DUK_USE_MARK_AND_SWEEP
+			thr->heap->mark_and_sweep_base_flags = prev_mark_and_sweep_base_flags;
+#endif
+			DUK_ERROR(thr, DUK_ERR_ALLOC_ERROR, "object resize failed (alloc/intern error)");
+		}
+		new_e_k = DUK_HSHAPE_GET_KEY_BASE(new_shape);
+		new_e_f = DUK_HSHAPE_GET_FLAGS_BASE(new_shape);
+		new_h = DUK_HSHAPE_GET_H_BASE(new_shape);
+	}
+#endif
+
 	DUK_DDD(DUK_DDDPRINT("new alloc size %d, new_e_k=%p, new_e_pv=%p, new_e_f=%p, new_a=%p, new_h=%p",
 	                     new_alloc_size, (void *) new_e_k, (void *) new_e_pv, (void *) new_e_f,
 	                     (void *) new_a, (void *) new_h));
@@ -655,6 +747,20 @@ static void duk__realloc_props(duk_hthread *thr,
 			continue;
 		}
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+		DUK_ASSERT(new_p != NULL && new_e_pv != NULL);
+
+		new_e_pv[new_e_used] = DUK_HOBJECT_E_GET_VALUE(obj, i);
+		if (new_shape != NULL) {
+			DUK_ASSERT(new_e_k != NULL && new_e_f != NULL);
+			new_e_k[new_e_used] = key;
+			new_e_f[new_e_used] = DUK_HOBJECT_E_GET_FLAGS(obj, i);
+			DUK_HSTRING_INCREF(thr, key);
+		} else {
+			DUK_ASSERT(new_e_used == i);  /* no deleted keys in tree shapes */
+		}
+		new_e_used++;
+#else
 		DUK_ASSERT(new_p != NULL && new_e_k != NULL &&
 		           new_e_pv != NULL && new_e_f != NULL);
 
@@ -662,6 +768,7 @@ static void duk__realloc_props(duk_hthread *thr,
 		new_e_pv[new_e_used] = DUK_HOBJECT_E_GET_VALUE(obj, i);
 		new_e_f[new_e_used] = DUK_HOBJECT_E_GET_FLAGS(obj, i);
 		new_e_used++;
+#endif
 	}
 	/* the entries [new_e_used, new_e_size_adjusted[ are left uninitialized on purpose (ok, not gc reachable) */
 
@@ -721,36 +828,8 @@ static void duk__realloc_props(duk_hthread *thr,
 
 	if (new_h_size > 0) {
 		DUK_ASSERT(new_h != NULL);
-
-		/* fill new_h with u32 0xff = UNUSED */
-		DUK_ASSERT(obj->p != NULL);
-		DUK_ASSERT(new_h_size > 0);
-		DUK_MEMSET(new_h, 0xff, sizeof(duk_uint32_t) * new_h_size);
-
-		DUK_ASSERT(new_e_used <= new_h_size);  /* equality not actually possible */
-		for (i = 0; i < new_e_used; i++) {
-			duk_hstring *key = new_e_k[i];
-			int j;  /* FIXME: typing */
-			int step;
-
-			DUK_ASSERT(key != NULL);
-			j = DUK__HASH_INITIAL(DUK_HSTRING_GET_HASH(key), new_h_size);
-			step = DUK__HASH_PROBE_STEP(DUK_HSTRING_GET_HASH(key));
-
-			for (;;) {
-				DUK_ASSERT(new_h[j] != DUK__HASH_DELETED);  /* should never happen */
-				if (new_h[j] == DUK__HASH_UNUSED) {
-					DUK_DDD(DUK_DDDPRINT("rebuild hit %d -> %d", j, i));
-					new_h[j] = i;
-					break;
-				}
-				DUK_DDD(DUK_DDDPRINT("rebuild miss %d, step %d", j, step));
-				j = (j + step) % new_h_size;
-
-				/* guaranteed to finish */
-				DUK_ASSERT(j != (int) DUK__HASH_INITIAL(DUK_HSTRING_GET_HASH(key), new_h_size));  /* FIXME: typing */
-			}
-		}
+		DUK_ASSERT(new_e_k != NULL);
+		duk__rebuild_hash(new_e_k, new_e_used, new_h, new_h_size);
 	} else {
 		DUK_DDD(DUK_DDDPRINT("no hash part, no rehash"));
 	}
@@ -787,6 +866,17 @@ static void duk__realloc_props(duk_hthread *thr,
 	obj->e_used = new_e_used;
 	obj->a_size = new_a_size;
 	obj->h_size = new_h_size;
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	if (new_shape != NULL) {
+		/* decref of old keys has no side effects (strings have no finalizers) */
+		duk_hshape *old_shape = obj->shape;
+		new_shape->e_used = new_e_used;
+		obj->shape = new_shape;
+		duk_hshape_decref(thr, old_shape);
+	}
+	DUK_ASSERT(obj->shape->e_used == obj->e_used);
+	DUK_ASSERT(obj->shape->h_size == obj->h_size);
+#endif
 
 	if (new_p) {
 		/*
@@ -846,6 +936,11 @@ static void duk__realloc_props(duk_hthread *thr,
 		DUK_ASSERT(new_e_k[i] != NULL);
 		DUK_HSTRING_DECREF(thr, new_e_k[i]);
 	}
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* keys were decref'd above */
+	DUK_ASSERT(new_shape != NULL);
+	duk_hshape_free_raw(thr->heap, new_shape);
+#endif
 
 #ifdef DUK_USE_MARK_AND_SWEEP
 	thr->heap->mark_and_sweep_base_flags = prev_mark_and_sweep_base_flags;
@@ -956,6 +1051,12 @@ void duk_hobject_compact_props(duk_hthread *thr, duk_hobject *obj) {
 	DUK_ASSERT(thr != NULL);
 	DUK_ASSERT(obj != NULL);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		/* ROM objects are already compact and immutable. */
+		DUK_DDD(DUK_DDDPRINT("skip compacting read-only object %p", (void *) obj));
+		return;
+	}
+
 	e_size = duk__count_used_e_keys(obj);
 	duk__compute_a_stats(obj, &a_used, &a_size);
 
@@ -988,6 +1089,87 @@ void duk_hobject_compact_props(duk_hthread *thr, duk_hobject *obj) {
 	duk__realloc_props(thr, obj, e_size, a_size, h_size, abandon_array);
 }
 
+/*
+ *  Preallocate the property table of an empty object for a known number
+ *  of entry part and array part properties, so that defining them one at
+ *  a time doesn't need to grow the allocation.  Used when restoring heap
+ *  snapshots.
+ *
+ *  The call may fail due to allocation error.
+ */
+
+void duk_hobject_prealloc_props(duk_hthread *thr, duk_hobject *obj, duk_uint32_t e_size, duk_uint32_t a_size) {
+	duk_uint32_t h_size;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(obj != NULL);
+	DUK_ASSERT(obj->e_used == 0);
+	DUK_ASSERT(a_size == 0 || DUK_HOBJECT_HAS_ARRAY_PART(obj));
+
+	if (e_size >= DUK_HOBJECT_E_USE_HASH_LIMIT) {
+		h_size = duk__get_default_h_size(e_size);
+	} else {
+		h_size = 0;
+	}
+
+	duk__realloc_props(thr, obj, e_size, a_size, h_size, 0);
+}
+
+/*
+ *  Give an object a unique shape of its own so that its keys and flags
+ *  can be modified in place.  Entry indices are preserved (no compaction)
+ *  but a hash part may be added, so callers holding a hash index must
+ *  look it up again.
+ *
+ *  The call may fail due to allocation error.
+ */
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+void duk_hobject_unshare_shape(duk_hthread *thr, duk_hobject *obj) {
+	duk_hshape *old_shape;
+	duk_hshape *new_shape;
+	duk_hstring **keys;
+	duk_uint32_t h_size;
+	duk_uint_fast32_t i;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(obj != NULL);
+
+	old_shape = obj->shape;
+	DUK_ASSERT(old_shape != NULL);
+	DUK_ASSERT(!DUK_HSHAPE_HAS_UNIQUE(old_shape));
+	DUK_ASSERT(old_shape->e_used == obj->e_used);
+	DUK_ASSERT(obj->e_used <= obj->e_size);
+
+	h_size = duk__get_default_h_size(obj->e_size);
+	new_shape = duk_hshape_alloc(thr->heap, obj->e_size, h_size, DUK_HSHAPE_FLAG_UNIQUE);
+	if (!new_shape) {
+		DUK_ERROR(thr, DUK_ERR_ALLOC_ERROR, "shape alloc failed");
+	}
+
+	keys = DUK_HSHAPE_GET_KEY_BASE(new_shape);
+	if (obj->e_used > 0) {
+		DUK_MEMCPY((void *) keys, (void *) DUK_HSHAPE_GET_KEY_BASE(old_shape), sizeof(duk_hstring *) * obj->e_used);
+		DUK_MEMCPY((void *) DUK_HSHAPE_GET_FLAGS_BASE(new_shape), (void *) DUK_HSHAPE_GET_FLAGS_BASE(old_shape), sizeof(duk_uint8_t) * obj->e_used);
+	}
+	for (i = 0; i < obj->e_used; i++) {
+		DUK_HSTRING_INCREF(thr, keys[i]);
+	}
+	new_shape->e_used = obj->e_used;
+	if (h_size > 0) {
+		duk__rebuild_hash(keys, obj->e_used, DUK_HSHAPE_GET_H_BASE(new_shape), h_size);
+	}
+
+	DUK_DDD(DUK_DDDPRINT("unshared shape of object %p: %p -> %p, e_size=%d, e_used=%d, h_size=%d",
+	                     (void *) obj, (void *) old_shape, (void *) new_shape,
+	                     (int) obj->e_size, (int) obj->e_used, (int) h_size));
+
+	obj->shape = new_shape;
+	obj->h_size = h_size;
+	duk_hshape_decref(thr, old_shape);
+}
+#endif  /* DUK_USE_HOBJECT_SHAPES */
+
 /*
  *  Find an existing key from entry part either by linear scan or by
  *  using the hash index (if it exists).
@@ -1124,17 +1306,23 @@ duk_tval *duk_hobject_find_existing_array_entry_tval_ptr(duk_hobject *obj, duk_u
  *  Allocate and initialize a new entry, resizing the properties allocation
  *  if necessary.  Returns entry index (e_idx) or throws an error if alloc fails.
  *
- *  Sets the key of the entry (increasing the key's refcount), and updates
- *  the hash part if it exists.  Caller must set value and flags, and update
- *  the entry value refcount.  A decref for the previous value is not necessary.
+ *  Sets the key of the entry (increasing the key's refcount) and its flags,
+ *  and updates the hash part if it exists.  Caller must set the value and
+ *  update the entry value refcount.  A decref for the previous value is not
+ *  necessary.
+ *
+ *  With shapes, the key and flags are set by transitioning to a child shape
+ *  instead, unless the object already has a unique shape or would get too
+ *  many keys for a tree shape.
  */
 
-static int duk__alloc_entry_checked(duk_hthread *thr, duk_hobject *obj, duk_hstring *key) {
+static int duk__alloc_entry_checked(duk_hthread *thr, duk_hobject *obj, duk_hstring *key, duk_small_int_t propflags) {
 	duk_uint32_t idx;
 
 	DUK_ASSERT(thr != NULL);
 	DUK_ASSERT(obj != NULL);
 	DUK_ASSERT(key != NULL);
+	DUK_ASSERT((propflags & ~DUK_PROPDESC_FLAGS_MASK) == 0);
 	DUK_ASSERT(obj->e_used <= obj->e_size);
 
 #ifdef DUK_USE_ASSERTIONS
@@ -1153,10 +1341,29 @@ static int duk__alloc_entry_checked(duk_hthread *thr, duk_hobject *obj, duk_hstr
 		duk__grow_props_for_new_entry_item(thr, obj);
 	}
 	DUK_ASSERT(obj->e_used < obj->e_size);
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	if (!DUK_HSHAPE_HAS_UNIQUE(obj->shape)) {
+		if (obj->e_used < DUK_HSHAPE_TREE_MAX_KEYS) {
+			duk_hshape *old_shape = obj->shape;
+
+			obj->shape = duk_hshape_transition(thr, old_shape, key, propflags);
+			duk_hshape_decref(thr, old_shape);  /* child keeps it alive */
+			idx = obj->e_used++;
+			DUK_ASSERT(obj->shape->e_used == obj->e_used);
+			DUK_ASSERT(DUK_HOBJECT_E_GET_KEY(obj, idx) == key);
+			return idx;
+		}
+		DUK_DDD(DUK_DDDPRINT("too many keys for a tree shape, unshare"));
+		duk_hobject_unshare_shape(thr, obj);
+	}
+	obj->shape->e_used++;
+#endif
 	idx = obj->e_used++;
 
 	/* previous value is assumed to be garbage, so don't touch it */
 	DUK_HOBJECT_E_SET_KEY(obj, idx, key);
+	DUK_HOBJECT_E_SET_FLAGS(obj, idx, propflags);
 	DUK_HSTRING_INCREF(thr, key);
 
 	if (obj->h_size > 0) {
@@ -2159,6 +2366,36 @@ int duk_hobject_getprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key) {
 		break;
 	}
 
+	/* Lightfunc has virtual 'length' and 'name' properties, other
+	 * properties are inherited from Function.prototype.
+	 */
+	case DUK_TAG_LIGHTFUNC: {
+		duk_small_int_t lf_flags = DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv_obj);
+
+		arr_idx = duk__push_tval_to_hstring_arr_idx(ctx, tv_key, &key);
+		DUK_ASSERT(key != NULL);
+
+		if (key == DUK_HTHREAD_STRING_LENGTH(thr)) {
+			duk_pop(ctx);  /* [key] -> [] */
+			duk_push_int(ctx, DUK_LFUNC_FLAGS_GET_LENGTH(lf_flags));  /* [] -> [res] */
+
+			DUK_DDD(DUK_DDDPRINT("-> %!T (base is lightfunc, key is 'length')",
+			                     duk_get_tval(ctx, -1)));
+			return 1;
+		} else if (key == DUK_HTHREAD_STRING_NAME(thr)) {
+			duk_pop(ctx);  /* [key] -> [] */
+			duk_push_lightfunc_name(ctx, tv_obj);  /* [] -> [res] */
+
+			DUK_DDD(DUK_DDDPRINT("-> %!T (base is lightfunc, key is 'name')",
+			                     duk_get_tval(ctx, -1)));
+			return 1;
+		}
+
+		DUK_DDD(DUK_DDDPRINT("base object is a lightfunc, start lookup from function prototype"));
+		curr = thr->builtins[DUK_BIDX_FUNCTION_PROTOTYPE];
+		goto lookup;  /* avoid double coercion */
+	}
+
 	default: {
 		/* number */
 		DUK_DDD(DUK_DDDPRINT("base object is a number, start lookup from number prototype"));
@@ -2286,6 +2523,192 @@ int duk_hobject_getprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key) {
 	return 1;
 }
 
+/*
+ *  GETPROP/PUTPROP inline cache lookups for the bytecode executor.
+ *
+ *  Covers the common case of a plain object base value, a non-array-index
+ *  string key, and a data property in the entry part of the base object
+ *  (or an object in its prototype chain for reads).  The caller provides
+ *  the inline cache entries of the current bytecode instruction.  Cached
+ *  entries are validated against the actual objects on every use, so a
+ *  hit is always equivalent to a full lookup.  On a miss the property is
+ *  looked up (without side effects) and the cache is refilled.
+ *
+ *  NULL is returned whenever the full semantics might be needed (accessors,
+ *  exotic behavior, property not found, etc); the caller then falls back
+ *  to duk_hobject_getprop() / duk_hobject_putprop().  The returned value
+ *  pointer is only valid until the next side effect.
+ */
+
+#if defined(DUK_USE_PROPERTY_IC)
+
+/* Objects with these flags may have virtual properties or Proxy traps
+ * for non-array-index keys, so their lookups are never cached.
+ */
+#define DUK__IC_UNCACHEABLE_FLAGS  (DUK_HOBJECT_FLAG_EXOTIC_STRINGOBJ | \
+                                    DUK_HOBJECT_FLAG_EXOTIC_DUKFUNC | \
+                                    DUK_HOBJECT_FLAG_EXOTIC_BUFFEROBJ | \
+                                    DUK_HOBJECT_FLAG_EXOTIC_PROXYOBJ)
+#define DUK__IC_CACHEABLE(obj)     ((DUK_HEAPHDR_GET_FLAGS(&(obj)->hdr) & DUK__IC_UNCACHEABLE_FLAGS) == 0)
+
+/* Validate a cache entry: returns the holder object and its entry part
+ * index in 'out_holder', or -1 if the entry does not match.
+ */
+static duk_int_t duk__ic_check(duk_hobject *obj, duk_hstring *key, duk_uint_fast16_t ent, duk_hobject **out_holder) {
+	duk_uint_fast32_t depth;
+	duk_uint_fast32_t e_idx;
+	int tmp_e_idx;
+	int tmp_h_idx;
+
+	depth = DUK_HOBJECT_IC_GET_DEPTH(ent);
+	e_idx = DUK_HOBJECT_IC_GET_EIDX(ent);
+
+	/* Objects below the holder must not have the property. */
+	while (depth > 0) {
+		if (!DUK__IC_CACHEABLE(obj)) {
+			return -1;
+		}
+		duk_hobject_find_existing_entry(obj, key, &tmp_e_idx, &tmp_h_idx);
+		if (tmp_e_idx >= 0) {
+			return -1;
+		}
+		obj = obj->prototype;
+		if (obj == NULL) {
+			return -1;
+		}
+		depth--;
+	}
+
+	if (DUK__IC_CACHEABLE(obj) &&
+	    e_idx < obj->e_used &&
+	    DUK_HOBJECT_E_GET_KEY(obj, e_idx) == key &&
+	    !DUK_HOBJECT_E_SLOT_IS_ACCESSOR(obj, e_idx)) {
+		*out_holder = obj;
+		return (duk_int_t) e_idx;
+	}
+	return -1;
+}
+
+static void duk__ic_insert(duk_uint16_t *ic, duk_uint_fast32_t depth, int e_idx) {
+	duk_small_int_t i;
+
+	if (depth > DUK_HOBJECT_IC_MAX_DEPTH || (duk_uint_fast32_t) e_idx > DUK_HOBJECT_IC_MAX_EIDX) {
+		return;
+	}
+
+	/* most recent entry first */
+	for (i = DUK_HCOMPILEDFUNCTION_IC_WAYS - 1; i > 0; i--) {
+		ic[i] = ic[i - 1];
+	}
+	ic[0] = DUK_HOBJECT_IC_ENCODE(depth, e_idx);
+}
+
+duk_tval *duk_hobject_getprop_ic(duk_hthread *thr, duk_hobject *obj, duk_hstring *key, duk_uint16_t *ic) {
+	duk_hobject *curr;
+	duk_small_int_t i;
+	duk_uint_fast32_t depth;
+	int e_idx;
+	int h_idx;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(obj != NULL);
+	DUK_ASSERT(key != NULL);
+	DUK_ASSERT(ic != NULL);
+	DUK_UNREF(thr);
+
+	if (DUK_HSTRING_HAS_ARRIDX(key)) {
+		return NULL;
+	}
+#if !defined(DUK_USE_NONSTD_FUNC_CALLER_PROPERTY)
+	if (key == DUK_HTHREAD_STRING_CALLER(thr)) {
+		/* needs the 'caller' post-check of duk_hobject_getprop() */
+		return NULL;
+	}
+#endif
+
+	for (i = 0; i < DUK_HCOMPILEDFUNCTION_IC_WAYS; i++) {
+		if (ic[i] == DUK_HOBJECT_IC_EMPTY) {
+			break;
+		}
+		e_idx = duk__ic_check(obj, key, ic[i], &curr);
+		if (e_idx >= 0) {
+			DUK_DDD(DUK_DDDPRINT("getprop ic hit: key=%!O, ent=0x%04x", key, (int) ic[i]));
+			return DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(curr, e_idx);
+		}
+	}
+
+	curr = obj;
+	depth = 0;
+	do {
+		if (!DUK__IC_CACHEABLE(curr) || depth > DUK_HOBJECT_IC_MAX_DEPTH) {
+			return NULL;
+		}
+		duk_hobject_find_existing_entry(curr, key, &e_idx, &h_idx);
+		if (e_idx >= 0) {
+			if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(curr, e_idx)) {
+				return NULL;
+			}
+			DUK_DDD(DUK_DDDPRINT("getprop ic miss: key=%!O, refill depth=%d, e_idx=%d", key, (int) depth, e_idx));
+			duk__ic_insert(ic, depth, e_idx);
+			return DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(curr, e_idx);
+		}
+		curr = curr->prototype;
+		depth++;
+	} while (curr != NULL);
+
+	return NULL;
+}
+
+duk_tval *duk_hobject_putprop_ic(duk_hthread *thr, duk_hobject *obj, duk_hstring *key, duk_uint16_t *ic) {
+	duk_hobject *holder;
+	duk_small_int_t i;
+	int e_idx;
+	int h_idx;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(obj != NULL);
+	DUK_ASSERT(key != NULL);
+	DUK_ASSERT(ic != NULL);
+
+	if (DUK_HSTRING_HAS_ARRIDX(key) ||
+	    DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj) ||
+	    (DUK_HOBJECT_HAS_EXOTIC_ARRAY(obj) && key == DUK_HTHREAD_STRING_LENGTH(thr))) {
+		return NULL;
+	}
+
+	/* Only own properties are cached (depth 0), so a hit always has
+	 * obj as the holder.
+	 */
+	for (i = 0; i < DUK_HCOMPILEDFUNCTION_IC_WAYS; i++) {
+		if (ic[i] == DUK_HOBJECT_IC_EMPTY) {
+			break;
+		}
+		e_idx = duk__ic_check(obj, key, ic[i], &holder);
+		if (e_idx >= 0) {
+			DUK_ASSERT(holder == obj);
+			if (!DUK_HOBJECT_E_SLOT_IS_WRITABLE(obj, e_idx)) {
+				return NULL;
+			}
+			DUK_DDD(DUK_DDDPRINT("putprop ic hit: key=%!O, ent=0x%04x", key, (int) ic[i]));
+			return DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, e_idx);
+		}
+	}
+
+	if (!DUK__IC_CACHEABLE(obj)) {
+		return NULL;
+	}
+	duk_hobject_find_existing_entry(obj, key, &e_idx, &h_idx);
+	if (e_idx < 0 ||
+	    (DUK_HOBJECT_E_GET_FLAGS(obj, e_idx) & (DUK_PROPDESC_FLAG_ACCESSOR | DUK_PROPDESC_FLAG_WRITABLE)) != DUK_PROPDESC_FLAG_WRITABLE) {
+		return NULL;
+	}
+	DUK_DDD(DUK_DDDPRINT("putprop ic miss: key=%!O, refill e_idx=%d", key, e_idx));
+	duk__ic_insert(ic, 0, e_idx);
+	return DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, e_idx);
+}
+
+#endif  /* DUK_USE_PROPERTY_IC */
+
 /*
  *  HASPROP: Ecmascript property existence check ("in" operator).
  *
@@ -2314,6 +2737,22 @@ int duk_hobject_hasprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key) {
 	DUK_TVAL_SET_TVAL(&tv_key_copy, tv_key);
 	tv_key = &tv_key_copy;
 
+	if (DUK_TVAL_IS_LIGHTFUNC(tv_obj)) {
+		/* Lightfunc has virtual 'length' and 'name', other properties
+		 * are inherited from Function.prototype.
+		 */
+		arr_idx = duk__push_tval_to_hstring_arr_idx(ctx, tv_key, &key);
+		DUK_ASSERT(key != NULL);
+		DUK_UNREF(arr_idx);
+
+		if (key == DUK_HTHREAD_STRING_LENGTH(thr) ||
+		    key == DUK_HTHREAD_STRING_NAME(thr)) {
+			duk_pop(ctx);  /* [ key ] -> [] */
+			return 1;
+		}
+		obj = thr->builtins[DUK_BIDX_FUNCTION_PROTOTYPE];
+		goto lookup;
+	}
 	if (!DUK_TVAL_IS_OBJECT(tv_obj)) {
 		/* Note: unconditional throw */
 		DUK_DDD(DUK_DDDPRINT("base object is not an object -> reject"));
@@ -2377,6 +2816,7 @@ int duk_hobject_hasprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key) {
 
 	/* XXX: inline into a prototype walking loop? */
 
+ lookup:
 	rc = duk__get_property_desc(thr, obj, key, &desc, 0);  /* push_value = 0 */
 
 	duk_pop(ctx);  /* [ key ] -> [] */
@@ -2691,7 +3131,7 @@ static int duk__handle_put_array_length(duk_hthread *thr, duk_hobject *obj) {
 		DUK_ASSERT(!DUK_HOBJECT_E_SLOT_IS_ACCESSOR(obj, desc.e_idx));
 		tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, desc.e_idx);
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
-		DUK_TVAL_SET_NUMBER(tv, (double) new_len);  /* no decref needed for a number */
+		DUK_TVAL_SET_NUMBER_CHKFAST(tv, (double) new_len);  /* no decref needed for a number */
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
 		return 1;
 	}
@@ -2713,7 +3153,7 @@ static int duk__handle_put_array_length(duk_hthread *thr, duk_hobject *obj) {
 	DUK_ASSERT(!DUK_HOBJECT_E_SLOT_IS_ACCESSOR(obj, desc.e_idx));
 	tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, desc.e_idx);
 	DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
-	DUK_TVAL_SET_NUMBER(tv, (double) result_len);  /* no decref needed for a number */
+	DUK_TVAL_SET_NUMBER_CHKFAST(tv, (double) result_len);  /* no decref needed for a number */
 	DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
 
 	/*
@@ -2967,6 +3407,25 @@ int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, du
 		break;
 	}
 
+	case DUK_TAG_LIGHTFUNC: {
+		/* All lightfunc own properties are non-writable and the lightfunc
+		 * is considered non-extensible.  However, the write may be captured
+		 * by an inherited setter which means we can't stop the lookup here.
+		 */
+
+		arr_idx = duk__push_tval_to_hstring_arr_idx(ctx, tv_key, &key);
+		DUK_ASSERT(key != NULL);
+
+		if (key == DUK_HTHREAD_STRING_LENGTH(thr) ||
+		    key == DUK_HTHREAD_STRING_NAME(thr)) {
+			goto fail_not_writable;
+		}
+
+		DUK_DDD(DUK_DDDPRINT("base object is a lightfunc, start lookup from function prototype"));
+		curr = thr->builtins[DUK_BIDX_FUNCTION_PROTOTYPE];
+		goto lookup;  /* avoid double coercion */
+	}
+
 	default: {
 		/* number */
 		DUK_DDD(DUK_DDDPRINT("base object is a number, start lookup from number prototype"));
@@ -3128,6 +3587,10 @@ int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, du
 
 	DUK_ASSERT(orig != NULL);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) orig)) {
+		goto fail_readonly;
+	}
+
 	/* Although there are writable virtual properties (e.g. plain buffer
 	 * and buffer object number indices), they are handled before we come
 	 * here.
@@ -3217,6 +3680,10 @@ int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, du
 
 	DUK_ASSERT(orig != NULL);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) orig)) {
+		goto fail_readonly;
+	}
+
 	/* Not possible because array object 'length' is present
 	 * from its creation and cannot be deleted, and is thus
 	 * caught as an existing property above.
@@ -3368,14 +3835,13 @@ int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, du
 	 * refcount; may need a props allocation resize but doesn't
 	 * 'recheck' the valstack.
 	 */
-	e_idx = duk__alloc_entry_checked(thr, orig, key);
+	e_idx = duk__alloc_entry_checked(thr, orig, key, DUK_PROPDESC_FLAGS_WEC);
 	DUK_ASSERT(e_idx >= 0);
 
 	tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(orig, e_idx);
 	/* prev value can be garbage, no decref */
 	DUK_TVAL_SET_TVAL(tv, tv_val);
 	DUK_TVAL_INCREF(thr, tv);
-	DUK_HOBJECT_E_SET_FLAGS(orig, e_idx, DUK_PROPDESC_FLAGS_WEC);
 	goto entry_updated;
 
  entry_updated:
@@ -3403,7 +3869,7 @@ int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, du
 
 		tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(orig, desc.e_idx);
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
-		DUK_TVAL_SET_NUMBER(tv, (double) new_array_length);  /* no need for decref/incref because value is a number */
+		DUK_TVAL_SET_NUMBER_CHKFAST(tv, (double) new_array_length);  /* no need for decref/incref because value is a number */
 	}
 
 	/*
@@ -3488,6 +3954,15 @@ int duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, du
 	duk_pop(ctx);  /* remove key */
 	return 0;
 
+ fail_readonly:
+	/* ROM objects reject all writes, regardless of property attributes. */
+	DUK_DDD(DUK_DDDPRINT("result: error, object is read-only"));
+	if (throw_flag) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "object is read-only");
+	}
+	duk_pop(ctx);  /* remove key */
+	return 0;
+
  fail_array_length_partial:
 	DUK_DDD(DUK_DDDPRINT("result: error, array length write only partially successful"));
 	if (throw_flag) {
@@ -3545,6 +4020,9 @@ int duk_hobject_delprop_raw(duk_hthread *thr, duk_hobject *obj, duk_hstring *key
 	if ((desc.flags & DUK_PROPDESC_FLAG_CONFIGURABLE) == 0) {
 		goto fail_not_configurable;
 	}
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		goto fail_readonly;
+	}
 
 	/* currently there are no deletable virtual properties */
 	DUK_ASSERT(desc.a_idx >= 0 || desc.e_idx >= 0);
@@ -3560,6 +4038,15 @@ int duk_hobject_delprop_raw(duk_hthread *thr, duk_hobject *obj, duk_hstring *key
 	} else {
 		DUK_ASSERT(desc.a_idx < 0);
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+		/* deleting leaves a hole in the keys, which needs a unique shape */
+		if (!DUK_HSHAPE_HAS_UNIQUE(obj->shape)) {
+			duk_hobject_unshare_shape(thr, obj);
+			duk_hobject_find_existing_entry(obj, key, &desc.e_idx, &desc.h_idx);
+			DUK_ASSERT(desc.e_idx >= 0);
+		}
+#endif
+
 		/* remove hash entry (no decref) */
 		if (desc.h_idx >= 0) {
 			duk_uint32_t *h_base = DUK_HOBJECT_H_GET_BASE(obj);
@@ -3644,6 +4131,14 @@ int duk_hobject_delprop_raw(duk_hthread *thr, duk_hobject *obj, duk_hstring *key
 		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "property not configurable");
 	}
 	return 0;
+
+ fail_readonly:
+	DUK_DDD(DUK_DDDPRINT("delete failed: object is read-only"));
+
+	if (throw_flag) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "object is read-only");
+	}
+	return 0;
 }
 
 
@@ -3763,6 +4258,19 @@ int duk_hobject_delprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, in
 		    arr_idx < DUK_HSTRING_GET_CHARLEN(h)) {
 			goto fail_not_configurable;
 		}
+	} else if (DUK_TVAL_IS_LIGHTFUNC(tv_obj)) {
+		/* Lightfunc virtual properties are non-configurable, so
+		 * reject if match any of them.
+		 */
+
+		duk_to_string(ctx, -1);
+		key = duk_get_hstring(ctx, -1);
+		DUK_ASSERT(key != NULL);
+
+		if (key == DUK_HTHREAD_STRING_LENGTH(thr) ||
+		    key == DUK_HTHREAD_STRING_NAME(thr)) {
+			goto fail_not_configurable;
+		}
 	}
 	/* FIXME: buffer virtual properties? */
 
@@ -3835,6 +4343,10 @@ void duk_hobject_define_property_internal(duk_hthread *thr, duk_hobject *obj, du
 	DUK_ASSERT_VALSTACK_SPACE(thr, DUK__VALSTACK_SPACE);
 	DUK_ASSERT(duk_is_valid_index(ctx, -1));  /* contains value */
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "object is read-only");
+	}
+
 	arr_idx = DUK_HSTRING_GET_ARRIDX_SLOW(key);
 
 	if (duk__get_own_property_desc_raw(thr, obj, key, arr_idx, &desc, 0)) {  /* push_value = 0 */
@@ -3849,7 +4361,7 @@ void duk_hobject_define_property_internal(duk_hthread *thr, duk_hobject *obj, du
 				goto error_internal;
 			}
 
-			DUK_HOBJECT_E_SET_FLAGS(obj, desc.e_idx, propflags);
+			DUK_HOBJECT_E_UPDATE_FLAGS(thr, obj, desc.e_idx, propflags);
 			tv1 = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, desc.e_idx);
 		} else if (desc.a_idx >= 0) {
 			if (flags & DUK_PROPDESC_FLAG_NO_OVERWRITE) {
@@ -3892,9 +4404,8 @@ void duk_hobject_define_property_internal(duk_hthread *thr, duk_hobject *obj, du
 	}
 
 	DUK_DDD(DUK_DDDPRINT("property does not exist, object belongs in entry part -> allocate new entry and write value and attributes"));
-	e_idx = duk__alloc_entry_checked(thr, obj, key);  /* increases key refcount */
+	e_idx = duk__alloc_entry_checked(thr, obj, key, propflags);  /* increases key refcount */
 	DUK_ASSERT(e_idx >= 0);
-	DUK_HOBJECT_E_SET_FLAGS(obj, e_idx, propflags);
 	tv1 = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, e_idx);
 	/* new entry: previous value is garbage; set to undefined to share write_value */
 	DUK_TVAL_SET_UNDEFINED_ACTUAL(tv1);
@@ -3944,6 +4455,10 @@ void duk_hobject_define_property_internal_arridx(duk_hthread *thr, duk_hobject *
 	DUK_ASSERT(thr->heap != NULL);
 	DUK_ASSERT(obj != NULL);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "object is read-only");
+	}
+
 	if (DUK_HOBJECT_HAS_ARRAY_PART(obj) &&
 	    arr_idx != DUK__NO_ARRAY_INDEX &&
 	    flags == DUK_PROPDESC_FLAGS_WEC) {
@@ -4015,6 +4530,7 @@ void duk_hobject_define_accessor_internal(duk_hthread *thr, duk_hobject *obj, du
 	DUK_ASSERT(e_idx < (int) obj->e_used);  /* FIXME: e_idx typing */
 
 	/* no need to decref, as previous value is 'undefined' */
+	DUK_HOBJECT_E_UNSHARE(thr, obj);
 	DUK_HOBJECT_E_SLOT_SET_ACCESSOR(obj, e_idx);
 	DUK_HOBJECT_E_SET_VALUE_GETTER(obj, e_idx, getter);
 	DUK_HOBJECT_E_SET_VALUE_SETTER(obj, e_idx, setter);
@@ -4287,6 +4803,10 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 	DUK_ASSERT(key != NULL);
 	DUK_ASSERT(desc != NULL);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "object is read-only");
+	}
+
 	arr_idx = DUK_HSTRING_GET_ARRIDX_SLOW(key);
 
 	DUK_DDD(DUK_DDDPRINT("Object.defineProperty(): thr=%p obj=%!O key=%!O arr_idx=0x%08x desc=%!O",
@@ -4515,15 +5035,13 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 			}
 
 			/* write to entry part */
-			e_idx = duk__alloc_entry_checked(thr, obj, key);
+			e_idx = duk__alloc_entry_checked(thr, obj, key, new_flags);
 			DUK_ASSERT(e_idx >= 0);
 
 			DUK_HOBJECT_E_SET_VALUE_GETTER(obj, e_idx, get);
 			DUK_HOBJECT_E_SET_VALUE_SETTER(obj, e_idx, set);
 			DUK_HOBJECT_INCREF(thr, get);
 			DUK_HOBJECT_INCREF(thr, set);
-
-			DUK_HOBJECT_E_SET_FLAGS(obj, e_idx, new_flags);
 			goto success_exotics;
 		} else {
 			int e_idx;
@@ -4568,13 +5086,11 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 			}
 
 			/* write to entry part */
-			e_idx = duk__alloc_entry_checked(thr, obj, key);
+			e_idx = duk__alloc_entry_checked(thr, obj, key, new_flags);
 			DUK_ASSERT(e_idx >= 0);
 			tv2 = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, e_idx);
 			DUK_TVAL_SET_TVAL(tv2, &tv);
 			DUK_TVAL_INCREF(thr, tv2);
-
-			DUK_HOBJECT_E_SET_FLAGS(obj, e_idx, new_flags);
 			goto success_exotics;
 		}
 		DUK_UNREACHABLE();
@@ -4747,6 +5263,7 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 
 			DUK_HOBJECT_E_SET_VALUE_GETTER(obj, curr.e_idx, NULL);
 			DUK_HOBJECT_E_SET_VALUE_SETTER(obj, curr.e_idx, NULL);
+			DUK_HOBJECT_E_UNSHARE(thr, obj);
 			DUK_HOBJECT_E_SLOT_CLEAR_WRITABLE(obj, curr.e_idx);
 			DUK_HOBJECT_E_SLOT_SET_ACCESSOR(obj, curr.e_idx);
 
@@ -4788,6 +5305,7 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 			DUK_HOBJECT_DECREF(thr, tmp);
 
 			DUK_TVAL_SET_UNDEFINED_ACTUAL(DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, curr.e_idx));
+			DUK_HOBJECT_E_UNSHARE(thr, obj);
 			DUK_HOBJECT_E_SLOT_CLEAR_WRITABLE(obj, curr.e_idx);
 			DUK_HOBJECT_E_SLOT_CLEAR_ACCESSOR(obj, curr.e_idx);
 
@@ -4901,7 +5419,7 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 	DUK_ASSERT(curr.e_idx >= 0 && curr.a_idx < 0);
 
 	DUK_DDD(DUK_DDDPRINT("update existing property attributes"));
-	DUK_HOBJECT_E_SET_FLAGS(obj, curr.e_idx, new_flags);
+	DUK_HOBJECT_E_UPDATE_FLAGS(thr, obj, curr.e_idx, new_flags);
 
 	if (has_set) {
 		duk_hobject *tmp;
@@ -4980,7 +5498,7 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 
 			tmp = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, curr.e_idx);
 			DUK_ASSERT(DUK_TVAL_IS_NUMBER(tmp));
-			DUK_TVAL_SET_NUMBER(tmp, (double) arridx_new_array_length);  /* no need for decref/incref because value is a number */
+			DUK_TVAL_SET_NUMBER_CHKFAST(tmp, (double) arridx_new_array_length);  /* no need for decref/incref because value is a number */
 		}
 		if (key == DUK_HTHREAD_STRING_LENGTH(thr) && arrlen_new_len < arrlen_old_len) {
 			/*
@@ -5011,11 +5529,12 @@ int duk_hobject_object_define_property(duk_context *ctx) {
 			DUK_ASSERT(!DUK_HOBJECT_E_SLOT_IS_ACCESSOR(obj, curr.e_idx));
 			tmp = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(obj, curr.e_idx);
 			DUK_ASSERT(DUK_TVAL_IS_NUMBER(tmp));
-			DUK_TVAL_SET_NUMBER(tmp, (double) result_len);  /* no decref needed for a number */
+			DUK_TVAL_SET_NUMBER_CHKFAST(tmp, (double) result_len);  /* no decref needed for a number */
 			DUK_ASSERT(DUK_TVAL_IS_NUMBER(tmp));
 
 			if (pending_write_protect) {
 				DUK_DDD(DUK_DDDPRINT("setting array length non-writable (pending writability update)"));
+				DUK_HOBJECT_E_UNSHARE(thr, obj);
 				DUK_HOBJECT_E_SLOT_CLEAR_WRITABLE(obj, curr.e_idx);
 			}
 
@@ -5255,6 +5774,10 @@ void duk_hobject_object_seal_freeze_helper(duk_hthread *thr, duk_hobject *obj, i
 
 	DUK_ASSERT_VALSTACK_SPACE(thr, DUK__VALSTACK_SPACE);
 
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "object is read-only");
+	}
+
 	/*
 	 *  Abandon array part because all properties must become non-configurable.
 	 *  Note that this is now done regardless of whether this is always the case
@@ -5264,6 +5787,9 @@ void duk_hobject_object_seal_freeze_helper(duk_hthread *thr, duk_hobject *obj, i
 
 	duk__abandon_array_checked(thr, obj);
 	DUK_ASSERT(obj->a_size == 0);
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	DUK_ASSERT(DUK_HSHAPE_HAS_UNIQUE(obj->shape));  /* abandoning the array part always unshares */
+#endif
 
 	for (i = 0; i < obj->e_used; i++) {
 		duk_uint8_t *fp;
@@ -0,0 +1,219 @@
+/*
+ *  Shared property shapes (DUK_USE_HOBJECT_SHAPES).
+ *
+ *  A shape holds the ordered entry part keys and their attribute flags,
+ *  and for large objects the hash part.  Objects created the same way
+ *  (same keys added in the same order with the same attributes) share
+ *  a single shape through a transition tree rooted at heap->shape_root,
+ *  and only store their values.
+ *
+ *  Shapes are reference counted manually regardless of whether heap
+ *  reference counting is enabled: each object holds one reference to
+ *  its shape and each tree shape holds one reference to its parent.
+ *  Child and sibling links are weak; a shape unlinks itself from its
+ *  parent when freed.  Tree shapes hold counted references to their
+ *  keys, so keys stay reachable for mark-and-sweep through any object
+ *  using the shape (or one of its descendants, which has a superset of
+ *  the keys).
+ *
+ *  Operations which modify keys or flags in place (other than appending)
+ *  go through duk_hobject_unshare_shape() in duk_hobject_props.c, which
+ *  gives the object a unique shape of its own.
+ */
+
+#include "duk_internal.h"
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+
+/*
+ *  Allocate a shape with room for 'e_size' keys and a hash part of
+ *  'h_size' entries.  The shape is returned with a refcount of 1 and no
+ *  keys; the hash part (if any) is initialized to unused.  Returns NULL
+ *  on allocation failure.
+ *
+ *  The allocation may trigger a mark-and-sweep; finalizers and object
+ *  compaction are prevented so that the object whose shape is being
+ *  changed is not modified from underneath the caller.
+ */
+
+duk_hshape *duk_hshape_alloc(duk_heap *heap, duk_uint32_t e_size, duk_uint32_t h_size, duk_small_uint_t flags) {
+#ifdef DUK_USE_MARK_AND_SWEEP
+	int prev_mark_and_sweep_base_flags;
+#endif
+	duk_hshape *res;
+
+	DUK_ASSERT(heap != NULL);
+
+#ifdef DUK_USE_MARK_AND_SWEEP
+	prev_mark_and_sweep_base_flags = heap->mark_and_sweep_base_flags;
+	heap->mark_and_sweep_base_flags |=
+	        DUK_MS_FLAG_NO_FINALIZERS |         /* avoid attempts to add/remove object keys */
+	        DUK_MS_FLAG_NO_OBJECT_COMPACTION;   /* avoid attempt to compact the current object */
+#endif
+
+	res = (duk_hshape *) DUK_ALLOC(heap, DUK_HSHAPE_COMPUTE_SIZE(e_size, h_size));
+
+#ifdef DUK_USE_MARK_AND_SWEEP
+	heap->mark_and_sweep_base_flags = prev_mark_and_sweep_base_flags;
+#endif
+
+	if (!res) {
+		return NULL;
+	}
+	DUK_MEMZERO(res, sizeof(duk_hshape));
+
+#ifdef DUK_USE_EXPLICIT_NULL_INIT
+	res->parent = NULL;
+	res->child = NULL;
+	res->next = NULL;
+#endif
+	res->refcount = 1;
+	res->e_size = e_size;
+	res->e_used = 0;
+	res->h_size = h_size;
+	res->flags = flags;
+
+	if (h_size > 0) {
+		/* fill with u32 0xff = UNUSED */
+		DUK_MEMSET(DUK_HSHAPE_GET_H_BASE(res), 0xff, sizeof(duk_uint32_t) * h_size);
+	}
+
+	DUK_DDD(DUK_DDDPRINT("allocated shape %p, e_size=%d, h_size=%d, flags=0x%02x",
+	                     (void *) res, (int) e_size, (int) h_size, (int) flags));
+	return res;
+}
+
+/*
+ *  Find or create the child of a tree shape for a new key with the given
+ *  attribute flags.  The child is returned with an added reference for
+ *  the caller; the caller remains responsible for its reference to
+ *  'shape'.
+ *
+ *  Children are kept in most recently used order so that objects created
+ *  repeatedly by the same code find their transitions quickly.
+ */
+
+duk_hshape *duk_hshape_transition(duk_hthread *thr, duk_hshape *shape, duk_hstring *key, duk_small_uint_t propflags) {
+	duk_hshape *res;
+	duk_hshape *prev;
+	duk_hstring **keys;
+	duk_uint8_t *flags;
+	duk_uint_fast32_t i;
+	duk_uint32_t n;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(shape != NULL);
+	DUK_ASSERT(key != NULL);
+	DUK_ASSERT(!DUK_HSHAPE_HAS_UNIQUE(shape));
+	DUK_ASSERT(shape->e_used == shape->e_size);
+	DUK_ASSERT(shape->h_size == 0);
+
+	n = shape->e_used;
+
+	prev = NULL;
+	for (res = shape->child; res != NULL; res = res->next) {
+		DUK_ASSERT(res->parent == shape);
+		DUK_ASSERT(res->e_used == n + 1);
+		if (DUK_HSHAPE_GET_KEY_BASE(res)[n] == key &&
+		    DUK_HSHAPE_GET_FLAGS_BASE(res)[n] == propflags) {
+			DUK_DDD(DUK_DDDPRINT("shape transition hit: %p -> %p", (void *) shape, (void *) res));
+			if (prev != NULL) {
+				prev->next = res->next;
+				res->next = shape->child;
+				shape->child = res;
+			}
+			res->refcount++;
+			return res;
+		}
+		prev = res;
+	}
+
+	res = duk_hshape_alloc(thr->heap, n + 1, 0, 0);
+	if (!res) {
+		DUK_ERROR(thr, DUK_ERR_ALLOC_ERROR, "shape alloc failed");
+	}
+
+	keys = DUK_HSHAPE_GET_KEY_BASE(res);
+	flags = DUK_HSHAPE_GET_FLAGS_BASE(res);
+	if (n > 0) {
+		DUK_MEMCPY((void *) keys, (void *) DUK_HSHAPE_GET_KEY_BASE(shape), sizeof(duk_hstring *) * n);
+		DUK_MEMCPY((void *) flags, (void *) DUK_HSHAPE_GET_FLAGS_BASE(shape), sizeof(duk_uint8_t) * n);
+	}
+	keys[n] = key;
+	flags[n] = (duk_uint8_t) propflags;
+	res->e_used = n + 1;
+	for (i = 0; i <= n; i++) {
+		DUK_HSTRING_INCREF(thr, keys[i]);
+	}
+
+	res->parent = shape;
+	shape->refcount++;
+	res->next = shape->child;
+	shape->child = res;
+
+	DUK_DDD(DUK_DDDPRINT("shape transition created: %p -> %p, key %!O, flags 0x%02x",
+	                     (void *) shape, (void *) res, (duk_heaphdr *) key, (int) propflags));
+	return res;
+}
+
+/*
+ *  Release a shape reference, freeing the shape (and possibly its now
+ *  unused ancestors) when the refcount drops to zero.
+ *
+ *  With a NULL 'thr' keys are not decref'd.  This is used when freeing
+ *  objects without refcount finalization (mark-and-sweep only builds and
+ *  heap destruction): keys are then either unreachable or already freed
+ *  and must not be touched.
+ */
+
+static void duk__hshape_release(duk_heap *heap, duk_hthread *thr, duk_hshape *shape) {
+	duk_hshape *parent;
+	duk_hshape **link;
+	duk_uint_fast32_t i;
+
+	DUK_ASSERT(heap != NULL);
+
+	while (shape != NULL) {
+		DUK_ASSERT(shape->refcount > 0);
+		if (--shape->refcount > 0) {
+			return;
+		}
+
+		DUK_DDD(DUK_DDDPRINT("free shape %p, e_used=%d", (void *) shape, (int) shape->e_used));
+		DUK_ASSERT(shape->child == NULL);  /* children hold a reference */
+
+		parent = shape->parent;
+		if (parent != NULL) {
+			link = &parent->child;
+			while (*link != shape) {
+				DUK_ASSERT(*link != NULL);
+				link = &(*link)->next;
+			}
+			*link = shape->next;
+		}
+
+		if (thr != NULL) {
+			duk_hstring **keys = DUK_HSHAPE_GET_KEY_BASE(shape);
+			for (i = 0; i < shape->e_used; i++) {
+				/* unique shapes may have NULL (deleted) keys */
+				if (keys[i] != NULL) {
+					DUK_HSTRING_DECREF(thr, keys[i]);
+				}
+			}
+		}
+
+		DUK_FREE(heap, shape);
+		shape = parent;
+	}
+}
+
+void duk_hshape_decref(duk_hthread *thr, duk_hshape *shape) {
+	DUK_ASSERT(thr != NULL);
+	duk__hshape_release(thr->heap, thr, shape);
+}
+
+void duk_hshape_free_raw(duk_heap *heap, duk_hshape *shape) {
+	duk__hshape_release(heap, NULL, shape);
+}
+
+#endif  /* DUK_USE_HOBJECT_SHAPES */
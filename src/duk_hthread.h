@@ -53,6 +53,14 @@
 #define DUK_ACT_FLAG_CONSTRUCT       (1 << 2)  /* function executes as a constructor (called via "new") */
 #define DUK_ACT_FLAG_PREVENT_YIELD   (1 << 3)  /* activation prevents yield (native call or "new") */
 #define DUK_ACT_FLAG_DIRECT_EVAL     (1 << 4)  /* activation is a direct eval call */
+#define DUK_ACT_FLAG_DELAYED_ARGS    (1 << 5)  /* 'arguments' object is created with the delayed environment record */
+
+/* With DUK_ACT_FLAG_DELAYED_ARGS the actual argument count is kept in the
+ * upper flag bits; the arguments themselves are in registers 0...n-1.
+ */
+#define DUK_ACT_DELAYED_ARGS_SHIFT   16
+#define DUK_ACT_DELAYED_ARGS_MAX     0x7fff
+#define DUK_ACT_GET_DELAYED_ARGS(act)  (((act)->flags >> DUK_ACT_DELAYED_ARGS_SHIFT) & DUK_ACT_DELAYED_ARGS_MAX)
 
 /*
  *  Flags for __FILE__ / __LINE__ registered into tracedata
@@ -135,7 +143,10 @@
 
 /* Note: it's nice if size is 2^N (now 32 bytes on 32 bit) */
 struct duk_activation {
-	duk_hobject *func;      /* function being executed; for bound function calls, this is the final, real function */
+	duk_tval tv_func;       /* borrowed: function being executed as a tagged value; the only reference for lightfuncs */
+	duk_hobject *func;      /* function being executed; for bound function calls, this is the final, real function;
+	                         * NULL for lightfuncs
+	                         */
 	duk_hobject *var_env;   /* current variable environment (may be NULL if delayed) */
 	duk_hobject *lex_env;   /* current lexical environment (may be NULL if delayed) */
 #ifdef DUK_USE_NONSTD_FUNC_CALLER_PROPERTY
@@ -6,6 +6,7 @@
 
 #include "duk_internal.h"
 
+#if !defined(DUK_USE_ROM_OBJECTS)
 /*
  *  Encoding constants, must match genbuiltins.py
  */
@@ -37,21 +38,136 @@
 #define DUK__PROP_TYPE_BOOLEAN_TRUE      5
 #define DUK__PROP_TYPE_BOOLEAN_FALSE     6
 #define DUK__PROP_TYPE_ACCESSOR          7
+#endif  /* !DUK_USE_ROM_OBJECTS */
+
+#if defined(DUK_USE_ROM_OBJECTS)
+/*
+ *  With ROM objects the built-ins are constant data generated by
+ *  genbuiltins.py and shared by all heaps.  The few built-ins which are
+ *  extended after creation (ROM_RAM_BUILTINS in genbuiltins.py) are
+ *  created in RAM, copying the properties of their ROM templates.
+ */
+
+/* References from the ROM templates to other RAM built-ins must be
+ * redirected to the RAM copies.
+ */
+static duk_hobject *duk__rom_template_to_builtin(duk_hthread *thr, duk_hobject *h) {
+	duk_small_uint_t i;
+	duk_small_uint_t bidx;
+
+	for (i = 0; i < DUK_ROM_NUM_RAM_BUILTINS; i++) {
+		bidx = (duk_small_uint_t) duk_rom_ram_builtins[i];
+		if (h == (duk_hobject *) duk_rom_builtins[bidx]) {
+			return thr->builtins[bidx];
+		}
+	}
+	return h;
+}
+
+static void duk__create_rom_builtin_objects(duk_hthread *thr) {
+	duk_context *ctx = (duk_context *) thr;
+	duk_hobject *h;
+	duk_hobject *h_rom;
+	duk_small_uint_t i;
+	duk_small_uint_t bidx;
+	duk_uint_fast32_t j;
+
+	for (i = 0; i < DUK_NUM_BUILTINS; i++) {
+		/* no INCREF, ROM objects have no refcount */
+		thr->builtins[i] = (duk_hobject *) duk_rom_builtins[i];
+	}
+
+	DUK_DD(DUK_DDPRINT("create RAM built-ins"));
+	for (i = 0; i < DUK_ROM_NUM_RAM_BUILTINS; i++) {
+		bidx = (duk_small_uint_t) duk_rom_ram_builtins[i];
+		h_rom = (duk_hobject *) duk_rom_builtins[bidx];
+		DUK_ASSERT(DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h_rom));
+
+		if (DUK_HOBJECT_IS_NATIVEFUNCTION(h_rom)) {
+			duk_hnativefunction *h_rom_func = (duk_hnativefunction *) h_rom;
+
+			duk_push_c_function_noexotic(ctx,
+			                             h_rom_func->func,
+			                             (h_rom_func->nargs == DUK_HNATIVEFUNCTION_NARGS_VARARGS ?
+			                              DUK_VARARGS : (int) h_rom_func->nargs));
+			h = duk_require_hobject(ctx, -1);
+			((duk_hnativefunction *) h)->magic = h_rom_func->magic;
+		} else {
+			duk_push_object_helper(ctx, 0, -1);
+			h = duk_require_hobject(ctx, -1);
+		}
+		DUK_HEAPHDR_SET_FLAGS(&h->hdr, DUK_HEAPHDR_GET_FLAGS(&h_rom->hdr) & ~DUK_HEAPHDR_FLAG_READONLY);
+
+		thr->builtins[bidx] = h;
+		DUK_HOBJECT_INCREF(thr, h);
+		duk_pop(ctx);
+	}
+
+	DUK_DD(DUK_DDPRINT("initialize RAM built-in properties"));
+	for (i = 0; i < DUK_ROM_NUM_RAM_BUILTINS; i++) {
+		bidx = (duk_small_uint_t) duk_rom_ram_builtins[i];
+		h_rom = (duk_hobject *) duk_rom_builtins[bidx];
+		h = thr->builtins[bidx];
+
+		DUK_HOBJECT_SET_PROTOTYPE_UPDREF(thr, h, duk__rom_template_to_builtin(thr, h_rom->prototype));
+
+		duk_hobject_prealloc_props(thr, h, h_rom->e_used, 0);
+		for (j = 0; j < h_rom->e_used; j++) {
+			duk_hstring *key = DUK_HOBJECT_E_GET_KEY(h_rom, j);
+			duk_small_int_t prop_flags = (duk_small_int_t) DUK_HOBJECT_E_GET_FLAGS(h_rom, j);
+			duk_tval *tv;
+
+			if (key == NULL) {
+				continue;
+			}
+			if (prop_flags & DUK_PROPDESC_FLAG_ACCESSOR) {
+				duk_hobject_define_accessor_internal(thr,
+				                                     h,
+				                                     key,
+				                                     duk__rom_template_to_builtin(thr, DUK_HOBJECT_E_GET_VALUE_GETTER(h_rom, j)),
+				                                     duk__rom_template_to_builtin(thr, DUK_HOBJECT_E_GET_VALUE_SETTER(h_rom, j)),
+				                                     prop_flags);
+				continue;
+			}
+
+			tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(h_rom, j);
+			if (DUK_TVAL_IS_OBJECT(tv)) {
+				duk_push_hobject(ctx, duk__rom_template_to_builtin(thr, DUK_TVAL_GET_OBJECT(tv)));
+			} else {
+				duk_push_tval(ctx, tv);
+			}
+			duk_hobject_define_property_internal(thr, h, key, prop_flags);
+		}
+	}
+
+	/* Built-ins are expected on the value stack in built-in index order. */
+	for (i = 0; i < DUK_NUM_BUILTINS; i++) {
+		duk_push_hobject(ctx, thr->builtins[i]);
+	}
+}
+#endif  /* DUK_USE_ROM_OBJECTS */
 
 /*
  *  Create built-in objects by parsing an init bitstream generated
- *  by genbuiltins.py.
+ *  by genbuiltins.py, or from ROM objects.
  */
 
 void duk_hthread_create_builtin_objects(duk_hthread *thr) {
 	duk_context *ctx = (duk_context *) thr;
+#if !defined(DUK_USE_ROM_OBJECTS)
 	duk_bitdecoder_ctx bd_ctx;
 	duk_bitdecoder_ctx *bd = &bd_ctx;  /* convenience */
 	duk_hobject *h;
-	int i, j;
+	int j;
+#endif
+	int i;
 
 	DUK_D(DUK_DPRINT("INITBUILTINS BEGIN"));
 
+#if defined(DUK_USE_ROM_OBJECTS)
+	DUK_ASSERT_TOP(ctx, 0);
+	duk__create_rom_builtin_objects(thr);
+#else  /* DUK_USE_ROM_OBJECTS */
 	DUK_MEMZERO(&bd_ctx, sizeof(bd_ctx));
 	bd->data = (const duk_uint8_t *) duk_builtins_data;
 	bd->length = (duk_size_t) DUK_BUILTINS_DATA_LENGTH;
@@ -476,6 +592,12 @@ void duk_hthread_create_builtin_objects(duk_hthread *thr) {
 	(void) duk_hobject_delprop_raw(thr, thr->builtins[DUK_BIDX_OBJECT_CONSTRUCTOR], DUK_HTHREAD_STRING_SET_PROTOTYPE_OF(thr), 1 /*throw_flag*/);
 #endif
 
+#if !defined(DUK_USE_OPCODE_STATS)
+	DUK_DD(DUK_DDPRINT("delete Duktape.opstats built-in which is not enabled in features"));
+	(void) duk_hobject_delprop_raw(thr, thr->builtins[DUK_BIDX_DUKTAPE], DUK_HTHREAD_STRING_OPSTATS(thr), 1 /*throw_flag*/);
+#endif
+#endif  /* DUK_USE_ROM_OBJECTS */
+
 	duk_push_string(ctx,
 #if defined(DUK_USE_INTEGER_LE)
 	                "l"
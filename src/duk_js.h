@@ -73,16 +73,24 @@ int duk_js_getvar_envrec(duk_hthread *thr, duk_hobject *env, duk_hstring *name,
 int duk_js_getvar_activation(duk_hthread *thr, duk_activation *act, duk_hstring *name, int throw_flag);
 void duk_js_putvar_envrec(duk_hthread *thr, duk_hobject *env, duk_hstring *name, duk_tval *val, int strict);
 void duk_js_putvar_activation(duk_hthread *thr, duk_activation *act, duk_hstring *name, duk_tval *val, int strict);
+#if defined(DUK_USE_PROPERTY_IC)
+duk_tval *duk_js_getvar_ic(duk_hthread *thr, duk_activation *act, duk_hstring *name, duk_uint16_t *ic);
+duk_tval *duk_js_putvar_ic(duk_hthread *thr, duk_activation *act, duk_hstring *name, duk_uint16_t *ic);
+#endif
 int duk_js_delvar_envrec(duk_hthread *thr, duk_hobject *env, duk_hstring *name);
 int duk_js_delvar_activation(duk_hthread *thr, duk_activation *act, duk_hstring *name);
 int duk_js_declvar_activation(duk_hthread *thr, duk_activation *act, duk_hstring *name, duk_tval *val, int prop_flags, int is_func_decl);
 void duk_js_init_activation_environment_records_delayed(duk_hthread *thr, duk_activation *act);
 void duk_js_close_environment_record(duk_hthread *thr, duk_hobject *env, duk_hobject *func, int regbase);
+duk_hobject *duk_js_get_outer_lex_env(duk_hthread *thr, duk_hobject *func);
 duk_hobject *duk_create_activation_environment_record(duk_hthread *thr, duk_hobject *func, duk_uint32_t reg_bottom);
 void duk_js_push_closure(duk_hthread *thr,
                          duk_hcompiledfunction *fun_temp,
                          duk_hobject *outer_var_env,
                          duk_hobject *outer_lex_env);
+#if defined(DUK_USE_LAZY_COMPILE)
+void duk_js_compile_lazy_closure(duk_hthread *thr, duk_hcompiledfunction *fun_clos);
+#endif
 
 /* call handling */
 int duk_handle_call(duk_hthread *thr,
@@ -95,9 +103,37 @@ int duk_handle_safe_call(duk_hthread *thr,
 void duk_handle_ecma_call_setup(duk_hthread *thr,
                                 int num_stack_args,
                                 int call_flags);
+void duk_create_delayed_arguments_object(duk_hthread *thr,
+                                         duk_hobject *func,
+                                         duk_hobject *env,
+                                         int idx_bottom,
+                                         int num_args);
 
 /* bytecode execution */
 void duk_js_execute_bytecode(duk_hthread *entry_thread);
 
+/* baseline JIT */
+#if defined(DUK_USE_JIT)
+#define DUK_JIT_HOTNESS_THRESHOLD            1000  /* function entries + backward jumps before compiling */
+
+/* JIT state shared by all functions with the same bytecode, i.e. a
+ * function template and its closures.
+ */
+struct duk_jitcode {
+	duk_size_t refcount;           /* number of functions referring to this state */
+	duk_uint32_t hotness;          /* function entries + backward jumps so far */
+	duk_uint8_t *code;             /* mmap()'d code, read+exec after compilation; NULL if not compiled */
+	duk_size_t code_size;          /* size of the mapping */
+	duk_uint32_t num_pcs;
+	duk_uint32_t *pc_offsets;      /* code offset of each instruction, 'num_pcs' entries */
+};
+
+duk_jitcode *duk_js_jit_get_state(duk_heap *heap, duk_hcompiledfunction *fun);
+void duk_js_jit_release(duk_heap *heap, duk_jitcode *jit);
+duk_bool_t duk_js_jit_slowpath(duk_hthread *thr, duk_instr ins, duk_int_t pc_next);
+duk_bool_t duk_js_jit_compile(duk_hthread *thr, duk_hcompiledfunction *fun);
+void duk_js_jit_run(duk_hthread *thr, duk_hcompiledfunction *fun);
+#endif
+
 #endif  /* DUK_JS_H_INCLUDED */
 
@@ -121,8 +121,8 @@ typedef duk_uint32_t duk_instr;
 #define DUK_OP_BREAK                56
 #define DUK_OP_CONTINUE             57
 #define DUK_OP_TRYCATCH             58
-#define DUK_OP_UNUSED59             59
-#define DUK_OP_UNUSED60             60
+#define DUK_OP_IFCMP                59
+#define DUK_OP_INCDEC               60
 #define DUK_OP_UNUSED61             61
 #define DUK_OP_EXTRA                62
 #define DUK_OP_INVALID              63
@@ -176,6 +176,16 @@ typedef duk_uint32_t duk_instr;
 #define DUK_BC_RETURN_FLAG_FAST             (1 << 0)
 #define DUK_BC_RETURN_FLAG_HAVE_RETVAL      (1 << 1)
 
+/* DUK_OP_IFCMP: comparison opcode (DUK_OP_EQ ... DUK_OP_LE) and flags in A;
+ * the instruction following IFCMP is always a JUMP
+ */
+#define DUK_BC_IFCMP_OP_MASK                0x3f
+#define DUK_BC_IFCMP_FLAG_TRUE              (1 << 6)  /* skip the JUMP if comparison is true (default: if false) */
+
+/* DUK_OP_INCDEC flags in C */
+#define DUK_BC_INCDEC_FLAG_DEC              (1 << 0)  /* decrement (default: increment) */
+#define DUK_BC_INCDEC_FLAG_POST             (1 << 1)  /* result is the old value (default: new value) */
+
 /* DUK_OP_DECLVAR flags in A; bottom bits are reserved for propdesc flags (DUK_PROPDESC_FLAG_XXX) */
 #define DUK_BC_DECLVAR_FLAG_UNDEF_VALUE     (1 << 4)  /* use 'undefined' for value automatically */
 #define DUK_BC_DECLVAR_FLAG_FUNC_DECL       (1 << 5)  /* function declaration */
@@ -295,6 +295,66 @@ static void duk__handle_createargs_for_call(duk_hthread *thr,
 	/* [... arg1 ... argN envobj] */
 }
 
+/* Check whether 'arguments' object creation can be delayed for a call.
+ * This is the case when all actual arguments fit into the formal argument
+ * registers: a non-strict arguments object maps each formal to its
+ * register binding, so an arguments object created later from the current
+ * register values is identical to one created on entry.  (A formal shadowed
+ * by a later formal of the same name is not mapped, but its register is
+ * then unreachable and still holds the original value.)  Strict arguments
+ * objects are not mapped and must capture the original values, so they
+ * are always created on entry.
+ */
+static int duk__can_delay_createargs(duk_hobject *func, int nargs, int num_stack_args) {
+	DUK_ASSERT(func != NULL);
+	DUK_ASSERT(DUK_HOBJECT_HAS_CREATEARGS(func));
+
+	return (!DUK_HOBJECT_HAS_STRICT(func) &&
+	        num_stack_args <= nargs &&
+	        num_stack_args <= DUK_ACT_DELAYED_ARGS_MAX);
+}
+
+/* Create a delayed arguments object and add it to the env record on top
+ * of the value stack.  The arguments are copied from registers starting
+ * at absolute valstack index 'idx_bottom'.  Called when the delayed
+ * environment record of an activation with DUK_ACT_FLAG_DELAYED_ARGS is
+ * created.
+ */
+void duk_create_delayed_arguments_object(duk_hthread *thr,
+                                         duk_hobject *func,
+                                         duk_hobject *env,
+                                         int idx_bottom,
+                                         int num_args) {
+	duk_context *ctx = (duk_context *) thr;
+	int i;
+
+	DUK_DDD(DUK_DDDPRINT("creating delayed arguments object, num_args=%d", num_args));
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(func != NULL);
+	DUK_ASSERT(env != NULL);
+	DUK_ASSERT(DUK_HOBJECT_HAS_CREATEARGS(func));
+	DUK_ASSERT(!DUK_HOBJECT_HAS_STRICT(func));
+	DUK_ASSERT(idx_bottom >= 0);
+	DUK_ASSERT(num_args >= 0);
+
+	/* [... envobj] */
+
+	for (i = 0; i < num_args; i++) {
+		/* valstack may be resized by each push, so re-lookup */
+		duk_push_tval(ctx, thr->valstack + idx_bottom + i);
+	}
+	duk_push_hobject(ctx, env);
+
+	/* [... envobj arg1 ... argN envobj] */
+
+	duk__handle_createargs_for_call(thr, func, env, num_args);
+
+	/* [... envobj arg1 ... argN envobj] */
+
+	duk_pop_n(ctx, num_args + 1);
+}
+
 /*
  *  Helper for handling a "bound function" chain when a call is being made.
  *
@@ -478,9 +538,10 @@ static void duk__update_func_caller_prop(duk_hthread *thr, duk_hobject *func) {
 
 		if (act_caller) {
 			/* act_caller->func may be NULL in some finalization cases,
-			 * just treat like we don't know the caller.
+			 * and is always NULL for a lightfunc caller; just treat
+			 * like we don't know the caller.
 			 */
-			if (act_caller->func && !DUK_HOBJECT_HAS_NEWENV(act_caller->func)) {
+			if (act_caller->func == NULL || !DUK_HOBJECT_HAS_NEWENV(act_caller->func)) {
 				/* Setting to NULL causes 'caller' to be set to
 				 * 'null' as desired.
 				 */
@@ -638,7 +699,9 @@ int duk_handle_call(duk_hthread *thr,
 	int nargs;            /* # argument registers target function wants (< 0 => "as is") */
 	int nregs;            /* # total registers target function wants on entry (< 0 => "as is") */
 	unsigned int vs_min_size;  /* FIXME: type */
-	duk_hobject *func;    /* 'func' on stack (borrowed reference) */
+	duk_hobject *func;    /* 'func' on stack (borrowed reference), NULL for lightfuncs */
+	duk_tval *tv_func;    /* duk_tval ptr for 'func' on stack (borrowed reference) */
+	duk_c_function volatile lf_func = NULL;  /* lightfunc pointer, only used if func == NULL (volatile: assigned after setjmp()) */
 	duk_activation *act;
 	duk_hobject *env;
 	duk_jmpbuf our_jmpbuf;
@@ -900,7 +963,36 @@ int duk_handle_call(duk_hthread *thr,
 	if (!duk_is_callable(thr, idx_func)) {
 		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "call target not callable");
 	}
-	func = duk_get_hobject(thr, idx_func);
+	tv_func = duk_get_tval(ctx, idx_func);
+	DUK_ASSERT(tv_func != NULL);
+
+	/* These base values are never used, but if the compiler doesn't know
+	 * that DUK_ERROR() won't return, these are needed to silence warnings.
+	 * On the other hand, scan-build will warn about the values not being
+	 * used, so add a DUK_UNREF.
+	 */
+	nargs = 0; DUK_UNREF(nargs);
+	nregs = 0; DUK_UNREF(nregs);
+
+	if (DUK_TVAL_IS_LIGHTFUNC(tv_func)) {
+		/* Lightfuncs behave like strict native functions: no 'this'
+		 * coercion, no environment record, no 'arguments' object.
+		 */
+		duk_small_uint_t lf_flags;
+
+		func = NULL;
+		lf_func = DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv_func);
+		lf_flags = DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv_func);
+		nargs = DUK_LFUNC_FLAGS_GET_NARGS(lf_flags);
+		if (nargs == DUK_LFUNC_NARGS_VARARGS) {
+			nargs = -1;  /* vararg */
+		}
+		nregs = nargs;
+		DUK_DDD(DUK_DDDPRINT("lightfunc call, 'this' binding is: %!T", duk_get_tval(ctx, idx_func + 1)));
+		goto func_done;
+	}
+
+	func = DUK_TVAL_GET_OBJECT(tv_func);
 	DUK_ASSERT(func != NULL);
 
 	if (DUK_HOBJECT_HAS_BOUND(func)) {
@@ -914,15 +1006,13 @@ int duk_handle_call(duk_hthread *thr,
 	duk__coerce_effective_this_binding(thr, func, idx_func + 1);
 	DUK_DDD(DUK_DDDPRINT("effective 'this' binding is: %!T", duk_get_tval(ctx, idx_func + 1)));
 
-	/* These base values are never used, but if the compiler doesn't know
-	 * that DUK_ERROR() won't return, these are needed to silence warnings.
-	 * On the other hand, scan-build will warn about the values not being
-	 * used, so add a DUK_UNREF.
-	 */
-	nargs = 0; DUK_UNREF(nargs);
-	nregs = 0; DUK_UNREF(nregs);
-
 	if (DUK_HOBJECT_IS_COMPILEDFUNCTION(func)) {
+#if defined(DUK_USE_LAZY_COMPILE)
+		if (DUK_HCOMPILEDFUNCTION_IS_LAZY((duk_hcompiledfunction *) func)) {
+			/* first call, 'func' is reachable through idx_func */
+			duk_js_compile_lazy_closure(thr, (duk_hcompiledfunction *) func);
+		}
+#endif
 		nargs = ((duk_hcompiledfunction *) func)->nargs;
 		nregs = ((duk_hcompiledfunction *) func)->nregs;
 		DUK_ASSERT(nregs >= nargs);
@@ -938,6 +1028,7 @@ int duk_handle_call(duk_hthread *thr,
 		DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "call target not a function");
 	}
 
+ func_done:
 	/* [ ... func this arg1 ... argN ] */
 
 	/*
@@ -957,7 +1048,7 @@ int duk_handle_call(duk_hthread *thr,
 	vs_min_size = (thr->valstack_bottom - thr->valstack) +         /* bottom of current func */
 	              idx_args;                                        /* bottom of new func */
 	vs_min_size += (nregs >= 0 ? nregs : num_stack_args);          /* num entries of new func at entry */
-	if (DUK_HOBJECT_IS_NATIVEFUNCTION(func)) {
+	if (func == NULL || DUK_HOBJECT_IS_NATIVEFUNCTION(func)) {
 		vs_min_size += DUK_VALSTACK_API_ENTRY_MINIMUM;         /* Duktape/C API guaranteed entries (on top of args) */
 	}
 	vs_min_size += DUK_VALSTACK_INTERNAL_EXTRA,                    /* + spare */
@@ -995,17 +1086,17 @@ int duk_handle_call(duk_hthread *thr,
 	thr->callstack_top++;
 	DUK_ASSERT(thr->callstack_top <= thr->callstack_size);
 	DUK_ASSERT(thr->valstack_top > thr->valstack_bottom);  /* at least effective 'this' */
-	DUK_ASSERT(!DUK_HOBJECT_HAS_BOUND(func));
+	DUK_ASSERT(func == NULL || !DUK_HOBJECT_HAS_BOUND(func));
 
 	act->flags = 0;
-	if (DUK_HOBJECT_HAS_STRICT(func)) {
+	if (func == NULL || DUK_HOBJECT_HAS_STRICT(func)) {
 		act->flags |= DUK_ACT_FLAG_STRICT;
 	}
 	if (call_flags & DUK_CALL_FLAG_CONSTRUCTOR_CALL) {
 		act->flags |= DUK_ACT_FLAG_CONSTRUCT;
 		/*act->flags |= DUK_ACT_FLAG_PREVENT_YIELD;*/
 	}
-	if (DUK_HOBJECT_IS_NATIVEFUNCTION(func)) {
+	if (func == NULL || DUK_HOBJECT_IS_NATIVEFUNCTION(func)) {
 		/*act->flags |= DUK_ACT_FLAG_PREVENT_YIELD;*/
 	}
 	if (call_flags & DUK_CALL_FLAG_DIRECT_EVAL) {
@@ -1017,7 +1108,14 @@ int duk_handle_call(duk_hthread *thr,
 	 */
 	act->flags |= DUK_ACT_FLAG_PREVENT_YIELD;
 
-	act->func = func;
+	act->func = func;  /* NULL for lightfunc */
+	if (func == NULL) {
+		/* tv_func may be stale after the resize above, re-lookup */
+		DUK_TVAL_SET_TVAL(&act->tv_func, duk_get_tval(ctx, idx_func));
+		DUK_ASSERT(DUK_TVAL_IS_LIGHTFUNC(&act->tv_func));
+	} else {
+		DUK_TVAL_SET_OBJECT(&act->tv_func, func);  /* borrowed, no refcount */
+	}
 	act->var_env = NULL;
 	act->lex_env = NULL;
 #ifdef DUK_USE_NONSTD_FUNC_CALLER_PROPERTY
@@ -1034,11 +1132,13 @@ int duk_handle_call(duk_hthread *thr,
 		thr->callstack_preventcount++;
 	}
 
-	DUK_HOBJECT_INCREF(thr, func);  /* act->func */
+	DUK_HOBJECT_INCREF(thr, func);  /* act->func; NULL for lightfunc */
 
 #ifdef DUK_USE_NONSTD_FUNC_CALLER_PROPERTY
-	duk__update_func_caller_prop(thr, func);
-	act = thr->callstack + thr->callstack_top - 1;
+	if (func != NULL) {
+		duk__update_func_caller_prop(thr, func);
+		act = thr->callstack + thr->callstack_top - 1;
+	}
 #endif
 
 	/* [... func this arg1 ... argN] */
@@ -1059,8 +1159,16 @@ int duk_handle_call(duk_hthread *thr,
 	 *  environment record initialization is delayed (which is good).
 	 *
 	 *  Delayed creation (on demand) is handled in duk_js_var.c.
+	 *
+	 *  Lightfuncs never have an environment record.
 	 */
 
+	if (func == NULL) {
+		DUK_ASSERT(act->lex_env == NULL);
+		DUK_ASSERT(act->var_env == NULL);
+		goto env_done;
+	}
+
 	DUK_ASSERT(!DUK_HOBJECT_HAS_BOUND(func));  /* bound function chain has already been resolved */
 
 	if (!DUK_HOBJECT_HAS_NEWENV(func)) {
@@ -1086,6 +1194,18 @@ int duk_handle_call(duk_hthread *thr,
 		goto env_done;
 	}
 
+	if (duk__can_delay_createargs(func, nargs, num_stack_args)) {
+		/* arguments object is created only if the delayed environment
+		 * record is (e.g. when 'arguments' is looked up), see
+		 * duk_js_init_activation_environment_records_delayed()
+		 */
+		DUK_DDD(DUK_DDDPRINT("delaying arguments object creation, num_stack_args=%d", num_stack_args));
+		act->flags |= DUK_ACT_FLAG_DELAYED_ARGS | (num_stack_args << DUK_ACT_DELAYED_ARGS_SHIFT);
+		DUK_ASSERT(act->lex_env == NULL);
+		DUK_ASSERT(act->var_env == NULL);
+		goto env_done;
+	}
+
 	/* third arg: absolute index (to entire valstack) of idx_bottom of new activation */
 	env = duk_create_activation_environment_record(thr, func, act->idx_bottom);
 	DUK_ASSERT(env != NULL);
@@ -1128,7 +1248,7 @@ int duk_handle_call(duk_hthread *thr,
 	 *  Determine call type; then setup activation and call
 	 */
 
-	if (DUK_HOBJECT_IS_COMPILEDFUNCTION(func)) {
+	if (func != NULL && DUK_HOBJECT_IS_COMPILEDFUNCTION(func)) {
 		goto ecmascript_call;
 	} else {
 		goto native_call;
@@ -1149,7 +1269,8 @@ int duk_handle_call(duk_hthread *thr,
 	DUK_ASSERT(thr->valstack_bottom >= thr->valstack);
 	DUK_ASSERT(thr->valstack_top >= thr->valstack_bottom);
 	DUK_ASSERT(thr->valstack_end >= thr->valstack_top);
-	DUK_ASSERT(((duk_hnativefunction *) func)->func != NULL);
+	DUK_ASSERT(func == NULL || ((duk_hnativefunction *) func)->func != NULL);
+	DUK_ASSERT(func != NULL || lf_func != NULL);
 
 	/* [... func this | arg1 ... argN] ('this' must precede new bottom) */
 
@@ -1163,7 +1284,11 @@ int duk_handle_call(duk_hthread *thr,
 	 *  other  invalid
 	 */
 
-	rc = ((duk_hnativefunction *) func)->func((duk_context *) thr);
+	if (func != NULL) {
+		rc = ((duk_hnativefunction *) func)->func((duk_context *) thr);
+	} else {
+		rc = lf_func((duk_context *) thr);
+	}
 
 	if (rc < 0) {
 		duk_error_throw_from_negative_rc(thr, rc);
@@ -1855,6 +1980,16 @@ void duk_handle_ecma_call_setup(duk_hthread *thr,
 	duk__coerce_effective_this_binding(thr, func, idx_func + 1);
 	DUK_DDD(DUK_DDDPRINT("effective 'this' binding is: %!T", duk_get_tval(ctx, idx_func + 1)));
 
+#if defined(DUK_USE_LAZY_COMPILE)
+	if (DUK_HCOMPILEDFUNCTION_IS_LAZY((duk_hcompiledfunction *) func)) {
+		/* first call, 'func' is reachable through idx_func; a thread's
+		 * initial function is compiled before the thread is resumed
+		 */
+		DUK_ASSERT((call_flags & DUK_CALL_FLAG_IS_RESUME) == 0);
+		duk_js_compile_lazy_closure(thr, (duk_hcompiledfunction *) func);
+	}
+#endif
+
 	nargs = ((duk_hcompiledfunction *) func)->nargs;
 	nregs = ((duk_hcompiledfunction *) func)->nregs;
 	DUK_ASSERT(nregs >= nargs);
@@ -1943,6 +2078,7 @@ void duk_handle_ecma_call_setup(duk_hthread *thr,
 
 		/* Start filling in the activation */
 		act->func = func;  /* don't want an intermediate exposed state with func == NULL */
+		DUK_TVAL_SET_OBJECT(&act->tv_func, func);  /* borrowed, no refcount */
 #ifdef DUK_USE_NONSTD_FUNC_CALLER_PROPERTY
 		act->prev_caller = NULL;
 #endif
@@ -2059,6 +2195,7 @@ void duk_handle_ecma_call_setup(duk_hthread *thr,
 		              DUK_ACT_FLAG_STRICT :
 	        	      0);
 		act->func = func;
+		DUK_TVAL_SET_OBJECT(&act->tv_func, func);  /* borrowed, no refcount */
 		act->var_env = NULL;
 		act->lex_env = NULL;
 #ifdef DUK_USE_NONSTD_FUNC_CALLER_PROPERTY
@@ -2122,6 +2259,18 @@ void duk_handle_ecma_call_setup(duk_hthread *thr,
 		goto env_done;
 	}
 
+	if (duk__can_delay_createargs(func, nargs, num_stack_args)) {
+		/* arguments object is created only if the delayed environment
+		 * record is (e.g. when 'arguments' is looked up), see
+		 * duk_js_init_activation_environment_records_delayed()
+		 */
+		DUK_DDD(DUK_DDDPRINT("delaying arguments object creation, num_stack_args=%d", num_stack_args));
+		act->flags |= DUK_ACT_FLAG_DELAYED_ARGS | (num_stack_args << DUK_ACT_DELAYED_ARGS_SHIFT);
+		DUK_ASSERT(act->lex_env == NULL);
+		DUK_ASSERT(act->var_env == NULL);
+		goto env_done;
+	}
+
 	/* third arg: absolute index (to entire valstack) of idx_bottom of new activation */
 	env = duk_create_activation_environment_record(thr, func, act->idx_bottom);
 	DUK_ASSERT(env != NULL);
@@ -29,8 +29,8 @@
 #define DUK__MAX_ARRAY_INIT_VALUES        20
 #define DUK__MAX_OBJECT_INIT_PAIRS        10
 
-/* XXX: hack, remove when const lookup is not O(n) */
-#define DUK__GETCONST_MAX_CONSTS_CHECK    256
+/* number of constants after which constants are deduplicated using const maps */
+#define DUK__CONSTMAP_MIN_CONSTS          16
 
 /* these limits are based on bytecode limits */
 #define DUK__MAX_CONSTS                   (DUK_BC_BC_MAX + 1)
@@ -51,7 +51,7 @@
  * overlap (in control flow), some can be eliminated.
  */
 
-#define DUK__COMPILE_ENTRY_SLOTS          8
+#define DUK__COMPILE_ENTRY_SLOTS          10
 #define DUK__FUNCTION_INIT_REQUIRE_SLOTS  16
 #define DUK__FUNCTION_BODY_REQUIRE_SLOTS  16
 #define DUK__PARSE_STATEMENTS_SLOTS       16
@@ -62,15 +62,41 @@
  */
 typedef struct {
 	int flags;
+	int lazy_offset;       /* DUK_JS_COMPILE_FLAG_LAZY: lexer point to start from */
+	int lazy_line;
+#if defined(DUK_USE_LAZY_COMPILE)
+	duk_hstring *h_preparse;  /* DUK_JS_COMPILE_FLAG_LAZY: preparse data of inner functions (borrowed reference) */
+#endif
 	duk_compiler_ctx comp_ctx_alloc;
 	duk_lexer_point lex_pt_alloc;
 } duk__compiler_stkstate;
 
+/* A token recorded on pass 1 for replaying on pass 2.  The token's string
+ * values are kept reachable in a separate array (comp_ctx->h_tokvals)
+ * starting from 'val_idx'; 'tok.str1' and 'tok.str2' are not valid.
+ */
+typedef struct {
+	duk_token tok;
+	int val_idx;
+	int flags;
+} duk__token_record;
+
+#define DUK__TOKREC_FLAG_STRICT   (1 << 0)  /* lexed in strict mode */
+#define DUK__TOKREC_FLAG_REGEXP   (1 << 1)  /* lexed in regexp mode */
+#define DUK__TOKREC_FLAG_STR1     (1 << 2)  /* has str1 */
+#define DUK__TOKREC_FLAG_STR2     (1 << 3)  /* has str2 */
+
 /*
  *  Prototypes
  */
 
 /* lexing */
+static void duk__tokvals_append(duk_compiler_ctx *comp_ctx, int slot_idx);
+static void duk__tokvals_remove(duk_compiler_ctx *comp_ctx, int val_start, int val_end);
+static void duk__record_token(duk_compiler_ctx *comp_ctx, int strict, int regexp);
+static void duk__replay_token(duk_compiler_ctx *comp_ctx, int strict, int regexp);
+static void duk__tokrec_drop(duk_compiler_ctx *comp_ctx, int idx_start, int idx_end);
+static void duk__tokrec_check_strict(duk_compiler_ctx *comp_ctx, int idx_start);
 static void duk__advance_helper(duk_compiler_ctx *comp_ctx, int expect);
 static void duk__advance_expect(duk_compiler_ctx *comp_ctx, int expect);
 static void duk__advance(duk_compiler_ctx *ctx);
@@ -80,7 +106,8 @@ static void duk__init_func_valstack_slots(duk_compiler_ctx *comp_ctx);
 static void duk__reset_func_for_pass2(duk_compiler_ctx *comp_ctx);
 static void duk__init_varmap_and_prologue_for_pass2(duk_compiler_ctx *comp_ctx, int *out_stmt_value_reg);
 static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx);
-static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx);
+static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx, duk_hobject *h_keep);
+static int duk__inner_func_may_capture(duk_compiler_ctx *comp_ctx, int fnum);
 
 /* code emission */
 static int duk__get_current_pc(duk_compiler_ctx *comp_ctx);
@@ -110,6 +137,7 @@ static void duk__patch_trycatch(duk_compiler_ctx *comp_ctx, int trycatch_pc, int
 static void duk__emit_if_false_skip(duk_compiler_ctx *comp_ctx, int regconst);
 static void duk__emit_if_true_skip(duk_compiler_ctx *comp_ctx, int regconst);
 static void duk__emit_invalid(duk_compiler_ctx *comp_ctx);
+static void duk__remove_code(duk_compiler_ctx *comp_ctx, int pc);
 
 /* ivalue/ispec helpers */
 static void duk__copy_ispec(duk_compiler_ctx *comp_ctx, duk_ispec *src, duk_ispec *dst);
@@ -118,12 +146,17 @@ static int duk__is_whole_get_i32(double x, duk_int32_t *ival);
 static int duk__alloctemps(duk_compiler_ctx *comp_ctx, int num);
 static int duk__alloctemp(duk_compiler_ctx *comp_ctx);
 static void duk__settemp_checkmax(duk_compiler_ctx *comp_ctx, int temp_next);
+static int duk__constmap_push_key(duk_compiler_ctx *comp_ctx);
+static void duk__constmap_init(duk_compiler_ctx *comp_ctx, int n);
 static int duk__getconst(duk_compiler_ctx *comp_ctx);
 static int duk__ispec_toregconst_raw(duk_compiler_ctx *comp_ctx,
                                      duk_ispec *x,
                                      int forced_reg,
                                      int flags);
 static int duk__ispec_toforcedreg(duk_compiler_ctx *comp_ctx, duk_ispec *x, int forced_reg);
+static int duk__ivalue_fold_binary(duk_compiler_ctx *comp_ctx, duk_ivalue *x);
+static int duk__ivalue_fold_unary(duk_compiler_ctx *comp_ctx, duk_ivalue *x, int tok);
+static int duk__ivalue_get_const_truth(duk_compiler_ctx *comp_ctx, duk_ivalue *x);
 static void duk__ivalue_toplain_raw(duk_compiler_ctx *comp_ctx, duk_ivalue *x, int forced_reg);
 static void duk__ivalue_toplain(duk_compiler_ctx *comp_ctx, duk_ivalue *x);
 static void duk__ivalue_toplain_ignore(duk_compiler_ctx *comp_ctx, duk_ivalue *x);
@@ -137,6 +170,7 @@ static int duk__ivalue_totempreg(duk_compiler_ctx *comp_ctx, duk_ivalue *x);
 #endif
 static int duk__ivalue_toforcedreg(duk_compiler_ctx *comp_ctx, duk_ivalue *x, int forced_reg);
 static int duk__ivalue_toregconst(duk_compiler_ctx *comp_ctx, duk_ivalue *x);
+static void duk__ivalue_emit_if_skip(duk_compiler_ctx *comp_ctx, duk_ivalue *x, int truthval);
 
 /* identifier handling */
 static int duk__lookup_active_register_binding(duk_compiler_ctx *comp_ctx);
@@ -196,13 +230,22 @@ static void duk__parse_return_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res);
 static void duk__parse_throw_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res);
 static void duk__parse_try_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res);
 static void duk__parse_with_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res);
-static void duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int allow_source_elem);
-static void duk__parse_stmts(duk_compiler_ctx *comp_ctx, int allow_source_elem, int expect_eof);
+static int duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int allow_source_elem);
+static int duk__parse_stmts(duk_compiler_ctx *comp_ctx, int allow_source_elem, int expect_eof);
 
 static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int implicit_return_value);
 static void duk__parse_func_formals(duk_compiler_ctx *comp_ctx);
 static void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, int is_decl, int is_setget);
 static int duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, int is_decl, int is_setget);
+static void duk__push_free_idrefs(duk_compiler_ctx *comp_ctx, int outer_idrefs_idx, duk_hbuffer_dynamic *buf);
+#if defined(DUK_USE_LAZY_COMPILE)
+static void duk__preparse_append_uint(duk_compiler_ctx *comp_ctx, duk_hbuffer_dynamic *buf, duk_uint32_t val);
+static void duk__preparse_append_header(duk_compiler_ctx *comp_ctx, duk_hbuffer_dynamic *buf, duk_hobject *h_templ, int end_offset, int end_line, int any_idrefs);
+static void duk__preparse_append_inner(duk_compiler_ctx *comp_ctx, duk_hbuffer_dynamic *buf);
+static duk_uint32_t duk__preparse_get_uint(duk_compiler_ctx *comp_ctx);
+static void duk__preparse_skip_func_body(duk_compiler_ctx *comp_ctx);
+static void duk__finish_lazy_func(duk_compiler_ctx *comp_ctx);
+#endif
 
 /*
  *  Parser control values for tokens.  The token table is ordered by the
@@ -390,6 +433,244 @@ static int duk__hstring_is_eval_or_arguments_in_strict_mode(duk_compiler_ctx *co
  *  Parser duk__advance() token eating functions
  */
 
+/* Tokens lexed on pass 1 are recorded so that pass 2 can replay them
+ * instead of lexing (decoding, interning) the function body again.  A
+ * function body's tokens are dropped once the function is finished,
+ * except for its closing brace and the token following it, which the
+ * outer function's pass 2 replays when skipping the inner function.
+ * The record therefore only holds the tokens of the functions being
+ * compiled, excluding their finished inner functions.
+ *
+ * A token is lexed again on replay if the strict or regexp mode differs
+ * from when it was recorded: this happens for tokens preceding a 'use strict'
+ * directive and for the token following a skipped inner function.
+ *
+ * If the record grows too large (e.g. a huge flat data file), it is
+ * discarded and a new recording epoch is started.  Functions whose body
+ * was started in an earlier epoch rewind the lexer for pass 2 instead.
+ *
+ * The string values of recorded tokens are kept reachable in the array
+ * part of an internal object which is accessed directly: this is in the
+ * lexing hot path and the generic property calls would cost more than
+ * what replaying saves.
+ */
+
+/* Append the value in valstack slot 'slot_idx' to the token values. */
+static void duk__tokvals_append(duk_compiler_ctx *comp_ctx, int slot_idx) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+	duk_hobject *h = comp_ctx->h_tokvals;
+	duk_tval *tv_src;
+	duk_tval *tv_dst;
+
+	if ((duk_uint32_t) comp_ctx->tokvals_count >= h->a_size) {
+		/* may trigger a GC, don't hold tval pointers over the call */
+		duk_hobject_prealloc_props(thr, h, 0, h->a_size + h->a_size / 2 + 64);
+	}
+	DUK_ASSERT((duk_uint32_t) comp_ctx->tokvals_count < h->a_size);
+
+	tv_src = duk_get_tval(ctx, slot_idx);
+	DUK_ASSERT(tv_src != NULL && DUK_TVAL_IS_STRING(tv_src));
+	tv_dst = DUK_HOBJECT_A_GET_VALUE_PTR(h, comp_ctx->tokvals_count);
+	DUK_ASSERT(DUK_TVAL_IS_UNDEFINED_UNUSED(tv_dst));
+	DUK_TVAL_SET_TVAL(tv_dst, tv_src);
+	DUK_TVAL_INCREF(thr, tv_dst);
+	comp_ctx->tokvals_count++;
+}
+
+/* Remove token values [val_start, val_end[, moving the values following
+ * them down.
+ */
+static void duk__tokvals_remove(duk_compiler_ctx *comp_ctx, int val_start, int val_end) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_tval *tv_base;
+	duk_tval tv_tmp;
+	int i;
+
+	DUK_ASSERT(val_start >= 0 && val_start <= val_end && val_end <= comp_ctx->tokvals_count);
+
+	tv_base = DUK_HOBJECT_A_GET_BASE(comp_ctx->h_tokvals);
+	for (i = val_start; i < val_end; i++) {
+		/* strings have no side effects when freed */
+		DUK_TVAL_SET_TVAL(&tv_tmp, tv_base + i);
+		DUK_TVAL_SET_UNDEFINED_UNUSED(tv_base + i);
+		DUK_TVAL_DECREF(thr, &tv_tmp);
+	}
+	for (i = val_end; i < comp_ctx->tokvals_count; i++) {
+		/* move, no refcount changes */
+		DUK_TVAL_SET_TVAL(tv_base + i - (val_end - val_start), tv_base + i);
+		DUK_TVAL_SET_UNDEFINED_UNUSED(tv_base + i);
+	}
+	comp_ctx->tokvals_count -= val_end - val_start;
+}
+
+static void duk__record_token(duk_compiler_ctx *comp_ctx, int strict, int regexp) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk__token_record rec;
+
+	DUK_ASSERT(comp_ctx->tokrec_next == comp_ctx->tokrec_count);
+
+	if (comp_ctx->tokrec_count >= DUK_COMPILER_TOKREC_LIMIT) {
+		DUK_DD(DUK_DDPRINT("token record limit reached, discard recorded tokens"));
+		duk_hbuffer_reset(thr, comp_ctx->h_tokrec);
+		duk__tokvals_remove(comp_ctx, 0, comp_ctx->tokvals_count);
+		comp_ctx->tokrec_count = 0;
+		comp_ctx->tokrec_next = 0;
+		comp_ctx->tokrec_epoch++;
+	}
+
+	DUK_MEMCPY(&rec.tok, &comp_ctx->curr_token, sizeof(duk_token));
+	rec.val_idx = comp_ctx->tokvals_count;
+	rec.flags = (strict ? DUK__TOKREC_FLAG_STRICT : 0) |
+	            (regexp ? DUK__TOKREC_FLAG_REGEXP : 0);
+
+	if (comp_ctx->curr_token.str1) {
+		duk__tokvals_append(comp_ctx, comp_ctx->tok11_idx);
+		rec.flags |= DUK__TOKREC_FLAG_STR1;
+	}
+	if (comp_ctx->curr_token.str2) {
+		duk__tokvals_append(comp_ctx, comp_ctx->tok12_idx);
+		rec.flags |= DUK__TOKREC_FLAG_STR2;
+	}
+
+	duk_hbuffer_append_bytes(thr, comp_ctx->h_tokrec, (duk_uint8_t *) &rec, sizeof(rec));
+	comp_ctx->tokrec_count++;
+	comp_ctx->tokrec_next++;
+}
+
+static void duk__replay_token(duk_compiler_ctx *comp_ctx, int strict, int regexp) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+	duk__token_record *rec;
+	duk_tval *tv_val;
+
+	DUK_ASSERT(comp_ctx->tokrec_next < comp_ctx->tokrec_count);
+
+	rec = (duk__token_record *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(comp_ctx->h_tokrec) + comp_ctx->tokrec_next;
+	comp_ctx->tokrec_next++;
+
+	if ((strict != 0) != ((rec->flags & DUK__TOKREC_FLAG_STRICT) != 0) ||
+	    ((regexp != 0) != ((rec->flags & DUK__TOKREC_FLAG_REGEXP) != 0) &&
+	     (rec->tok.t == DUK_TOK_DIV || rec->tok.t == DUK_TOK_DIV_EQ || rec->tok.t == DUK_TOK_REGEXP))) {
+		duk_lexer_point lex_pt_curr;
+		duk_lexer_point lex_pt_tok;
+		int lineterm = rec->tok.lineterm;
+		int allow_auto_semi = rec->tok.allow_auto_semi;
+
+		DUK_DDD(DUK_DDDPRINT("lex recorded token again: strict %d -> %d, regexp %d -> %d",
+		                     (rec->flags & DUK__TOKREC_FLAG_STRICT ? 1 : 0), strict,
+		                     (rec->flags & DUK__TOKREC_FLAG_REGEXP ? 1 : 0), regexp));
+
+		DUK_LEXER_GETPOINT(&comp_ctx->lex, &lex_pt_curr);
+		lex_pt_tok.offset = rec->tok.start_offset;
+		lex_pt_tok.line = rec->tok.start_line;
+		DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt_tok);
+		duk_lexer_parse_js_input_element(&comp_ctx->lex, &comp_ctx->curr_token, strict, regexp);
+		DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt_curr);
+
+		/* preceding whitespace was not lexed again */
+		comp_ctx->curr_token.lineterm = lineterm;
+		comp_ctx->curr_token.allow_auto_semi = allow_auto_semi;
+		return;
+	}
+
+	DUK_MEMCPY(&comp_ctx->curr_token, &rec->tok, sizeof(duk_token));
+	tv_val = DUK_HOBJECT_A_GET_VALUE_PTR(comp_ctx->h_tokvals, rec->val_idx);
+	if (rec->flags & DUK__TOKREC_FLAG_STR1) {
+		DUK_ASSERT(DUK_TVAL_IS_STRING(tv_val));
+		duk_push_tval(ctx, tv_val++);
+		duk_replace(ctx, comp_ctx->tok11_idx);
+		comp_ctx->curr_token.str1 = duk_get_hstring(ctx, comp_ctx->tok11_idx);
+	} else {
+		duk_to_undefined(ctx, comp_ctx->tok11_idx);
+		comp_ctx->curr_token.str1 = NULL;
+	}
+	if (rec->flags & DUK__TOKREC_FLAG_STR2) {
+		DUK_ASSERT(DUK_TVAL_IS_STRING(tv_val));
+		duk_push_tval(ctx, tv_val);
+		duk_replace(ctx, comp_ctx->tok12_idx);
+		comp_ctx->curr_token.str2 = duk_get_hstring(ctx, comp_ctx->tok12_idx);
+	} else {
+		duk_to_undefined(ctx, comp_ctx->tok12_idx);
+		comp_ctx->curr_token.str2 = NULL;
+	}
+}
+
+/* Drop recorded tokens [idx_start, idx_end[, moving the tokens following
+ * them (and their string values) down.
+ */
+static void duk__tokrec_drop(duk_compiler_ctx *comp_ctx, int idx_start, int idx_end) {
+	duk__token_record *recs;
+	int val_start;
+	int val_end;
+	int i;
+
+	DUK_ASSERT(idx_start >= 0 && idx_start <= idx_end && idx_end <= comp_ctx->tokrec_count);
+	DUK_ASSERT(comp_ctx->tokrec_next == comp_ctx->tokrec_count);
+
+	if (idx_start == idx_end) {
+		return;
+	}
+
+	recs = (duk__token_record *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(comp_ctx->h_tokrec);
+	val_start = recs[idx_start].val_idx;
+	val_end = (idx_end < comp_ctx->tokrec_count ? recs[idx_end].val_idx : comp_ctx->tokvals_count);
+	duk__tokvals_remove(comp_ctx, val_start, val_end);
+	for (i = idx_end; i < comp_ctx->tokrec_count; i++) {
+		recs[i].val_idx -= val_end - val_start;
+	}
+
+	duk_hbuffer_remove_slice(comp_ctx->thr,
+	                         comp_ctx->h_tokrec,
+	                         (size_t) idx_start * sizeof(duk__token_record),
+	                         (size_t) (idx_end - idx_start) * sizeof(duk__token_record));
+	comp_ctx->tokrec_count -= idx_end - idx_start;
+	comp_ctx->tokrec_next = comp_ctx->tokrec_count;
+}
+
+/* Lex recorded tokens [idx_start, tokrec_count[ which were lexed in non-strict
+ * mode again in strict mode, only to detect errors.  Needed for the tokens
+ * preceding a 'use strict' directive when there is no pass 2.
+ */
+static void duk__tokrec_check_strict(duk_compiler_ctx *comp_ctx, int idx_start) {
+	duk_context *ctx = (duk_context *) comp_ctx->thr;
+	duk__token_record *rec;
+	duk_lexer_point lex_pt_curr;
+	duk_lexer_point lex_pt_tok;
+	duk_token tok;
+	int slot1_idx;
+	int slot2_idx;
+	int i;
+
+	DUK_LEXER_GETPOINT(&comp_ctx->lex, &lex_pt_curr);
+	slot1_idx = comp_ctx->lex.slot1_idx;
+	slot2_idx = comp_ctx->lex.slot2_idx;
+	duk_push_undefined(ctx);
+	duk_push_undefined(ctx);
+	comp_ctx->lex.slot1_idx = duk_get_top(ctx) - 2;  /* don't clobber curr_token values */
+	comp_ctx->lex.slot2_idx = duk_get_top(ctx) - 1;
+
+	for (i = idx_start; i < comp_ctx->tokrec_count; i++) {
+		rec = (duk__token_record *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(comp_ctx->h_tokrec) + i;
+		if (rec->flags & DUK__TOKREC_FLAG_STRICT) {
+			continue;
+		}
+		DUK_DDD(DUK_DDDPRINT("lex recorded token %d again in strict mode", i));
+		lex_pt_tok.offset = rec->tok.start_offset;
+		lex_pt_tok.line = rec->tok.start_line;
+		DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt_tok);
+		duk_lexer_parse_js_input_element(&comp_ctx->lex,
+		                                 &tok,
+		                                 1 /*strict*/,
+		                                 rec->flags & DUK__TOKREC_FLAG_REGEXP ? 1 : 0);
+	}
+
+	comp_ctx->lex.slot1_idx = slot1_idx;
+	comp_ctx->lex.slot2_idx = slot2_idx;
+	duk_pop_2(ctx);
+	DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt_curr);
+}
+
 /* XXX: valstack handling is awkward.  Add a valstack helper which
  * avoids dup():ing; valstack_copy(src, dst)?
  */
@@ -431,11 +712,18 @@ static void duk__advance_helper(duk_compiler_ctx *comp_ctx, int expect) {
 	duk_dup(ctx, comp_ctx->tok12_idx);
 	duk_replace(ctx, comp_ctx->tok22_idx);
 
-	/* parse new token */
-	duk_lexer_parse_js_input_element(&comp_ctx->lex,
-	                                 &comp_ctx->curr_token,
-	                                 comp_ctx->curr_func.is_strict,
-	                                 regexp);
+	/* parse new token, or replay a token recorded on pass 1 */
+	if (comp_ctx->tokrec_next < comp_ctx->tokrec_count) {
+		duk__replay_token(comp_ctx, comp_ctx->curr_func.is_strict, regexp);
+	} else {
+		duk_lexer_parse_js_input_element(&comp_ctx->lex,
+		                                 &comp_ctx->curr_token,
+		                                 comp_ctx->curr_func.is_strict,
+		                                 regexp);
+		if (comp_ctx->tokrec_enabled) {
+			duk__record_token(comp_ctx, comp_ctx->curr_func.is_strict, regexp);
+		}
+	}
 
 	DUK_DDD(DUK_DDDPRINT("advance: curr: tok=%d/%d,%d-%d,term=%d,%!T,%!T "
 	                     "prev: tok=%d/%d,%d-%d,term=%d,%!T,%!T",
@@ -483,12 +771,19 @@ static void duk__init_func_valstack_slots(duk_compiler_ctx *comp_ctx) {
 	func->h_name = NULL;
 	func->h_code = NULL;
 	func->h_consts = NULL;
+	func->h_strconstmap = NULL;
+	func->h_numconstmap = NULL;
 	func->h_funcs = NULL;
 	func->h_decls = NULL;
 	func->h_labelnames = NULL;
 	func->h_labelinfos = NULL;
 	func->h_argnames = NULL;
 	func->h_varmap = NULL;
+	func->h_idrefs = NULL;
+	func->h_funcidrefs = NULL;
+#if defined(DUK_USE_LAZY_COMPILE)
+	func->h_preparse = NULL;
+#endif
 #endif
 
 	duk_require_stack(ctx, DUK__FUNCTION_INIT_REQUIRE_SLOTS);
@@ -537,29 +832,65 @@ static void duk__init_func_valstack_slots(duk_compiler_ctx *comp_ctx) {
 	func->varmap_idx = entry_top + 7;
 	func->h_varmap = duk_get_hobject(ctx, entry_top + 7);
 	DUK_ASSERT(func->h_varmap != NULL);
+
+	duk_push_object_internal(ctx);
+	func->idrefs_idx = entry_top + 8;
+	func->h_idrefs = duk_get_hobject(ctx, entry_top + 8);
+	DUK_ASSERT(func->h_idrefs != NULL);
+
+	duk_push_array(ctx);
+	func->funcidrefs_idx = entry_top + 9;
+	func->h_funcidrefs = duk_get_hobject(ctx, entry_top + 9);
+	DUK_ASSERT(func->h_funcidrefs != NULL);
+
+	/* const maps are created on demand by duk__getconst() */
+	duk_push_undefined(ctx);
+	func->strconstmap_idx = entry_top + 10;
+	DUK_ASSERT(func->h_strconstmap == NULL);
+
+	duk_push_undefined(ctx);
+	func->numconstmap_idx = entry_top + 11;
+	DUK_ASSERT(func->h_numconstmap == NULL);
+
+#if defined(DUK_USE_LAZY_COMPILE)
+	/* preparse data buffer is created by duk__parse_func_like_fnum() */
+	duk_push_undefined(ctx);
+	func->preparse_idx = entry_top + 12;
+	DUK_ASSERT(func->h_preparse == NULL);
+#endif
 }
 
 /* reset function state (prepare for pass 2) */
 static void duk__reset_func_for_pass2(duk_compiler_ctx *comp_ctx) {
 	duk_compiler_func *func = &comp_ctx->curr_func;
 	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
 
 	/* XXX: reset buffers while keeping existing spare */
 
 	duk_hbuffer_reset(thr, func->h_code);
 	duk_hobject_set_length_zero(thr, func->h_consts);
+	/* const maps are recreated on demand */
+	duk_push_undefined(ctx);
+	duk_replace(ctx, func->strconstmap_idx);
+	func->h_strconstmap = NULL;
+	duk_push_undefined(ctx);
+	duk_replace(ctx, func->numconstmap_idx);
+	func->h_numconstmap = NULL;
 	/* keep func->h_funcs; inner functions are not reparsed to avoid O(depth^2) parsing */
 	func->fnum_next = 0;
 	/* duk_hobject_set_length_zero(thr, func->h_funcs); */
 	duk_hobject_set_length_zero(thr, func->h_labelnames);
 	duk_hbuffer_reset(thr, func->h_labelinfos);
 	/* keep func->h_argnames; it is fixed for all passes */
+	/* keep func->h_idrefs and func->h_funcidrefs; inner functions are only parsed on pass 1 */
 }
 
 /* cleanup varmap from any null entries, compact it, etc; returns number
- * of final entries after cleanup.
+ * of final entries after cleanup.  If 'h_keep' is non-NULL, only register
+ * bindings whose name is a key of 'h_keep' are retained.
  */
-static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx) {
+static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx, duk_hobject *h_keep) {
 	duk_hthread *thr = comp_ctx->thr;
 	duk_context *ctx = (duk_context *) thr;
 	duk_hobject *h_varmap;
@@ -573,6 +904,9 @@ static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx) {
 	h_varmap = duk_get_hobject(ctx, -1);
 	DUK_ASSERT(h_varmap != NULL);
 
+	/* keys are removed in place below */
+	DUK_HOBJECT_E_UNSHARE(thr, h_varmap);
+
 	ret = 0;
 	e_used = h_varmap->e_used;
 	for (i = 0; i < e_used; i++) {
@@ -591,7 +925,8 @@ static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx) {
 		 */
 
 		tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(h_varmap, i);
-		if (!DUK_TVAL_IS_NUMBER(tv)) {
+		if (!DUK_TVAL_IS_NUMBER(tv) ||
+		    (h_keep != NULL && duk_hobject_find_existing_entry_tval_ptr(h_keep, h_key) == NULL)) {
 			DUK_ASSERT(!DUK_TVAL_IS_HEAP_ALLOCATED(tv));
 			DUK_TVAL_SET_UNDEFINED_UNUSED(tv);
 			DUK_HOBJECT_E_SET_KEY(h_varmap, i, NULL);
@@ -606,6 +941,45 @@ static int duk__cleanup_varmap(duk_compiler_ctx *comp_ctx) {
 	return ret;
 }
 
+/* Check whether inner function 'fnum' may refer to a binding in the current
+ * function's environment record.  Inner functions whose free identifiers
+ * are unknown (direct eval) are assumed to capture.
+ */
+static int duk__inner_func_may_capture(duk_compiler_ctx *comp_ctx, int fnum) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+	duk_compiler_func *func = &comp_ctx->curr_func;
+	int ret = 0;
+
+	duk_get_prop_index(ctx, func->funcidrefs_idx, fnum);
+	if (!duk_is_object(ctx, -1)) {
+		duk_pop(ctx);
+		return 1;
+	}
+
+	duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+	while (duk_next(ctx, -1, 0 /*get_value*/)) {
+		/* [ ... idrefs enum key ] */
+
+		/* 'arguments' may be bound in the environment record even
+		 * though it's not in the varmap.
+		 */
+		if (duk_get_hstring(ctx, -1) == DUK_HTHREAD_STRING_LC_ARGUMENTS(thr)) {
+			duk_pop(ctx);
+			ret = 1;
+			break;
+		}
+		if (duk_has_prop(ctx, func->varmap_idx)) {  /* consumes key */
+			ret = 1;
+			break;
+		}
+	}
+	DUK_DDD(DUK_DDDPRINT("inner function %d may capture an outer binding: %d", fnum, ret));
+
+	duk_pop_2(ctx);
+	return ret;
+}
+
 /* convert duk_compiler_func into a function template, leaving the result
  * on top of stack.
  */
@@ -692,9 +1066,9 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	 */
 
 	consts_count = duk_hobject_get_length(comp_ctx->thr, func->h_consts);
-	funcs_count = duk_hobject_get_length(comp_ctx->thr, func->h_funcs) / 3;
+	funcs_count = duk_hobject_get_length(comp_ctx->thr, func->h_funcs) / 4;
 	code_count = DUK_HBUFFER_GET_SIZE(func->h_code) / sizeof(duk_compiler_instr);
-	code_size = code_count * sizeof(duk_instr);
+	code_size = code_count * DUK_HCOMPILEDFUNCTION_CODE_ENTRY_SIZE;  /* includes inline caches, if any */
 
 	data_size = consts_count * sizeof(duk_tval) +
 	            funcs_count * sizeof(duk_hobject *) +
@@ -719,6 +1093,12 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 		tv = duk_hobject_find_existing_array_entry_tval_ptr(func->h_consts, i);
 		DUK_ASSERT(tv != NULL);
 		DUK_TVAL_SET_TVAL(p_const, tv);
+#if defined(DUK_USE_FASTINT)
+		if (DUK_TVAL_IS_NUMBER(tv)) {
+			/* whole number constants are used as fastints by the executor */
+			DUK_TVAL_SET_NUMBER_CHKFAST(p_const, DUK_TVAL_GET_NUMBER(tv));
+		}
+#endif
 		p_const++;
 		DUK_TVAL_INCREF(thr, tv);  /* may be a string constant */
 
@@ -729,7 +1109,7 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	h_res->funcs = p_func;
 	for (i = 0; i < funcs_count; i++) {
 		duk_hobject *h;
-		tv = duk_hobject_find_existing_array_entry_tval_ptr(func->h_funcs, i * 3);
+		tv = duk_hobject_find_existing_array_entry_tval_ptr(func->h_funcs, i * 4);
 		DUK_ASSERT(tv != NULL);
 		DUK_ASSERT(DUK_TVAL_IS_OBJECT(tv));
 		h = DUK_TVAL_GET_OBJECT(tv);
@@ -752,6 +1132,14 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	}
 	/* Note: 'q_instr' is still used below */
 
+#if defined(DUK_USE_PROPERTY_IC)
+	/* inline caches start out empty */
+	DUK_MEMSET((void *) (p_instr + code_count),
+	           0xff,
+	           code_count * DUK_HCOMPILEDFUNCTION_IC_WAYS * sizeof(duk_uint16_t));
+	DUK_ASSERT(DUK_HOBJECT_IC_EMPTY == 0xffffU);
+#endif
+
 	duk_pop(ctx);  /* 'data' (and everything in it) is reachable through h_res now */
 
 	/*
@@ -765,16 +1153,47 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 
 	/* [ ... res ] */
 
+	/* Capture analysis: an inner function which cannot refer to any binding
+	 * of this function is flagged NOCAPTURE, so that creating a closure for
+	 * it doesn't force this function's environment record to be created
+	 * (see DUK_OP_CLOSURE).  A direct eval may declare new bindings into
+	 * the environment record, so nothing is flagged in that case.
+	 */
+	if (func->is_function && !func->may_direct_eval) {
+		for (i = 0; i < funcs_count; i++) {
+			if (!duk__inner_func_may_capture(comp_ctx, (int) i)) {
+				DUK_DDD(DUK_DDDPRINT("inner function %d captures nothing -> set NOCAPTURE", (int) i));
+				DUK_HOBJECT_SET_NOCAPTURE(h_res->funcs[i]);
+			}
+		}
+	}
+
 	/* _varmap: omitted if function is guaranteed not to do slow path identifier
 	 * accesses or if it would turn out to be empty of actual register mappings
-	 * after a cleanup.
+	 * after a cleanup.  Unless a direct eval may look up arbitrary names, only
+	 * register bindings which are actually looked up through the scope chain
+	 * (by the function itself or by inner functions) are kept; the rest never
+	 * need to be visible in the environment record.  The formals of a non-strict
+	 * function with an arguments object are accessed through the environment
+	 * record by the arguments object, so they're kept too.
 	 */
-	if (func->id_access_slow ||     /* directly uses slow accesses */
-	    func->may_direct_eval ||    /* may indirectly slow access through a direct eval */
-	    funcs_count > 0) {          /* has inner functions which may slow access (XXX: this can be optimized by looking at the inner functions) */
+	if (func->is_lazy) {
+		/* no code to access the varmap yet */
+	} else if (func->id_access_slow ||     /* directly uses slow accesses */
+	           func->may_direct_eval ||    /* may indirectly slow access through a direct eval */
+	           funcs_count > 0) {          /* has inner functions which may slow access */
+		duk_hobject *h_keep;
 		int num_used;
+
+		h_keep = func->h_idrefs;
+		if (func->may_direct_eval ||
+		    func->inner_may_direct_eval ||
+		    (DUK_HOBJECT_HAS_CREATEARGS((duk_hobject *) h_res) && !func->is_strict)) {
+			h_keep = NULL;
+		}
+
 		duk_dup(ctx, func->varmap_idx);
-		num_used = duk__cleanup_varmap(comp_ctx);
+		num_used = duk__cleanup_varmap(comp_ctx, h_keep);
 		DUK_DDD(DUK_DDDPRINT("cleaned up varmap: %!T (num_used=%d)", duk_get_tval(ctx, -1), num_used));
 
 		if (num_used > 0) {
@@ -847,7 +1266,7 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 
 	/* _pc2line */
 #if defined(DUK_USE_PC2LINE)
-	if (1) {
+	if (!func->is_lazy) {
 		/*
 		 *  Size-optimized pc->line mapping.
 		 */
@@ -882,9 +1301,15 @@ static void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	 *  undefined.
 	 */
 
-	DUK_ASSERT(func->temp_max >= 0);
-	h_res->nregs = func->temp_max;
-	h_res->nargs = duk_hobject_get_length(thr, func->h_argnames);
+	if (func->is_lazy) {
+		/* never called before being compiled */
+		DUK_ASSERT(h_res->nregs == 0);
+		DUK_ASSERT(h_res->nargs == 0);
+	} else {
+		DUK_ASSERT(func->temp_max >= 0);
+		h_res->nregs = func->temp_max;
+		h_res->nargs = duk_hobject_get_length(thr, func->h_argnames);
+	}
 	DUK_ASSERT(h_res->nregs >= h_res->nargs);  /* pass2 allocation handles this */
 
 	DUK_DD(DUK_DDPRINT("converted function: %!ixT", duk_get_tval(ctx, -1)));
@@ -1463,6 +1888,24 @@ static void duk__emit_invalid(duk_compiler_ctx *comp_ctx) {
 	duk__emit_abc(comp_ctx, DUK_OP_INVALID, 0);
 }
 
+/* Remove code emitted starting from 'pc'.  Used for unreachable code,
+ * which must still be parsed for syntax errors and declarations.  The
+ * removed range must be self-contained: jumps and label sites inside the
+ * range may only be referenced from inside the range.
+ */
+static void duk__remove_code(duk_compiler_ctx *comp_ctx, int pc) {
+	duk_hbuffer_dynamic *h;
+	duk_size_t offset;
+
+	h = comp_ctx->curr_func.h_code;
+	offset = (duk_size_t) pc * sizeof(duk_compiler_instr);
+	DUK_ASSERT(offset <= DUK_HBUFFER_GET_SIZE(h));
+
+	DUK_DDD(DUK_DDDPRINT("removing unreachable code: pc %d -> %d",
+	                     pc, duk__get_current_pc(comp_ctx)));
+	duk_hbuffer_remove_slice(comp_ctx->thr, h, offset, DUK_HBUFFER_GET_SIZE(h) - offset);
+}
+
 /*
  *  Peephole optimizer for finished bytecode.
  *
@@ -1628,43 +2071,133 @@ static void duk__settemp_checkmax(duk_compiler_ctx *comp_ctx, int temp_next) {
 	}
 }
 
+/* Push the const map key for the value at valstack top and return the
+ * valstack index of the const map to use, or -1 if the value type has no
+ * const map.  Strings and numbers need separate maps because e.g. 1 and
+ * '1' have the same property key.  Strict equality is NOT enough for
+ * dedup (we cannot use the same constant for +0 and -0), the key must
+ * match SameValue: ToString() is unique for all numbers except +0/-0, so
+ * -0 is keyed as '-0' instead.  All NaNs map to 'NaN' which is correct.
+ */
+static int duk__constmap_push_key(duk_compiler_ctx *comp_ctx) {
+	duk_context *ctx = (duk_context *) comp_ctx->thr;
+	duk_compiler_func *f = &comp_ctx->curr_func;
+	duk_tval *tv;
+
+	tv = duk_get_tval(ctx, -1);
+	DUK_ASSERT(tv != NULL);
+
+	if (DUK_TVAL_IS_STRING(tv)) {
+		duk_dup_top(ctx);
+		return f->strconstmap_idx;
+	} else if (DUK_TVAL_IS_NUMBER(tv)) {
+		duk_double_t d = DUK_TVAL_GET_NUMBER(tv);
+
+		if (d == 0 && DUK_SIGNBIT(d)) {
+			duk_push_hstring_stridx(ctx, DUK_STRIDX_MINUS_ZERO);
+		} else {
+			duk_dup_top(ctx);
+			duk_to_string(ctx, -1);
+		}
+		return f->numconstmap_idx;
+	}
+	return -1;
+}
+
+/* Create const maps and index existing constants into them. */
+static void duk__constmap_init(duk_compiler_ctx *comp_ctx, int n) {
+	duk_context *ctx = (duk_context *) comp_ctx->thr;
+	duk_compiler_func *f = &comp_ctx->curr_func;
+	int i, map_idx;
+
+	duk_push_object_internal(ctx);
+	duk_replace(ctx, f->strconstmap_idx);
+	f->h_strconstmap = duk_get_hobject(ctx, f->strconstmap_idx);
+	duk_push_object_internal(ctx);
+	duk_replace(ctx, f->numconstmap_idx);
+	f->h_numconstmap = duk_get_hobject(ctx, f->numconstmap_idx);
+
+	for (i = 0; i < n; i++) {
+		duk_get_prop_index(ctx, f->consts_idx, i);
+		map_idx = duk__constmap_push_key(comp_ctx);
+		if (map_idx >= 0) {
+			/* constants are unique so no existing key is overwritten */
+			duk_push_int(ctx, i);
+			duk_put_prop(ctx, map_idx);
+		}
+		duk_pop(ctx);
+	}
+}
+
 /* get const for value at valstack top */
 static int duk__getconst(duk_compiler_ctx *comp_ctx) {
 	duk_hthread *thr = comp_ctx->thr;
 	duk_context *ctx = (duk_context *) thr;
 	duk_compiler_func *f = &comp_ctx->curr_func;
-	duk_tval *tv1;
-	int i, n, n_check;
+	int i, n;
+	int map_idx;
 
 	n = duk_get_length(ctx, f->consts_idx);
 
-	tv1 = duk_get_tval(ctx, -1);
-	DUK_ASSERT(tv1 != NULL);
-
-	/* Sanity workaround for handling functions with a large number of
-	 * constants at least somewhat reasonably.  Otherwise checking whether
-	 * we already have the constant would grow very slow (as it is O(N^2)).
+	/* Functions with only a few constants use a linear scan.  Once the
+	 * number of constants grows, const maps are used so that lookups
+	 * are O(1) instead of O(n).
 	 */
-	n_check = (n > DUK__GETCONST_MAX_CONSTS_CHECK ? DUK__GETCONST_MAX_CONSTS_CHECK : n);
-	for (i = 0; i < n_check; i++) {
-		duk_tval *tv2 = DUK_HOBJECT_A_GET_VALUE_PTR(f->h_consts, i);
+	if (f->h_strconstmap == NULL && n >= DUK__CONSTMAP_MIN_CONSTS) {
+		DUK_DDD(DUK_DDDPRINT("%d constants, switch to const maps", n));
+		duk__constmap_init(comp_ctx, n);
+	}
 
-		/* Strict equality is NOT enough, because we cannot use the same
-		 * constant for e.g. +0 and -0.
-		 */
-		if (duk_js_samevalue(tv1, tv2)) {
-			DUK_DDD(DUK_DDDPRINT("reused existing constant for %!T -> const index %d", tv1, i));
-			duk_pop(ctx);
+	map_idx = -1;
+	if (f->h_strconstmap != NULL) {
+		map_idx = duk__constmap_push_key(comp_ctx);
+	}
+
+	if (map_idx >= 0) {
+		/* [ ... value key ] */
+		duk_dup_top(ctx);
+		if (duk_get_prop(ctx, map_idx)) {
+			i = duk_get_int(ctx, -1);
+			DUK_ASSERT(i >= 0 && i < n);
+			DUK_ASSERT(duk_js_samevalue(duk_get_tval(ctx, -3), DUK_HOBJECT_A_GET_VALUE_PTR(f->h_consts, i)));
+			DUK_DDD(DUK_DDDPRINT("reused existing constant for %!T -> const index %d",
+			                     duk_get_tval(ctx, -3), i));
+			duk_pop_3(ctx);
 			return i | DUK__CONST_MARKER;
 		}
+		duk_pop(ctx);
+	} else {
+		duk_tval *tv1 = duk_get_tval(ctx, -1);
+		DUK_ASSERT(tv1 != NULL);
+
+		for (i = 0; i < n; i++) {
+			duk_tval *tv2 = DUK_HOBJECT_A_GET_VALUE_PTR(f->h_consts, i);
+
+			/* Strict equality is NOT enough, because we cannot use the same
+			 * constant for e.g. +0 and -0.
+			 */
+			if (duk_js_samevalue(tv1, tv2)) {
+				DUK_DDD(DUK_DDDPRINT("reused existing constant for %!T -> const index %d", tv1, i));
+				duk_pop(ctx);
+				return i | DUK__CONST_MARKER;
+			}
+		}
 	}
 
 	if (n >= DUK__MAX_CONSTS) {
 		DUK_ERROR(comp_ctx->thr, DUK_ERR_INTERNAL_ERROR, "out of consts");
 	}
 
-	DUK_DDD(DUK_DDDPRINT("allocating new constant for %!T -> const index %d", tv1, n));
-	(void) duk_put_prop_index(ctx, f->consts_idx, n);  /* invalidates tv1, tv2 */
+	if (map_idx >= 0) {
+		/* [ ... value key ] */
+		duk_push_int(ctx, n);
+		duk_put_prop(ctx, map_idx);
+	}
+
+	/* [ ... value ] */
+
+	DUK_DDD(DUK_DDDPRINT("allocating new constant for %!T -> const index %d", duk_get_tval(ctx, -1), n));
+	(void) duk_put_prop_index(ctx, f->consts_idx, n);
 	return n | DUK__CONST_MARKER;
 }
 
@@ -1769,6 +2302,10 @@ static int duk__ispec_toregconst_raw(duk_compiler_ctx *comp_ctx,
 			DUK_UNREACHABLE();
 			break;
 		}
+		case DUK_TAG_LIGHTFUNC: {
+			DUK_UNREACHABLE();
+			break;
+		}
 		default: {
 			/* number */
 			int constidx;
@@ -1841,6 +2378,198 @@ static int duk__ispec_toforcedreg(duk_compiler_ctx *comp_ctx, duk_ispec *x, int
 	return duk__ispec_toregconst_raw(comp_ctx, x, forced_reg, 0 /*flags*/);
 }
 
+#define DUK__FOLD_NONPRIMITIVE_MASK  (DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_BUFFER | DUK_TYPE_MASK_POINTER)
+
+/* Fold a binary operation whose arguments are both constant values into
+ * a plain constant value.  Constant values are always primitives so the
+ * coercions involved have no side effects and use the same helpers as
+ * the executor, so the result is identical to run time evaluation.
+ * Returns 1 if 'x' was folded, 0 if it must be evaluated at run time.
+ */
+static int duk__ivalue_fold_binary(duk_compiler_ctx *comp_ctx, duk_ivalue *x) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+	int idx1;
+	int idx2;
+	int op;
+	double d1;
+	double d2;
+	duk_int32_t i1;
+	duk_int32_t i2;
+	duk_uint32_t u2;
+
+	if (x->t != DUK_IVAL_ARITH ||
+	    x->x1.t != DUK_ISPEC_VALUE || x->x2.t != DUK_ISPEC_VALUE) {
+		return 0;
+	}
+	idx1 = x->x1.valstack_idx;
+	idx2 = x->x2.valstack_idx;
+	op = x->op;
+	if (duk_check_type_mask(ctx, idx1, DUK__FOLD_NONPRIMITIVE_MASK) ||
+	    duk_check_type_mask(ctx, idx2, DUK__FOLD_NONPRIMITIVE_MASK)) {
+		return 0;
+	}
+
+	DUK_DDD(DUK_DDDPRINT("fold binary op %d: %!T, %!T",
+	                     op, duk_get_tval(ctx, idx1), duk_get_tval(ctx, idx2)));
+
+	switch (op) {
+	case DUK_OP_ADD:
+		if (duk_is_string(ctx, idx1) || duk_is_string(ctx, idx2)) {
+			duk_dup(ctx, idx1);
+			duk_to_string(ctx, -1);
+			duk_dup(ctx, idx2);
+			duk_to_string(ctx, -1);
+			duk_concat(ctx, 2);
+			break;
+		}
+		/* fall through */
+	case DUK_OP_SUB:
+	case DUK_OP_MUL:
+	case DUK_OP_DIV:
+	case DUK_OP_MOD: {
+		d1 = duk_js_tonumber(thr, duk_get_tval(ctx, idx1));
+		d2 = duk_js_tonumber(thr, duk_get_tval(ctx, idx2));
+		switch (op) {
+		case DUK_OP_ADD:  d1 = d1 + d2; break;
+		case DUK_OP_SUB:  d1 = d1 - d2; break;
+		case DUK_OP_MUL:  d1 = d1 * d2; break;
+		case DUK_OP_DIV:  d1 = d1 / d2; break;
+		default:          d1 = DUK_FMOD(d1, d2); break;
+		}
+		duk_push_number(ctx, d1);
+		break;
+	}
+	case DUK_OP_BAND:
+	case DUK_OP_BOR:
+	case DUK_OP_BXOR:
+	case DUK_OP_BASL:
+	case DUK_OP_BLSR:
+	case DUK_OP_BASR: {
+		/* E5 Sections 11.10, 11.7.1, 11.7.2, 11.7.3 */
+		i1 = duk_js_toint32(thr, duk_get_tval(ctx, idx1));
+		i2 = duk_js_toint32(thr, duk_get_tval(ctx, idx2));
+		u2 = ((duk_uint32_t) i2) & 0x1fU;
+		switch (op) {
+		case DUK_OP_BAND:  duk_push_int(ctx, i1 & i2); break;
+		case DUK_OP_BOR:   duk_push_int(ctx, i1 | i2); break;
+		case DUK_OP_BXOR:  duk_push_int(ctx, i1 ^ i2); break;
+		case DUK_OP_BASL:  duk_push_int(ctx, (duk_int32_t) (((duk_uint32_t) i1) << u2)); break;
+		case DUK_OP_BASR:  duk_push_int(ctx, i1 >> u2); break;
+		default:           duk_push_number(ctx, (double) (((duk_uint32_t) i1) >> u2)); break;
+		}
+		break;
+	}
+	case DUK_OP_EQ:
+	case DUK_OP_NEQ: {
+		duk_push_boolean(ctx, duk_js_equals(thr, duk_get_tval(ctx, idx1), duk_get_tval(ctx, idx2)) ^ (op == DUK_OP_NEQ));
+		break;
+	}
+	case DUK_OP_SEQ:
+	case DUK_OP_SNEQ: {
+		duk_push_boolean(ctx, duk_js_strict_equals(duk_get_tval(ctx, idx1), duk_get_tval(ctx, idx2)) ^ (op == DUK_OP_SNEQ));
+		break;
+	}
+	case DUK_OP_GT: {
+		duk_push_boolean(ctx, duk_js_compare_helper(thr, duk_get_tval(ctx, idx2), duk_get_tval(ctx, idx1), 0));
+		break;
+	}
+	case DUK_OP_GE: {
+		duk_push_boolean(ctx, duk_js_compare_helper(thr, duk_get_tval(ctx, idx1), duk_get_tval(ctx, idx2),
+		                                            DUK_COMPARE_FLAG_EVAL_LEFT_FIRST | DUK_COMPARE_FLAG_NEGATE));
+		break;
+	}
+	case DUK_OP_LT: {
+		duk_push_boolean(ctx, duk_js_compare_helper(thr, duk_get_tval(ctx, idx1), duk_get_tval(ctx, idx2),
+		                                            DUK_COMPARE_FLAG_EVAL_LEFT_FIRST));
+		break;
+	}
+	case DUK_OP_LE: {
+		duk_push_boolean(ctx, duk_js_compare_helper(thr, duk_get_tval(ctx, idx2), duk_get_tval(ctx, idx1),
+		                                            DUK_COMPARE_FLAG_NEGATE));
+		break;
+	}
+	default: {
+		/* INSTOF and IN throw for primitive arguments, leave them
+		 * to run time.
+		 */
+		return 0;
+	}
+	}
+
+	duk_replace(ctx, idx1);
+	x->t = DUK_IVAL_PLAIN;
+	DUK_ASSERT(x->x1.t == DUK_ISPEC_VALUE);
+	DUK_DDD(DUK_DDDPRINT("folded to %!T", duk_get_tval(ctx, idx1)));
+	return 1;
+}
+
+/* Fold a unary operation ('tok' is the operator token) on a constant value,
+ * see duk__ivalue_fold_binary().  Returns 1 if 'x' was folded.
+ */
+static int duk__ivalue_fold_unary(duk_compiler_ctx *comp_ctx, duk_ivalue *x, int tok) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+	duk_tval *tv;
+
+	duk__ivalue_fold_binary(comp_ctx, x);
+	if (x->t != DUK_IVAL_PLAIN || x->x1.t != DUK_ISPEC_VALUE ||
+	    duk_check_type_mask(ctx, x->x1.valstack_idx, DUK__FOLD_NONPRIMITIVE_MASK)) {
+		return 0;
+	}
+	tv = duk_get_tval(ctx, x->x1.valstack_idx);
+	DUK_ASSERT(tv != NULL);
+
+	switch (tok) {
+	case DUK_TOK_ADD: {
+		duk_push_number(ctx, duk_js_tonumber(thr, tv));
+		break;
+	}
+	case DUK_TOK_SUB: {
+		/* this is important to handle negative literals (which are not
+		 * directly provided by the lexical grammar)
+		 */
+		duk_push_number(ctx, -duk_js_tonumber(thr, tv));
+		break;
+	}
+	case DUK_TOK_BNOT: {
+		duk_push_int(ctx, ~duk_js_toint32(thr, tv));
+		break;
+	}
+	case DUK_TOK_LNOT: {
+		/* handles common idioms like '!0' and '!1' */
+		duk_push_boolean(ctx, !duk_js_toboolean(tv));
+		break;
+	}
+	case DUK_TOK_TYPEOF: {
+		duk_push_hstring(ctx, duk_js_typeof(thr, tv));
+		break;
+	}
+	default: {
+		return 0;
+	}
+	}
+
+	duk_replace(ctx, x->x1.valstack_idx);
+	DUK_DDD(DUK_DDDPRINT("folded unary token %d to %!T", tok, duk_get_tval(ctx, x->x1.valstack_idx)));
+	return 1;
+}
+
+/* Get the truth value of 'x' if it is a compile time constant: returns
+ * 0 or 1, or -1 if the value is only known at run time.  Code for 'x'
+ * (e.g. side effects of a comma expression) is not affected.
+ */
+static int duk__ivalue_get_const_truth(duk_compiler_ctx *comp_ctx, duk_ivalue *x) {
+	duk_context *ctx = (duk_context *) comp_ctx->thr;
+
+	duk__ivalue_fold_binary(comp_ctx, x);
+	if (x->t != DUK_IVAL_PLAIN || x->x1.t != DUK_ISPEC_VALUE ||
+	    duk_check_type_mask(ctx, x->x1.valstack_idx, DUK__FOLD_NONPRIMITIVE_MASK)) {
+		return -1;
+	}
+	return duk_js_toboolean(duk_get_tval(ctx, x->x1.valstack_idx));
+}
+
 /* Coerce an duk_ivalue to a 'plain' value by generating the necessary
  * arithmetic operations, property access, or variable access bytecode.
  * The duk_ivalue argument ('x') is converted into a plain value as a
@@ -1861,62 +2590,15 @@ static void duk__ivalue_toplain_raw(duk_compiler_ctx *comp_ctx, duk_ivalue *x, i
 	case DUK_IVAL_PLAIN: {
 		return;
 	}
-	/* XXX: support unary arithmetic ivalues (useful?) */
 	case DUK_IVAL_ARITH: {
 		int arg1;
 		int arg2;
 		int dest;
-		duk_tval *tv1;
-		duk_tval *tv2;
 
 		DUK_DDD(DUK_DDDPRINT("arith to plain conversion"));
 
-		/* inline arithmetic check for constant values */
-		/* XXX: use the exactly same arithmetic function here as in executor */
-		if (x->x1.t == DUK_ISPEC_VALUE && x->x2.t == DUK_ISPEC_VALUE) {
-			tv1 = duk_get_tval(ctx, x->x1.valstack_idx);
-			tv2 = duk_get_tval(ctx, x->x2.valstack_idx);
-			DUK_ASSERT(tv1 != NULL);
-			DUK_ASSERT(tv2 != NULL);
-
-			DUK_DDD(DUK_DDDPRINT("arith: tv1=%!T, tv2=%!T", tv1, tv2));
-
-			if (DUK_TVAL_IS_NUMBER(tv1) && DUK_TVAL_IS_NUMBER(tv2)) {
-				double d1 = DUK_TVAL_GET_NUMBER(tv1);
-				double d2 = DUK_TVAL_GET_NUMBER(tv2);
-				double d3;
-				int accept = 1;
-
-				DUK_DDD(DUK_DDDPRINT("arith inline check: d1=%lf, d2=%lf, op=%d", d1, d2, x->op));
-				switch (x->op) {
-				case DUK_OP_ADD:	d3 = d1 + d2; break;
-				case DUK_OP_SUB:	d3 = d1 - d2; break;
-				case DUK_OP_MUL:	d3 = d1 * d2; break;
-				case DUK_OP_DIV:	d3 = d1 / d2; break;
-				default:		accept = 0; break;
-				}
-
-				if (accept) {
-					duk_double_union du;
-					du.d = d3;
-					DUK_DBLUNION_NORMALIZE_NAN_CHECK(&du);
-					d3 = du.d;
-
-					x->t = DUK_IVAL_PLAIN;
-					DUK_ASSERT(x->x1.t == DUK_ISPEC_VALUE);
-					DUK_TVAL_SET_NUMBER(tv1, d3);  /* old value is number: no refcount */
-					return;
-				}
-			} else if (x->op == DUK_OP_ADD && DUK_TVAL_IS_STRING(tv1) && DUK_TVAL_IS_STRING(tv2)) {
-				/* inline string concatenation */
-				duk_dup(ctx, x->x1.valstack_idx);
-				duk_dup(ctx, x->x2.valstack_idx);
-				duk_concat(ctx, 2);
-				duk_replace(ctx, x->x1.valstack_idx);
-				x->t = DUK_IVAL_PLAIN;
-				DUK_ASSERT(x->x1.t == DUK_ISPEC_VALUE);
-				return;
-			}
+		if (duk__ivalue_fold_binary(comp_ctx, x)) {
+			return;
 		}
 
 		arg1 = duk__ispec_toregconst_raw(comp_ctx, &x->x1, -1, DUK__IVAL_FLAG_ALLOW_CONST | DUK__IVAL_FLAG_REQUIRE_SHORT /*flags*/);
@@ -2071,6 +2753,41 @@ static int duk__ivalue_toregconst(duk_compiler_ctx *comp_ctx, duk_ivalue *x) {
 	return duk__ivalue_toregconst_raw(comp_ctx, x, -1, DUK__IVAL_FLAG_ALLOW_CONST /*flags*/);
 }
 
+/* Emit a conditional skip of the next instruction based on the truth value
+ * of 'x', i.e. the equivalent of coercing 'x' to a register/constant and
+ * emitting an IF.  A comparison is emitted as a fused IFCMP instead, which
+ * avoids a temporary and executes the following JUMP inline, so the caller
+ * must always emit a JUMP right after this.
+ */
+static void duk__ivalue_emit_if_skip(duk_compiler_ctx *comp_ctx, duk_ivalue *x, int truthval) {
+	int arg1;
+	int arg2;
+
+	if (x->t == DUK_IVAL_ARITH && x->op >= DUK_OP_EQ && x->op <= DUK_OP_LE) {
+		DUK_ASSERT(DUK_OP_NEQ == DUK_OP_EQ + 1 && DUK_OP_SEQ == DUK_OP_EQ + 2 &&
+		           DUK_OP_SNEQ == DUK_OP_EQ + 3 && DUK_OP_GT == DUK_OP_EQ + 4 &&
+		           DUK_OP_GE == DUK_OP_EQ + 5 && DUK_OP_LT == DUK_OP_EQ + 6 &&
+		           DUK_OP_LE == DUK_OP_EQ + 7);
+
+		/* same argument coercion as in duk__ivalue_toplain_raw() */
+		arg1 = duk__ispec_toregconst_raw(comp_ctx, &x->x1, -1, DUK__IVAL_FLAG_ALLOW_CONST | DUK__IVAL_FLAG_REQUIRE_SHORT /*flags*/);
+		arg2 = duk__ispec_toregconst_raw(comp_ctx, &x->x2, -1, DUK__IVAL_FLAG_ALLOW_CONST | DUK__IVAL_FLAG_REQUIRE_SHORT /*flags*/);
+		duk__emit_a_b_c(comp_ctx,
+		                DUK_OP_IFCMP | DUK__EMIT_FLAG_NO_SHUFFLE_A,
+		                x->op | (truthval ? DUK_BC_IFCMP_FLAG_TRUE : 0),
+		                arg1,
+		                arg2);
+		return;
+	}
+
+	arg1 = duk__ivalue_toregconst(comp_ctx, x);
+	if (truthval) {
+		duk__emit_if_true_skip(comp_ctx, arg1);
+	} else {
+		duk__emit_if_false_skip(comp_ctx, arg1);
+	}
+}
+
 /* The issues below can be solved with better flags */
 
 /* XXX: many operations actually want toforcedtemp() -- brand new temp? */
@@ -2137,6 +2854,18 @@ static int duk__lookup_active_register_binding(duk_compiler_ctx *comp_ctx) {
 	DUK_DDD(DUK_DDDPRINT("identifier lookup -> slow path"));
 
 	comp_ctx->curr_func.id_access_slow = 1;
+
+	/* Record the name for capture analysis.  Only the second pass is
+	 * relevant because the varmap is incomplete during the first pass,
+	 * except for a lazily compiled function which has no second pass:
+	 * all names it refers to are recorded, a conservative superset.
+	 * The caller keeps 'h_varname' reachable.
+	 */
+	if (!comp_ctx->curr_func.in_scanning || comp_ctx->curr_func.is_lazy) {
+		duk_push_hstring(ctx, h_varname);
+		duk_push_true(ctx);
+		duk_put_prop(ctx, comp_ctx->curr_func.idrefs_idx);
+	}
 	return -1;
 }
 
@@ -3174,6 +3903,9 @@ static void duk__expr_nud(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 			}
 		}
 
+		if (duk__ivalue_fold_unary(comp_ctx, res, tok)) {
+			return;
+		}
 		args = (DUK_EXTRAOP_TYPEOF << 8) + 0;
 		goto unary_extraop;
 	}
@@ -3188,10 +3920,7 @@ static void duk__expr_nud(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 	case DUK_TOK_ADD: {
 		/* unary plus */
 		duk__expr(comp_ctx, res, DUK__BP_MULTIPLICATIVE /*rbp_flags*/);  /* UnaryExpression */
-		if (res->t == DUK_IVAL_PLAIN && res->x1.t == DUK_ISPEC_VALUE &&
-		    duk_is_number(ctx, res->x1.valstack_idx)) {
-			/* unary plus of a number is identity */
-			;
+		if (duk__ivalue_fold_unary(comp_ctx, res, tok)) {
 			return;
 		}
 		args = (DUK_EXTRAOP_UNP << 8) + 0;
@@ -3200,20 +3929,7 @@ static void duk__expr_nud(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 	case DUK_TOK_SUB: {
 		/* unary minus */
 		duk__expr(comp_ctx, res, DUK__BP_MULTIPLICATIVE /*rbp_flags*/);  /* UnaryExpression */
-		if (res->t == DUK_IVAL_PLAIN && res->x1.t == DUK_ISPEC_VALUE &&
-		    duk_is_number(ctx, res->x1.valstack_idx)) {
-			/* this optimization is important to handle negative literals (which are not directly
-			 * provided by the lexical grammar
-			 */
-			duk_tval *tv_num = duk_get_tval(ctx, res->x1.valstack_idx);
-			duk_double_union du;
-
-			DUK_ASSERT(tv_num != NULL);
-			DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv_num));
-			du.d = DUK_TVAL_GET_NUMBER(tv_num);
-			du.d = -du.d;
-			DUK_DBLUNION_NORMALIZE_NAN_CHECK(&du);
-			DUK_TVAL_SET_NUMBER(tv_num, du.d);
+		if (duk__ivalue_fold_unary(comp_ctx, res, tok)) {
 			return;
 		}
 		args = (DUK_EXTRAOP_UNM << 8) + 0;
@@ -3221,39 +3937,16 @@ static void duk__expr_nud(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 	}
 	case DUK_TOK_BNOT: {
 		duk__expr(comp_ctx, res, DUK__BP_MULTIPLICATIVE /*rbp_flags*/);  /* UnaryExpression */
+		if (duk__ivalue_fold_unary(comp_ctx, res, tok)) {
+			return;
+		}
 		args = (DUK_OP_BNOT << 8) + 0;
 		goto unary;
 	}
 	case DUK_TOK_LNOT: {
 		duk__expr(comp_ctx, res, DUK__BP_MULTIPLICATIVE /*rbp_flags*/);  /* UnaryExpression */
-		if (res->t == DUK_IVAL_PLAIN && res->x1.t == DUK_ISPEC_VALUE) {
-			/* Very minimal inlining to handle common idioms '!0' and '!1',
-			 * and also boolean arguments like '!false' and '!true'.
-			 */
-			duk_tval *tv_val = duk_get_tval(ctx, res->x1.valstack_idx);
-
-			DUK_ASSERT(tv_val != NULL);
-			if (DUK_TVAL_IS_NUMBER(tv_val)) {
-				duk_double_t d;
-				d = DUK_TVAL_GET_NUMBER(tv_val);
-				if (d == 0.0) {
-					/* Matches both +0 and -0 on purpose. */
-					DUK_DDD(DUK_DDDPRINT("inlined lnot: !0 -> true"));
-					DUK_TVAL_SET_BOOLEAN_TRUE(tv_val);
-					return;
-				} else if (d == 1.0) {
-					DUK_DDD(DUK_DDDPRINT("inlined lnot: !1 -> false"));
-					DUK_TVAL_SET_BOOLEAN_FALSE(tv_val);
-					return;
-				}
-			} else if (DUK_TVAL_IS_BOOLEAN(tv_val)) {
-				duk_small_int_t v;
-				v = DUK_TVAL_GET_BOOLEAN(tv_val);
-				DUK_DDD(DUK_DDDPRINT("inlined lnot boolean: %d", (int) v));
-				DUK_ASSERT(v == 0 || v == 1);
-				DUK_TVAL_SET_BOOLEAN(tv_val, v ^ 0x01);
-				return;
-			}
+		if (duk__ivalue_fold_unary(comp_ctx, res, tok)) {
+			return;
 		}
 		args = (DUK_OP_LNOT << 8) + 0;
 		goto unary;
@@ -3317,11 +4010,20 @@ static void duk__expr_nud(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 
 			duk_dup(ctx, res->x1.valstack_idx);
 			if (duk__lookup_lhs(comp_ctx, &reg_varbind, &reg_varname)) {
-				duk__emit_extraop_b_c(comp_ctx,
-				                      args_op | DUK__EMIT_FLAG_B_IS_TARGET,
-				                      reg_varbind,
-				                      reg_varbind);
-				duk__emit_a_bc(comp_ctx, DUK_OP_LDREG, reg_res, reg_varbind);
+				if (DUK_BC_ISREG(reg_varbind)) {
+					/* in-place update, new value to reg_res */
+					duk__emit_a_b_c(comp_ctx,
+					                DUK_OP_INCDEC | DUK__EMIT_FLAG_NO_SHUFFLE_B | DUK__EMIT_FLAG_NO_SHUFFLE_C,
+					                reg_res,
+					                reg_varbind,
+					                (args_op == DUK_EXTRAOP_DEC ? DUK_BC_INCDEC_FLAG_DEC : 0));
+				} else {
+					duk__emit_extraop_b_c(comp_ctx,
+					                      args_op | DUK__EMIT_FLAG_B_IS_TARGET,
+					                      reg_varbind,
+					                      reg_varbind);
+					duk__emit_a_bc(comp_ctx, DUK_OP_LDREG, reg_res, reg_varbind);
+				}
 			} else {
 				duk__emit_a_bc(comp_ctx, DUK_OP_GETVAR, reg_res, reg_varname);
 				duk__emit_extraop_b_c(comp_ctx,
@@ -3693,6 +4395,32 @@ static void duk__expr_led(duk_compiler_ctx *comp_ctx, duk_ivalue *left, duk_ival
 		int reg_temp;
 		int pc_jump1;
 		int pc_jump2;
+		int truth;
+
+		truth = duk__ivalue_get_const_truth(comp_ctx, left);
+		if (truth >= 0) {
+			/* Constant condition: only the selected branch is
+			 * compiled, the other one is parsed and dropped.
+			 */
+			reg_temp = DUK__ALLOCTEMP(comp_ctx);
+			pc_jump1 = duk__get_current_pc(comp_ctx);
+			duk__expr_toforcedreg(comp_ctx, res, DUK__BP_COMMA /*rbp_flags*/, reg_temp /*forced_reg*/);  /* AssignmentExpression */
+			if (!truth) {
+				duk__remove_code(comp_ctx, pc_jump1);
+			}
+			duk__advance_expect(comp_ctx, DUK_TOK_COLON);
+			pc_jump2 = duk__get_current_pc(comp_ctx);
+			duk__expr_toforcedreg(comp_ctx, res, DUK__BP_COMMA /*rbp_flags*/, reg_temp /*forced_reg*/);  /* AssignmentExpression */
+			if (truth) {
+				duk__remove_code(comp_ctx, pc_jump2);
+			}
+
+			DUK__SETTEMP(comp_ctx, reg_temp + 1);
+			res->t = DUK_IVAL_PLAIN;
+			res->x1.t = DUK_ISPEC_REGCONST;
+			res->x1.regconst = reg_temp;
+			return;
+		}
 
 		reg_temp = DUK__ALLOCTEMP(comp_ctx);
 		duk__ivalue_toforcedreg(comp_ctx, left, reg_temp);
@@ -3868,6 +4596,27 @@ static void duk__expr_led(duk_compiler_ctx *comp_ctx, duk_ivalue *left, duk_ival
 		int pc_jump;
 		int args_truthval = args >> 8;
 		int args_rbp = args & 0xff;
+		int truth;
+
+		truth = duk__ivalue_get_const_truth(comp_ctx, left);
+		if (truth == args_truthval) {
+			/* Constant left side which doesn't short circuit:
+			 * the result is the right side as is.
+			 */
+			duk__expr(comp_ctx, res, args_rbp /*rbp_flags*/);
+			return;
+		} else if (truth >= 0) {
+			/* Constant left side which short circuits: the right
+			 * side is parsed but never evaluated.
+			 */
+			reg_temp = DUK__GETTEMP(comp_ctx);
+			pc_jump = duk__get_current_pc(comp_ctx);
+			duk__expr(comp_ctx, res, args_rbp /*rbp_flags*/);
+			duk__remove_code(comp_ctx, pc_jump);
+			DUK__SETTEMP(comp_ctx, reg_temp);
+			duk__copy_ivalue(comp_ctx, left, res);
+			return;
+		}
 
 		/* XXX: unoptimal use of temps, resetting */
 
@@ -4067,15 +4816,25 @@ static void duk__expr_led(duk_compiler_ctx *comp_ctx, duk_ivalue *left, duk_ival
 
 			duk_dup(ctx, left->x1.valstack_idx);
 			if (duk__lookup_lhs(comp_ctx, &reg_varbind, &reg_varname)) {
-				duk__emit_a_bc(comp_ctx, DUK_OP_LDREG, reg_res, reg_varbind);
-				duk__emit_extraop_b_c(comp_ctx,
-				                      DUK_EXTRAOP_TONUM | DUK__EMIT_FLAG_B_IS_TARGET,
-				                      reg_res,
-				                      reg_res);
-				duk__emit_extraop_b_c(comp_ctx,
-				                      args_op | DUK__EMIT_FLAG_B_IS_TARGET,
-				                      reg_varbind,
-				                      reg_res);
+				if (DUK_BC_ISREG(reg_varbind)) {
+					/* in-place update, ToNumber() coerced old value to reg_res */
+					duk__emit_a_b_c(comp_ctx,
+					                DUK_OP_INCDEC | DUK__EMIT_FLAG_NO_SHUFFLE_B | DUK__EMIT_FLAG_NO_SHUFFLE_C,
+					                reg_res,
+					                reg_varbind,
+					                DUK_BC_INCDEC_FLAG_POST |
+					                (args_op == DUK_EXTRAOP_DEC ? DUK_BC_INCDEC_FLAG_DEC : 0));
+				} else {
+					duk__emit_a_bc(comp_ctx, DUK_OP_LDREG, reg_res, reg_varbind);
+					duk__emit_extraop_b_c(comp_ctx,
+					                      DUK_EXTRAOP_TONUM | DUK__EMIT_FLAG_B_IS_TARGET,
+					                      reg_res,
+					                      reg_res);
+					duk__emit_extraop_b_c(comp_ctx,
+					                      args_op | DUK__EMIT_FLAG_B_IS_TARGET,
+					                      reg_varbind,
+					                      reg_res);
+				}
 			} else {
 				int reg_temp = DUK__ALLOCTEMP(comp_ctx);
 				duk__emit_a_bc(comp_ctx, DUK_OP_GETVAR, reg_res, reg_varname);
@@ -4633,7 +5392,6 @@ static void duk__parse_for_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int
 	 *  reg_temps + 1: unused
 	 */
 	{
-		int reg_cond;
 		int pc_l1, pc_l2, pc_l3, pc_l4;
 		int pc_jumpto_l3, pc_jumpto_l4;
 		int expr_c_empty;
@@ -4653,8 +5411,7 @@ static void duk__parse_for_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int
 			pc_jumpto_l3 = duk__emit_jump_empty(comp_ctx);  /* to body */
 			pc_jumpto_l4 = -1;  /* omitted */
 		} else {
-			reg_cond = duk__ivalue_toregconst(comp_ctx, res);
-			duk__emit_if_false_skip(comp_ctx, reg_cond);
+			duk__ivalue_emit_if_skip(comp_ctx, res, 0 /*truthval*/);
 			pc_jumpto_l3 = duk__emit_jump_empty(comp_ctx);  /* to body */
 			pc_jumpto_l4 = duk__emit_jump_empty(comp_ctx);  /* to exit */
 		}
@@ -4853,6 +5610,8 @@ static void duk__parse_switch_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res,
 
 	for (;;) {
 		int num_stmts;
+		int terminal;
+		int pc_dead;
 		int tok;
 
 		/* sufficient for keeping temp reg numbers in check */
@@ -4919,6 +5678,7 @@ static void duk__parse_switch_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res,
 		 */
 
 		num_stmts = 0;
+		terminal = 0;
 		if (pc_default == -2) {
 			pc_default = duk__get_current_pc(comp_ctx);
 		}
@@ -4938,21 +5698,24 @@ static void duk__parse_switch_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res,
 				break;
 			}
 			num_stmts++;
-			duk__parse_stmt(comp_ctx, res, 0 /*allow_source_elem*/);
+			if (terminal) {
+				/* unreachable, see duk__parse_stmts() */
+				pc_dead = duk__get_current_pc(comp_ctx);
+				(void) duk__parse_stmt(comp_ctx, res, 0 /*allow_source_elem*/);
+				duk__remove_code(comp_ctx, pc_dead);
+			} else {
+				terminal = duk__parse_stmt(comp_ctx, res, 0 /*allow_source_elem*/);
+			}
 		}
 
-		/* fall-through jump to next code of next case (backpatched) */
-		pc_prevstmt = duk__emit_jump_empty(comp_ctx);
-
-		/* XXX: would be nice to omit this jump when the jump is not
-		 * reachable, at least in the obvious cases (such as the case
-		 * ending with a 'break'.
-		 *
-		 * Perhaps duk__parse_stmt() could provide some info on whether
-		 * the statement is a "dead end"?
-		 *
-		 * If implemented, just set pc_prevstmt to -1 when not needed.
+		/* Fall-through jump to next code of next case (backpatched),
+		 * not needed if the clause ends in e.g. a 'break'.
 		 */
+		if (terminal) {
+			pc_prevstmt = -1;
+		} else {
+			pc_prevstmt = duk__emit_jump_empty(comp_ctx);
+		}
 	}
 
 	DUK_ASSERT(comp_ctx->curr_token.t == DUK_TOK_RCURLY);
@@ -4993,8 +5756,8 @@ static void duk__parse_switch_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res,
 
 static void duk__parse_if_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 	int temp_reset;
-	int reg_cond;
 	int pc_jump_false;
+	int truth;
 
 	DUK_DDD(DUK_DDDPRINT("begin parsing if statement"));
 
@@ -5003,8 +5766,35 @@ static void duk__parse_if_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 	duk__advance(comp_ctx);  /* eat 'if' */
 	duk__advance_expect(comp_ctx, DUK_TOK_LPAREN);
 
-	reg_cond = duk__exprtop_toregconst(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);
-	duk__emit_if_true_skip(comp_ctx, reg_cond);
+	duk__exprtop(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);
+	truth = duk__ivalue_get_const_truth(comp_ctx, res);
+	if (truth >= 0) {
+		/* Constant condition (e.g. "if (false)" or "if (!1)"): only
+		 * the selected branch is compiled, the other one is parsed
+		 * (for syntax errors and declarations) and its code dropped.
+		 */
+		DUK_DDD(DUK_DDDPRINT("if statement with constant condition: %d", truth));
+		DUK__SETTEMP(comp_ctx, temp_reset);
+		duk__advance_expect(comp_ctx, DUK_TOK_RPAREN);
+
+		pc_jump_false = duk__get_current_pc(comp_ctx);
+		duk__parse_stmt(comp_ctx, res, 0 /*allow_source_elem*/);
+		if (!truth) {
+			duk__remove_code(comp_ctx, pc_jump_false);
+		}
+		if (comp_ctx->curr_token.t == DUK_TOK_ELSE) {
+			duk__advance(comp_ctx);
+			pc_jump_false = duk__get_current_pc(comp_ctx);
+			duk__parse_stmt(comp_ctx, res, 0 /*allow_source_elem*/);
+			if (truth) {
+				duk__remove_code(comp_ctx, pc_jump_false);
+			}
+		}
+
+		DUK_DDD(DUK_DDDPRINT("end parsing if statement"));
+		return;
+	}
+	duk__ivalue_emit_if_skip(comp_ctx, res, 1 /*truthval*/);
 	pc_jump_false = duk__emit_jump_empty(comp_ctx);  /* jump to end or else part */
 	DUK__SETTEMP(comp_ctx, temp_reset);
 
@@ -5039,8 +5829,8 @@ static void duk__parse_if_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 }
 
 static void duk__parse_do_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int pc_label_site) {
-	int reg_cond;
 	int pc_start;
+	int truth;
 
 	DUK_DDD(DUK_DDDPRINT("begin parsing do statement"));
 
@@ -5053,9 +5843,17 @@ static void duk__parse_do_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int
 	duk__advance_expect(comp_ctx, DUK_TOK_WHILE);
 	duk__advance_expect(comp_ctx, DUK_TOK_LPAREN);
 
-	reg_cond = duk__exprtop_toregconst(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);
-	duk__emit_if_false_skip(comp_ctx, reg_cond);
-	duk__emit_jump(comp_ctx, pc_start);
+	duk__exprtop(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);
+	truth = duk__ivalue_get_const_truth(comp_ctx, res);
+	if (truth < 0) {
+		duk__ivalue_emit_if_skip(comp_ctx, res, 0 /*truthval*/);
+		duk__emit_jump(comp_ctx, pc_start);
+	} else if (truth) {
+		duk__emit_jump(comp_ctx, pc_start);
+	} else {
+		/* "do { ... } while (false)": body runs once, no loop jump */
+		;
+	}
 	/* no need to reset temps, as we're finished emitting code */
 
 	duk__advance_expect(comp_ctx, DUK_TOK_RPAREN);
@@ -5067,9 +5865,10 @@ static void duk__parse_do_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int
 
 static void duk__parse_while_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int pc_label_site) {
 	int temp_reset;
-	int reg_cond;
 	int pc_start;
+	int pc_body;
 	int pc_jump_false;
+	int truth;
 
 	DUK_DDD(DUK_DDDPRINT("begin parsing while statement"));
 
@@ -5082,15 +5881,27 @@ static void duk__parse_while_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, i
 	pc_start = duk__get_current_pc(comp_ctx);
 	duk__patch_jump_here(comp_ctx, pc_label_site + 2);  /* continue jump */
 
-	reg_cond = duk__exprtop_toregconst(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);
-	duk__emit_if_true_skip(comp_ctx, reg_cond);
-	pc_jump_false = duk__emit_jump_empty(comp_ctx);
+	duk__exprtop(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);
+	truth = duk__ivalue_get_const_truth(comp_ctx, res);
+	if (truth < 0) {
+		duk__ivalue_emit_if_skip(comp_ctx, res, 1 /*truthval*/);
+		pc_jump_false = duk__emit_jump_empty(comp_ctx);
+	} else {
+		/* "while (true)" needs no condition check; for "while (false)"
+		 * the body is unreachable and its code is dropped below.
+		 */
+		pc_jump_false = -1;
+	}
 	DUK__SETTEMP(comp_ctx, temp_reset);
 
 	duk__advance_expect(comp_ctx, DUK_TOK_RPAREN);
 
+	pc_body = duk__get_current_pc(comp_ctx);
 	duk__parse_stmt(comp_ctx, res, 0 /*allow_source_elem*/);
 	duk__emit_jump(comp_ctx, pc_start);
+	if (truth == 0) {
+		duk__remove_code(comp_ctx, pc_body);
+	}
 
 	duk__patch_jump_here(comp_ctx, pc_jump_false);
 	duk__patch_jump_here(comp_ctx, pc_label_site + 1);  /* break jump */
@@ -5531,7 +6342,10 @@ static int duk__stmt_label_site(duk_compiler_ctx *comp_ctx, int label_id) {
  * Creates a label site (with an empty label) automatically for iteration
  * statements.  Also "peels off" any label statements for explicit labels.
  */
-static void duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int allow_source_elem) {
+/* Returns 1 if the statement is terminal, i.e. control never flows from
+ * it to the next statement (e.g. 'return' and 'throw').
+ */
+static int duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int allow_source_elem) {
 	duk_hthread *thr = comp_ctx->thr;
 	duk_context *ctx = (duk_context *) thr;
 	int dir_prol_at_entry;
@@ -5635,7 +6449,7 @@ static void duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int all
 				int n;
 				duk_hstring *h_funcname;
 
-				duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 3);
+				duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 4);
 				duk_get_prop_stridx(ctx, -1, DUK_STRIDX_NAME);  /* -> [ ... func name ] */
 				h_funcname = duk_get_hstring(ctx, -1);
 				DUK_ASSERT(h_funcname != NULL);
@@ -5661,9 +6475,12 @@ static void duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int all
 	case DUK_TOK_LCURLY: {
 		DUK_DDD(DUK_DDDPRINT("block statement"));
 		duk__advance(comp_ctx);
-		duk__parse_stmts(comp_ctx, 0 /*allow_source_elem*/, 0 /*expect_eof*/);
+		if (duk__parse_stmts(comp_ctx, 0 /*allow_source_elem*/, 0 /*expect_eof*/)) {
+			stmt_flags = DUK__IS_TERMINAL;
+		} else {
+			stmt_flags = 0;
+		}
 		/* the DUK_TOK_RCURLY is eaten by duk__parse_stmts() */
-		stmt_flags = 0;
 		break;
 	}
 	case DUK_TOK_VAR: {
@@ -5998,9 +6815,12 @@ static void duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int all
 
 	duk__reset_labels_to_length(comp_ctx, labels_len_at_entry);
 
-	/* XXX: return indication of "terminalness" (e.g. a 'throw' is terminal) */
-
 	DUK__RECURSION_DECREASE(comp_ctx, thr);
+
+	/* A label site makes the statement non-terminal: a 'break' inside
+	 * it may continue after the statement.
+	 */
+	return ((stmt_flags & DUK__IS_TERMINAL) && label_id < 0) ? 1 : 0;
 }
 
 #undef DUK__HAS_VAL
@@ -6016,13 +6836,19 @@ static void duk__parse_stmt(duk_compiler_ctx *comp_ctx, duk_ivalue *res, int all
  *  statement (parsed in the "allow regexp literal" mode).  Upon exit,
  *  'curr_tok' contains the token following the statement list terminator
  *  (EOF or closing brace).
+ *
+ *  Statements following a terminal statement (e.g. 'return') are
+ *  unreachable: they are parsed for syntax errors and declarations but
+ *  their code is dropped.  Returns 1 if the statement list is terminal.
  */
 
-static void duk__parse_stmts(duk_compiler_ctx *comp_ctx, int allow_source_elem, int expect_eof) {
+static int duk__parse_stmts(duk_compiler_ctx *comp_ctx, int allow_source_elem, int expect_eof) {
 	duk_hthread *thr = comp_ctx->thr;
 	duk_context *ctx = (duk_context *) thr;
 	duk_ivalue res_alloc;
 	duk_ivalue *res = &res_alloc;
+	int terminal = 0;
+	int pc_dead;
 
 	/* Setup state.  Initial ivalue is 'undefined'. */
 
@@ -6064,7 +6890,13 @@ static void duk__parse_stmts(duk_compiler_ctx *comp_ctx, int allow_source_elem,
 
 		DUK_DDD(DUK_DDDPRINT("TOKEN %d (non-whitespace, non-comment)", comp_ctx->curr_token.t));
 
-		duk__parse_stmt(comp_ctx, res, allow_source_elem);
+		if (terminal) {
+			pc_dead = duk__get_current_pc(comp_ctx);
+			(void) duk__parse_stmt(comp_ctx, res, allow_source_elem);
+			duk__remove_code(comp_ctx, pc_dead);
+		} else {
+			terminal = duk__parse_stmt(comp_ctx, res, allow_source_elem);
+		}
 	}
 
 	duk__advance(comp_ctx);
@@ -6072,6 +6904,8 @@ static void duk__parse_stmts(duk_compiler_ctx *comp_ctx, int allow_source_elem,
 	/* Tear down state. */
 
 	duk_pop_2(ctx);
+
+	return terminal;
 }
 
 /*
@@ -6379,6 +7213,218 @@ static void duk__init_varmap_and_prologue_for_pass2(duk_compiler_ctx *comp_ctx,
 	return;
 }
 
+/*
+ *  Preparse data for lazily compiled functions (DUK_USE_LAZY_COMPILE).
+ *
+ *  A lazily compiled function is only pre-parsed when its outer function
+ *  is compiled, and so are its inner functions, recursively.  Without
+ *  further measures, compiling a function parses its inner functions
+ *  again, so that a function nested N levels deep is parsed N times in
+ *  total as the functions get called.
+ *
+ *  To avoid this, the pre-parse of a function (or the compilation of an
+ *  inner function of a lazily compiled function) summarizes each of its
+ *  inner functions into its 'preparse' buffer, and the summaries end up
+ *  in the function template (DUK_HCOMPILEDFUNCTION_LAZY_CONST_PREPARSE).
+ *  When the function is compiled, its inner function bodies are skipped
+ *  using the summaries, in source order, and each inner function template
+ *  gets the summaries of its own inner functions.
+ *
+ *  Each summary consists of unsigned varints (7 bits per byte, low bits
+ *  first, high bit set if more bytes follow):
+ *
+ *    - source offset and line of the closing brace of the function body
+ *    - DUK__PREPARSE_FLAG_xxx
+ *    - unless DUK__PREPARSE_FLAG_ANY_IDREFS is set, the free identifiers
+ *      of the function (and its inner functions): byte length plus one
+ *      and the bytes of each identifier, terminated by a zero
+ *    - byte length of the summaries of the function's inner functions,
+ *      followed by the summaries
+ *
+ *  The summary contains everything the outer function's compilation needs
+ *  from the inner function: where it ends, the template flags depending on
+ *  the function body, and the free identifiers for capture analysis, see
+ *  duk__push_free_idrefs().
+ */
+
+#if defined(DUK_USE_LAZY_COMPILE)
+#define DUK__PREPARSE_FLAG_STRICT      (1 << 0)
+#define DUK__PREPARSE_FLAG_NOTAIL      (1 << 1)
+#define DUK__PREPARSE_FLAG_CREATEARGS  (1 << 2)
+#define DUK__PREPARSE_FLAG_ANY_IDREFS  (1 << 3)  /* may access any identifier (direct eval) */
+
+static void duk__preparse_append_uint(duk_compiler_ctx *comp_ctx, duk_hbuffer_dynamic *buf, duk_uint32_t val) {
+	while (val >= 0x80U) {
+		duk_hbuffer_append_byte(comp_ctx->thr, buf, (duk_uint8_t) ((val & 0x7fU) | 0x80U));
+		val >>= 7;
+	}
+	duk_hbuffer_append_byte(comp_ctx->thr, buf, (duk_uint8_t) val);
+}
+
+/* Append the start of a summary of the inner function just parsed
+ * (comp_ctx->curr_func) to 'buf' of the outer function.  The free
+ * identifiers are appended by duk__push_free_idrefs().
+ */
+static void duk__preparse_append_header(duk_compiler_ctx *comp_ctx, duk_hbuffer_dynamic *buf, duk_hobject *h_templ, int end_offset, int end_line, int any_idrefs) {
+	duk_uint32_t flags;
+
+	flags = 0;
+	if (DUK_HOBJECT_HAS_STRICT(h_templ)) {
+		flags |= DUK__PREPARSE_FLAG_STRICT;
+	}
+	if (DUK_HOBJECT_HAS_NOTAIL(h_templ)) {
+		flags |= DUK__PREPARSE_FLAG_NOTAIL;
+	}
+	if (DUK_HOBJECT_HAS_CREATEARGS(h_templ)) {
+		flags |= DUK__PREPARSE_FLAG_CREATEARGS;
+	}
+	if (any_idrefs) {
+		flags |= DUK__PREPARSE_FLAG_ANY_IDREFS;
+	}
+
+	duk__preparse_append_uint(comp_ctx, buf, (duk_uint32_t) end_offset);
+	duk__preparse_append_uint(comp_ctx, buf, (duk_uint32_t) end_line);
+	duk__preparse_append_uint(comp_ctx, buf, flags);
+}
+
+/* Finish the summary with the inner function's own preparse data. */
+static void duk__preparse_append_inner(duk_compiler_ctx *comp_ctx, duk_hbuffer_dynamic *buf) {
+	duk_hbuffer_dynamic *h_inner;
+
+	h_inner = comp_ctx->curr_func.h_preparse;
+	DUK_ASSERT(h_inner != NULL);
+	duk__preparse_append_uint(comp_ctx, buf, (duk_uint32_t) DUK_HBUFFER_GET_SIZE(h_inner));
+	if (DUK_HBUFFER_GET_SIZE(h_inner) > 0) {
+		duk_hbuffer_append_bytes(comp_ctx->thr, buf,
+		                         (duk_uint8_t *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(h_inner),
+		                         DUK_HBUFFER_GET_SIZE(h_inner));
+	}
+}
+
+static duk_uint32_t duk__preparse_get_uint(duk_compiler_ctx *comp_ctx) {
+	duk_uint32_t res = 0;
+	int shift = 0;
+	duk_uint8_t b;
+
+	for (;;) {
+		if (comp_ctx->preparse_ptr >= comp_ctx->preparse_end || shift > 28) {
+			DUK_ERROR(comp_ctx->thr, DUK_ERR_INTERNAL_ERROR, "invalid preparse data");
+		}
+		b = *comp_ctx->preparse_ptr++;
+		res |= ((duk_uint32_t) (b & 0x7fU)) << shift;
+		if (!(b & 0x80U)) {
+			return res;
+		}
+		shift += 7;
+	}
+}
+
+/* Skip the body of a lazily compiled inner function using its summary,
+ * with the same end state as a pre-parse of the body.  Upon entry,
+ * 'curr_tok' is the opening brace.
+ */
+static void duk__preparse_skip_func_body(duk_compiler_ctx *comp_ctx) {
+	duk_compiler_func *func = &comp_ctx->curr_func;
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+	duk_lexer_point lex_pt;
+	duk_uint32_t offset;
+	duk_uint32_t flags;
+	duk_uint32_t len;
+
+	offset = duk__preparse_get_uint(comp_ctx);
+	lex_pt.line = (int) duk__preparse_get_uint(comp_ctx);
+	flags = duk__preparse_get_uint(comp_ctx);
+	if (offset <= (duk_uint32_t) comp_ctx->curr_token.start_offset ||
+	    offset >= (duk_uint32_t) comp_ctx->lex.input_length) {
+		goto error_data;
+	}
+	lex_pt.offset = (int) offset;
+
+	DUK_DDD(DUK_DDDPRINT("skip preparsed function body: end offset=%d, line=%d, flags=0x%08x",
+	                     lex_pt.offset, lex_pt.line, (int) flags));
+
+	/* Set up the state duk__convert_to_func_template() derives the flags
+	 * from and which duk__parse_func_like_fnum() uses.
+	 */
+	func->is_strict = (flags & DUK__PREPARSE_FLAG_STRICT ? 1 : 0);
+	func->is_notail = (flags & DUK__PREPARSE_FLAG_NOTAIL ? 1 : 0);
+	func->id_access_arguments = (flags & DUK__PREPARSE_FLAG_CREATEARGS ? 1 : 0);
+	func->is_arguments_shadowed = 0;
+	func->may_direct_eval = 0;
+
+	if (flags & DUK__PREPARSE_FLAG_ANY_IDREFS) {
+		func->inner_may_direct_eval = 1;
+	} else {
+		/* the varmap stays empty, so all of these are free identifiers */
+		while ((len = duk__preparse_get_uint(comp_ctx)) != 0) {
+			len--;
+			if (len > (duk_uint32_t) (comp_ctx->preparse_end - comp_ctx->preparse_ptr)) {
+				goto error_data;
+			}
+			duk_push_lstring(ctx, (const char *) comp_ctx->preparse_ptr, (size_t) len);
+			comp_ctx->preparse_ptr += len;
+			duk_push_true(ctx);
+			duk_put_prop(ctx, func->idrefs_idx);
+		}
+	}
+
+	len = duk__preparse_get_uint(comp_ctx);
+	if (len > (duk_uint32_t) (comp_ctx->preparse_end - comp_ctx->preparse_ptr)) {
+		goto error_data;
+	}
+	DUK_ASSERT(func->h_preparse != NULL);
+	if (len > 0) {
+		duk_hbuffer_append_bytes(thr, func->h_preparse, (duk_uint8_t *) comp_ctx->preparse_ptr, (size_t) len);
+		comp_ctx->preparse_ptr += len;
+	}
+
+	/* Reparse the closing brace and the token following it, like when
+	 * skipping an inner function on pass 2.
+	 */
+	DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt);
+	comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
+	duk__advance(comp_ctx);
+	duk__advance_expect(comp_ctx, DUK_TOK_RCURLY);
+	return;
+
+ error_data:
+	DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "invalid preparse data");
+}
+
+/* Finish the function template of a lazily compiled function: it gets
+ * no code, only the constants needed to compile the function later, see
+ * duk_js_compile_lazy().
+ */
+static void duk__finish_lazy_func(duk_compiler_ctx *comp_ctx) {
+	duk_compiler_func *func = &comp_ctx->curr_func;
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+
+	DUK_ASSERT(func->is_lazy);
+	DUK_ASSERT(comp_ctx->prev_token.t == DUK_TOK_RCURLY);
+	DUK_ASSERT(comp_ctx->h_sourcecode != NULL);
+	DUK_ASSERT(func->h_preparse != NULL);
+
+	duk_hbuffer_reset(thr, func->h_code);
+	duk_hobject_set_length_zero(thr, func->h_consts);
+	duk_hobject_set_length_zero(thr, func->h_funcs);
+
+	duk_push_hstring(ctx, comp_ctx->h_sourcecode);
+	duk_put_prop_index(ctx, func->consts_idx, DUK_HCOMPILEDFUNCTION_LAZY_CONST_SOURCE);
+	duk_push_int(ctx, func->lazy_offset);
+	duk_put_prop_index(ctx, func->consts_idx, DUK_HCOMPILEDFUNCTION_LAZY_CONST_OFFSET);
+	duk_push_int(ctx, func->lazy_line);
+	duk_put_prop_index(ctx, func->consts_idx, DUK_HCOMPILEDFUNCTION_LAZY_CONST_LINE);
+	duk_push_int(ctx, func->lazy_flags);
+	duk_put_prop_index(ctx, func->consts_idx, DUK_HCOMPILEDFUNCTION_LAZY_CONST_FLAGS);
+	duk_push_lstring(ctx,
+	                 (const char *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(func->h_preparse),
+	                 DUK_HBUFFER_GET_SIZE(func->h_preparse));
+	duk_put_prop_index(ctx, func->consts_idx, DUK_HCOMPILEDFUNCTION_LAZY_CONST_PREPARSE);
+}
+#endif  /* DUK_USE_LAZY_COMPILE */
+
 /*
  *  Parse a function-body-like expression (FunctionBody or Program
  *  in E5 grammar) using a two-pass parse.  The productions appear
@@ -6419,7 +7465,9 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 	duk_context *ctx = (duk_context *) thr;
 	int reg_stmt_value = -1;
 	duk_lexer_point lex_pt;
+	int was_strict;
 	int temp_first;
+	int terminal;
 
 	DUK_ASSERT(comp_ctx != NULL);
 	DUK_ASSERT(func != NULL);
@@ -6429,10 +7477,28 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 	duk_require_stack(ctx, DUK__FUNCTION_BODY_REQUIRE_SLOTS);
 
 	/*
-	 *  Store lexer position for a later rewind
+	 *  Store lexer position and recorded token index for a later rewind
 	 */
 
 	DUK_LEXER_GETPOINT(&comp_ctx->lex, &lex_pt);
+	DUK_ASSERT(comp_ctx->tokrec_next == comp_ctx->tokrec_count);
+	func->tokrec_first = comp_ctx->tokrec_count;
+	func->tokrec_epoch = comp_ctx->tokrec_epoch;
+	was_strict = func->is_strict;
+
+#if defined(DUK_USE_LAZY_COMPILE)
+	/*
+	 *  Inner functions of a lazily compiled function were already pre-parsed
+	 *  when the function itself was: skip their bodies using the preparse data.
+	 */
+
+	if (func->is_lazy && comp_ctx->preparse_ptr != NULL) {
+		duk__preparse_skip_func_body(comp_ctx);
+		duk__finish_lazy_func(comp_ctx);
+		DUK__RECURSION_DECREASE(comp_ctx, thr);
+		return;
+	}
+#endif
 
 	/*
 	 *  Program code (global and eval code) has an implicit return value
@@ -6483,7 +7549,25 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 	DUK_DDD(DUK_DDDPRINT("end 1st pass"));
 
 	/*
-	 *  Rewind lexer.
+	 *  Tokens preceding a 'use strict' directive were lexed in non-strict
+	 *  mode; pass 2 lexes them again in strict mode, see duk__replay_token().
+	 *  A lazily compiled function has no pass 2 now, so check the recorded
+	 *  tokens, or compile the function now if they've been discarded.
+	 */
+
+	if (func->is_lazy && func->is_strict && !was_strict) {
+		if (func->tokrec_epoch == comp_ctx->tokrec_epoch) {
+			duk__tokrec_check_strict(comp_ctx, func->tokrec_first);
+		} else {
+			DUK_DD(DUK_DDPRINT("recorded tokens discarded, compile strict function now"));
+			func->is_lazy = 0;
+		}
+	}
+
+	/*
+	 *  Rewind to the tokens recorded on pass 1, or rewind the lexer if
+	 *  the recorded tokens were discarded during pass 1.  In the latter
+	 *  case there's nothing to record on pass 2.
 	 *
 	 *  duk__parse_stmts() expects curr_tok to be set; parse in "allow regexp
 	 *  literal" mode with current strictness.
@@ -6492,10 +7576,20 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 	 *  generating prologue, to ensure prologue bytecode gets nice line numbers.
 	 */
 
-	DUK_DDD(DUK_DDDPRINT("rewind lexer"));
-	DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt);
-	comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
-	duk__advance(comp_ctx);
+	if (func->is_lazy) {
+		/* no second pass */
+	} else if (func->tokrec_epoch == comp_ctx->tokrec_epoch) {
+		DUK_DDD(DUK_DDDPRINT("rewind to recorded tokens"));
+		comp_ctx->tokrec_next = func->tokrec_first;
+		comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
+		duk__advance(comp_ctx);
+	} else {
+		DUK_DDD(DUK_DDDPRINT("rewind lexer"));
+		DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt);
+		comp_ctx->tokrec_enabled = 0;
+		comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
+		duk__advance(comp_ctx);
+	}
 
 	/*
 	 *  Reset function state and perform register allocation, which creates
@@ -6525,8 +7619,10 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 	func->label_next = 0;
 
 	/* XXX: init or assert catch depth etc -- all values */
-	func->id_access_arguments = 0;
-	func->id_access_slow = 0;
+	if (!func->is_lazy) {
+		func->id_access_arguments = 0;
+		func->id_access_slow = 0;
+	}
 
 	/*
 	 *  Check function name validity now that we know strictness.
@@ -6555,6 +7651,21 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 		}
 	}
 
+	/*
+	 *  A lazily compiled function stops here: the first pass has checked
+	 *  the syntax, the varmap and prologue checked the formals, and the
+	 *  closing brace has been consumed just like after a second pass.
+	 */
+
+#if defined(DUK_USE_LAZY_COMPILE)
+	if (func->is_lazy) {
+		DUK_DDD(DUK_DDDPRINT("lazy function, skip 2nd pass"));
+		duk__finish_lazy_func(comp_ctx);
+		DUK__RECURSION_DECREASE(comp_ctx, thr);
+		return;
+	}
+#endif
+
 	/*
 	 *  Second pass parsing.
 	 */
@@ -6564,28 +7675,27 @@ static void duk__parse_func_body(duk_compiler_ctx *comp_ctx, int expect_eof, int
 	}
 
 	DUK_DDD(DUK_DDDPRINT("begin 2nd pass"));
-	duk__parse_stmts(comp_ctx,
-	                 1,             /* allow source elements */
-	                 expect_eof);   /* expect EOF instead of } */
+	terminal = duk__parse_stmts(comp_ctx,
+	                            1,             /* allow source elements */
+	                            expect_eof);   /* expect EOF instead of } */
 	DUK_DDD(DUK_DDDPRINT("end 2nd pass"));
+	comp_ctx->tokrec_enabled = 1;
 
 	/*
 	 *  Emit a final RETURN.
 	 *
-	 *  It would be nice to avoid emitting an unnecessary "return" opcode
-	 *  if the current PC is not reachable.  However, this cannot be reliably
-	 *  detected; even if the previous instruction is an unconditional jump,
-	 *  there may be a previous jump which jumps to current PC (which is the
-	 *  case for iteration and conditional statements, for instance).
-	 */
-
-	/* XXX: request a "last statement is terminal" from duk__parse_stmt() and duk__parse_stmts();
-	 * we could avoid the last RETURN if we could ensure there is no way to get here
-	 * (directly or via a jump)
+	 *  Even if the previous instruction is an unconditional jump, there
+	 *  may be a previous jump which jumps to current PC (which is the
+	 *  case for iteration and conditional statements, for instance), so
+	 *  the RETURN can only be omitted when the function body ends in a
+	 *  terminal statement (e.g. 'return' or 'throw').  Jumps inside the
+	 *  body never target the end of a terminal statement list.
 	 */
 
 	DUK_ASSERT(comp_ctx->curr_func.catch_depth == 0);  /* fast returns are always OK here */
-	if (reg_stmt_value >= 0) {
+	if (terminal) {
+		DUK_DDD(DUK_DDDPRINT("function body is terminal, no final RETURN needed"));
+	} else if (reg_stmt_value >= 0) {
 		duk__emit_a_b(comp_ctx,
 		              DUK_OP_RETURN,
 		              DUK_BC_RETURN_FLAG_HAVE_RETVAL | DUK_BC_RETURN_FLAG_FAST /*flags*/,
@@ -6770,6 +7880,57 @@ static void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, int is_decl, in
 	duk__convert_to_func_template(comp_ctx);  /* -> [ ... func ] */
 }
 
+/* Push an object whose keys are the free identifiers of the current (inner)
+ * function, i.e. names it may look up from its scope chain without binding
+ * them itself.  The names are also added to the outer function's 'idrefs'
+ * because they may resolve further up the scope chain.  Names the inner
+ * function binds in a way not visible in the varmap (e.g. its own name)
+ * are included conservatively.  If 'buf' is non-NULL, the names are also
+ * appended to it as preparse data, see duk__preparse_append_header().
+ */
+static void duk__push_free_idrefs(duk_compiler_ctx *comp_ctx, int outer_idrefs_idx, duk_hbuffer_dynamic *buf) {
+	duk_hthread *thr = comp_ctx->thr;
+	duk_context *ctx = (duk_context *) thr;
+#if defined(DUK_USE_LAZY_COMPILE)
+	duk_hstring *h_key;
+#endif
+
+	duk_push_object_internal(ctx);
+	duk_enum(ctx, comp_ctx->curr_func.idrefs_idx, DUK_ENUM_OWN_PROPERTIES_ONLY);
+	while (duk_next(ctx, -1, 0 /*get_value*/)) {
+		/* [ ... res enum key ] */
+		duk_dup_top(ctx);
+		if (duk_has_prop(ctx, comp_ctx->curr_func.varmap_idx)) {
+			duk_pop(ctx);
+			continue;
+		}
+#if defined(DUK_USE_LAZY_COMPILE)
+		if (buf != NULL) {
+			h_key = duk_get_hstring(ctx, -1);
+			DUK_ASSERT(h_key != NULL);
+			DUK_ASSERT(DUK_HSTRING_GET_BYTELEN(h_key) > 0);
+			duk__preparse_append_uint(comp_ctx, buf, (duk_uint32_t) DUK_HSTRING_GET_BYTELEN(h_key) + 1);
+			duk_hbuffer_append_bytes(thr, buf, (duk_uint8_t *) DUK_HSTRING_GET_DATA(h_key), DUK_HSTRING_GET_BYTELEN(h_key));
+		}
+#endif
+		duk_dup_top(ctx);
+		duk_push_true(ctx);
+		duk_put_prop(ctx, outer_idrefs_idx);
+		duk_push_true(ctx);
+		duk_put_prop(ctx, -4);
+	}
+	duk_pop(ctx);
+#if defined(DUK_USE_LAZY_COMPILE)
+	if (buf != NULL) {
+		duk__preparse_append_uint(comp_ctx, buf, 0);  /* end of names */
+	}
+#else
+	DUK_UNREF(buf);
+#endif
+
+	DUK_DDD(DUK_DDDPRINT("free identifiers of inner function: %!O", duk_get_hobject(ctx, -1)));
+}
+
 /* Parse an inner function, adding the function template to the current function's
  * function table.  Return a function number to be used by the outer function.
  *
@@ -6779,6 +7940,11 @@ static void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, int is_decl, in
  * pass, skip the function and return the same 'fnum' as on the first pass by using
  * a running counter.
  *
+ * With DUK_USE_LAZY_COMPILE the inner function only gets its own first pass
+ * here, and is compiled when it is first called, see duk_js_compile_lazy().
+ * Its summary is appended to the outer function's preparse data so that the
+ * inner function needs no pre-parse when the outer function is compiled.
+ *
  * An unfortunate side effect of this is that when parsing the inner function, almost
  * nothing is known of the outer function, i.e. the inner function's scope.  We don't
  * need that information at the moment, but it would allow some optimizations if it
@@ -6788,6 +7954,11 @@ static int duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, int is_decl, in
 	duk_hthread *thr = comp_ctx->thr;
 	duk_context *ctx = (duk_context *) thr;
 	duk_compiler_func old_func;
+	duk_hobject *h_templ;
+	duk_hbuffer_dynamic *h_preparse;
+	int any_idrefs;
+	int end_offset;
+	int end_line;
 	int entry_top;
 	int fnum;
 
@@ -6799,17 +7970,29 @@ static int duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, int is_decl, in
 		duk_lexer_point lex_pt;
 
 		fnum = comp_ctx->curr_func.fnum_next++;
-		duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 3 + 1);
-		lex_pt.offset = duk_to_int(ctx, -1);
-		duk_pop(ctx);
-		duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 3 + 2);
-		lex_pt.line = duk_to_int(ctx, -1);
-		duk_pop(ctx);
 
-		DUK_DDD(DUK_DDDPRINT("second pass of an inner func, skip the function, reparse closing brace; lex offset=%d, line=%d",
-		                     lex_pt.offset, lex_pt.line));
+		if (comp_ctx->curr_func.tokrec_epoch == comp_ctx->tokrec_epoch) {
+			/* replaying recorded tokens */
+			duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 4 + 1);
+			comp_ctx->tokrec_next = duk_to_int(ctx, -1);
+			duk_pop(ctx);
+
+			DUK_DDD(DUK_DDDPRINT("second pass of an inner func, skip the function, replay closing brace; token index=%d",
+			                     comp_ctx->tokrec_next));
+		} else {
+			duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 4 + 2);
+			lex_pt.offset = duk_to_int(ctx, -1);
+			duk_pop(ctx);
+			duk_get_prop_index(ctx, comp_ctx->curr_func.funcs_idx, fnum * 4 + 3);
+			lex_pt.line = duk_to_int(ctx, -1);
+			duk_pop(ctx);
+
+			DUK_DDD(DUK_DDDPRINT("second pass of an inner func, skip the function, reparse closing brace; lex offset=%d, line=%d",
+			                     lex_pt.offset, lex_pt.line));
+
+			DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt);
+		}
 
-		DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt);
 		comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
 		duk__advance(comp_ctx);
 		duk__advance_expect(comp_ctx, DUK_TOK_RCURLY);
@@ -6841,6 +8024,26 @@ static int duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, int is_decl, in
 	comp_ctx->curr_func.is_setget = is_setget;
 	comp_ctx->curr_func.is_decl = is_decl;
 
+#if defined(DUK_USE_LAZY_COMPILE)
+	/* Only pre-parse the inner function: the template records where to
+	 * compile it from when it is first called.  The initial strictness
+	 * is inherited from this function.
+	 */
+	duk_push_dynamic_buffer(ctx, 0);
+	duk_replace(ctx, comp_ctx->curr_func.preparse_idx);
+	comp_ctx->curr_func.h_preparse = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, comp_ctx->curr_func.preparse_idx);
+	DUK_ASSERT(comp_ctx->curr_func.h_preparse != NULL);
+	DUK_ASSERT(DUK_HBUFFER_HAS_DYNAMIC(comp_ctx->curr_func.h_preparse));
+
+	comp_ctx->curr_func.is_lazy = 1;
+	comp_ctx->curr_func.lazy_offset = comp_ctx->curr_token.start_offset;
+	comp_ctx->curr_func.lazy_line = comp_ctx->curr_token.start_line;
+	comp_ctx->curr_func.lazy_flags = DUK_JS_COMPILE_FLAG_LAZY |
+	                                 (old_func.is_strict ? DUK_JS_COMPILE_FLAG_STRICT : 0) |
+	                                 (is_decl ? DUK_JS_COMPILE_FLAG_DECL : 0) |
+	                                 (is_setget ? DUK_JS_COMPILE_FLAG_SETGET : 0);
+#endif
+
 	/*
 	 *  Parse inner function
 	 */
@@ -6854,20 +8057,69 @@ static int duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, int is_decl, in
 	DUK_DDD(DUK_DDDPRINT("after func: prev_tok.start_offset=%d, curr_tok.start_offset=%d",
 	                     comp_ctx->prev_token.start_offset, comp_ctx->curr_token.start_offset));
 	DUK_ASSERT(comp_ctx->lex.input[comp_ctx->prev_token.start_offset] == (duk_uint8_t) '}');
+	h_templ = duk_get_hobject(ctx, -1);
+	DUK_ASSERT(h_templ != NULL);
+	end_offset = comp_ctx->prev_token.start_offset;
+	end_line = comp_ctx->prev_token.start_line;
+
+	/* The function body's recorded tokens are no longer needed, only the
+	 * closing brace and the token following it (the last two recorded
+	 * tokens) for skipping the function on pass 2.  If the recorded tokens
+	 * were discarded meanwhile, the outer function rewinds the lexer and
+	 * skips using the lexer point.
+	 */
+	if (comp_ctx->curr_func.tokrec_epoch == comp_ctx->tokrec_epoch) {
+		DUK_ASSERT(comp_ctx->tokrec_count - 2 >= comp_ctx->curr_func.tokrec_first);
+		duk__tokrec_drop(comp_ctx, comp_ctx->curr_func.tokrec_first, comp_ctx->tokrec_count - 2);
+		DUK_ASSERT(((duk__token_record *) DUK_HBUFFER_DYNAMIC_GET_CURR_DATA_PTR(comp_ctx->h_tokrec))
+		           [comp_ctx->curr_func.tokrec_first].tok.t == DUK_TOK_RCURLY);
+	}
 
 	/* XXX: append primitive */
-	DUK_ASSERT(duk_get_length(ctx, old_func.funcs_idx) == (duk_uint32_t) (old_func.fnum_next * 3));
+	DUK_ASSERT(duk_get_length(ctx, old_func.funcs_idx) == (duk_uint32_t) (old_func.fnum_next * 4));
 	fnum = old_func.fnum_next++;
 
 	if (fnum >= DUK__MAX_FUNCS) {
 		DUK_ERROR(comp_ctx->thr, DUK_ERR_INTERNAL_ERROR, "out of funcs");
 	}
 
-	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 3);  /* autoincrements length */
-	duk_push_int(ctx, comp_ctx->prev_token.start_offset);
-	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 3 + 1);
-	duk_push_int(ctx, comp_ctx->prev_token.start_line);
-	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 3 + 2);
+	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 4);  /* autoincrements length; template stays reachable */
+	duk_push_int(ctx, comp_ctx->curr_func.tokrec_first);
+	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 4 + 1);
+	duk_push_int(ctx, end_offset);
+	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 4 + 2);
+	duk_push_int(ctx, end_line);
+	(void) duk_put_prop_index(ctx, old_func.funcs_idx, fnum * 4 + 3);
+
+	/*
+	 *  Record the free identifiers of the inner function for capture
+	 *  analysis of the outer function, see duk__convert_to_func_template().
+	 */
+
+	any_idrefs = comp_ctx->curr_func.may_direct_eval || comp_ctx->curr_func.inner_may_direct_eval;
+#if defined(DUK_USE_LAZY_COMPILE)
+	h_preparse = old_func.h_preparse;
+	if (h_preparse != NULL) {
+		duk__preparse_append_header(comp_ctx, h_preparse, h_templ, end_offset, end_line, any_idrefs);
+	}
+#else
+	h_preparse = NULL;
+	DUK_UNREF(h_templ);
+#endif
+
+	if (any_idrefs) {
+		old_func.inner_may_direct_eval = 1;
+		duk_push_null(ctx);
+	} else {
+		duk__push_free_idrefs(comp_ctx, old_func.idrefs_idx, h_preparse);
+	}
+	(void) duk_put_prop_index(ctx, old_func.funcidrefs_idx, fnum);
+
+#if defined(DUK_USE_LAZY_COMPILE)
+	if (h_preparse != NULL) {
+		duk__preparse_append_inner(comp_ctx, h_preparse);
+	}
+#endif
 
 	/*
 	 *  Cleanup: restore original function, restore valstack state.
@@ -6907,6 +8159,7 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	int is_strict;
 	int is_eval;
 	int is_funcexpr;
+	int is_lazy;
 	int flags;
 
 	DUK_ASSERT(thr != NULL);
@@ -6928,6 +8181,7 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	is_eval = (flags & DUK_JS_COMPILE_FLAG_EVAL ? 1 : 0);
 	is_strict = (flags & DUK_JS_COMPILE_FLAG_STRICT ? 1 : 0);
 	is_funcexpr = (flags & DUK_JS_COMPILE_FLAG_FUNCEXPR ? 1 : 0);
+	is_lazy = (flags & DUK_JS_COMPILE_FLAG_LAZY ? 1 : 0);
 
 	h_sourcecode = duk_require_hstring(ctx, -3);
 	h_filename = duk_get_hstring(ctx, -2);  /* may be undefined */
@@ -6940,6 +8194,9 @@ static int duk__js_compile_raw(duk_context *ctx) {
 #ifdef DUK_USE_EXPLICIT_NULL_INIT
 	comp_ctx->thr = NULL;
 	comp_ctx->h_filename = NULL;
+	comp_ctx->h_sourcecode = NULL;
+	comp_ctx->h_tokrec = NULL;
+	comp_ctx->h_tokvals = NULL;
 	comp_ctx->prev_token.str1 = NULL;
 	comp_ctx->prev_token.str2 = NULL;
 	comp_ctx->curr_token.str1 = NULL;
@@ -6953,13 +8210,36 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	duk_push_undefined(ctx);               /* entry_top + 2 */
 	duk_push_undefined(ctx);               /* entry_top + 3 */
 	duk_push_undefined(ctx);               /* entry_top + 4 */
+	duk_push_dynamic_buffer(ctx, 0);       /* entry_top + 5 */
+	duk_push_object_helper(ctx,
+	                       DUK_HOBJECT_FLAG_EXTENSIBLE |
+	                       DUK_HOBJECT_FLAG_ARRAY_PART |
+	                       DUK_HOBJECT_CLASS_AS_FLAGS(DUK_HOBJECT_CLASS_OBJECT),
+	                       -1);            /* entry_top + 6 */
 
 	comp_ctx->thr = thr;
 	comp_ctx->h_filename = h_filename;
+	comp_ctx->h_sourcecode = h_sourcecode;
 	comp_ctx->tok11_idx = entry_top + 1;
 	comp_ctx->tok12_idx = entry_top + 2;
 	comp_ctx->tok21_idx = entry_top + 3;
 	comp_ctx->tok22_idx = entry_top + 4;
+	comp_ctx->tokrec_idx = entry_top + 5;
+	comp_ctx->h_tokrec = (duk_hbuffer_dynamic *) duk_get_hbuffer(ctx, entry_top + 5);
+	DUK_ASSERT(comp_ctx->h_tokrec != NULL);
+	DUK_ASSERT(DUK_HBUFFER_HAS_DYNAMIC(comp_ctx->h_tokrec));
+	comp_ctx->tokvals_idx = entry_top + 6;
+	comp_ctx->h_tokvals = duk_get_hobject(ctx, entry_top + 6);
+	DUK_ASSERT(comp_ctx->h_tokvals != NULL);
+	comp_ctx->tokrec_enabled = 1;
+#if defined(DUK_USE_LAZY_COMPILE)
+	comp_ctx->preparse_ptr = NULL;
+	comp_ctx->preparse_end = NULL;
+	if (is_lazy && comp_stk->h_preparse != NULL && DUK_HSTRING_GET_BYTELEN(comp_stk->h_preparse) > 0) {
+		comp_ctx->preparse_ptr = DUK_HSTRING_GET_DATA(comp_stk->h_preparse);
+		comp_ctx->preparse_end = comp_ctx->preparse_ptr + DUK_HSTRING_GET_BYTELEN(comp_stk->h_preparse);
+	}
+#endif
 	comp_ctx->recursion_limit = DUK_COMPILER_RECURSION_LIMIT;
 
 	DUK_LEXER_INITCTX(&comp_ctx->lex);   /* just zeroes/NULLs */
@@ -6974,8 +8254,13 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	DUK_ASSERT(DUK_HBUFFER_HAS_DYNAMIC(comp_ctx->lex.buf));
 	comp_ctx->lex.token_limit = DUK_COMPILER_TOKEN_LIMIT;
 
-	lex_pt->offset = 0;
-	lex_pt->line = 1;
+	if (is_lazy) {
+		lex_pt->offset = comp_stk->lazy_offset;
+		lex_pt->line = comp_stk->lazy_line;
+	} else {
+		lex_pt->offset = 0;
+		lex_pt->line = 1;
+	}
 	DUK_LEXER_SETPOINT(&comp_ctx->lex, lex_pt);    /* fills window */
 
 	/*
@@ -6985,8 +8270,10 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	duk__init_func_valstack_slots(comp_ctx);
 	DUK_ASSERT(func->num_formals == 0);
 
-	if (is_funcexpr) {
-		/* funcexpr is now used for Function constructor, anonymous */
+	if (is_funcexpr || is_lazy) {
+		/* funcexpr is now used for Function constructor, anonymous;
+		 * a lazily compiled function parses its own name
+		 */
 	} else {
 		duk_push_hstring_stridx(ctx, (is_eval ? DUK_STRIDX_EVAL :
 		                                        DUK_STRIDX_GLOBAL));
@@ -6999,10 +8286,19 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	 */
 
 	func->is_strict = is_strict;
-	func->is_setget = 0;
-	func->is_decl = 0;
+	func->is_setget = (flags & DUK_JS_COMPILE_FLAG_SETGET ? 1 : 0);
+	func->is_decl = (flags & DUK_JS_COMPILE_FLAG_DECL ? 1 : 0);
+
+	if (is_lazy) {
+		func->is_function = 1;
+		func->is_eval = 0;
+		func->is_global = 0;
 
-	if (is_funcexpr) {
+		duk__advance(comp_ctx);  /* init 'curr_token' to the token following 'function' */
+		(void) duk__parse_func_like_raw(comp_ctx,
+		                                func->is_decl,
+		                                func->is_setget);
+	} else if (is_funcexpr) {
 		func->is_function = 1;
 		func->is_eval = 0;
 		func->is_global = 0;
@@ -7037,18 +8333,18 @@ static int duk__js_compile_raw(duk_context *ctx) {
 	return 1;
 }
 
-void duk_js_compile(duk_hthread *thr, int flags) {
+/* Input stack:  [ ... sourcecode filename ]
+ * Output stack: [ ... func_template ]
+ */
+static void duk__js_compile_helper(duk_hthread *thr, duk__compiler_stkstate *comp_stk) {
 	duk_context *ctx = (duk_context *) thr;
-	duk__compiler_stkstate comp_stk;
 
 	/* XXX: this illustrates that a C catchpoint implemented using duk_safe_call()
 	 * is a bit heavy at the moment.  The wrapper compiles to ~180 bytes on x64.
 	 * Alternatives would be nice.
 	 */
 
-	DUK_MEMZERO(&comp_stk, sizeof(comp_stk));
-	comp_stk.flags = flags;
-	duk_push_pointer(ctx, (void *) &comp_stk);
+	duk_push_pointer(ctx, (void *) comp_stk);
 
 	if (duk_safe_call(ctx, duk__js_compile_raw, 3 /*nargs*/, 1 /*nret*/) != DUK_EXEC_SUCCESS) {
 		/* This now adds a line number to -any- error thrown during compilation.
@@ -7059,7 +8355,7 @@ void duk_js_compile(duk_hthread *thr, int flags) {
 		DUK_DDD(DUK_DDDPRINT("compile error, before adding line info: %!T", duk_get_tval(ctx, -1)));
 		if (duk_is_object(ctx, -1)) {
 			if (duk_get_prop_stridx(ctx, -1, DUK_STRIDX_MESSAGE)) {
-				duk_push_sprintf(ctx, " (line %d)", (int) comp_stk.comp_ctx_alloc.curr_token.start_line);
+				duk_push_sprintf(ctx, " (line %d)", (int) comp_stk->comp_ctx_alloc.curr_token.start_line);
 				duk_concat(ctx, 2);
 				duk_put_prop_stridx(ctx, -2, DUK_STRIDX_MESSAGE);
 			} else {
@@ -7070,3 +8366,170 @@ void duk_js_compile(duk_hthread *thr, int flags) {
 		duk_throw(ctx);
 	}
 }
+
+void duk_js_compile(duk_hthread *thr, int flags) {
+	duk__compiler_stkstate comp_stk;
+
+	DUK_MEMZERO(&comp_stk, sizeof(comp_stk));
+	comp_stk.flags = flags;
+	duk__js_compile_helper(thr, &comp_stk);
+}
+
+/* Same as duk_js_compile() but looks up and stores the result in the heap
+ * compile cache, used for eval() and Function constructor code.  A cached
+ * template is shared by all callers, so it must only be used for creating
+ * closures.  Long sources are compiled without the cache.
+ */
+void duk_js_compile_cached(duk_hthread *thr, int flags) {
+#if defined(DUK_USE_COMPILE_CACHE)
+	duk_context *ctx = (duk_context *) thr;
+	duk_hstring *h_source;
+	duk_hstring *h_filename;
+	duk_hcompiledfunction *h_func;
+
+	/* [ ... source filename ] */
+
+	h_source = duk_get_hstring(ctx, -2);
+	h_filename = duk_get_hstring(ctx, -1);
+	if (h_source == NULL || DUK_HSTRING_GET_BYTELEN(h_source) > DUK_USE_COMPILE_CACHE_MAXLEN) {
+		duk_js_compile(thr, flags);
+		return;
+	}
+
+	h_func = duk_heap_compcache_lookup(thr->heap, h_source, h_filename, (duk_small_int_t) flags);
+	if (h_func != NULL) {
+		duk_pop_2(ctx);  /* cache entry keeps h_func reachable */
+		duk_push_hobject(ctx, (duk_hobject *) h_func);
+		return;
+	}
+
+	/* Keep the key strings reachable until the entry has been inserted. */
+	duk_dup(ctx, -2);
+	duk_dup(ctx, -2);
+	duk_js_compile(thr, flags);
+
+	/* [ ... source filename template ] */
+
+	h_func = (duk_hcompiledfunction *) duk_get_hobject(ctx, -1);
+	DUK_ASSERT(h_func != NULL);
+	DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) h_func));
+	duk_heap_compcache_insert(thr, h_source, h_filename, (duk_small_int_t) flags, h_func);
+
+	duk_replace(ctx, -3);
+	duk_pop(ctx);
+#else
+	duk_js_compile(thr, flags);
+#endif
+}
+
+#if defined(DUK_USE_LAZY_COMPILE)
+/* Compile a lazily compiled function template in place.  The template
+ * object itself is kept because the outer function's 'funcs' refers to it
+ * and its NOCAPTURE flag comes from the outer function's capture analysis.
+ * The function data is swapped with that of the compiled result, which
+ * keeps refcounts of both data buffers (and their contents) intact.
+ */
+void duk_js_compile_lazy(duk_hthread *thr, duk_hcompiledfunction *fun) {
+	duk_context *ctx = (duk_context *) thr;
+	duk__compiler_stkstate comp_stk;
+	duk_hcompiledfunction *h_res;
+	duk_tval *tv;
+	duk_tval *tv_consts;
+	duk_hbuffer *tmp_data;
+	duk_hobject **tmp_funcs;
+	duk_instr *tmp_bytecode;
+	duk_uint16_t tmp_nregs;
+	duk_uint16_t tmp_nargs;
+	duk_uint32_t mask;
+
+	DUK_ASSERT(fun != NULL);
+	DUK_ASSERT(DUK_HCOMPILEDFUNCTION_IS_LAZY(fun));
+	DUK_ASSERT(DUK_HCOMPILEDFUNCTION_GET_CONSTS_COUNT(fun) == DUK_HCOMPILEDFUNCTION_LAZY_CONST_COUNT);
+
+	duk_push_hobject(ctx, (duk_hobject *) fun);
+
+	/* The preparse data is kept reachable on the value stack: a finalizer
+	 * run during compilation might compile the function and release the
+	 * lazy constants.
+	 */
+	tv_consts = DUK_HCOMPILEDFUNCTION_GET_CONSTS_BASE(fun);
+	DUK_ASSERT(DUK_TVAL_IS_STRING(tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_PREPARSE));
+	duk_push_tval(ctx, tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_PREPARSE);
+	DUK_ASSERT(DUK_TVAL_IS_STRING(tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_SOURCE));
+	duk_push_tval(ctx, tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_SOURCE);
+	tv = duk_hobject_find_existing_entry_tval_ptr((duk_hobject *) fun, DUK_HTHREAD_STRING_FILE_NAME(thr));
+	if (tv != NULL) {
+		duk_push_tval(ctx, tv);
+	} else {
+		duk_push_undefined(ctx);
+	}
+
+	DUK_MEMZERO(&comp_stk, sizeof(comp_stk));
+	comp_stk.flags = (int) DUK_TVAL_GET_NUMBER(tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_FLAGS);
+	comp_stk.lazy_offset = (int) DUK_TVAL_GET_NUMBER(tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_OFFSET);
+	comp_stk.lazy_line = (int) DUK_TVAL_GET_NUMBER(tv_consts + DUK_HCOMPILEDFUNCTION_LAZY_CONST_LINE);
+	comp_stk.h_preparse = duk_get_hstring(ctx, -3);
+	DUK_ASSERT(comp_stk.flags & DUK_JS_COMPILE_FLAG_LAZY);
+
+	DUK_DDD(DUK_DDDPRINT("lazy compile of %p: offset=%d, line=%d, flags=0x%08x",
+	                     (void *) fun, comp_stk.lazy_offset, comp_stk.lazy_line, comp_stk.flags));
+
+	duk__js_compile_helper(thr, &comp_stk);  /* [ ... fun preparse source filename ] -> [ ... fun preparse res ] */
+	duk_remove(ctx, -2);
+
+	/* A finalizer run during compilation may have created a closure for
+	 * the same function, compiling it already; the result is then unused.
+	 */
+	h_res = (duk_hcompiledfunction *) duk_get_hobject(ctx, -1);
+	DUK_ASSERT(h_res != NULL);
+	DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) h_res));
+	if (!DUK_HCOMPILEDFUNCTION_IS_LAZY(fun)) {
+		duk_pop_2(ctx);
+		return;
+	}
+
+	tmp_data = fun->data;
+	tmp_funcs = fun->funcs;
+	tmp_bytecode = fun->bytecode;
+	tmp_nregs = fun->nregs;
+	tmp_nargs = fun->nargs;
+	fun->data = h_res->data;
+	fun->funcs = h_res->funcs;
+	fun->bytecode = h_res->bytecode;
+	fun->nregs = h_res->nregs;
+	fun->nargs = h_res->nargs;
+	h_res->data = tmp_data;
+	h_res->funcs = tmp_funcs;
+	h_res->bytecode = tmp_bytecode;
+	h_res->nregs = tmp_nregs;
+	h_res->nargs = tmp_nargs;
+
+	/* Flags were computed from the pre-parse too; take them from the
+	 * actual compilation result anyway.  NOCAPTURE is kept.
+	 */
+	mask = DUK_HOBJECT_FLAG_STRICT | DUK_HOBJECT_FLAG_NOTAIL | DUK_HOBJECT_FLAG_NEWENV |
+	       DUK_HOBJECT_FLAG_NAMEBINDING | DUK_HOBJECT_FLAG_CREATEARGS;
+	DUK_HEAPHDR_CLEAR_FLAG_BITS(&fun->obj.hdr, mask);
+	DUK_HEAPHDR_SET_FLAG_BITS(&fun->obj.hdr, DUK_HEAPHDR_GET_FLAGS(&h_res->obj.hdr) & mask);
+
+	/* '_formals', 'name' and 'fileName' were already set by the pre-parse */
+	if (duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_VARMAP)) {
+		duk_def_prop_stridx(ctx, -3, DUK_STRIDX_INT_VARMAP, DUK_PROPDESC_FLAGS_NONE);
+	} else {
+		duk_pop(ctx);
+	}
+#if defined(DUK_USE_PC2LINE)
+	if (duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_PC2LINE)) {
+		duk_def_prop_stridx(ctx, -3, DUK_STRIDX_INT_PC2LINE, DUK_PROPDESC_FLAGS_NONE);
+	} else {
+		duk_pop(ctx);
+	}
+#endif
+
+	duk_pop(ctx);
+	duk_compact(ctx, -1);
+	duk_pop(ctx);
+
+	DUK_DDD(DUK_DDDPRINT("lazily compiled function: %!O", (duk_hobject *) fun));
+}
+#endif  /* DUK_USE_LAZY_COMPILE */
@@ -12,6 +12,7 @@
 #define DUK_COMPILER_RECURSION_LIMIT       50
 #endif
 #define DUK_COMPILER_TOKEN_LIMIT           100000000  /* 1e8: protects against deeply nested inner functions */
+#define DUK_COMPILER_TOKREC_LIMIT          16384      /* max tokens recorded for replay on pass 2, lexer rewind if exceeded */
 
 /* maximum loopcount for peephole optimization */
 #define DUK_COMPILER_PEEPHOLE_MAXITER      3
@@ -111,8 +112,11 @@ struct duk_compiler_func {
 	duk_hstring *h_name;                /* function name (borrowed reference), ends up in _name */
 	duk_hbuffer_dynamic *h_code;        /* C array of duk_compiler_instr */
 	duk_hobject *h_consts;              /* array */
-	duk_hobject *h_funcs;               /* array of function templates: [func1, offset1, line1, func2, offset2, line2]
-	                                     * offset/line points to closing brace to allow skipping on pass 2
+	duk_hobject *h_strconstmap;         /* string constant -> const index, NULL until enough constants */
+	duk_hobject *h_numconstmap;         /* ToString(number constant) ('-0' for negative zero) -> const index */
+	duk_hobject *h_funcs;               /* array of function templates: [func1, tokidx1, offset1, line1, func2, ...]
+	                                     * recorded token index and offset/line point to closing brace to allow
+	                                     * skipping on pass 2
 	                                     */
 	duk_hobject *h_decls;               /* array of declarations: [ name1, val1, name2, val2, ... ]
 	                                     * valN = (typeN) | (fnum << 8), where fnum is inner func number (0 for vars)
@@ -122,6 +126,17 @@ struct duk_compiler_func {
 	duk_hbuffer_dynamic *h_labelinfos;  /* C array of duk_labelinfo */
 	duk_hobject *h_argnames;            /* array of formal argument names (-> _formals) */
 	duk_hobject *h_varmap;              /* variable map for pass 2 (identifier -> register number or null (unmapped)) */
+	duk_hobject *h_idrefs;              /* identifiers which may be looked up from the scope chain: own slow path
+	                                     * accesses (pass 2) and free identifiers of inner functions (keys only)
+	                                     */
+	duk_hobject *h_funcidrefs;          /* array of inner function free identifier sets indexed by fnum,
+	                                     * null if the inner function may access any identifier
+	                                     */
+#if defined(DUK_USE_LAZY_COMPILE)
+	duk_hbuffer_dynamic *h_preparse;    /* preparse data of inner functions, see duk__preparse_append();
+	                                     * NULL for the outermost function being compiled
+	                                     */
+#endif
 
 	int is_function;                    /* is an actual function (not global/eval code) */
 	int is_eval;                        /* is eval code */
@@ -130,9 +145,11 @@ struct duk_compiler_func {
 	int is_decl;                        /* is a function declaration (as opposed to function expression) */
 	int is_strict;                      /* function is strict */
 	int is_notail;                      /* function must not be tailcalled */
+	int is_lazy;                        /* function body is only pre-parsed, see duk__parse_func_like_fnum() */
 	int in_directive_prologue;          /* parsing in "directive prologue", recognize directives */
 	int in_scanning;                    /* parsing in "scanning" phase (first pass) */
 	int may_direct_eval;                /* function may call direct eval */
+	int inner_may_direct_eval;          /* some inner function (at any depth) may call direct eval */
 	int id_access_arguments;            /* function refers to 'arguments' identifier */
 	int id_access_slow;                 /* function makes one or more slow path accesses */
 	int is_arguments_shadowed;          /* argument/function declaration shadows 'arguments' */
@@ -144,6 +161,8 @@ struct duk_compiler_func {
 
 	int code_idx;
 	int consts_idx;
+	int strconstmap_idx;
+	int numconstmap_idx;
 	int funcs_idx;
 	int fnum_next;
 	int decls_idx;
@@ -151,6 +170,11 @@ struct duk_compiler_func {
 	int labelinfos_idx;
 	int argnames_idx;
 	int varmap_idx;
+	int idrefs_idx;
+	int funcidrefs_idx;
+#if defined(DUK_USE_LAZY_COMPILE)
+	int preparse_idx;
+#endif
 
 	/* temp reg handling */
 	int temp_first;                     /* first register that is a temporary (below: variables) */
@@ -180,6 +204,15 @@ struct duk_compiler_func {
 	int paren_level;                    /* parenthesis count, 0 = top level */
 	int expr_lhs;                       /* expression is left-hand-side compatible */
 	int allow_in;                       /* current paren level allows 'in' token */
+
+	/* token recording for pass 2, see duk__advance_helper() */
+	int tokrec_first;                   /* index of first recorded token of function body */
+	int tokrec_epoch;                   /* recording epoch when function body was started */
+
+	/* lazy compilation: where and how to compile the function later */
+	int lazy_offset;                    /* source offset of the token following 'function' (or 'get'/'set') */
+	int lazy_line;                      /* source line of the same token */
+	int lazy_flags;                     /* DUK_JS_COMPILE_FLAG_xxx for compiling the function body */
 };
 
 struct duk_compiler_ctx {
@@ -188,6 +221,9 @@ struct duk_compiler_ctx {
 	/* filename being compiled (ends up in functions' '_filename' property) */
 	duk_hstring *h_filename;            /* borrowed reference */
 
+	/* source code being compiled (referenced by lazily compiled inner functions) */
+	duk_hstring *h_sourcecode;          /* borrowed reference */
+
 	/* lexing (tokenization) state (contains two valstack slot indices) */
 	duk_lexer_ctx lex;
 
@@ -199,6 +235,25 @@ struct duk_compiler_ctx {
 	int tok21_idx;                      /* prev_token slot1 */
 	int tok22_idx;                      /* prev_token slot2 */
 
+	/* tokens lexed on pass 1, replayed on pass 2 instead of lexing again */
+	duk_hbuffer_dynamic *h_tokrec;      /* C array of duk__token_record (borrowed reference) */
+	duk_hobject *h_tokvals;             /* array of string values of recorded tokens (borrowed reference) */
+	int tokrec_idx;
+	int tokvals_idx;
+	int tokrec_count;                   /* number of recorded tokens */
+	int tokrec_next;                    /* next token to replay; == tokrec_count when lexing */
+	int tokvals_count;                  /* number of string values */
+	int tokrec_epoch;                   /* incremented when the recorded tokens are discarded */
+	int tokrec_enabled;                 /* record lexed tokens (disabled on a pass 2 without replay) */
+
+#if defined(DUK_USE_LAZY_COMPILE)
+	/* preparse data of the inner functions of a lazily compiled function,
+	 * consumed in order by duk__parse_func_body() to skip their bodies
+	 */
+	const duk_uint8_t *preparse_ptr;    /* NULL if not available */
+	const duk_uint8_t *preparse_end;
+#endif
+
 	/* recursion limit */
 	int recursion_depth;
 	int recursion_limit;
@@ -214,8 +269,15 @@ struct duk_compiler_ctx {
 #define DUK_JS_COMPILE_FLAG_EVAL      (1 << 0)  /* source is eval code (not program) */
 #define DUK_JS_COMPILE_FLAG_STRICT    (1 << 1)  /* strict outer context */
 #define DUK_JS_COMPILE_FLAG_FUNCEXPR  (1 << 2)  /* source is a function expression (used for Function constructor) */
+#define DUK_JS_COMPILE_FLAG_LAZY      (1 << 3)  /* compile a lazily compiled inner function (internal) */
+#define DUK_JS_COMPILE_FLAG_DECL      (1 << 4)  /* lazy: function is a declaration */
+#define DUK_JS_COMPILE_FLAG_SETGET    (1 << 5)  /* lazy: function is a setter/getter */
 
 void duk_js_compile(duk_hthread *thr, int flags);
+void duk_js_compile_cached(duk_hthread *thr, int flags);
+#if defined(DUK_USE_LAZY_COMPILE)
+void duk_js_compile_lazy(duk_hthread *thr, duk_hcompiledfunction *fun);
+#endif
 
 #endif  /* DUK_JS_COMPILER_H_INCLUDED */
 
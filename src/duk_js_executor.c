@@ -70,6 +70,93 @@ static double duk__compute_mod(double d1, double d2) {
 	return DUK_FMOD(d1, d2);
 }
 
+#if defined(DUK_USE_FASTINT)
+/* Replace register 'idx_z' with a fastint value. */
+static void duk__vm_set_fastint(duk_hthread *thr, int idx_z, duk_int32_t v) {
+	duk_tval tv_tmp;
+	duk_tval *tv_z;
+
+	tv_z = &thr->valstack_bottom[idx_z];
+	DUK_TVAL_SET_TVAL(&tv_tmp, tv_z);
+	DUK_TVAL_SET_FASTINT(tv_z, v);
+	DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
+}
+
+/* Overflow checked fastint arithmetic.  Returns 1 and writes the result
+ * to 'out' if the exact Ecmascript result is a fastint (whole, within
+ * the int32 range, and not a negative zero).  Otherwise returns 0 and
+ * the caller computes the result using doubles.
+ */
+static int duk__vm_arith_fastint(int opcode, duk_int32_t v1, duk_int32_t v2, duk_int32_t *out) {
+	switch (opcode) {
+	case DUK_OP_ADD: {
+		if (v2 > 0 ? v1 > DUK_INT32_MAX - v2 : v1 < DUK_INT32_MIN - v2) {
+			return 0;
+		}
+		*out = v1 + v2;
+		return 1;
+	}
+	case DUK_OP_SUB: {
+		if (v2 < 0 ? v1 > DUK_INT32_MAX + v2 : v1 < DUK_INT32_MIN + v2) {
+			return 0;
+		}
+		*out = v1 - v2;
+		return 1;
+	}
+	case DUK_OP_MUL: {
+#if defined(DUK_USE_64BIT_OPS)
+		duk_int64_t r;
+
+		r = (duk_int64_t) v1 * (duk_int64_t) v2;
+		if (r < (duk_int64_t) DUK_INT32_MIN || r > (duk_int64_t) DUK_INT32_MAX) {
+			return 0;
+		}
+#else
+		duk_int32_t r;
+
+		/* Without 64-bit arithmetic only handle operands whose
+		 * product cannot overflow.
+		 */
+		if (v1 < -0x8000L || v1 > 0x7fffL || v2 < -0x8000L || v2 > 0x7fffL) {
+			return 0;
+		}
+		r = v1 * v2;
+#endif
+		if (r == 0 && (v1 < 0 || v2 < 0)) {
+			return 0;  /* -0 */
+		}
+		*out = (duk_int32_t) r;
+		return 1;
+	}
+	case DUK_OP_DIV: {
+		/* Exact quotients only.  Also rules out -0 and the overflowing
+		 * DUK_INT32_MIN / -1.
+		 */
+		if (v2 == 0 || (v1 == 0 && v2 < 0) || (v1 == DUK_INT32_MIN && v2 == -1)) {
+			return 0;
+		}
+		if (v1 % v2 != 0) {
+			return 0;
+		}
+		*out = v1 / v2;
+		return 1;
+	}
+	case DUK_OP_MOD: {
+		/* The sign of '%' with negative operands is implementation
+		 * defined in C89 (and a negative zero may result), so only
+		 * handle the common non-negative case.
+		 */
+		if (v1 < 0 || v2 <= 0) {
+			return 0;
+		}
+		*out = v1 % v2;
+		return 1;
+	}
+	}
+	return 0;
+}
+#endif  /* DUK_USE_FASTINT */
+
 static void duk__vm_arith_add(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, int idx_z) {
 	/*
 	 *  Addition operator is different from other arithmetic
@@ -100,6 +187,17 @@ static void duk__vm_arith_add(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y,
 	 *  Fast paths
 	 */
 
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+		duk_int32_t v3;
+
+		if (duk__vm_arith_fastint(DUK_OP_ADD, DUK_TVAL_GET_FASTINT(tv_x), DUK_TVAL_GET_FASTINT(tv_y), &v3)) {
+			duk__vm_set_fastint(thr, idx_z, v3);
+			return;
+		}
+	}
+#endif
+
 	if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
 		duk_tval tv_tmp;
 		duk_tval *tv_z;
@@ -110,7 +208,7 @@ static void duk__vm_arith_add(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y,
 
 		tv_z = &thr->valstack_bottom[idx_z];
 		DUK_TVAL_SET_TVAL(&tv_tmp, tv_z);
-		DUK_TVAL_SET_NUMBER(tv_z, du.d);
+		DUK_TVAL_SET_NUMBER_CHKFAST(tv_z, du.d);
 		DUK_ASSERT(!DUK_TVAL_IS_HEAP_ALLOCATED(tv_z));  /* no need to incref */
 		DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
 		return;
@@ -176,6 +274,17 @@ static void duk__vm_arith_binary_op(duk_hthread *thr, duk_tval *tv_x, duk_tval *
 	DUK_ASSERT(tv_y != NULL);  /* may be reg or const */
 	DUK_ASSERT(idx_z >= 0 && idx_z < duk_get_top(ctx));
 
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+		duk_int32_t v3;
+
+		if (duk__vm_arith_fastint(opcode, DUK_TVAL_GET_FASTINT(tv_x), DUK_TVAL_GET_FASTINT(tv_y), &v3)) {
+			duk__vm_set_fastint(thr, idx_z, v3);
+			return;
+		}
+	}
+#endif
+
 	if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
 		/* fast path */
 		d1 = DUK_TVAL_GET_NUMBER(tv_x);
@@ -221,7 +330,7 @@ static void duk__vm_arith_binary_op(duk_hthread *thr, duk_tval *tv_x, duk_tval *
 	
 	tv_z = &thr->valstack_bottom[idx_z];
 	DUK_TVAL_SET_TVAL(&tv_tmp, tv_z);
-	DUK_TVAL_SET_NUMBER(tv_z, du.d);
+	DUK_TVAL_SET_NUMBER_CHKFAST(tv_z, du.d);
 	DUK_ASSERT(!DUK_TVAL_IS_HEAP_ALLOCATED(tv_z));  /* no need to incref */
 	DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
 }
@@ -240,7 +349,7 @@ static void duk__vm_bitwise_binary_op(duk_hthread *thr, duk_tval *tv_x, duk_tval
 	duk_context *ctx = (duk_context *) thr;
 	duk_tval tv_tmp;
 	duk_tval *tv_z;
-	duk_int32_t i1, i2;
+	duk_int32_t i1, i2, i3;
 	double val;
 
 	DUK_ASSERT(thr != NULL);
@@ -249,23 +358,32 @@ static void duk__vm_bitwise_binary_op(duk_hthread *thr, duk_tval *tv_x, duk_tval
 	DUK_ASSERT(tv_y != NULL);  /* may be reg or const */
 	DUK_ASSERT(idx_z >= 0 && idx_z < duk_get_top(ctx));
 
-	duk_push_tval(ctx, tv_x);
-	duk_push_tval(ctx, tv_y);
-	i1 = duk_to_int32(ctx, -2);
-	i2 = duk_to_int32(ctx, -1);
-	duk_pop_2(ctx);
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+		/* fast path: no coercion needed */
+		i1 = DUK_TVAL_GET_FASTINT(tv_x);
+		i2 = DUK_TVAL_GET_FASTINT(tv_y);
+	} else
+#endif
+	{
+		duk_push_tval(ctx, tv_x);
+		duk_push_tval(ctx, tv_y);
+		i1 = duk_to_int32(ctx, -2);
+		i2 = duk_to_int32(ctx, -1);
+		duk_pop_2(ctx);
+	}
 
 	switch (opcode) {
 	case DUK_OP_BAND: {
-		val = (double) (i1 & i2);
+		i3 = i1 & i2;
 		break;
 	}
 	case DUK_OP_BOR: {
-		val = (double) (i1 | i2);
+		i3 = i1 | i2;
 		break;
 	}
 	case DUK_OP_BXOR: {
-		val = (double) (i1 ^ i2);
+		i3 = i1 ^ i2;
 		break;
 	}
 	case DUK_OP_BASL: {
@@ -275,12 +393,10 @@ static void duk__vm_bitwise_binary_op(duk_hthread *thr, duk_tval *tv_x, duk_tval
 		 */
 
 		duk_uint32_t u2;
-		duk_int32_t i3;
 
 		u2 = ((duk_uint32_t) i2) & 0xffffffffU;
 		i3 = i1 << (u2 & 0x1f);                     /* E5 Section 11.7.1, steps 7 and 8 */
 		i3 = i3 & ((duk_int32_t) 0xffffffffU);      /* Note: left shift, should mask */
-		val = (double) i3;
 		break;
 	}
 	case DUK_OP_BASR: {
@@ -289,27 +405,41 @@ static void duk__vm_bitwise_binary_op(duk_hthread *thr, duk_tval *tv_x, duk_tval
 		duk_uint32_t u2;
 
 		u2 = ((duk_uint32_t) i2) & 0xffffffffU;
-		val = (double) (i1 >> (u2 & 0x1f));     /* E5 Section 11.7.2, steps 7 and 8 */
+		i3 = i1 >> (u2 & 0x1f);                     /* E5 Section 11.7.2, steps 7 and 8 */
 		break;
 	}
 	case DUK_OP_BLSR: {
-		/* unsigned shift */
+		/* unsigned shift; the result may not fit into a signed 32-bit value */
 
 		duk_uint32_t u1;
 		duk_uint32_t u2;
+		duk_uint32_t u3;
 
 		u1 = ((duk_uint32_t) i1) & 0xffffffffU;
 		u2 = ((duk_uint32_t) i2) & 0xffffffffU;
 
-		val = (double) (u1 >> (u2 & 0x1f));     /* E5 Section 11.7.2, steps 7 and 8 */
+		u3 = u1 >> (u2 & 0x1f);                     /* E5 Section 11.7.2, steps 7 and 8 */
+		if (u3 > 0x7fffffffUL) {
+			val = (double) u3;
+			goto set_double;
+		}
+		i3 = (duk_int32_t) u3;
 		break;
 	}
 	default: {
-		val = (double) 0;  /* should not happen */
+		i3 = 0;  /* should not happen */
 		break;
 	}
 	}
 
+#if defined(DUK_USE_FASTINT)
+	duk__vm_set_fastint(thr, idx_z, i3);
+	return;
+#else
+	val = (double) i3;
+#endif
+
+ set_double:
 	DUK_ASSERT(!DUK_ISNAN(val));            /* 'val' is never NaN, so no need to normalize */
 	DUK_ASSERT_DOUBLE_IS_NORMALIZED(val);   /* always normalized */
 
@@ -340,6 +470,42 @@ static void duk__vm_arith_unary_op(duk_hthread *thr, duk_tval *tv_x, int idx_z,
 	DUK_ASSERT(tv_x != NULL);  /* may be reg or const */
 	DUK_ASSERT(idx_z >= 0 && idx_z < duk_get_top(ctx));
 
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv_x)) {
+		duk_int32_t v1;
+
+		v1 = DUK_TVAL_GET_FASTINT(tv_x);
+		switch (opcode) {
+		case DUK_EXTRAOP_UNM: {
+			/* -0 and -DUK_INT32_MIN are not fastints */
+			if (v1 != 0 && v1 != DUK_INT32_MIN) {
+				duk__vm_set_fastint(thr, idx_z, -v1);
+				return;
+			}
+			break;
+		}
+		case DUK_EXTRAOP_UNP: {
+			duk__vm_set_fastint(thr, idx_z, v1);
+			return;
+		}
+		case DUK_EXTRAOP_INC: {
+			if (v1 != DUK_INT32_MAX) {
+				duk__vm_set_fastint(thr, idx_z, v1 + 1);
+				return;
+			}
+			break;
+		}
+		case DUK_EXTRAOP_DEC: {
+			if (v1 != DUK_INT32_MIN) {
+				duk__vm_set_fastint(thr, idx_z, v1 - 1);
+				return;
+			}
+			break;
+		}
+		}
+	}
+#endif
+
 	if (DUK_TVAL_IS_NUMBER(tv_x)) {
 		/* fast path */
 		d1 = DUK_TVAL_GET_NUMBER(tv_x);
@@ -379,7 +545,7 @@ static void duk__vm_arith_unary_op(duk_hthread *thr, duk_tval *tv_x, int idx_z,
 
 	tv_z = &thr->valstack_bottom[idx_z];
 	DUK_TVAL_SET_TVAL(&tv_tmp, tv_z);
-	DUK_TVAL_SET_NUMBER(tv_z, du.d);
+	DUK_TVAL_SET_NUMBER_CHKFAST(tv_z, du.d);
 	DUK_ASSERT(!DUK_TVAL_IS_HEAP_ALLOCATED(tv_z));  /* no need to incref */
 	DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
 }
@@ -390,21 +556,35 @@ static void duk__vm_bitwise_not(duk_hthread *thr, duk_tval *tv_x, int idx_z) {
 	 */
 
 	duk_context *ctx = (duk_context *) thr;
+#if !defined(DUK_USE_FASTINT)
 	duk_tval tv_tmp;
 	duk_tval *tv_z;
-	duk_int32_t i1, i2;
 	double val;
+#endif
+	duk_int32_t i1, i2;
 
 	DUK_ASSERT(thr != NULL);
 	DUK_ASSERT(ctx != NULL);
 	DUK_ASSERT(tv_x != NULL);  /* may be reg or const */
 	DUK_ASSERT(idx_z >= 0 && idx_z < duk_get_top(ctx));
 
-	duk_push_tval(ctx, tv_x);
-	i1 = duk_to_int32(ctx, -1);
-	duk_pop(ctx);
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv_x)) {
+		/* fast path: no coercion needed */
+		i1 = DUK_TVAL_GET_FASTINT(tv_x);
+	} else
+#endif
+	{
+		duk_push_tval(ctx, tv_x);
+		i1 = duk_to_int32(ctx, -1);
+		duk_pop(ctx);
+	}
 
 	i2 = ~i1;
+
+#if defined(DUK_USE_FASTINT)
+	duk__vm_set_fastint(thr, idx_z, i2);
+#else
 	val = (double) i2;
 
 	DUK_ASSERT(!DUK_ISNAN(val));            /* 'val' is never NaN, so no need to normalize */
@@ -415,6 +595,7 @@ static void duk__vm_bitwise_not(duk_hthread *thr, duk_tval *tv_x, int idx_z) {
 	DUK_TVAL_SET_NUMBER(tv_z, val);
 	DUK_ASSERT(!DUK_TVAL_IS_HEAP_ALLOCATED(tv_z));  /* no need to incref */
 	DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
+#endif
 }
 
 static void duk__vm_logical_not(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_z) {
@@ -441,6 +622,106 @@ static void duk__vm_logical_not(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_z
 	DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
 }
 
+static int duk__vm_compare_op(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, int opcode) {
+	/*
+	 *  Result of comparison opcode DUK_OP_EQ ... DUK_OP_LE for arbitrary
+	 *  operands, used by DUK_OP_IFCMP (which has the number fast path
+	 *  inline).  Argument order and flags must match the corresponding
+	 *  opcode cases.
+	 *
+	 *  E5 Sections 11.8.1 - 11.8.5, 11.9.1 - 11.9.6.
+	 */
+
+	int res;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(tv_x != NULL);  /* may be reg or const */
+	DUK_ASSERT(tv_y != NULL);  /* may be reg or const */
+
+	switch (opcode) {
+	case DUK_OP_EQ: {
+		res = duk_js_equals(thr, tv_x, tv_y);
+		break;
+	}
+	case DUK_OP_NEQ: {
+		res = !duk_js_equals(thr, tv_x, tv_y);
+		break;
+	}
+	case DUK_OP_SEQ: {
+		res = duk_js_strict_equals(tv_x, tv_y);
+		break;
+	}
+	case DUK_OP_SNEQ: {
+		res = !duk_js_strict_equals(tv_x, tv_y);
+		break;
+	}
+	case DUK_OP_GT: {
+		res = duk_js_compare_helper(thr, tv_y, tv_x, 0);
+		break;
+	}
+	case DUK_OP_GE: {
+		res = duk_js_compare_helper(thr, tv_x, tv_y, DUK_COMPARE_FLAG_EVAL_LEFT_FIRST | DUK_COMPARE_FLAG_NEGATE);
+		break;
+	}
+	case DUK_OP_LT: {
+		res = duk_js_compare_helper(thr, tv_x, tv_y, DUK_COMPARE_FLAG_EVAL_LEFT_FIRST);
+		break;
+	}
+	default: {
+		DUK_ASSERT(opcode == DUK_OP_LE);
+		res = duk_js_compare_helper(thr, tv_y, tv_x, DUK_COMPARE_FLAG_NEGATE);
+		break;
+	}
+	}
+
+	return res;
+}
+
+static void duk__vm_incdec(duk_hthread *thr, int idx_z, int idx_x, int flags) {
+	/*
+	 *  In-place prefix/postfix increment/decrement of register 'idx_x',
+	 *  with the result value written to register 'idx_z' (DUK_OP_INCDEC).
+	 *
+	 *  E5 Sections 11.3.1, 11.3.2, 11.4.4, 11.4.5.
+	 */
+
+	duk_context *ctx = (duk_context *) thr;
+	duk_tval tv_tmp;
+	duk_tval *tv_x;
+	duk_tval *tv_z;
+	double d1;
+	duk_double_union du;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(idx_x >= 0 && idx_x < duk_get_top(ctx));
+	DUK_ASSERT(idx_z >= 0 && idx_z < duk_get_top(ctx));
+	DUK_ASSERT(idx_x != idx_z);
+
+	tv_x = &thr->valstack_bottom[idx_x];
+	if (DUK_TVAL_IS_NUMBER(tv_x)) {
+		d1 = DUK_TVAL_GET_NUMBER(tv_x);
+	} else {
+		duk_push_tval(ctx, tv_x);
+		d1 = duk_to_number(ctx, -1);  /* side effects */
+		DUK_ASSERT_DOUBLE_IS_NORMALIZED(d1);
+		duk_pop(ctx);
+	}
+
+	du.d = (flags & DUK_BC_INCDEC_FLAG_DEC) ? d1 - 1.0 : d1 + 1.0;
+	DUK_DBLUNION_NORMALIZE_NAN_CHECK(&du);
+	DUK_ASSERT(DUK_DBLUNION_IS_NORMALIZED(&du));
+
+	tv_x = &thr->valstack_bottom[idx_x];  /* relookup, valstack may have been resized */
+	DUK_TVAL_SET_TVAL(&tv_tmp, tv_x);
+	DUK_TVAL_SET_NUMBER_CHKFAST(tv_x, du.d);
+	DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
+
+	tv_z = &thr->valstack_bottom[idx_z];
+	DUK_TVAL_SET_TVAL(&tv_tmp, tv_z);
+	DUK_TVAL_SET_NUMBER_CHKFAST(tv_z, (flags & DUK_BC_INCDEC_FLAG_POST) ? d1 : du.d);
+	DUK_TVAL_DECREF(thr, &tv_tmp);   /* side effects */
+}
+
 /*
  *  Longjmp handler for the bytecode executor (and a bunch of static
  *  helpers for it).
@@ -1291,6 +1572,9 @@ static void duk__executor_interrupt(duk_hthread *thr) {
 	duk_int_t ctr;
 	duk_activation *act;
 	duk_hcompiledfunction *fun;
+#if defined(DUK_USE_PROFILER)
+	duk_bool_t prof_sample = 0;
+#endif
 
 	DUK_ASSERT(thr != NULL);
 	DUK_ASSERT(thr->callstack != NULL);
@@ -1303,21 +1587,49 @@ static void duk__executor_interrupt(duk_hthread *thr) {
 
 	ctr = DUK_HEAP_INTCTR_DEFAULT;
 
-#if 0
-	/* XXX: cumulative instruction count example */
-	static int step_count = 0;
-	step_count += thr->heap->interrupt_init;
-	if (step_count >= 1000000) {
+#if defined(DUK_USE_PROFILER)
+	/* Interrupts also happen early for other reasons (execution budget),
+	 * so sample only when a full profiler interval has been executed.
+	 * This is done before the budget check which may throw.
+	 */
+	if (thr->heap->prof_interval > 0) {
+		thr->heap->prof_remaining -= thr->heap->interrupt_init;
+		if (thr->heap->prof_remaining <= 0) {
+			thr->heap->prof_remaining = thr->heap->prof_interval;
+			prof_sample = 1;
+		}
+	}
+#endif
+
+#if defined(DUK_USE_EXEC_BUDGET)
+	/* Instructions executed since the previous interrupt are charged to
+	 * the budget of the innermost duk_pcall_budget().  The next interrupt
+	 * is scheduled so that the instruction budget runs out exactly at an
+	 * interrupt; the deadline is checked with interrupt granularity.
+	 */
+	if (thr->heap->budget_steps >= 0) {
+		thr->heap->budget_steps -= thr->heap->interrupt_init;
+		if (thr->heap->budget_steps < 0) {
+			thr->heap->budget_steps = 0;
+		}
+	}
+	if (thr->heap->budget_steps == 0 ||
+	    (thr->heap->budget_deadline > 0.0 &&
+	     duk_bi_date_get_now((duk_context *) thr) >= thr->heap->budget_deadline)) {
 		/* Keep throwing an error whenever we get here.  The unusual values
 		 * are set this way because no instruction is ever executed, we just
 		 * throw an error until all try/catch/finally and other catchpoints
-		 * have been exhausted.
+		 * have been exhausted.  duk_pcall_budget() restores the outer
+		 * budget when the error reaches it.
 		 */
-		DUK_D(DUK_DPRINT("execution step limit reached, throwing a RangeError"));
+		DUK_D(DUK_DPRINT("execution budget exhausted, throwing a RangeError"));
 		thr->heap->interrupt_init = 0;
 		thr->heap->interrupt_counter = 0;
 		thr->interrupt_counter = 0;
-		DUK_ERROR(thr, DUK_ERR_RANGE_ERROR, "execution step limit");
+		DUK_ERROR(thr, DUK_ERR_RANGE_ERROR, "execution budget exceeded");
+	}
+	if (thr->heap->budget_steps > 0 && thr->heap->budget_steps < ctr) {
+		ctr = thr->heap->budget_steps;
 	}
 #endif
 
@@ -1329,6 +1641,12 @@ static void duk__executor_interrupt(duk_hthread *thr) {
 	}
 #endif
 
+#if defined(DUK_USE_PROFILER)
+	if (thr->heap->prof_interval > 0 && thr->heap->prof_remaining < ctr) {
+		ctr = thr->heap->prof_remaining;
+	}
+#endif
+
 	DUK_DDD(DUK_DDDPRINT("executor interrupt finished, cstop=%d, pc=%d, nextctr=%d",
 	                     (int) thr->callstack_top, (int) act->pc, (int) ctr));
 
@@ -1339,6 +1657,15 @@ static void duk__executor_interrupt(duk_hthread *thr) {
 	thr->heap->interrupt_init = ctr;
 	thr->heap->interrupt_counter = ctr - 1;
 	thr->interrupt_counter = ctr - 1;
+
+#if defined(DUK_USE_PROFILER)
+	/* Sample only after the counters have been updated: taking a sample
+	 * may allocate and run finalizers, re-entering the executor.
+	 */
+	if (prof_sample) {
+		duk_profiler_sample(thr);
+	}
+#endif
 }
 #endif  /* DUK_USE_INTERRUPT_COUNTER */
 
@@ -1378,6 +1705,145 @@ static void duk__executor_interrupt(duk_hthread *thr) {
 #define DUK__REGCONST(x)    ((x) < DUK_BC_REGLIMIT ? DUK__REG((x)) : DUK__CONST((x) - DUK_BC_REGLIMIT))
 #define DUK__REGCONSTP(x)   ((x) < DUK_BC_REGLIMIT ? DUK__REGP((x)) : DUK__CONSTP((x) - DUK_BC_REGLIMIT))
 
+/* Replace register 'x' with a number or a boolean directly, without going
+ * through the value stack.  The new value is not heap allocated so no
+ * INCREF is needed; the old value is DECREF'd last (side effects).
+ */
+#define DUK__REPLACE_REG_NUMBER(x,d)  do { \
+		duk_tval duk__tv_old; \
+		duk_tval *duk__tv_reg = DUK__REGP((x)); \
+		DUK_TVAL_SET_TVAL(&duk__tv_old, duk__tv_reg); \
+		DUK_TVAL_SET_NUMBER_CHKFAST(duk__tv_reg, (d)); \
+		DUK_TVAL_DECREF(thr, &duk__tv_old); \
+	} while (0)
+#define DUK__REPLACE_REG_BOOLEAN(x,b)  do { \
+		duk_tval duk__tv_old; \
+		duk_tval *duk__tv_reg = DUK__REGP((x)); \
+		DUK_TVAL_SET_TVAL(&duk__tv_old, duk__tv_reg); \
+		DUK_TVAL_SET_BOOLEAN(duk__tv_reg, (b)); \
+		DUK_TVAL_DECREF(thr, &duk__tv_old); \
+	} while (0)
+
+/* Inline cache entries of the instruction being executed; 'act->pc' has
+ * already been advanced past it.
+ */
+#if defined(DUK_USE_PROPERTY_IC)
+#define DUK__ICP()          (DUK_HCOMPILEDFUNCTION_GET_IC_BASE(fun) + (act->pc - 1) * DUK_HCOMPILEDFUNCTION_IC_WAYS)
+#endif
+
+/* Executor interrupt counter check, used to implement breakpoints,
+ * debugging interface, execution timeouts, etc.  The counter is heap
+ * specific but is maintained in the current thread to make the check
+ * as fast as possible.  The counter is copied back to the heap struct
+ * whenever a thread switch occurs by the DUK_HEAP_SWITCH_THREAD() macro.
+ */
+#ifdef DUK_USE_INTERRUPT_COUNTER
+#define DUK__INTERRUPT_CHECK()  do { \
+		int_ctr = thr->interrupt_counter; \
+		if (DUK_LIKELY(int_ctr > 0)) { \
+			thr->interrupt_counter = int_ctr - 1; \
+		} else { \
+			/* Trigger at zero or below */ \
+			duk__executor_interrupt(thr); \
+		} \
+	} while (0)
+#else
+#define DUK__INTERRUPT_CHECK()  do { } while (0)
+#endif
+
+/* Opcode and opcode pair counting for DUK_USE_OPCODE_STATS.  The pair
+ * counter follows the dispatch sequence, so it also sees transitions
+ * across calls and returns.
+ */
+#if defined(DUK_USE_OPCODE_STATS)
+#define DUK__OPCODE_STATS()  do { \
+		duk_heap *stats_heap = thr->heap; \
+		duk_small_uint_t stats_op = (duk_small_uint_t) DUK_DEC_OP(ins); \
+		stats_heap->opcode_counts[stats_op]++; \
+		stats_heap->opcode_pair_counts[stats_heap->opcode_prev][stats_op]++; \
+		stats_heap->opcode_prev = stats_op; \
+	} while (0)
+#define DUK__EXTRAOP_STATS(extraop)  do { \
+		thr->heap->extraop_counts[(extraop)]++; \
+	} while (0)
+#else
+#define DUK__OPCODE_STATS()  do { } while (0)
+#define DUK__EXTRAOP_STATS(extraop)  do { } while (0)
+#endif
+
+/* Instruction fetch, executed before every opcode.
+ *
+ * Because ANY DECREF potentially invalidates 'act' now (through
+ * finalization), we need to re-lookup 'act' in almost every case.
+ *
+ * FIXME:
+ * This is not nice; it would be nice if the program counter was a
+ * behind a stable pointer.  For instance, put a raw bytecode pointer
+ * into duk_hthread struct (not into the callstack); since bytecode
+ * has a stable pointer this would work nicely.  Whenever a call is
+ * made, the bytecode pointer could be backed up as an integer index
+ * to the calling activation.
+ */
+#define DUK__FETCH()  do { \
+		DUK_ASSERT(thr->callstack_top >= 1); \
+		DUK_ASSERT(thr->valstack_top - thr->valstack_bottom == fun->nregs); \
+		DUK_ASSERT((int) (thr->valstack_top - thr->valstack) == valstack_top_base); \
+		DUK__INTERRUPT_CHECK(); \
+		act = thr->callstack + thr->callstack_top - 1; \
+		DUK_ASSERT(bcode + act->pc >= DUK_HCOMPILEDFUNCTION_GET_CODE_BASE(fun)); \
+		DUK_ASSERT(bcode + act->pc < DUK_HCOMPILEDFUNCTION_GET_CODE_END(fun)); \
+		DUK_DDD(DUK_DDDPRINT("executing bytecode: pc=%d ins=0x%08x, op=%d, valstack_top=%d/%d  -->  %!I", \
+		                     act->pc, bcode[act->pc], DUK_DEC_OP(bcode[act->pc]), \
+		                     (int) (thr->valstack_top - thr->valstack), \
+		                     (int) (thr->valstack_end - thr->valstack), \
+		                     bcode[act->pc])); \
+		ins = bcode[act->pc++]; \
+		DUK__OPCODE_STATS(); \
+	} while (0)
+
+/* Opcode dispatch.  With DUK_USE_EXEC_COMPUTED_GOTO every opcode handler
+ * ends in its own fetch and indirect jump through a label table (GCC/Clang
+ * "labels as values") instead of returning to the single switch at the
+ * top of the loop.  Each dispatch site then gets its own branch history,
+ * which predicts much better than one shared indirect branch.  The switch
+ * is still used for the first instruction after a (re)start.
+ */
+#if defined(DUK_USE_EXEC_COMPUTED_GOTO)
+#define DUK__OPCASE(x)      case x: duk__op_##x:
+#define DUK__OPLABEL(x)     __extension__ &&duk__op_##x
+#define DUK__NEXT()         do { \
+		DUK__FETCH(); \
+		__extension__ ({ goto *duk__dispatch[DUK_DEC_OP(ins)]; }); \
+	} while (0)
+#else
+#define DUK__OPCASE(x)      case x:
+#define DUK__NEXT()         break
+#endif
+
+/* Baseline JIT entry: run compiled code from the current pc, compiling
+ * the function first once it becomes hot.  The compiled code returns at
+ * the first instruction it doesn't handle (or when an interrupt is due)
+ * with 'act->pc' pointing to that instruction, and interpretation then
+ * continues normally.  Used on (re)entry to a function and on backward
+ * jumps, so a loop with unsupported instructions goes back to compiled
+ * code on its next iteration.
+ */
+#if defined(DUK_USE_JIT)
+#define DUK__JIT_ENTER()  do { \
+		duk_jitcode *duk__jit = fun->jit; \
+		if (duk__jit == NULL) { \
+			duk__jit = duk_js_jit_get_state(thr->heap, fun); \
+		} \
+		if (duk__jit != NULL && \
+		    (duk__jit->code != NULL || \
+		     (++duk__jit->hotness == DUK_JIT_HOTNESS_THRESHOLD && duk_js_jit_compile(thr, fun)))) { \
+			duk_js_jit_run(thr, fun); \
+		} \
+	} while (0)
+#else
+#define DUK__JIT_ENTER()  do { } while (0)
+#endif
+
 #ifdef DUK_USE_VERBOSE_EXECUTOR_ERRORS
 #define DUK__INTERNAL_ERROR(msg)  do { \
 		DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, (msg)); \
@@ -1416,6 +1882,76 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 	int valstack_top_base;    /* valstack top, should match before interpreting each op (no leftovers) */
 #endif
 
+#if defined(DUK_USE_EXEC_COMPUTED_GOTO)
+	/* Dispatch table indexed by opcode, must match DUK_OP_xxx numbering. */
+	static const void * const duk__dispatch[64] = {
+		DUK__OPLABEL(DUK_OP_LDREG),
+		DUK__OPLABEL(DUK_OP_STREG),
+		DUK__OPLABEL(DUK_OP_LDCONST),
+		DUK__OPLABEL(DUK_OP_LDINT),
+		DUK__OPLABEL(DUK_OP_LDINTX),
+		DUK__OPLABEL(DUK_OP_MPUTOBJ),
+		DUK__OPLABEL(DUK_OP_MPUTOBJI),
+		DUK__OPLABEL(DUK_OP_MPUTARR),
+		DUK__OPLABEL(DUK_OP_MPUTARRI),
+		DUK__OPLABEL(DUK_OP_NEW),
+		DUK__OPLABEL(DUK_OP_NEWI),
+		DUK__OPLABEL(DUK_OP_REGEXP),
+		DUK__OPLABEL(DUK_OP_CSREG),
+		DUK__OPLABEL(DUK_OP_CSREGI),
+		DUK__OPLABEL(DUK_OP_GETVAR),
+		DUK__OPLABEL(DUK_OP_PUTVAR),
+		DUK__OPLABEL(DUK_OP_DECLVAR),
+		DUK__OPLABEL(DUK_OP_DELVAR),
+		DUK__OPLABEL(DUK_OP_CSVAR),
+		DUK__OPLABEL(DUK_OP_CSVARI),
+		DUK__OPLABEL(DUK_OP_CLOSURE),
+		DUK__OPLABEL(DUK_OP_GETPROP),
+		DUK__OPLABEL(DUK_OP_PUTPROP),
+		DUK__OPLABEL(DUK_OP_DELPROP),
+		DUK__OPLABEL(DUK_OP_CSPROP),
+		DUK__OPLABEL(DUK_OP_CSPROPI),
+		DUK__OPLABEL(DUK_OP_ADD),
+		DUK__OPLABEL(DUK_OP_SUB),
+		DUK__OPLABEL(DUK_OP_MUL),
+		DUK__OPLABEL(DUK_OP_DIV),
+		DUK__OPLABEL(DUK_OP_MOD),
+		DUK__OPLABEL(DUK_OP_BAND),
+		DUK__OPLABEL(DUK_OP_BOR),
+		DUK__OPLABEL(DUK_OP_BXOR),
+		DUK__OPLABEL(DUK_OP_BASL),
+		DUK__OPLABEL(DUK_OP_BLSR),
+		DUK__OPLABEL(DUK_OP_BASR),
+		DUK__OPLABEL(DUK_OP_BNOT),
+		DUK__OPLABEL(DUK_OP_LNOT),
+		DUK__OPLABEL(DUK_OP_EQ),
+		DUK__OPLABEL(DUK_OP_NEQ),
+		DUK__OPLABEL(DUK_OP_SEQ),
+		DUK__OPLABEL(DUK_OP_SNEQ),
+		DUK__OPLABEL(DUK_OP_GT),
+		DUK__OPLABEL(DUK_OP_GE),
+		DUK__OPLABEL(DUK_OP_LT),
+		DUK__OPLABEL(DUK_OP_LE),
+		DUK__OPLABEL(DUK_OP_IF),
+		DUK__OPLABEL(DUK_OP_INSTOF),
+		DUK__OPLABEL(DUK_OP_IN),
+		DUK__OPLABEL(DUK_OP_JUMP),
+		DUK__OPLABEL(DUK_OP_RETURN),
+		DUK__OPLABEL(DUK_OP_CALL),
+		DUK__OPLABEL(DUK_OP_CALLI),
+		DUK__OPLABEL(DUK_OP_LABEL),
+		DUK__OPLABEL(DUK_OP_ENDLABEL),
+		DUK__OPLABEL(DUK_OP_BREAK),
+		DUK__OPLABEL(DUK_OP_CONTINUE),
+		DUK__OPLABEL(DUK_OP_TRYCATCH),
+		DUK__OPLABEL(DUK_OP_IFCMP),
+		DUK__OPLABEL(DUK_OP_INCDEC),
+		DUK__OPLABEL(unused),
+		DUK__OPLABEL(DUK_OP_EXTRA),
+		DUK__OPLABEL(DUK_OP_INVALID)
+	};
+#endif
+
 	/* XXX: document assumptions on setjmp and volatile variables
 	 * (see duk_handle_call()).
 	 */
@@ -1611,54 +2147,14 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 	valstack_top_base = (int) (thr->valstack_top - thr->valstack);
 #endif
 
-	for (;;) {
-		DUK_ASSERT(thr->callstack_top >= 1);
-		DUK_ASSERT(thr->valstack_top - thr->valstack_bottom == fun->nregs);
-		DUK_ASSERT((int) (thr->valstack_top - thr->valstack) == valstack_top_base);
-
-		/* Executor interrupt counter check, used to implement breakpoints,
-		 * debugging interface, execution timeouts, etc.  The counter is heap
-		 * specific but is maintained in the current thread to make the check
-		 * as fast as possible.  The counter is copied back to the heap struct
-		 * whenever a thread switch occurs by the DUK_HEAP_SWITCH_THREAD() macro.
-		 */
-#ifdef DUK_USE_INTERRUPT_COUNTER
-		int_ctr = thr->interrupt_counter;
-		if (DUK_LIKELY(int_ctr > 0)) {
-			thr->interrupt_counter = int_ctr - 1;
-		} else {
-			/* Trigger at zero or below */
-			duk__executor_interrupt(thr);
-		}
-#endif
-
-		/* Because ANY DECREF potentially invalidates 'act' now (through
-		 * finalization), we need to re-lookup 'act' in almost every case.
-		 *
-		 * FIXME:
-		 * This is not nice; it would be nice if the program counter was a
-		 * behind a stable pointer.  For instance, put a raw bytecode pointer
-		 * into duk_hthread struct (not into the callstack); since bytecode
-		 * has a stable pointer this would work nicely.  Whenever a call is
-		 * made, the bytecode pointer could be backed up as an integer index
-		 * to the calling activation.
-		 */
-
-		act = thr->callstack + thr->callstack_top - 1;
-		DUK_ASSERT(bcode + act->pc >= DUK_HCOMPILEDFUNCTION_GET_CODE_BASE(fun));
-		DUK_ASSERT(bcode + act->pc < DUK_HCOMPILEDFUNCTION_GET_CODE_END(fun));
-
-		DUK_DDD(DUK_DDDPRINT("executing bytecode: pc=%d ins=0x%08x, op=%d, valstack_top=%d/%d  -->  %!I",
-		                     act->pc, bcode[act->pc], DUK_DEC_OP(bcode[act->pc]),
-		                     (int) (thr->valstack_top - thr->valstack),
-		                     (int) (thr->valstack_end - thr->valstack),
-		                     bcode[act->pc]));
+	DUK__JIT_ENTER();
 
-		ins = bcode[act->pc++];
+	for (;;) {
+		DUK__FETCH();
 
 		switch ((duk_small_int_t) DUK_DEC_OP(ins)) {
 
-		case DUK_OP_LDREG: {
+		DUK__OPCASE(DUK_OP_LDREG) {
 			int t;
 			duk_tval tv_tmp;
 			duk_tval *tv1, *tv2;
@@ -1669,10 +2165,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			DUK_TVAL_SET_TVAL(tv1, tv2);
 			DUK_TVAL_INCREF(thr, tv1);
 			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_STREG: {
+		DUK__OPCASE(DUK_OP_STREG) {
 			int t;
 			duk_tval tv_tmp;
 			duk_tval *tv1, *tv2;
@@ -1683,10 +2179,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			DUK_TVAL_SET_TVAL(tv2, tv1);
 			DUK_TVAL_INCREF(thr, tv2);
 			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LDCONST: {
+		DUK__OPCASE(DUK_OP_LDCONST) {
 			int t;
 			duk_tval tv_tmp;
 			duk_tval *tv1, *tv2;
@@ -1697,24 +2193,27 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			DUK_TVAL_SET_TVAL(tv1, tv2);
 			DUK_TVAL_INCREF(thr, tv2);  /* may be e.g. string */
 			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LDINT: {
+		DUK__OPCASE(DUK_OP_LDINT) {
 			int t;
 			duk_tval tv_tmp;
 			duk_tval *tv1;
-			double val;
 
 			t = DUK_DEC_A(ins); tv1 = DUK__REGP(t);
-			t = DUK_DEC_BC(ins); val = (double) (t - DUK_BC_LDINT_BIAS);
+			t = DUK_DEC_BC(ins);
 			DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
-			DUK_TVAL_SET_NUMBER(tv1, val);
+#if defined(DUK_USE_FASTINT)
+			DUK_TVAL_SET_FASTINT(tv1, (duk_int32_t) (t - DUK_BC_LDINT_BIAS));
+#else
+			DUK_TVAL_SET_NUMBER(tv1, (double) (t - DUK_BC_LDINT_BIAS));
+#endif
 			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LDINTX: {
+		DUK__OPCASE(DUK_OP_LDINTX) {
 			int t;
 			duk_tval *tv1;
 			double val;
@@ -1725,12 +2224,12 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			}
 			val = DUK_TVAL_GET_NUMBER(tv1) * ((double) (1 << DUK_BC_LDINTX_SHIFT)) +
 			      (double) DUK_DEC_BC(ins);
-			DUK_TVAL_SET_NUMBER(tv1, val);
-			break;
+			DUK_TVAL_SET_NUMBER_CHKFAST(tv1, val);
+			DUK__NEXT();
 		}
 
-		case DUK_OP_MPUTOBJ:
-		case DUK_OP_MPUTOBJI: {
+		DUK__OPCASE(DUK_OP_MPUTOBJ)
+		DUK__OPCASE(DUK_OP_MPUTOBJI) {
 			duk_context *ctx = (duk_context *) thr;
 			int t;
 			duk_tval *tv1;
@@ -1782,11 +2281,11 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			}
 
 			duk_pop(ctx);  /* [... obj] -> [...] */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_MPUTARR:
-		case DUK_OP_MPUTARRI: {
+		DUK__OPCASE(DUK_OP_MPUTARR)
+		DUK__OPCASE(DUK_OP_MPUTARRI) {
 			duk_context *ctx = (duk_context *) thr;
 			int t;
 			duk_tval *tv1;
@@ -1860,11 +2359,11 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			duk_hobject_set_length(thr, obj, arr_idx);
 
 			duk_pop(ctx);  /* [... obj] -> [...] */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_NEW:
-		case DUK_OP_NEWI: {
+		DUK__OPCASE(DUK_OP_NEW)
+		DUK__OPCASE(DUK_OP_NEWI) {
 			duk_context *ctx = (duk_context *) thr;
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
@@ -1901,10 +2400,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			duk_new(ctx, c);  /* [... constructor arg1 ... argN] -> [retval] */
 			DUK_DDD(DUK_DDDPRINT("NEW -> %!iT", duk_get_tval(ctx, -1)));
 			duk_replace(ctx, b);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_REGEXP: {
+		DUK__OPCASE(DUK_OP_REGEXP) {
 #ifdef DUK_USE_REGEXP_SUPPORT
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
@@ -1928,11 +2427,11 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			DUK__INTERNAL_ERROR("no regexp support");
 #endif
 
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_CSREG:
-		case DUK_OP_CSREGI: {
+		DUK__OPCASE(DUK_OP_CSREG)
+		DUK__OPCASE(DUK_OP_CSREGI) {
 			/*
 			 *  Assuming a register binds to a variable declared within this
 			 *  function (a declarative binding), the 'this' for the call
@@ -1966,10 +2465,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			duk_replace(ctx, a);
 			duk_push_undefined(ctx);
 			duk_replace(ctx, a+1);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_GETVAR: {
+		DUK__OPCASE(DUK_OP_GETVAR) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int bc = DUK_DEC_BC(ins);
@@ -1983,14 +2482,27 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			}
 			name = DUK_TVAL_GET_STRING(tv1);
 			DUK_DDD(DUK_DDDPRINT("GETVAR: '%!O'", name));
+#if defined(DUK_USE_PROPERTY_IC)
+			tv1 = duk_js_getvar_ic(thr, act, name, DUK__ICP());
+			if (tv1 != NULL) {
+				duk_tval tv_tmp;
+				duk_tval *tv_dst = DUK__REGP(a);
+
+				DUK_TVAL_SET_TVAL(&tv_tmp, tv_dst);
+				DUK_TVAL_SET_TVAL(tv_dst, tv1);
+				DUK_TVAL_INCREF(thr, tv_dst);
+				DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+				DUK__NEXT();
+			}
+#endif
 			(void) duk_js_getvar_activation(thr, act, name, 1 /*throw*/);  /* -> [... val this] */
 
 			duk_pop(ctx);  /* 'this' binding is not needed here */
 			duk_replace(ctx, a);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_PUTVAR: {
+		DUK__OPCASE(DUK_OP_PUTVAR) {
 			int a = DUK_DEC_A(ins);
 			int bc = DUK_DEC_BC(ins);
 			duk_tval *tv1;
@@ -2006,12 +2518,24 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			 * should be reworked.
 			 */
 
+#if defined(DUK_USE_PROPERTY_IC)
+			tv1 = duk_js_putvar_ic(thr, act, name, DUK__ICP());
+			if (tv1 != NULL) {
+				duk_tval tv_tmp;
+
+				DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
+				DUK_TVAL_SET_TVAL(tv1, DUK__REGP(a));
+				DUK_TVAL_INCREF(thr, tv1);
+				DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+				DUK__NEXT();
+			}
+#endif
 			tv1 = DUK__REGP(a);  /* val */
 			duk_js_putvar_activation(thr, act, name, tv1, DUK__STRICT());
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_DECLVAR: {
+		DUK__OPCASE(DUK_OP_DECLVAR) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2056,10 +2580,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			}
 
 			duk_pop(ctx);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_DELVAR: {
+		DUK__OPCASE(DUK_OP_DELVAR) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2077,11 +2601,11 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			duk_push_boolean(ctx, rc);
 			duk_replace(ctx, a);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_CSVAR:
-		case DUK_OP_CSVARI: {
+		DUK__OPCASE(DUK_OP_CSVAR)
+		DUK__OPCASE(DUK_OP_CSVARI) {
 			/* 'this' value:
 			 * E5 Section 6.b.i
 			 *
@@ -2102,7 +2626,17 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 				DUK__INTERNAL_ERROR("CSVAR name not a string");
 			}
 			name = DUK_TVAL_GET_STRING(tv1);
-			(void) duk_js_getvar_activation(thr, act, name, 1 /*throw*/);  /* -> [... val this] */
+#if defined(DUK_USE_PROPERTY_IC)
+			tv1 = duk_js_getvar_ic(thr, act, name, DUK__ICP());
+			if (tv1 != NULL) {
+				/* global object binding, 'this' is undefined */
+				duk_push_tval(ctx, tv1);
+				duk_push_undefined(ctx);
+			} else
+#endif
+			{
+				(void) duk_js_getvar_activation(thr, act, name, 1 /*throw*/);  /* -> [... val this] */
+			}
 
 			/* Note: target registers a and a+1 may overlap with DUK__REGCONSTP(b)
 			 * and DUK__REGCONSTP(c).  Careful here.
@@ -2118,10 +2652,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			duk_replace(ctx, a+1);  /* 'this' binding */
 			duk_replace(ctx, a);    /* variable value (function, we hope, not checked here) */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_CLOSURE: {
+		DUK__OPCASE(DUK_OP_CLOSURE) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int bc = DUK_DEC_BC(ins);
@@ -2142,7 +2676,26 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			DUK_DDD(DUK_DDDPRINT("CLOSURE: function template is: %p -> %!O", (void *) fun_temp, fun_temp));
 
-			if (act->lex_env == NULL) {
+			if (act->lex_env == NULL && DUK_HOBJECT_HAS_NOCAPTURE(fun_temp)) {
+				duk_hobject *outer_env;
+
+				/* The inner function doesn't refer to any binding of
+				 * this activation (compiler capture analysis), so its
+				 * scope can start from our outer environment and the
+				 * delayed environment record need not be created.
+				 */
+				DUK_ASSERT(act->var_env == NULL);
+				outer_env = duk_js_get_outer_lex_env(thr, (duk_hobject *) fun);
+				DUK_DDD(DUK_DDDPRINT("CLOSURE: template captures nothing, skip env creation"));
+				duk_js_push_closure(thr,
+				                    (duk_hcompiledfunction *) fun_temp,
+				                    outer_env,
+				                    outer_env);
+				duk_replace(ctx, a);
+				DUK__NEXT();
+			}
+
+			if (act->lex_env == NULL) {
 				DUK_ASSERT(act->var_env == NULL);
 				duk_js_init_activation_environment_records_delayed(thr, act);
 			}
@@ -2159,10 +2712,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			                    act->lex_env);
 			duk_replace(ctx, a);
 
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_GETPROP: {
+		DUK__OPCASE(DUK_OP_GETPROP) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2179,6 +2732,23 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			tv_obj = DUK__REGCONSTP(b);
 			tv_key = DUK__REGCONSTP(c);
 			DUK_DDD(DUK_DDDPRINT("GETPROP: a=%d obj=%!T, key=%!T", a, DUK__REGCONSTP(b), DUK__REGCONSTP(c)));
+#if defined(DUK_USE_PROPERTY_IC)
+			if (DUK_TVAL_IS_OBJECT(tv_obj) && DUK_TVAL_IS_STRING(tv_key)) {
+				duk_tval *tv_val;
+
+				tv_val = duk_hobject_getprop_ic(thr, DUK_TVAL_GET_OBJECT(tv_obj), DUK_TVAL_GET_STRING(tv_key), DUK__ICP());
+				if (tv_val != NULL) {
+					duk_tval tv_tmp;
+					duk_tval *tv_dst = DUK__REGP(a);
+
+					DUK_TVAL_SET_TVAL(&tv_tmp, tv_dst);
+					DUK_TVAL_SET_TVAL(tv_dst, tv_val);
+					DUK_TVAL_INCREF(thr, tv_dst);
+					DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+					DUK__NEXT();
+				}
+			}
+#endif
 			rc = duk_hobject_getprop(thr, tv_obj, tv_key);  /* -> [val] */
 			DUK_UNREF(rc);  /* ignore */
 			DUK_DDD(DUK_DDDPRINT("GETPROP --> %!T", duk_get_tval(ctx, -1)));
@@ -2186,10 +2756,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			tv_key = NULL;  /* invalidated */
 
 			duk_replace(ctx, a);    /* val */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_PUTPROP: {
+		DUK__OPCASE(DUK_OP_PUTPROP) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
@@ -2210,6 +2780,22 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			tv_key = DUK__REGCONSTP(b);
 			tv_val = DUK__REGCONSTP(c);
 			DUK_DDD(DUK_DDDPRINT("PUTPROP: obj=%!T, key=%!T, val=%!T", DUK__REGP(a), DUK__REGCONSTP(b), DUK__REGCONSTP(c)));
+#if defined(DUK_USE_PROPERTY_IC)
+			if (DUK_TVAL_IS_OBJECT(tv_obj) && DUK_TVAL_IS_STRING(tv_key)) {
+				duk_tval *tv_dst;
+
+				tv_dst = duk_hobject_putprop_ic(thr, DUK_TVAL_GET_OBJECT(tv_obj), DUK_TVAL_GET_STRING(tv_key), DUK__ICP());
+				if (tv_dst != NULL) {
+					duk_tval tv_tmp;
+
+					DUK_TVAL_SET_TVAL(&tv_tmp, tv_dst);
+					DUK_TVAL_SET_TVAL(tv_dst, tv_val);
+					DUK_TVAL_INCREF(thr, tv_dst);
+					DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+					DUK__NEXT();
+				}
+			}
+#endif
 			rc = duk_hobject_putprop(thr, tv_obj, tv_key, tv_val, DUK__STRICT());
 			DUK_UNREF(rc);  /* ignore */
 			DUK_DDD(DUK_DDDPRINT("PUTPROP --> obj=%!T, key=%!T, val=%!T", DUK__REGP(a), DUK__REGCONSTP(b), DUK__REGCONSTP(c)));
@@ -2217,10 +2803,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			tv_key = NULL;  /* invalidated */
 			tv_val = NULL;  /* invalidated */
 
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_DELPROP: {
+		DUK__OPCASE(DUK_OP_DELPROP) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2242,17 +2828,20 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			duk_push_boolean(ctx, rc);
 			duk_replace(ctx, a);    /* result */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_CSPROP:
-		case DUK_OP_CSPROPI: {
+		DUK__OPCASE(DUK_OP_CSPROP)
+		DUK__OPCASE(DUK_OP_CSPROPI) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
 			duk_tval *tv_obj;
 			duk_tval *tv_key;
+#if defined(DUK_USE_PROPERTY_IC)
+			duk_tval *tv_val;
+#endif
 			int rc;
 
 			/* E5 Section 11.2.3, step 6.a.i */
@@ -2262,8 +2851,19 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			tv_obj = DUK__REGP(b);
 			tv_key = DUK__REGCONSTP(c);
-			rc = duk_hobject_getprop(thr, tv_obj, tv_key);  /* -> [val] */
-			DUK_UNREF(rc);  /* unused */
+#if defined(DUK_USE_PROPERTY_IC)
+			tv_val = NULL;
+			if (DUK_TVAL_IS_OBJECT(tv_obj) && DUK_TVAL_IS_STRING(tv_key)) {
+				tv_val = duk_hobject_getprop_ic(thr, DUK_TVAL_GET_OBJECT(tv_obj), DUK_TVAL_GET_STRING(tv_key), DUK__ICP());
+			}
+			if (tv_val != NULL) {
+				duk_push_tval(ctx, tv_val);  /* -> [val] */
+			} else
+#endif
+			{
+				rc = duk_hobject_getprop(thr, tv_obj, tv_key);  /* -> [val] */
+				DUK_UNREF(rc);  /* unused */
+			}
 			tv_obj = NULL;  /* invalidated */
 			tv_key = NULL;  /* invalidated */
 
@@ -2282,96 +2882,176 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			duk_push_tval(ctx, DUK__REGP(b));  /* [ ... val obj ] */
 			duk_replace(ctx, a+1);        /* 'this' binding */
 			duk_replace(ctx, a);          /* val */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_ADD:
-		case DUK_OP_SUB:
-		case DUK_OP_MUL:
-		case DUK_OP_DIV:
-		case DUK_OP_MOD: {
+		DUK__OPCASE(DUK_OP_ADD)
+		DUK__OPCASE(DUK_OP_SUB)
+		DUK__OPCASE(DUK_OP_MUL)
+		DUK__OPCASE(DUK_OP_DIV)
+		DUK__OPCASE(DUK_OP_MOD) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
 			int op = DUK_DEC_OP(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
+
+			/*
+			 *  Number fast path inline: the result is written directly
+			 *  to the target register.  The helpers are only called for
+			 *  non-number operands which need coercion (or concatenation).
+			 */
+
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				duk_int32_t v3;
+
+				if (duk__vm_arith_fastint(op, DUK_TVAL_GET_FASTINT(tv_x), DUK_TVAL_GET_FASTINT(tv_y), &v3)) {
+					duk__vm_set_fastint(thr, a, v3);
+					DUK__NEXT();
+				}
+			}
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				duk_double_union du;
+				double d1 = DUK_TVAL_GET_NUMBER(tv_x);
+				double d2 = DUK_TVAL_GET_NUMBER(tv_y);
+
+				switch (op) {
+				case DUK_OP_ADD: {
+					du.d = d1 + d2;
+					break;
+				}
+				case DUK_OP_SUB: {
+					du.d = d1 - d2;
+					break;
+				}
+				case DUK_OP_MUL: {
+					du.d = d1 * d2;
+					break;
+				}
+				case DUK_OP_DIV: {
+					du.d = d1 / d2;
+					break;
+				}
+				default: {
+					DUK_ASSERT(op == DUK_OP_MOD);
+					du.d = duk__compute_mod(d1, d2);
+					break;
+				}
+				}
+
+				/* important to use normalized NaN with 8-byte tagged types */
+				DUK_DBLUNION_NORMALIZE_NAN_CHECK(&du);
+				DUK_ASSERT(DUK_DBLUNION_IS_NORMALIZED(&du));
+				DUK__REPLACE_REG_NUMBER(a, du.d);  /* side effects */
+				DUK__NEXT();
+			}
 
 			if (op == DUK_OP_ADD) {
 				/*
 				 *  Handling DUK_OP_ADD this way is more compact (experimentally)
 				 *  than a separate case with separate argument decoding.
 				 */
-				duk__vm_arith_add(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a);
+				duk__vm_arith_add(thr, tv_x, tv_y, a);
 			} else {
-				duk__vm_arith_binary_op(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a, op);
+				duk__vm_arith_binary_op(thr, tv_x, tv_y, a, op);
 			}
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_BAND:
-		case DUK_OP_BOR:
-		case DUK_OP_BXOR:
-		case DUK_OP_BASL:
-		case DUK_OP_BLSR:
-		case DUK_OP_BASR: {
+		DUK__OPCASE(DUK_OP_BAND)
+		DUK__OPCASE(DUK_OP_BOR)
+		DUK__OPCASE(DUK_OP_BXOR)
+		DUK__OPCASE(DUK_OP_BASL)
+		DUK__OPCASE(DUK_OP_BLSR)
+		DUK__OPCASE(DUK_OP_BASR) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
 			int op = DUK_DEC_OP(ins);
 
 			duk__vm_bitwise_binary_op(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a, op);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_BNOT: {
+		DUK__OPCASE(DUK_OP_BNOT) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 
 			duk__vm_bitwise_not(thr, DUK__REGCONSTP(b), a);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LNOT: {
+		DUK__OPCASE(DUK_OP_LNOT) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 
 			duk__vm_logical_not(thr, DUK__REGCONSTP(b), DUK__REGP(a));
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_EQ:
-		case DUK_OP_NEQ: {
-			duk_context *ctx = (duk_context *) thr;
+		DUK__OPCASE(DUK_OP_EQ)
+		DUK__OPCASE(DUK_OP_NEQ) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
 			int tmp;
 
 			/* E5 Sections 11.9.1, 11.9.3 */
-			tmp = duk_js_equals(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c));
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				tmp = (DUK_TVAL_GET_FASTINT(tv_x) == DUK_TVAL_GET_FASTINT(tv_y));
+			} else
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				/* NaN and +0/-0 are handled correctly by C comparison */
+				tmp = (DUK_TVAL_GET_NUMBER(tv_x) == DUK_TVAL_GET_NUMBER(tv_y));
+			} else {
+				tmp = duk_js_equals(thr, tv_x, tv_y);
+			}
 			if (DUK_DEC_OP(ins) == DUK_OP_NEQ) {
 				tmp = !tmp;
 			}
-			duk_push_boolean(ctx, tmp);
-			duk_replace(ctx, a);
-			break;
+			DUK__REPLACE_REG_BOOLEAN(a, tmp);  /* side effects */
+			DUK__NEXT();
 		}
 
-		case DUK_OP_SEQ:
-		case DUK_OP_SNEQ: {
-			duk_context *ctx = (duk_context *) thr;
+		DUK__OPCASE(DUK_OP_SEQ)
+		DUK__OPCASE(DUK_OP_SNEQ) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
 			int tmp;
 
 			/* E5 Sections 11.9.1, 11.9.3 */
-			tmp = duk_js_strict_equals(DUK__REGCONSTP(b), DUK__REGCONSTP(c));
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				tmp = (DUK_TVAL_GET_FASTINT(tv_x) == DUK_TVAL_GET_FASTINT(tv_y));
+			} else
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				/* NaN and +0/-0 are handled correctly by C comparison */
+				tmp = (DUK_TVAL_GET_NUMBER(tv_x) == DUK_TVAL_GET_NUMBER(tv_y));
+			} else {
+				tmp = duk_js_strict_equals(tv_x, tv_y);
+			}
 			if (DUK_DEC_OP(ins) == DUK_OP_SNEQ) {
 				tmp = !tmp;
 			}
-			duk_push_boolean(ctx, tmp);
-			duk_replace(ctx, a);
-			break;
+			DUK__REPLACE_REG_BOOLEAN(a, tmp);  /* side effects */
+			DUK__NEXT();
 		}
 
 		/* Note: combining comparison ops must be done carefully because
@@ -2384,80 +3064,128 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 		 * XXX: can be combined; check code size.
 		 */
 
-		case DUK_OP_GT: {
-			duk_context *ctx = (duk_context *) thr;
+		DUK__OPCASE(DUK_OP_GT) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
 			int tmp;
 
 			/* x > y  -->  y < x */
-			tmp = duk_js_compare_helper(thr,
-			                            DUK__REGCONSTP(c),  /* y */
-			                            DUK__REGCONSTP(b),  /* x */
-			                            0);                 /* flags */
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				tmp = (DUK_TVAL_GET_FASTINT(tv_x) > DUK_TVAL_GET_FASTINT(tv_y));
+			} else
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				/* C comparison is false for NaN operands, as required */
+				tmp = (DUK_TVAL_GET_NUMBER(tv_x) > DUK_TVAL_GET_NUMBER(tv_y));
+			} else {
+				tmp = duk_js_compare_helper(thr,
+				                            tv_y,  /* y */
+				                            tv_x,  /* x */
+				                            0);    /* flags */
+			}
 
-			duk_push_boolean(ctx, tmp);
-			duk_replace(ctx, a);
-			break;
+			DUK__REPLACE_REG_BOOLEAN(a, tmp);  /* side effects */
+			DUK__NEXT();
 		}
 
-		case DUK_OP_GE: {
-			duk_context *ctx = (duk_context *) thr;
+		DUK__OPCASE(DUK_OP_GE) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
 			int tmp;
 
 			/* x >= y  -->  not (x < y) */
-			tmp = duk_js_compare_helper(thr,
-			                            DUK__REGCONSTP(b),  /* x */
-			                            DUK__REGCONSTP(c),  /* y */
-			                            DUK_COMPARE_FLAG_EVAL_LEFT_FIRST |
-			                            DUK_COMPARE_FLAG_NEGATE);  /* flags */
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				tmp = (DUK_TVAL_GET_FASTINT(tv_x) >= DUK_TVAL_GET_FASTINT(tv_y));
+			} else
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				/* C comparison is false for NaN operands, as required */
+				tmp = (DUK_TVAL_GET_NUMBER(tv_x) >= DUK_TVAL_GET_NUMBER(tv_y));
+			} else {
+				tmp = duk_js_compare_helper(thr,
+				                            tv_x,  /* x */
+				                            tv_y,  /* y */
+				                            DUK_COMPARE_FLAG_EVAL_LEFT_FIRST |
+				                            DUK_COMPARE_FLAG_NEGATE);  /* flags */
+			}
 
-			duk_push_boolean(ctx, tmp);
-			duk_replace(ctx, a);
-			break;
+			DUK__REPLACE_REG_BOOLEAN(a, tmp);  /* side effects */
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LT: {
-			duk_context *ctx = (duk_context *) thr;
+		DUK__OPCASE(DUK_OP_LT) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
 			int tmp;
 
 			/* x < y */
-			tmp = duk_js_compare_helper(thr,
-			                            DUK__REGCONSTP(b),  /* x */
-			                            DUK__REGCONSTP(c),  /* y */
-			                            DUK_COMPARE_FLAG_EVAL_LEFT_FIRST);  /* flags */
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				tmp = (DUK_TVAL_GET_FASTINT(tv_x) < DUK_TVAL_GET_FASTINT(tv_y));
+			} else
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				/* C comparison is false for NaN operands, as required */
+				tmp = (DUK_TVAL_GET_NUMBER(tv_x) < DUK_TVAL_GET_NUMBER(tv_y));
+			} else {
+				tmp = duk_js_compare_helper(thr,
+				                            tv_x,  /* x */
+				                            tv_y,  /* y */
+				                            DUK_COMPARE_FLAG_EVAL_LEFT_FIRST);  /* flags */
+			}
 
-			duk_push_boolean(ctx, tmp);
-			duk_replace(ctx, a);
-			break;
+			DUK__REPLACE_REG_BOOLEAN(a, tmp);  /* side effects */
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LE: {
-			duk_context *ctx = (duk_context *) thr;
+		DUK__OPCASE(DUK_OP_LE) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
 			int tmp;
 
 			/* x <= y  -->  not (x > y)  -->  not (y < x) */
-			tmp = duk_js_compare_helper(thr,
-			                            DUK__REGCONSTP(c),  /* y */
-			                            DUK__REGCONSTP(b),  /* x */
-			                            DUK_COMPARE_FLAG_NEGATE);  /* flags */
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+				tmp = (DUK_TVAL_GET_FASTINT(tv_x) <= DUK_TVAL_GET_FASTINT(tv_y));
+			} else
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				/* C comparison is false for NaN operands, as required */
+				tmp = (DUK_TVAL_GET_NUMBER(tv_x) <= DUK_TVAL_GET_NUMBER(tv_y));
+			} else {
+				tmp = duk_js_compare_helper(thr,
+				                            tv_y,  /* y */
+				                            tv_x,  /* x */
+				                            DUK_COMPARE_FLAG_NEGATE);  /* flags */
+			}
 
-			duk_push_boolean(ctx, tmp);
-			duk_replace(ctx, a);
-			break;
+			DUK__REPLACE_REG_BOOLEAN(a, tmp);  /* side effects */
+			DUK__NEXT();
 		}
 
-		case DUK_OP_IF: {
+		DUK__OPCASE(DUK_OP_IF) {
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
 			int tmp;
@@ -2469,10 +3197,136 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			} else {
 				;
 			}
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_INSTOF: {
+		DUK__OPCASE(DUK_OP_IFCMP) {
+			int a = DUK_DEC_A(ins);
+			int b = DUK_DEC_B(ins);
+			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+			duk_tval *tv_y;
+			int tmp;
+
+			/* A -> comparison opcode and flags
+			 * B -> x
+			 * C -> y
+			 *
+			 * Fused comparison and IF.  The next instruction is always a
+			 * JUMP: it is skipped if the comparison result matches the
+			 * TRUE flag, otherwise it's executed here without a dispatch.
+			 */
+
+			tv_x = DUK__REGCONSTP(b);
+			tv_y = DUK__REGCONSTP(c);
+			if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
+				double d1, d2;
+
+#if defined(DUK_USE_FASTINT)
+				if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+					d1 = (double) DUK_TVAL_GET_FASTINT(tv_x);
+					d2 = (double) DUK_TVAL_GET_FASTINT(tv_y);
+				} else
+#endif
+				{
+					d1 = DUK_TVAL_GET_NUMBER(tv_x);
+					d2 = DUK_TVAL_GET_NUMBER(tv_y);
+				}
+
+				/* C comparisons handle NaN and +0/-0 as required */
+				switch (a & DUK_BC_IFCMP_OP_MASK) {
+				case DUK_OP_EQ:
+				case DUK_OP_SEQ: {
+					tmp = (d1 == d2);
+					break;
+				}
+				case DUK_OP_NEQ:
+				case DUK_OP_SNEQ: {
+					tmp = (d1 != d2);
+					break;
+				}
+				case DUK_OP_GT: {
+					tmp = (d1 > d2);
+					break;
+				}
+				case DUK_OP_GE: {
+					tmp = (d1 >= d2);
+					break;
+				}
+				case DUK_OP_LT: {
+					tmp = (d1 < d2);
+					break;
+				}
+				default: {
+					DUK_ASSERT((a & DUK_BC_IFCMP_OP_MASK) == DUK_OP_LE);
+					tmp = (d1 <= d2);
+					break;
+				}
+				}
+			} else {
+				tmp = duk__vm_compare_op(thr, tv_x, tv_y, a & DUK_BC_IFCMP_OP_MASK);
+			}
+
+			if (tmp == ((a & DUK_BC_IFCMP_FLAG_TRUE) ? 1 : 0)) {
+				act->pc++;
+			} else {
+				duk_instr ins_jump = bcode[act->pc];
+				int abc = DUK_DEC_ABC(ins_jump);
+
+				DUK_ASSERT(DUK_DEC_OP(ins_jump) == DUK_OP_JUMP);
+				act->pc += 1 + abc - DUK_BC_JUMP_BIAS;
+#if defined(DUK_USE_JIT)
+				if (abc < DUK_BC_JUMP_BIAS) {
+					DUK__JIT_ENTER();
+				}
+#endif
+			}
+			DUK__NEXT();
+		}
+
+		DUK__OPCASE(DUK_OP_INCDEC) {
+			int a = DUK_DEC_A(ins);
+			int b = DUK_DEC_B(ins);
+			int c = DUK_DEC_C(ins);
+			duk_tval *tv_x;
+
+			/* A -> target register for result
+			 * B -> register updated in place
+			 * C -> flags
+			 */
+
+			DUK_ASSERT(DUK_BC_ISREG(b));
+			tv_x = DUK__REGP(b);
+#if defined(DUK_USE_FASTINT)
+			if (DUK_TVAL_IS_FASTINT(tv_x)) {
+				duk_int32_t v1 = DUK_TVAL_GET_FASTINT(tv_x);
+
+				if ((c & DUK_BC_INCDEC_FLAG_DEC) ? (v1 != DUK_INT32_MIN) : (v1 != DUK_INT32_MAX)) {
+					duk_int32_t v2 = (c & DUK_BC_INCDEC_FLAG_DEC) ? v1 - 1 : v1 + 1;
+
+					DUK_TVAL_SET_FASTINT(tv_x, v2);  /* old value is a number: no refcount */
+					duk__vm_set_fastint(thr, a, (c & DUK_BC_INCDEC_FLAG_POST) ? v1 : v2);
+					DUK__NEXT();
+				}
+			}
+#endif
+			if (DUK_TVAL_IS_NUMBER(tv_x)) {
+				duk_double_union du;
+				double d1 = DUK_TVAL_GET_NUMBER(tv_x);
+
+				du.d = (c & DUK_BC_INCDEC_FLAG_DEC) ? d1 - 1.0 : d1 + 1.0;
+				DUK_DBLUNION_NORMALIZE_NAN_CHECK(&du);
+				DUK_ASSERT(DUK_DBLUNION_IS_NORMALIZED(&du));
+				DUK_TVAL_SET_NUMBER_CHKFAST(tv_x, du.d);  /* old value is a number: no refcount */
+				DUK__REPLACE_REG_NUMBER(a, (c & DUK_BC_INCDEC_FLAG_POST) ? d1 : du.d);  /* side effects */
+				DUK__NEXT();
+			}
+
+			duk__vm_incdec(thr, a, b, c);
+			DUK__NEXT();
+		}
+
+		DUK__OPCASE(DUK_OP_INSTOF) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2482,10 +3336,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			tmp = duk_js_instanceof(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c));
 			duk_push_boolean(ctx, tmp);
 			duk_replace(ctx, a);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_IN: {
+		DUK__OPCASE(DUK_OP_IN) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2495,17 +3349,22 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			tmp = duk_js_in(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c));
 			duk_push_boolean(ctx, tmp);
 			duk_replace(ctx, a);
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_JUMP: {
+		DUK__OPCASE(DUK_OP_JUMP) {
 			int abc = DUK_DEC_ABC(ins);
 
 			act->pc += abc - DUK_BC_JUMP_BIAS;
-			break;
+#if defined(DUK_USE_JIT)
+			if (abc < DUK_BC_JUMP_BIAS) {
+				DUK__JIT_ENTER();
+			}
+#endif
+			DUK__NEXT();
 		}
 
-		case DUK_OP_RETURN: {
+		DUK__OPCASE(DUK_OP_RETURN) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2538,11 +3397,11 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 				duk_err_longjmp(thr);
 				DUK_UNREACHABLE();
 			}
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_CALL:
-		case DUK_OP_CALLI: {
+		DUK__OPCASE(DUK_OP_CALL)
+		DUK__OPCASE(DUK_OP_CALLI) {
 			duk_context *ctx = (duk_context *) thr;
 			int a = DUK_DEC_A(ins);
 			int b = DUK_DEC_B(ins);
@@ -2573,6 +3432,16 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			}
 
 			tv_func = DUK__REGP(b);
+			if (DUK_TVAL_IS_LIGHTFUNC(tv_func)) {
+				/* Lightfuncs are always Duktape/C functions and can
+				 * never be eval, so a plain C recursive call suffices.
+				 */
+				duk_set_top(ctx, b + c + 2);   /* [ ... func this arg1 ... argN ] */
+				duk_handle_call(thr, c, 0 /*call_flags*/);
+				duk_require_stack_top(ctx, fun->nregs);  /* may have shrunk by inner calls, must recheck */
+				duk_set_top(ctx, fun->nregs);
+				DUK__NEXT();
+			}
 			if (!DUK_TVAL_IS_OBJECT(tv_func)) {
 				DUK_ERROR(thr, DUK_ERR_TYPE_ERROR, "call target not an object");
 			}
@@ -2668,10 +3537,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 				 * will store and restore our state.
 				 */
 			}
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_LABEL: {
+		DUK__OPCASE(DUK_OP_LABEL) {
 			duk_catcher *cat;
 			int abc = DUK_DEC_ABC(ins);
 
@@ -2692,10 +3561,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			                     DUK_CAT_GET_LABEL(cat)));
 
 			act->pc += 2;  /* skip jump slots */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_ENDLABEL: {
+		DUK__OPCASE(DUK_OP_ENDLABEL) {
 			duk_catcher *cat;
 #if defined(DUK_USE_DDDPRINT) || defined(DUK_USE_ASSERTIONS)
 			duk_int_t abc = DUK_DEC_ABC(ins);
@@ -2713,10 +3582,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			duk_hthread_catchstack_unwind(thr, thr->catchstack_top - 1);
 			/* no need to unwind callstack */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_BREAK: {
+		DUK__OPCASE(DUK_OP_BREAK) {
 			duk_context *ctx = (duk_context *) thr;
 			int abc = DUK_DEC_ABC(ins);
 
@@ -2733,10 +3602,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			duk_err_longjmp(thr);
 
 			DUK_UNREACHABLE();
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_CONTINUE: {
+		DUK__OPCASE(DUK_OP_CONTINUE) {
 			duk_context *ctx = (duk_context *) thr;
 			int abc = DUK_DEC_ABC(ins);
 
@@ -2753,10 +3622,10 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			duk_err_longjmp(thr);
 
 			DUK_UNREACHABLE();
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_TRYCATCH: {
+		DUK__OPCASE(DUK_OP_TRYCATCH) {
 			duk_context *ctx = (duk_context *) thr;
 			duk_catcher *cat;
 			duk_tval *tv1;
@@ -2889,13 +3758,14 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 			                     cat->flags, cat->callstack_index, cat->pc_base, cat->idx_base, cat->h_varname));
 
 			act->pc += 2;  /* skip jump slots */
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_EXTRA: {
+		DUK__OPCASE(DUK_OP_EXTRA) {
 			/* XXX: shared decoding of 'b' and 'c'? */
 
 			int extraop = DUK_DEC_A(ins);
+			DUK__EXTRAOP_STATS(extraop);
 			switch (extraop) {
 
 			case DUK_EXTRAOP_NOP: {
@@ -3396,20 +4266,24 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 			}  /* end switch */
 
-			break;
+			DUK__NEXT();
 		}
 
-		case DUK_OP_INVALID: {
+		DUK__OPCASE(DUK_OP_INVALID) {
 			DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "INVALID opcode (%d)", DUK_DEC_ABC(ins));
-			break;
+			DUK__NEXT();
 		}
 
-		default: {
+		default:
+#if defined(DUK_USE_EXEC_COMPUTED_GOTO)
+		duk__op_unused:
+#endif
+		{
 			/* this should never be possible, because the switch-case is
 			 * comprehensive
 			 */
 			DUK__INTERNAL_ERROR("invalid opcode");
-			break;
+			DUK__NEXT();
 		}
 
 		}  /* end switch */
@@ -3424,3 +4298,272 @@ void duk_js_execute_bytecode(duk_hthread *entry_thread) {
 
 #undef DUK__INTERNAL_ERROR
 
+
+/*
+ *  Baseline JIT slow path
+ *
+ *  Executes a single instruction on behalf of JIT compiled code: either
+ *  an instruction the JIT has no inline code for, or the slow path of an
+ *  inline fast path (e.g. non-number operands).  The semantics must match
+ *  the corresponding opcode handlers above exactly.  'act->pc' is synced
+ *  first so that errors, tracebacks, inline caches and nested calls see
+ *  the same state as in the interpreter.
+ *
+ *  Returns 1 if an IF instruction skips the next instruction, 0 otherwise.
+ */
+
+#if defined(DUK_USE_JIT)
+duk_bool_t duk_js_jit_slowpath(duk_hthread *thr, duk_instr ins, duk_int_t pc_next) {
+	duk_context *ctx = (duk_context *) thr;
+	duk_activation *act;
+	duk_hcompiledfunction *fun;
+	int op = DUK_DEC_OP(ins);
+	int a = DUK_DEC_A(ins);
+	int b = DUK_DEC_B(ins);
+	int c = DUK_DEC_C(ins);
+	int bc = DUK_DEC_BC(ins);
+	duk_tval tv_tmp;
+	duk_tval *tv1;
+	duk_tval *tv2;
+	int tmp;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(thr->callstack_top >= 1);
+
+	act = thr->callstack + thr->callstack_top - 1;
+	act->pc = pc_next;
+	fun = (duk_hcompiledfunction *) act->func;
+	DUK_ASSERT(DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) fun));
+
+	switch (op) {
+	case DUK_OP_LDREG:
+	case DUK_OP_STREG:
+	case DUK_OP_LDCONST: {
+		if (op == DUK_OP_LDREG) {
+			tv1 = DUK__REGP(a); tv2 = DUK__REGP(bc);
+		} else if (op == DUK_OP_STREG) {
+			tv1 = DUK__REGP(bc); tv2 = DUK__REGP(a);
+		} else {
+			tv1 = DUK__REGP(a); tv2 = DUK__CONSTP(bc);
+		}
+		DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
+		DUK_TVAL_SET_TVAL(tv1, tv2);
+		DUK_TVAL_INCREF(thr, tv1);
+		DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+		break;
+	}
+	case DUK_OP_LDINT: {
+		tv1 = DUK__REGP(a);
+		DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
+#if defined(DUK_USE_FASTINT)
+		DUK_TVAL_SET_FASTINT(tv1, (duk_int32_t) (bc - DUK_BC_LDINT_BIAS));
+#else
+		DUK_TVAL_SET_NUMBER(tv1, (double) (bc - DUK_BC_LDINT_BIAS));
+#endif
+		DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+		break;
+	}
+	case DUK_OP_LDINTX: {
+		double val;
+
+		tv1 = DUK__REGP(a);
+		if (!DUK_TVAL_IS_NUMBER(tv1)) {
+			DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "LDINTX target not a number");
+		}
+		val = DUK_TVAL_GET_NUMBER(tv1) * ((double) (1 << DUK_BC_LDINTX_SHIFT)) +
+		      (double) bc;
+		DUK_TVAL_SET_NUMBER_CHKFAST(tv1, val);
+		break;
+	}
+	case DUK_OP_GETVAR:
+	case DUK_OP_PUTVAR: {
+		duk_hstring *name;
+
+		tv1 = DUK__CONSTP(bc);
+		if (!DUK_TVAL_IS_STRING(tv1)) {
+			DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "GETVAR/PUTVAR name not a string");
+		}
+		name = DUK_TVAL_GET_STRING(tv1);
+#if defined(DUK_USE_PROPERTY_IC)
+		tv2 = (op == DUK_OP_GETVAR ? duk_js_getvar_ic(thr, act, name, DUK__ICP()) :
+		                             duk_js_putvar_ic(thr, act, name, DUK__ICP()));
+		if (tv2 != NULL) {
+			if (op == DUK_OP_GETVAR) {
+				tv1 = DUK__REGP(a);
+			} else {
+				tv1 = tv2;
+				tv2 = DUK__REGP(a);
+			}
+			DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
+			DUK_TVAL_SET_TVAL(tv1, tv2);
+			DUK_TVAL_INCREF(thr, tv1);
+			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+			break;
+		}
+#endif
+		if (op == DUK_OP_GETVAR) {
+			(void) duk_js_getvar_activation(thr, act, name, 1 /*throw*/);  /* -> [... val this] */
+			duk_pop(ctx);  /* 'this' binding is not needed here */
+			duk_replace(ctx, a);
+		} else {
+			duk_js_putvar_activation(thr, act, name, DUK__REGP(a), DUK__STRICT());
+		}
+		break;
+	}
+	case DUK_OP_GETPROP: {
+		tv1 = DUK__REGCONSTP(b);
+		tv2 = DUK__REGCONSTP(c);
+#if defined(DUK_USE_PROPERTY_IC)
+		if (DUK_TVAL_IS_OBJECT(tv1) && DUK_TVAL_IS_STRING(tv2)) {
+			duk_tval *tv_val;
+
+			tv_val = duk_hobject_getprop_ic(thr, DUK_TVAL_GET_OBJECT(tv1), DUK_TVAL_GET_STRING(tv2), DUK__ICP());
+			if (tv_val != NULL) {
+				duk_tval *tv_dst = DUK__REGP(a);
+
+				DUK_TVAL_SET_TVAL(&tv_tmp, tv_dst);
+				DUK_TVAL_SET_TVAL(tv_dst, tv_val);
+				DUK_TVAL_INCREF(thr, tv_dst);
+				DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+				break;
+			}
+		}
+#endif
+		(void) duk_hobject_getprop(thr, tv1, tv2);  /* -> [val] */
+		duk_replace(ctx, a);
+		break;
+	}
+	case DUK_OP_PUTPROP: {
+		duk_tval *tv_val;
+
+		tv1 = DUK__REGP(a);
+		tv2 = DUK__REGCONSTP(b);
+		tv_val = DUK__REGCONSTP(c);
+#if defined(DUK_USE_PROPERTY_IC)
+		if (DUK_TVAL_IS_OBJECT(tv1) && DUK_TVAL_IS_STRING(tv2)) {
+			duk_tval *tv_dst;
+
+			tv_dst = duk_hobject_putprop_ic(thr, DUK_TVAL_GET_OBJECT(tv1), DUK_TVAL_GET_STRING(tv2), DUK__ICP());
+			if (tv_dst != NULL) {
+				DUK_TVAL_SET_TVAL(&tv_tmp, tv_dst);
+				DUK_TVAL_SET_TVAL(tv_dst, tv_val);
+				DUK_TVAL_INCREF(thr, tv_dst);
+				DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+				break;
+			}
+		}
+#endif
+		(void) duk_hobject_putprop(thr, tv1, tv2, tv_val, DUK__STRICT());
+		break;
+	}
+	case DUK_OP_ADD: {
+		duk__vm_arith_add(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a);
+		break;
+	}
+	case DUK_OP_SUB:
+	case DUK_OP_MUL:
+	case DUK_OP_DIV:
+	case DUK_OP_MOD: {
+		duk__vm_arith_binary_op(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a, op);
+		break;
+	}
+	case DUK_OP_BAND:
+	case DUK_OP_BOR:
+	case DUK_OP_BXOR:
+	case DUK_OP_BASL:
+	case DUK_OP_BLSR:
+	case DUK_OP_BASR: {
+		duk__vm_bitwise_binary_op(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a, op);
+		break;
+	}
+	case DUK_OP_BNOT: {
+		duk__vm_bitwise_not(thr, DUK__REGCONSTP(b), a);
+		break;
+	}
+	case DUK_OP_LNOT: {
+		duk__vm_logical_not(thr, DUK__REGCONSTP(b), DUK__REGP(a));
+		break;
+	}
+	case DUK_OP_EQ:
+	case DUK_OP_NEQ:
+	case DUK_OP_SEQ:
+	case DUK_OP_SNEQ:
+	case DUK_OP_GT:
+	case DUK_OP_GE:
+	case DUK_OP_LT:
+	case DUK_OP_LE: {
+		tmp = duk__vm_compare_op(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), op);
+		duk_push_boolean(ctx, tmp);
+		duk_replace(ctx, a);
+		break;
+	}
+	case DUK_OP_IF: {
+		tmp = duk_js_toboolean(DUK__REGCONSTP(b));
+		return (tmp == a);
+	}
+	case DUK_OP_IFCMP: {
+		/* returns 1 if the following JUMP is skipped */
+		tmp = duk__vm_compare_op(thr, DUK__REGCONSTP(b), DUK__REGCONSTP(c), a & DUK_BC_IFCMP_OP_MASK);
+		return (tmp == ((a & DUK_BC_IFCMP_FLAG_TRUE) ? 1 : 0));
+	}
+	case DUK_OP_INCDEC: {
+		duk__vm_incdec(thr, a, b, c);
+		break;
+	}
+	case DUK_OP_EXTRA: {
+		switch (a) {
+		case DUK_EXTRAOP_NOP: {
+			break;
+		}
+		case DUK_EXTRAOP_LDTHIS: {
+			tv1 = DUK__REGP(b);
+			tv2 = thr->valstack_bottom - 1;  /* 'this binding' is just under bottom */
+			DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
+			DUK_TVAL_SET_TVAL(tv1, tv2);
+			DUK_TVAL_INCREF(thr, tv1);
+			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+			break;
+		}
+		case DUK_EXTRAOP_LDUNDEF:
+		case DUK_EXTRAOP_LDNULL:
+		case DUK_EXTRAOP_LDTRUE:
+		case DUK_EXTRAOP_LDFALSE: {
+			tv1 = DUK__REGP(bc);
+			DUK_TVAL_SET_TVAL(&tv_tmp, tv1);
+			if (a == DUK_EXTRAOP_LDUNDEF) {
+				DUK_TVAL_SET_UNDEFINED_ACTUAL(tv1);
+			} else if (a == DUK_EXTRAOP_LDNULL) {
+				DUK_TVAL_SET_NULL(tv1);
+			} else {
+				DUK_TVAL_SET_BOOLEAN(tv1, (a == DUK_EXTRAOP_LDTRUE ? 1 : 0));
+			}
+			DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+			break;
+		}
+		case DUK_EXTRAOP_TONUM: {
+			duk_dup(ctx, c);
+			duk_to_number(ctx, -1);
+			duk_replace(ctx, b);
+			break;
+		}
+		case DUK_EXTRAOP_UNM:
+		case DUK_EXTRAOP_UNP:
+		case DUK_EXTRAOP_INC:
+		case DUK_EXTRAOP_DEC: {
+			duk__vm_arith_unary_op(thr, DUK__REGCONSTP(c), b, a);
+			break;
+		}
+		default: {
+			DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "extra opcode not supported by jit");
+		}
+		}
+		break;
+	}
+	default: {
+		DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "opcode not supported by jit");
+	}
+	}
+
+	return 0;
+}
+#endif  /* DUK_USE_JIT */
@@ -0,0 +1,830 @@
+/*
+ *  Baseline JIT for x86-64 Linux (DUK_USE_JIT).
+ *
+ *  A hot compiled function is translated into machine code one
+ *  instruction at a time using fixed templates; there is no register
+ *  allocation or optimization across instructions.  Registers and
+ *  constants stay in memory (valstack frame and constants table) so that
+ *  the interpreter and compiled code can hand over at any instruction
+ *  boundary.
+ *
+ *  Templates come in three flavors:
+ *
+ *    - Inline fast paths for simple number/boolean cases (register
+ *      copies, arithmetic, comparisons, IF, IFCMP, INCDEC, JUMP).  When
+ *      the operand types don't match, the template falls back to the
+ *      slow path.
+ *
+ *    - Slow path: a call to duk_js_jit_slowpath() in duk_js_executor.c
+ *      which executes a single instruction with interpreter semantics.
+ *
+ *    - Exit: instructions the JIT doesn't handle (calls, returns, try/
+ *      catch, environment manipulation etc) return to the interpreter
+ *      with the pc of the instruction.  The interpreter re-enters
+ *      compiled code on the next backward jump or function entry.
+ *
+ *  Every instruction first checks the executor interrupt counter in the
+ *  same way as the interpreter does, and exits if an interrupt is due,
+ *  so that execution budgets, the profiler etc see identical instruction
+ *  counts.
+ *
+ *  Register usage in compiled code:
+ *
+ *    rbx = duk_hthread *thr
+ *    r12 = thr->valstack_bottom (reloaded after every slow path call)
+ *    r13 = constants base
+ *    rax, rcx, rdx, rsi, rdi, xmm0, xmm1 = scratch
+ *
+ *  Only the unpacked 16-byte duk_tval layout is supported.
+ *
+ *  The hotness counter and compiled code live in a refcounted duk_jitcode
+ *  shared by a function template and all its closures, so creating many
+ *  closures of the same function costs one compilation and one mapping.
+ */
+
+#include "duk_internal.h"
+
+#if defined(DUK_USE_JIT)
+
+/* Entry point signature: runs compiled code starting from 'entry' and
+ * returns the pc of the first instruction to be interpreted.
+ */
+typedef duk_int_t (*duk__jit_func)(duk_hthread *thr, void *entry, duk_tval *consts);
+
+#define DUK__JIT_MAX_PCS          65536  /* don't bother with huge functions */
+#define DUK__JIT_PROLOGUE_SIZE    64
+#define DUK__JIT_MAX_INSTR_SIZE   256    /* upper bound for a single instruction template */
+
+/* x86-64 register numbers */
+#define DUK__RAX                  0
+#define DUK__RCX                  1
+#define DUK__RDX                  2
+#define DUK__RBX                  3
+#define DUK__RSI                  6
+#define DUK__RDI                  7
+#define DUK__R12                  12
+#define DUK__R13                  13
+#define DUK__XMM0                 0
+#define DUK__XMM1                 1
+
+#define DUK__TV_TAG               ((duk_int32_t) offsetof(duk_tval, t))
+#define DUK__TV_VAL               ((duk_int32_t) offsetof(duk_tval, v))
+
+typedef struct {
+	duk_instr *bcode;              /* bytecode being compiled */
+	duk_uint8_t *buf;
+	duk_size_t len;
+	duk_size_t epilogue;           /* offset of the shared epilogue */
+	duk_uint32_t *fixup_offs;      /* rel32 positions referring to instruction labels */
+	duk_uint32_t *fixup_pcs;       /* target pc of each fixup */
+	duk_uint32_t num_fixups;
+	duk_uint32_t num_pcs;
+} duk__jit_emitter;
+
+/*
+ *  Low level emitters
+ */
+
+static void duk__jit_u8(duk__jit_emitter *e, duk_uint32_t x) {
+	e->buf[e->len++] = (duk_uint8_t) x;
+}
+
+static void duk__jit_u32(duk__jit_emitter *e, duk_uint32_t x) {
+	duk__jit_u8(e, x & 0xff);
+	duk__jit_u8(e, (x >> 8) & 0xff);
+	duk__jit_u8(e, (x >> 16) & 0xff);
+	duk__jit_u8(e, (x >> 24) & 0xff);
+}
+
+static void duk__jit_u64(duk__jit_emitter *e, duk_uint64_t x) {
+	duk__jit_u32(e, (duk_uint32_t) (x & 0xffffffffUL));
+	duk__jit_u32(e, (duk_uint32_t) (x >> 32));
+}
+
+static void duk__jit_patch_rel32(duk__jit_emitter *e, duk_size_t pos, duk_size_t target) {
+	duk_uint32_t rel = (duk_uint32_t) ((duk_int32_t) target - (duk_int32_t) (pos + 4));
+
+	e->buf[pos] = (duk_uint8_t) (rel & 0xff);
+	e->buf[pos + 1] = (duk_uint8_t) ((rel >> 8) & 0xff);
+	e->buf[pos + 2] = (duk_uint8_t) ((rel >> 16) & 0xff);
+	e->buf[pos + 3] = (duk_uint8_t) ((rel >> 24) & 0xff);
+}
+
+/* Instruction with a [base + disp32] memory operand.  'opcode' is one
+ * byte, or two bytes (0x0fXX) for the 0x0f opcode map; 'prefix' is an
+ * optional mandatory prefix (0x66, 0xf2) which must precede REX.
+ */
+static void duk__jit_mem(duk__jit_emitter *e, duk_small_uint_t prefix, duk_small_uint_t rex_w,
+                         duk_uint32_t opcode, duk_small_uint_t reg, duk_small_uint_t base, duk_int32_t disp) {
+	duk_small_uint_t rex;
+
+	if (prefix != 0) {
+		duk__jit_u8(e, prefix);
+	}
+	rex = (rex_w ? 0x08 : 0) | ((reg & 0x08) ? 0x04 : 0) | ((base & 0x08) ? 0x01 : 0);
+	if (rex != 0) {
+		duk__jit_u8(e, 0x40 | rex);
+	}
+	if (opcode > 0xff) {
+		duk__jit_u8(e, opcode >> 8);
+	}
+	duk__jit_u8(e, opcode & 0xff);
+	duk__jit_u8(e, 0x80 | ((reg & 0x07) << 3) | (base & 0x07));  /* mod=10: [base + disp32] */
+	if ((base & 0x07) == 0x04) {
+		duk__jit_u8(e, 0x24);  /* SIB for rsp/r12 base, no index */
+	}
+	duk__jit_u32(e, (duk_uint32_t) disp);
+}
+
+/* jmp/jcc rel32 with a placeholder target; returns the rel32 position. */
+static duk_size_t duk__jit_jump(duk__jit_emitter *e, duk_uint32_t opcode) {
+	duk_size_t pos;
+
+	if (opcode > 0xff) {
+		duk__jit_u8(e, opcode >> 8);
+	}
+	duk__jit_u8(e, opcode & 0xff);
+	pos = e->len;
+	duk__jit_u32(e, 0);
+	return pos;
+}
+
+#define DUK__JMP                  0xe9
+#define DUK__JZ                   0x0f84
+#define DUK__JNZ                  0x0f85
+#define DUK__JBE                  0x0f86
+#define DUK__JG                   0x0f8f
+
+/* jmp/jcc to the label of instruction 'pc', resolved after all code is emitted. */
+static void duk__jit_jump_pc(duk__jit_emitter *e, duk_uint32_t opcode, duk_uint32_t pc) {
+	DUK_ASSERT(pc < e->num_pcs);
+	e->fixup_offs[e->num_fixups] = (duk_uint32_t) duk__jit_jump(e, opcode);
+	e->fixup_pcs[e->num_fixups] = pc;
+	e->num_fixups++;
+}
+
+/* Return to the interpreter with 'pc' as the next instruction. */
+static void duk__jit_exit(duk__jit_emitter *e, duk_uint32_t pc) {
+	duk__jit_u8(e, 0xb8);  /* mov eax, imm32 */
+	duk__jit_u32(e, pc);
+	duk__jit_patch_rel32(e, duk__jit_jump(e, DUK__JMP), e->epilogue);
+}
+
+/* Address of a B/C field operand (register or constant). */
+static void duk__jit_regconst(duk_uint32_t x, duk_small_uint_t *base, duk_int32_t *disp) {
+	if (DUK_BC_ISREG(x)) {
+		*base = DUK__R12;
+		*disp = (duk_int32_t) (x * sizeof(duk_tval));
+	} else {
+		*base = DUK__R13;
+		*disp = (duk_int32_t) ((x - DUK_BC_REGLIMIT) * sizeof(duk_tval));
+	}
+}
+
+/* movzx eax, word [tag] */
+static void duk__jit_load_tag(duk__jit_emitter *e, duk_small_uint_t reg, duk_small_uint_t base, duk_int32_t disp) {
+	duk__jit_mem(e, 0, 0, 0x0fb7, reg, base, disp + DUK__TV_TAG);
+}
+
+/* Store a tag as a 32-bit value, clearing 'v_extra' as well. */
+static void duk__jit_store_tag(duk__jit_emitter *e, duk_small_uint_t base, duk_int32_t disp, duk_uint32_t tag) {
+	duk__jit_mem(e, 0, 0, 0xc7, 0, base, disp + DUK__TV_TAG);  /* mov dword [mem], imm32 */
+	duk__jit_u32(e, tag);
+}
+
+#if defined(DUK_USE_REFERENCE_COUNTING)
+/* Jump (returned rel32 position) if the value is heap allocated, i.e.
+ * overwriting or copying it would need refcount updates.
+ */
+static duk_size_t duk__jit_heap_check(duk__jit_emitter *e, duk_small_uint_t base, duk_int32_t disp) {
+	duk__jit_load_tag(e, DUK__RAX, base, disp);
+	duk__jit_u8(e, 0x83); duk__jit_u8(e, 0xe8); duk__jit_u8(e, DUK_TAG_STRING);  /* sub eax, imm8 */
+	duk__jit_u8(e, 0x83); duk__jit_u8(e, 0xf8); duk__jit_u8(e, DUK_TAG_BUFFER - DUK_TAG_STRING);  /* cmp eax, imm8 */
+	return duk__jit_jump(e, DUK__JBE);
+}
+#endif
+
+/* Call the slow path for instruction 'ins' at 'pc'; result in eax. */
+static void duk__jit_slowpath(duk__jit_emitter *e, duk_instr ins, duk_uint32_t pc) {
+	duk_uint64_t addr;
+	duk_bool_t (*helper)(duk_hthread *, duk_instr, duk_int_t) = duk_js_jit_slowpath;
+
+	DUK_MEMCPY((void *) &addr, (const void *) &helper, sizeof(addr));
+
+	duk__jit_u8(e, 0x48); duk__jit_u8(e, 0x89); duk__jit_u8(e, 0xdf);  /* mov rdi, rbx */
+	duk__jit_u8(e, 0xbe); duk__jit_u32(e, (duk_uint32_t) ins);         /* mov esi, imm32 */
+	duk__jit_u8(e, 0xba); duk__jit_u32(e, pc + 1);                     /* mov edx, imm32 */
+	duk__jit_u8(e, 0x48); duk__jit_u8(e, 0xb8); duk__jit_u64(e, addr);  /* mov rax, imm64 */
+	duk__jit_u8(e, 0xff); duk__jit_u8(e, 0xd0);                        /* call rax */
+
+	/* valstack may have been resized */
+	duk__jit_mem(e, 0, 1, 0x8b, DUK__R12, DUK__RBX, (duk_int32_t) offsetof(duk_hthread, valstack_bottom));
+}
+
+/*
+ *  Instruction templates
+ */
+
+static duk_bool_t duk__jit_is_supported(duk_instr ins) {
+	switch (DUK_DEC_OP(ins)) {
+	case DUK_OP_LDREG:
+	case DUK_OP_STREG:
+	case DUK_OP_LDCONST:
+	case DUK_OP_LDINT:
+	case DUK_OP_LDINTX:
+	case DUK_OP_GETVAR:
+	case DUK_OP_PUTVAR:
+	case DUK_OP_GETPROP:
+	case DUK_OP_PUTPROP:
+	case DUK_OP_ADD:
+	case DUK_OP_SUB:
+	case DUK_OP_MUL:
+	case DUK_OP_DIV:
+	case DUK_OP_MOD:
+	case DUK_OP_BAND:
+	case DUK_OP_BOR:
+	case DUK_OP_BXOR:
+	case DUK_OP_BASL:
+	case DUK_OP_BLSR:
+	case DUK_OP_BASR:
+	case DUK_OP_BNOT:
+	case DUK_OP_LNOT:
+	case DUK_OP_EQ:
+	case DUK_OP_NEQ:
+	case DUK_OP_SEQ:
+	case DUK_OP_SNEQ:
+	case DUK_OP_GT:
+	case DUK_OP_GE:
+	case DUK_OP_LT:
+	case DUK_OP_LE:
+	case DUK_OP_IF:
+	case DUK_OP_JUMP:
+	case DUK_OP_IFCMP:
+	case DUK_OP_INCDEC:
+		return 1;
+	case DUK_OP_EXTRA:
+		switch (DUK_DEC_A(ins)) {
+		case DUK_EXTRAOP_NOP:
+		case DUK_EXTRAOP_LDTHIS:
+		case DUK_EXTRAOP_LDUNDEF:
+		case DUK_EXTRAOP_LDNULL:
+		case DUK_EXTRAOP_LDTRUE:
+		case DUK_EXTRAOP_LDFALSE:
+		case DUK_EXTRAOP_TONUM:
+		case DUK_EXTRAOP_UNM:
+		case DUK_EXTRAOP_UNP:
+		case DUK_EXTRAOP_INC:
+		case DUK_EXTRAOP_DEC:
+			return 1;
+		}
+		return 0;
+	}
+	return 0;
+}
+
+static duk_bool_t duk__jit_emit_instr(duk__jit_emitter *e, duk_instr ins, duk_uint32_t pc) {
+	duk_small_uint_t op = (duk_small_uint_t) DUK_DEC_OP(ins);
+	duk_uint32_t a = (duk_uint32_t) DUK_DEC_A(ins);
+	duk_uint32_t b = (duk_uint32_t) DUK_DEC_B(ins);
+	duk_uint32_t c = (duk_uint32_t) DUK_DEC_C(ins);
+	duk_uint32_t bc = (duk_uint32_t) DUK_DEC_BC(ins);
+	duk_size_t slow[4];            /* jumps to the slow path */
+	duk_small_uint_t num_slow = 0;
+	duk_bool_t inline_code = 0;    /* fast path emitted, needs a jump over the slow path */
+	duk_bool_t skip_check = 0;     /* IF: slow path result decides skipping */
+	duk_size_t done;
+	duk_small_uint_t i;
+	duk_small_uint_t base1, base2, base3;
+	duk_int32_t disp1, disp2, disp3;
+
+	DUK_UNREF(c);
+	DUK_UNREF(base3);
+	DUK_UNREF(disp3);
+
+	if (!duk__jit_is_supported(ins)) {
+		duk__jit_exit(e, pc);
+		return 1;
+	}
+
+#if defined(DUK_USE_INTERRUPT_COUNTER)
+	/* Same semantics as DUK__INTERRUPT_CHECK(): exit so that the
+	 * interpreter handles the interrupt before this instruction.
+	 */
+	duk__jit_mem(e, 0, 0, 0x83, 7, DUK__RBX, (duk_int32_t) offsetof(duk_hthread, interrupt_counter));  /* cmp dword [mem], imm8 */
+	duk__jit_u8(e, 0x00);
+	{
+		duk_size_t ok = duk__jit_jump(e, DUK__JG);
+		duk__jit_exit(e, pc);
+		duk__jit_patch_rel32(e, ok, e->len);
+	}
+	duk__jit_mem(e, 0, 0, 0xff, 1, DUK__RBX, (duk_int32_t) offsetof(duk_hthread, interrupt_counter));  /* dec dword [mem] */
+#endif
+
+	switch (op) {
+	case DUK_OP_LDREG:
+	case DUK_OP_STREG:
+	case DUK_OP_LDCONST: {
+		/* base1/disp1 = target, base2/disp2 = source */
+		base1 = base2 = DUK__R12;
+		if (op == DUK_OP_LDREG) {
+			disp1 = (duk_int32_t) (a * sizeof(duk_tval));
+			disp2 = (duk_int32_t) (bc * sizeof(duk_tval));
+		} else if (op == DUK_OP_STREG) {
+			disp1 = (duk_int32_t) (bc * sizeof(duk_tval));
+			disp2 = (duk_int32_t) (a * sizeof(duk_tval));
+		} else {
+			base2 = DUK__R13;
+			disp1 = (duk_int32_t) (a * sizeof(duk_tval));
+			disp2 = (duk_int32_t) (bc * sizeof(duk_tval));
+		}
+#if defined(DUK_USE_REFERENCE_COUNTING)
+		slow[num_slow++] = duk__jit_heap_check(e, base1, disp1);
+		slow[num_slow++] = duk__jit_heap_check(e, base2, disp2);
+#endif
+		duk__jit_mem(e, 0, 0, 0x0f10, DUK__XMM0, base2, disp2);  /* movups xmm0, [src] */
+		duk__jit_mem(e, 0, 0, 0x0f11, DUK__XMM0, base1, disp1);  /* movups [dst], xmm0 */
+		inline_code = 1;
+		break;
+	}
+	case DUK_OP_LDINT: {
+		disp1 = (duk_int32_t) (a * sizeof(duk_tval));
+#if defined(DUK_USE_REFERENCE_COUNTING)
+		slow[num_slow++] = duk__jit_heap_check(e, DUK__R12, disp1);
+#endif
+#if defined(DUK_USE_FASTINT)
+		duk__jit_store_tag(e, DUK__R12, disp1, DUK_TAG_FASTINT);
+		duk__jit_mem(e, 0, 0, 0xc7, 0, DUK__R12, disp1 + DUK__TV_VAL);  /* mov dword [mem], imm32 */
+		duk__jit_u32(e, (duk_uint32_t) ((duk_int32_t) bc - DUK_BC_LDINT_BIAS));
+#else
+		{
+			duk_double_t d = (duk_double_t) ((duk_int32_t) bc - DUK_BC_LDINT_BIAS);
+			duk_uint64_t bits;
+
+			DUK_MEMCPY((void *) &bits, (const void *) &d, sizeof(bits));
+			duk__jit_store_tag(e, DUK__R12, disp1, DUK__TAG_NUMBER);
+			duk__jit_u8(e, 0x48); duk__jit_u8(e, 0xb8); duk__jit_u64(e, bits);  /* mov rax, imm64 */
+			duk__jit_mem(e, 0, 1, 0x89, DUK__RAX, DUK__R12, disp1 + DUK__TV_VAL);  /* mov [mem], rax */
+		}
+#endif
+		inline_code = 1;
+		break;
+	}
+#if !defined(DUK_USE_FASTINT)
+	/* Number fast paths are only inlined without fastint support: with
+	 * fastints the interpreter's result representation depends on the
+	 * operand and result values.
+	 */
+	case DUK_OP_ADD:
+	case DUK_OP_SUB:
+	case DUK_OP_MUL:
+	case DUK_OP_DIV:
+	case DUK_OP_GT:
+	case DUK_OP_GE:
+	case DUK_OP_LT:
+	case DUK_OP_LE: {
+		duk_uint32_t sseop;
+
+		duk__jit_regconst(b, &base2, &disp2);
+		duk__jit_regconst(c, &base3, &disp3);
+		base1 = DUK__R12;
+		disp1 = (duk_int32_t) (a * sizeof(duk_tval));
+
+		/* both operands numbers: (tag1 | tag2) == DUK__TAG_NUMBER */
+		duk__jit_load_tag(e, DUK__RAX, base2, disp2);
+		duk__jit_load_tag(e, DUK__RCX, base3, disp3);
+		duk__jit_u8(e, 0x09); duk__jit_u8(e, 0xc8);  /* or eax, ecx */
+		slow[num_slow++] = duk__jit_jump(e, DUK__JNZ);
+#if defined(DUK_USE_REFERENCE_COUNTING)
+		slow[num_slow++] = duk__jit_heap_check(e, base1, disp1);
+#endif
+
+		if (op == DUK_OP_ADD || op == DUK_OP_SUB || op == DUK_OP_MUL || op == DUK_OP_DIV) {
+			sseop = (op == DUK_OP_ADD ? 0x0f58 : op == DUK_OP_SUB ? 0x0f5c : op == DUK_OP_MUL ? 0x0f59 : 0x0f5e);
+			duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* movsd xmm0, [b] */
+			duk__jit_mem(e, 0xf2, 0, sseop, DUK__XMM0, base3, disp3 + DUK__TV_VAL);   /* op xmm0, [c] */
+			duk__jit_mem(e, 0xf2, 0, 0x0f11, DUK__XMM0, base1, disp1 + DUK__TV_VAL);  /* movsd [a], xmm0 */
+			duk__jit_store_tag(e, base1, disp1, DUK__TAG_NUMBER);
+		} else {
+			/* x < y  <=>  y > x (seta), x <= y  <=>  y >= x (setae); both
+			 * are false for unordered (NaN) operands.
+			 */
+			if (op == DUK_OP_LT || op == DUK_OP_LE) {
+				duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base3, disp3 + DUK__TV_VAL);  /* movsd xmm0, [c] */
+				duk__jit_mem(e, 0x66, 0, 0x0f2e, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* ucomisd xmm0, [b] */
+			} else {
+				duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* movsd xmm0, [b] */
+				duk__jit_mem(e, 0x66, 0, 0x0f2e, DUK__XMM0, base3, disp3 + DUK__TV_VAL);  /* ucomisd xmm0, [c] */
+			}
+			duk__jit_u8(e, 0x0f);
+			duk__jit_u8(e, (op == DUK_OP_LT || op == DUK_OP_GT) ? 0x97 : 0x93);  /* seta/setae al */
+			duk__jit_u8(e, 0xc0);
+			duk__jit_u8(e, 0x0f); duk__jit_u8(e, 0xb6); duk__jit_u8(e, 0xc0);  /* movzx eax, al */
+			duk__jit_store_tag(e, base1, disp1, DUK_TAG_BOOLEAN);
+			duk__jit_mem(e, 0, 0, 0x89, DUK__RAX, base1, disp1 + DUK__TV_VAL);  /* mov [a], eax */
+		}
+		inline_code = 1;
+		break;
+	}
+#endif  /* !DUK_USE_FASTINT */
+	case DUK_OP_IF: {
+		if (pc + 2 >= e->num_pcs) {
+			return 0;
+		}
+		duk__jit_regconst(b, &base2, &disp2);
+		duk__jit_load_tag(e, DUK__RAX, base2, disp2);
+		duk__jit_u8(e, 0x83); duk__jit_u8(e, 0xf8); duk__jit_u8(e, DUK_TAG_BOOLEAN);  /* cmp eax, imm8 */
+		slow[num_slow++] = duk__jit_jump(e, DUK__JNZ);
+		duk__jit_mem(e, 0, 0, 0x8b, DUK__RAX, base2, disp2 + DUK__TV_VAL);  /* mov eax, [b] */
+		duk__jit_u8(e, 0x85); duk__jit_u8(e, 0xc0);  /* test eax, eax */
+		duk__jit_jump_pc(e, a ? DUK__JNZ : DUK__JZ, pc + 2);
+		inline_code = 1;
+		skip_check = 1;
+		break;
+	}
+	case DUK_OP_IFCMP: {
+		/* The following JUMP is executed as part of IFCMP (as in the
+		 * interpreter): eax is set to 1 if the JUMP is skipped, and the
+		 * shared tail either skips it or jumps directly to its target.
+		 */
+		duk_instr ins_jump;
+		duk_int32_t target;
+		duk_small_uint_t cmpop = (duk_small_uint_t) (a & DUK_BC_IFCMP_OP_MASK);
+		duk_size_t tail;
+
+		if (pc + 2 >= e->num_pcs) {
+			return 0;
+		}
+		ins_jump = e->bcode[pc + 1];
+		DUK_ASSERT(DUK_DEC_OP(ins_jump) == DUK_OP_JUMP);
+		target = (duk_int32_t) pc + 2 + (duk_int32_t) DUK_DEC_ABC(ins_jump) - DUK_BC_JUMP_BIAS;
+		if (target < 0 || target >= (duk_int32_t) e->num_pcs) {
+			return 0;
+		}
+
+#if !defined(DUK_USE_FASTINT)
+		duk__jit_regconst(b, &base2, &disp2);
+		duk__jit_regconst(c, &base3, &disp3);
+		duk__jit_load_tag(e, DUK__RAX, base2, disp2);
+		duk__jit_load_tag(e, DUK__RCX, base3, disp3);
+		duk__jit_u8(e, 0x09); duk__jit_u8(e, 0xc8);  /* or eax, ecx */
+		slow[num_slow++] = duk__jit_jump(e, DUK__JNZ);
+
+		if (cmpop == DUK_OP_LT || cmpop == DUK_OP_LE) {
+			duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base3, disp3 + DUK__TV_VAL);  /* movsd xmm0, [c] */
+			duk__jit_mem(e, 0x66, 0, 0x0f2e, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* ucomisd xmm0, [b] */
+		} else {
+			duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* movsd xmm0, [b] */
+			duk__jit_mem(e, 0x66, 0, 0x0f2e, DUK__XMM0, base3, disp3 + DUK__TV_VAL);  /* ucomisd xmm0, [c] */
+		}
+		if (cmpop == DUK_OP_GT || cmpop == DUK_OP_GE || cmpop == DUK_OP_LT || cmpop == DUK_OP_LE) {
+			duk__jit_u8(e, 0x0f);
+			duk__jit_u8(e, (cmpop == DUK_OP_LT || cmpop == DUK_OP_GT) ? 0x97 : 0x93);  /* seta/setae al */
+			duk__jit_u8(e, 0xc0);
+		} else {
+			/* equal: ZF=1 and PF=0 (unordered sets both) */
+			duk__jit_u8(e, 0x0f); duk__jit_u8(e, 0x94); duk__jit_u8(e, 0xc0);  /* sete al */
+			duk__jit_u8(e, 0x0f); duk__jit_u8(e, 0x9b); duk__jit_u8(e, 0xc1);  /* setnp cl */
+			duk__jit_u8(e, 0x20); duk__jit_u8(e, 0xc8);                        /* and al, cl */
+			if (cmpop == DUK_OP_NEQ || cmpop == DUK_OP_SNEQ) {
+				duk__jit_u8(e, 0x34); duk__jit_u8(e, 0x01);  /* xor al, 1 */
+			}
+		}
+		if (!(a & DUK_BC_IFCMP_FLAG_TRUE)) {
+			duk__jit_u8(e, 0x34); duk__jit_u8(e, 0x01);  /* xor al, 1 */
+		}
+		duk__jit_u8(e, 0x0f); duk__jit_u8(e, 0xb6); duk__jit_u8(e, 0xc0);  /* movzx eax, al */
+		tail = duk__jit_jump(e, DUK__JMP);
+#else
+		tail = 0;
+#endif
+		for (i = 0; i < num_slow; i++) {
+			duk__jit_patch_rel32(e, slow[i], e->len);
+		}
+		duk__jit_slowpath(e, ins, pc);
+#if !defined(DUK_USE_FASTINT)
+		duk__jit_patch_rel32(e, tail, e->len);
+#else
+		DUK_UNREF(tail);
+		DUK_UNREF(cmpop);
+#endif
+		duk__jit_u8(e, 0x85); duk__jit_u8(e, 0xc0);  /* test eax, eax */
+		duk__jit_jump_pc(e, DUK__JNZ, pc + 2);
+		duk__jit_jump_pc(e, DUK__JMP, (duk_uint32_t) target);
+		return 1;
+	}
+#if !defined(DUK_USE_FASTINT)
+	case DUK_OP_INCDEC: {
+		/* base1/disp1 = target, base2/disp2 = register updated in place */
+		base1 = base2 = DUK__R12;
+		disp1 = (duk_int32_t) (a * sizeof(duk_tval));
+		disp2 = (duk_int32_t) (b * sizeof(duk_tval));
+		duk__jit_load_tag(e, DUK__RAX, base2, disp2);
+		duk__jit_u8(e, 0x85); duk__jit_u8(e, 0xc0);  /* test eax, eax */
+		slow[num_slow++] = duk__jit_jump(e, DUK__JNZ);
+#if defined(DUK_USE_REFERENCE_COUNTING)
+		slow[num_slow++] = duk__jit_heap_check(e, base1, disp1);
+#endif
+		duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* movsd xmm0, [b] */
+		if (c & DUK_BC_INCDEC_FLAG_POST) {
+			duk__jit_mem(e, 0xf2, 0, 0x0f11, DUK__XMM0, base1, disp1 + DUK__TV_VAL);  /* movsd [a], xmm0 */
+		}
+		duk__jit_u8(e, 0x48); duk__jit_u8(e, 0xb8); duk__jit_u32(e, 0); duk__jit_u32(e, 0x3ff00000UL);  /* mov rax, 1.0 */
+		duk__jit_u8(e, 0x66); duk__jit_u8(e, 0x48); duk__jit_u8(e, 0x0f); duk__jit_u8(e, 0x6e); duk__jit_u8(e, 0xc8);  /* movq xmm1, rax */
+		duk__jit_u8(e, 0xf2); duk__jit_u8(e, 0x0f);
+		duk__jit_u8(e, (c & DUK_BC_INCDEC_FLAG_DEC) ? 0x5c : 0x58);  /* subsd/addsd xmm0, xmm1 */
+		duk__jit_u8(e, 0xc1);
+		duk__jit_mem(e, 0xf2, 0, 0x0f11, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* movsd [b], xmm0 */
+		if (!(c & DUK_BC_INCDEC_FLAG_POST)) {
+			duk__jit_mem(e, 0xf2, 0, 0x0f11, DUK__XMM0, base1, disp1 + DUK__TV_VAL);  /* movsd [a], xmm0 */
+		}
+		duk__jit_store_tag(e, base1, disp1, DUK__TAG_NUMBER);
+		inline_code = 1;
+		break;
+	}
+#endif  /* !DUK_USE_FASTINT */
+	case DUK_OP_JUMP: {
+		duk_int32_t target = (duk_int32_t) pc + 1 + (duk_int32_t) DUK_DEC_ABC(ins) - DUK_BC_JUMP_BIAS;
+
+		if (target < 0 || target >= (duk_int32_t) e->num_pcs) {
+			return 0;
+		}
+		duk__jit_jump_pc(e, DUK__JMP, (duk_uint32_t) target);
+		return 1;
+	}
+	case DUK_OP_EXTRA: {
+		switch (a) {
+		case DUK_EXTRAOP_NOP: {
+			return 1;
+		}
+		case DUK_EXTRAOP_LDUNDEF:
+		case DUK_EXTRAOP_LDNULL:
+		case DUK_EXTRAOP_LDTRUE:
+		case DUK_EXTRAOP_LDFALSE: {
+			disp1 = (duk_int32_t) (bc * sizeof(duk_tval));
+#if defined(DUK_USE_REFERENCE_COUNTING)
+			slow[num_slow++] = duk__jit_heap_check(e, DUK__R12, disp1);
+#endif
+			if (a == DUK_EXTRAOP_LDUNDEF) {
+				duk__jit_store_tag(e, DUK__R12, disp1, DUK_TAG_UNDEFINED);
+			} else if (a == DUK_EXTRAOP_LDNULL) {
+				duk__jit_store_tag(e, DUK__R12, disp1, DUK_TAG_NULL);
+			} else {
+				duk__jit_store_tag(e, DUK__R12, disp1, DUK_TAG_BOOLEAN);
+			}
+			if (a != DUK_EXTRAOP_LDNULL) {
+				duk__jit_mem(e, 0, 0, 0xc7, 0, DUK__R12, disp1 + DUK__TV_VAL);  /* mov dword [mem], imm32 */
+				duk__jit_u32(e, (a == DUK_EXTRAOP_LDTRUE ? 1 : 0));
+			}
+			inline_code = 1;
+			break;
+		}
+#if !defined(DUK_USE_FASTINT)
+		case DUK_EXTRAOP_INC:
+		case DUK_EXTRAOP_DEC: {
+			duk__jit_regconst(c, &base2, &disp2);
+			disp1 = (duk_int32_t) (b * sizeof(duk_tval));
+			duk__jit_load_tag(e, DUK__RAX, base2, disp2);
+			duk__jit_u8(e, 0x85); duk__jit_u8(e, 0xc0);  /* test eax, eax */
+			slow[num_slow++] = duk__jit_jump(e, DUK__JNZ);
+#if defined(DUK_USE_REFERENCE_COUNTING)
+			slow[num_slow++] = duk__jit_heap_check(e, DUK__R12, disp1);
+#endif
+			duk__jit_mem(e, 0xf2, 0, 0x0f10, DUK__XMM0, base2, disp2 + DUK__TV_VAL);  /* movsd xmm0, [c] */
+			duk__jit_u8(e, 0x48); duk__jit_u8(e, 0xb8); duk__jit_u32(e, 0); duk__jit_u32(e, 0x3ff00000UL);  /* mov rax, 1.0 */
+			duk__jit_u8(e, 0x66); duk__jit_u8(e, 0x48); duk__jit_u8(e, 0x0f); duk__jit_u8(e, 0x6e); duk__jit_u8(e, 0xc8);  /* movq xmm1, rax */
+			duk__jit_u8(e, 0xf2); duk__jit_u8(e, 0x0f);
+			duk__jit_u8(e, a == DUK_EXTRAOP_INC ? 0x58 : 0x5c);  /* addsd/subsd xmm0, xmm1 */
+			duk__jit_u8(e, 0xc1);
+			duk__jit_mem(e, 0xf2, 0, 0x0f11, DUK__XMM0, DUK__R12, disp1 + DUK__TV_VAL);  /* movsd [b], xmm0 */
+			duk__jit_store_tag(e, DUK__R12, disp1, DUK__TAG_NUMBER);
+			inline_code = 1;
+			break;
+		}
+#endif
+		default: {
+			break;
+		}
+		}
+		break;
+	}
+	default: {
+		break;
+	}
+	}
+
+	/* Slow path: either the only code for the instruction or reached
+	 * through 'slow' jumps from the fast path.
+	 */
+	done = 0;
+	if (inline_code) {
+		if (num_slow == 0) {
+			return 1;
+		}
+		done = duk__jit_jump(e, DUK__JMP);
+	}
+	for (i = 0; i < num_slow; i++) {
+		duk__jit_patch_rel32(e, slow[i], e->len);
+	}
+	duk__jit_slowpath(e, ins, pc);
+	if (skip_check) {
+		duk__jit_u8(e, 0x85); duk__jit_u8(e, 0xc0);  /* test eax, eax */
+		duk__jit_jump_pc(e, DUK__JNZ, pc + 2);
+	}
+	if (inline_code) {
+		duk__jit_patch_rel32(e, done, e->len);
+	}
+	return 1;
+}
+
+/*
+ *  Compile a function.  Returns 0 if the function can't be compiled
+ *  (e.g. out of memory); the function is then never retried.
+ */
+
+duk_bool_t duk_js_jit_compile(duk_hthread *thr, duk_hcompiledfunction *fun) {
+	duk_heap *heap;
+	duk__jit_emitter e;
+	duk_jitcode *jit;
+	duk_uint32_t *pc_offsets = NULL;
+	duk_instr *bcode;
+	duk_uint32_t num_pcs;
+	duk_uint32_t pc;
+	duk_size_t buf_size;
+	void *code;
+	duk_uint32_t i;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(fun != NULL);
+	DUK_ASSERT(fun->jit != NULL);
+	DUK_ASSERT(fun->jit->code == NULL);
+
+	heap = thr->heap;
+	jit = fun->jit;
+	bcode = DUK_HCOMPILEDFUNCTION_GET_CODE_BASE(fun);
+	num_pcs = (duk_uint32_t) DUK_HCOMPILEDFUNCTION_GET_CODE_COUNT(fun);
+
+	/* The templates assume the unpacked 16-byte tval layout. */
+	if (sizeof(duk_tval) != 16 || num_pcs == 0 || num_pcs > DUK__JIT_MAX_PCS) {
+		DUK_D(DUK_DPRINT("jit: not compiling function %p (num_pcs=%d)", (void *) fun, (int) num_pcs));
+		return 0;
+	}
+
+	DUK_MEMZERO(&e, sizeof(e));
+	e.bcode = bcode;
+	e.num_pcs = num_pcs;
+	buf_size = DUK__JIT_PROLOGUE_SIZE + (duk_size_t) (num_pcs + 1) * DUK__JIT_MAX_INSTR_SIZE;
+	e.buf = (duk_uint8_t *) DUK_ALLOC_RAW(heap, buf_size);
+	e.fixup_offs = (duk_uint32_t *) DUK_ALLOC_RAW(heap, sizeof(duk_uint32_t) * 2 * num_pcs);
+	e.fixup_pcs = (duk_uint32_t *) DUK_ALLOC_RAW(heap, sizeof(duk_uint32_t) * 2 * num_pcs);
+	pc_offsets = (duk_uint32_t *) DUK_ALLOC_RAW(heap, sizeof(duk_uint32_t) * num_pcs);
+	if (e.buf == NULL || e.fixup_offs == NULL || e.fixup_pcs == NULL || pc_offsets == NULL) {
+		goto fail;
+	}
+
+	/* prologue: save callee-saved registers (also aligns the stack for
+	 * calls) and jump to the entry instruction
+	 */
+	duk__jit_u8(&e, 0x53);                                              /* push rbx */
+	duk__jit_u8(&e, 0x41); duk__jit_u8(&e, 0x54);                       /* push r12 */
+	duk__jit_u8(&e, 0x41); duk__jit_u8(&e, 0x55);                       /* push r13 */
+	duk__jit_u8(&e, 0x48); duk__jit_u8(&e, 0x89); duk__jit_u8(&e, 0xfb);  /* mov rbx, rdi */
+	duk__jit_u8(&e, 0x49); duk__jit_u8(&e, 0x89); duk__jit_u8(&e, 0xd5);  /* mov r13, rdx */
+	duk__jit_mem(&e, 0, 1, 0x8b, DUK__R12, DUK__RBX, (duk_int32_t) offsetof(duk_hthread, valstack_bottom));
+	duk__jit_u8(&e, 0xff); duk__jit_u8(&e, 0xe6);                       /* jmp rsi */
+
+	/* epilogue: return value (next pc) is in eax */
+	e.epilogue = e.len;
+	duk__jit_u8(&e, 0x41); duk__jit_u8(&e, 0x5d);                       /* pop r13 */
+	duk__jit_u8(&e, 0x41); duk__jit_u8(&e, 0x5c);                       /* pop r12 */
+	duk__jit_u8(&e, 0x5b);                                              /* pop rbx */
+	duk__jit_u8(&e, 0xc3);                                              /* ret */
+	DUK_ASSERT(e.len <= DUK__JIT_PROLOGUE_SIZE);
+
+	for (pc = 0; pc < num_pcs; pc++) {
+		duk_size_t start = e.len;
+
+		pc_offsets[pc] = (duk_uint32_t) e.len;
+		if (!duk__jit_emit_instr(&e, bcode[pc], pc)) {
+			DUK_D(DUK_DPRINT("jit: cannot compile instruction at pc %d of function %p", (int) pc, (void *) fun));
+			goto fail;
+		}
+		DUK_ASSERT(e.len - start <= DUK__JIT_MAX_INSTR_SIZE);
+		DUK_UNREF(start);
+	}
+	duk__jit_exit(&e, num_pcs);  /* not reached: bytecode always ends in a RETURN */
+
+	for (i = 0; i < e.num_fixups; i++) {
+		duk__jit_patch_rel32(&e, e.fixup_offs[i], pc_offsets[e.fixup_pcs[i]]);
+	}
+
+	code = mmap(NULL, e.len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (code == MAP_FAILED) {
+		goto fail;
+	}
+	DUK_MEMCPY(code, (const void *) e.buf, e.len);
+	if (mprotect(code, e.len, PROT_READ | PROT_EXEC) != 0) {
+		(void) munmap(code, e.len);
+		goto fail;
+	}
+
+	jit->code = (duk_uint8_t *) code;
+	jit->code_size = e.len;
+	jit->num_pcs = num_pcs;
+	jit->pc_offsets = pc_offsets;
+
+	DUK_D(DUK_DPRINT("jit: compiled function %p, %d instructions -> %d bytes of code",
+	                 (void *) fun, (int) num_pcs, (int) e.len));
+
+	DUK_FREE_RAW(heap, e.buf);
+	DUK_FREE_RAW(heap, e.fixup_offs);
+	DUK_FREE_RAW(heap, e.fixup_pcs);
+	return 1;
+
+ fail:
+	DUK_FREE_RAW(heap, e.buf);
+	DUK_FREE_RAW(heap, e.fixup_offs);
+	DUK_FREE_RAW(heap, e.fixup_pcs);
+	DUK_FREE_RAW(heap, pc_offsets);
+	return 0;
+}
+
+/*
+ *  Run compiled code of the current activation from 'act->pc' until the
+ *  next instruction which needs to be interpreted, and update 'act->pc'.
+ */
+
+void duk_js_jit_run(duk_hthread *thr, duk_hcompiledfunction *fun) {
+	duk_jitcode *jit;
+	duk_activation *act;
+	duk__jit_func func;
+	duk_int_t pc;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(fun != NULL);
+	DUK_ASSERT(fun->jit != NULL);
+	DUK_ASSERT(fun->jit->code != NULL);
+	DUK_ASSERT(fun->jit->num_pcs == (duk_uint32_t) DUK_HCOMPILEDFUNCTION_GET_CODE_COUNT(fun));
+	DUK_ASSERT(thr->callstack_top >= 1);
+
+	jit = fun->jit;
+	act = thr->callstack + thr->callstack_top - 1;
+	DUK_ASSERT(act->func == (duk_hobject *) fun);
+	pc = act->pc;
+	DUK_ASSERT(pc >= 0 && (duk_uint32_t) pc < jit->num_pcs);
+
+	DUK_MEMCPY((void *) &func, (const void *) &jit->code, sizeof(func));
+	pc = func(thr, (void *) (jit->code + jit->pc_offsets[pc]), DUK_HCOMPILEDFUNCTION_GET_CONSTS_BASE(fun));
+
+	/* callstack may have been resized by the slow path */
+	act = thr->callstack + thr->callstack_top - 1;
+	act->pc = pc;
+	DUK_DDD(DUK_DDDPRINT("jit: returning to interpreter at pc %d", (int) pc));
+}
+
+/*
+ *  Shared JIT state management.  The state is allocated on demand and
+ *  referenced by the template and every closure created of it (see
+ *  duk_js_push_closure()); it is freed with the last function referring
+ *  to it.  Allocation failure is not an error: the function is then
+ *  simply interpreted.
+ */
+
+duk_jitcode *duk_js_jit_get_state(duk_heap *heap, duk_hcompiledfunction *fun) {
+	duk_jitcode *jit;
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(fun != NULL);
+
+	jit = fun->jit;
+	if (jit == NULL) {
+		jit = (duk_jitcode *) DUK_ALLOC_RAW(heap, sizeof(duk_jitcode));
+		if (jit == NULL) {
+			return NULL;
+		}
+		DUK_MEMZERO(jit, sizeof(duk_jitcode));
+#ifdef DUK_USE_EXPLICIT_NULL_INIT
+		jit->code = NULL;
+		jit->pc_offsets = NULL;
+#endif
+		jit->refcount = 1;
+		fun->jit = jit;
+	}
+	return jit;
+}
+
+void duk_js_jit_release(duk_heap *heap, duk_jitcode *jit) {
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(jit != NULL);
+	DUK_ASSERT(jit->refcount > 0);
+
+	if (--jit->refcount > 0) {
+		return;
+	}
+	if (jit->code != NULL) {
+		(void) munmap((void *) jit->code, jit->code_size);
+	}
+	DUK_FREE_RAW(heap, jit->pc_offsets);
+	DUK_FREE_RAW(heap, jit);
+}
+
+#endif  /* DUK_USE_JIT */
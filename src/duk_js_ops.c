@@ -74,7 +74,8 @@ int duk_js_toboolean(duk_tval *tv) {
 		DUK_ASSERT(h != NULL);
 		return (h->blen > 0 ? 1 : 0);
 	}
-	case DUK_TAG_OBJECT: {
+	case DUK_TAG_OBJECT:
+	case DUK_TAG_LIGHTFUNC: {
 		return 1;
 	}
 	case DUK_TAG_BUFFER: {
@@ -91,6 +92,11 @@ int duk_js_toboolean(duk_tval *tv) {
 		/* number */
 		int c;
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
+#if defined(DUK_USE_FASTINT)
+		if (DUK_TVAL_IS_FASTINT(tv)) {
+			return (DUK_TVAL_GET_FASTINT(tv) != 0 ? 1 : 0);
+		}
+#endif
 		c = DUK_FPCLASSIFY(DUK_TVAL_GET_NUMBER(tv));
 		if (c == DUK_FP_ZERO || c == DUK_FP_NAN) {
 			return 0;
@@ -187,9 +193,11 @@ double duk_js_tonumber(duk_hthread *thr, duk_tval *tv) {
 		duk_push_hstring(ctx, h);
 		return duk__tonumber_string_raw(thr);
 	}
-	case DUK_TAG_OBJECT: {
+	case DUK_TAG_OBJECT:
+	case DUK_TAG_LIGHTFUNC: {
 		/* Note: ToPrimitive(object,hint) == [[DefaultValue]](object,hint),
-		 * so use [[DefaultValue]] directly.
+		 * so use [[DefaultValue]] directly.  Lightfuncs are coerced like
+		 * function objects.
 		 */
 		double d;
 		duk_push_tval(ctx, tv);
@@ -304,7 +312,15 @@ static double duk__toint32_touint32_helper(double x, int is_toint32) {
 }
 
 duk_int32_t duk_js_toint32(duk_hthread *thr, duk_tval *tv) {
-	double d = duk_js_tonumber(thr, tv);  /* invalidates tv */
+	double d;
+
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv)) {
+		return DUK_TVAL_GET_FASTINT(tv);
+	}
+#endif
+
+	d = duk_js_tonumber(thr, tv);  /* invalidates tv */
 	d = duk__toint32_touint32_helper(d, 1);
 	DUK_ASSERT(DUK_FPCLASSIFY(d) == DUK_FP_ZERO || DUK_FPCLASSIFY(d) == DUK_FP_NORMAL);
 	DUK_ASSERT(d >= -2147483648.0 && d <= 2147483647.0);  /* [-0x80000000,0x7fffffff] */
@@ -314,7 +330,15 @@ duk_int32_t duk_js_toint32(duk_hthread *thr, duk_tval *tv) {
 
 
 duk_uint32_t duk_js_touint32(duk_hthread *thr, duk_tval *tv) {
-	double d = duk_js_tonumber(thr, tv);  /* invalidates tv */
+	double d;
+
+#if defined(DUK_USE_FASTINT)
+	if (DUK_TVAL_IS_FASTINT(tv)) {
+		return ((duk_uint32_t) DUK_TVAL_GET_FASTINT(tv)) & 0xffffffffU;
+	}
+#endif
+
+	d = duk_js_tonumber(thr, tv);  /* invalidates tv */
 	d = duk__toint32_touint32_helper(d, 0);
 	DUK_ASSERT(DUK_FPCLASSIFY(d) == DUK_FP_ZERO || DUK_FPCLASSIFY(d) == DUK_FP_NORMAL);
 	DUK_ASSERT(d >= 0.0 && d <= 4294967295.0);  /* [0x00000000, 0xffffffff] */
@@ -519,6 +543,15 @@ int duk_js_equals_helper(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, duk_s
 	 *  representation, need the awkward if + switch.
 	 */
 
+#if defined(DUK_USE_FASTINT)
+	/* Fastints are never NaN or negative zero, so integer comparison
+	 * is correct for all of equals, strict equals, and SameValue.
+	 */
+	if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+		return (DUK_TVAL_GET_FASTINT(tv_x) == DUK_TVAL_GET_FASTINT(tv_y) ? 1 : 0);
+	}
+#endif
+
 	if (DUK_TVAL_IS_NUMBER(tv_x) && DUK_TVAL_IS_NUMBER(tv_y)) {
 		if (DUK_UNLIKELY((flags & DUK_EQUALS_FLAG_SAMEVALUE) != 0)) {
 			/* SameValue */
@@ -541,6 +574,11 @@ int duk_js_equals_helper(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, duk_s
 		case DUK_TAG_POINTER: {
 			return DUK_TVAL_GET_POINTER(tv_x) == DUK_TVAL_GET_POINTER(tv_y);
 		}
+		case DUK_TAG_LIGHTFUNC: {
+			/* function pointer and flags must both match */
+			return (DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv_x) == DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv_y) &&
+			        DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv_x) == DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv_y)) ? 1 : 0;
+		}
 		case DUK_TAG_STRING:
 		case DUK_TAG_OBJECT: {
 			/* heap pointer comparison suffices */
@@ -667,14 +705,16 @@ int duk_js_equals_helper(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, duk_s
 		return rc;
 	}
 
-	/* String-number-buffer/object -> coerce object to primitive (apparently without hint), then try again. */
+	/* String-number-buffer/object -> coerce object to primitive (apparently without hint), then try again.
+	 * Lightfuncs are coerced like objects.
+	 */
 	if ((DUK_TVAL_IS_STRING(tv_x) || DUK_TVAL_IS_NUMBER(tv_x) || DUK_TVAL_IS_BUFFER(tv_x)) &&
-	    DUK_TVAL_IS_OBJECT(tv_y)) {
+	    (DUK_TVAL_IS_OBJECT(tv_y) || DUK_TVAL_IS_LIGHTFUNC(tv_y))) {
 		tv_tmp = tv_x;
 		tv_x = tv_y;
 		tv_y = tv_tmp;
 	}
-	if (DUK_TVAL_IS_OBJECT(tv_x) &&
+	if ((DUK_TVAL_IS_OBJECT(tv_x) || DUK_TVAL_IS_LIGHTFUNC(tv_x)) &&
 	    (DUK_TVAL_IS_STRING(tv_y) || DUK_TVAL_IS_NUMBER(tv_y) || DUK_TVAL_IS_BUFFER(tv_y))) {
 		int rc;
 		duk_push_tval(ctx, tv_x);
@@ -762,6 +802,19 @@ int duk_js_compare_helper(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, duk_
 	int rc;
 	int retval;
 
+#if defined(DUK_USE_FASTINT)
+	/* Fast path for fastints: no coercion and no NaN or zero sign
+	 * special cases.
+	 */
+	if (DUK_TVAL_IS_FASTINT(tv_x) && DUK_TVAL_IS_FASTINT(tv_y)) {
+		retval = (DUK_TVAL_GET_FASTINT(tv_x) < DUK_TVAL_GET_FASTINT(tv_y) ? 1 : 0);
+		if (flags & DUK_COMPARE_FLAG_NEGATE) {
+			retval ^= 1;
+		}
+		return retval;
+	}
+#endif
+
 	duk_push_tval(ctx, tv_x);
 	duk_push_tval(ctx, tv_y);
 
@@ -912,6 +965,17 @@ int duk_js_instanceof(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y) {
 
 	duk_push_tval(ctx, tv_x);
 	duk_push_tval(ctx, tv_y);
+
+	/* Lightfuncs are coerced to equivalent function objects: as an rval
+	 * the result is the same (no 'prototype' property), and as an lval
+	 * this gives Function.prototype as the internal prototype.
+	 */
+	if (duk_is_lightfunc(ctx, -1)) {
+		duk_to_object(ctx, -1);
+	}
+	if (duk_is_lightfunc(ctx, -2)) {
+		duk_to_object(ctx, -2);
+	}
 	func = duk_require_hobject(ctx, -1);
 
 	/*
@@ -1053,7 +1117,9 @@ int duk_js_in(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y) {
 
 	duk_push_tval(ctx, tv_x);
 	duk_push_tval(ctx, tv_y);
-	(void) duk_require_hobject(ctx, -1);  /* TypeError if rval not object */
+	(void) duk_check_type_mask(ctx, -1, DUK_TYPE_MASK_OBJECT |
+	                                    DUK_TYPE_MASK_LIGHTFUNC |
+	                                    DUK_TYPE_MASK_THROW);  /* TypeError if rval not object or lightfunc */
 	duk_to_string(ctx, -2);               /* coerce lval with ToString() */
 
 	retval = duk_hobject_hasprop(thr, duk_get_tval(ctx, -1), duk_get_tval(ctx, -2));
@@ -1117,6 +1183,10 @@ duk_hstring *duk_js_typeof(duk_hthread *thr, duk_tval *tv_x) {
 		idx = DUK_STRIDX_LC_BUFFER;
 		break;
 	}
+	case DUK_TAG_LIGHTFUNC: {
+		idx = DUK_STRIDX_LC_FUNCTION;
+		break;
+	}
 	default: {
 		/* number */
 		DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv_x));
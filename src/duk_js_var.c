@@ -96,6 +96,92 @@ static void duk__inc_data_inner_refcounts(duk_hthread *thr, duk_hcompiledfunctio
 	}
 }
 
+#if defined(DUK_USE_LAZY_COMPILE)
+/* Compile a lazily compiled closure before its first call.  Its function
+ * template is compiled in place (once, for all closures created from it)
+ * and the closure then switches over to the template's compiled data.
+ */
+void duk_js_compile_lazy_closure(duk_hthread *thr, duk_hcompiledfunction *fun_clos) {
+	duk_context *ctx = (duk_context *) thr;
+	duk_hcompiledfunction *fun_temp;
+	duk_hbuffer *old_data;
+	duk_tval *tv, *tv_end;
+	duk_uint32_t mask;
+
+	DUK_ASSERT(fun_clos != NULL);
+	DUK_ASSERT(DUK_HCOMPILEDFUNCTION_IS_LAZY(fun_clos));
+
+	duk_push_hobject(ctx, (duk_hobject *) fun_clos);
+	duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_TEMPLATE);  /* -> [ ... closure template ] */
+	fun_temp = (duk_hcompiledfunction *) duk_get_hobject(ctx, -1);
+	if (fun_temp == NULL || !DUK_HOBJECT_IS_COMPILEDFUNCTION((duk_hobject *) fun_temp)) {
+		DUK_ERROR(thr, DUK_ERR_INTERNAL_ERROR, "invalid lazy function");
+	}
+
+	if (DUK_HCOMPILEDFUNCTION_IS_LAZY(fun_temp)) {
+		duk_js_compile_lazy(thr, fun_temp);  /* may throw */
+	}
+	DUK_ASSERT(!DUK_HCOMPILEDFUNCTION_IS_LAZY(fun_temp));
+
+	if (DUK_HCOMPILEDFUNCTION_IS_LAZY(fun_clos)) {
+		/* Not already done by a side effect of the compilation (a
+		 * finalizer calling the same closure).
+		 */
+		old_data = fun_clos->data;
+
+		fun_clos->data = fun_temp->data;
+		fun_clos->funcs = fun_temp->funcs;
+		fun_clos->bytecode = fun_temp->bytecode;
+		DUK_HBUFFER_INCREF(thr, fun_clos->data);
+		duk__inc_data_inner_refcounts(thr, fun_temp);
+
+		fun_clos->nregs = fun_temp->nregs;
+		fun_clos->nargs = fun_temp->nargs;
+
+		/* The lazy data only contains strings and numbers so releasing
+		 * it has no side effects.
+		 */
+		tv = (duk_tval *) DUK_HBUFFER_FIXED_GET_DATA_PTR((duk_hbuffer_fixed *) old_data);
+		tv_end = tv + DUK_HCOMPILEDFUNCTION_LAZY_CONST_COUNT;
+		while (tv < tv_end) {
+			DUK_ASSERT(DUK_TVAL_IS_STRING(tv) || DUK_TVAL_IS_NUMBER(tv));
+			DUK_TVAL_DECREF(thr, tv);
+			tv++;
+		}
+		DUK_HBUFFER_DECREF(thr, old_data);
+
+		/* The flags were computed from the pre-parse when the closure
+		 * was created; the environment setup they controlled is done.
+		 */
+		mask = DUK_HOBJECT_FLAG_STRICT | DUK_HOBJECT_FLAG_NOTAIL | DUK_HOBJECT_FLAG_CREATEARGS;
+		DUK_ASSERT((DUK_HEAPHDR_GET_FLAGS(&fun_clos->obj.hdr) & mask) ==
+		           (DUK_HEAPHDR_GET_FLAGS(&fun_temp->obj.hdr) & mask));
+		DUK_HEAPHDR_CLEAR_FLAG_BITS(&fun_clos->obj.hdr, mask);
+		DUK_HEAPHDR_SET_FLAG_BITS(&fun_clos->obj.hdr, DUK_HEAPHDR_GET_FLAGS(&fun_temp->obj.hdr) & mask);
+
+		if (duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_VARMAP)) {
+			duk_def_prop_stridx(ctx, -3, DUK_STRIDX_INT_VARMAP, DUK_PROPDESC_FLAGS_WC);
+		} else {
+			duk_pop(ctx);
+		}
+#if defined(DUK_USE_PC2LINE)
+		if (duk_get_prop_stridx(ctx, -1, DUK_STRIDX_INT_PC2LINE)) {
+			duk_def_prop_stridx(ctx, -3, DUK_STRIDX_INT_PC2LINE, DUK_PROPDESC_FLAGS_WC);
+		} else {
+			duk_pop(ctx);
+		}
+#endif
+		/* fails quietly if the closure has been frozen */
+		(void) duk_hobject_delprop_raw(thr, (duk_hobject *) fun_clos, DUK_HTHREAD_STRING_INT_TEMPLATE(thr), 0);
+		duk_compact(ctx, -2);
+	}
+
+	duk_pop_2(ctx);
+
+	DUK_DDD(DUK_DDDPRINT("lazily compiled closure: %!O", (duk_hobject *) fun_clos));
+}
+#endif  /* DUK_USE_LAZY_COMPILE */
+
 /* Push a new closure on the stack.
  *
  * Note: if fun_temp has NEWENV, i.e. a new lexical and variable
@@ -155,6 +241,15 @@ void duk_js_push_closure(duk_hthread *thr,
 	fun_clos->nregs = fun_temp->nregs;
 	fun_clos->nargs = fun_temp->nargs;
 
+#if defined(DUK_USE_JIT)
+	/* Same bytecode, so share the hotness counter and compiled code. */
+	DUK_ASSERT(fun_clos->jit == NULL);
+	fun_clos->jit = duk_js_jit_get_state(thr->heap, fun_temp);
+	if (fun_clos->jit != NULL) {
+		fun_clos->jit->refcount++;
+	}
+#endif
+
 	DUK_ASSERT(fun_clos->data != NULL);
 	DUK_ASSERT(fun_clos->funcs != NULL);
 	DUK_ASSERT(fun_clos->bytecode != NULL);
@@ -185,6 +280,7 @@ void duk_js_push_closure(duk_hthread *thr,
 	}
 	/* DUK_HOBJECT_FLAG_NEWENV: handled below */
 	DUK_ASSERT(!DUK_HOBJECT_HAS_NAMEBINDING(&fun_clos->obj));
+	DUK_ASSERT(!DUK_HOBJECT_HAS_NOCAPTURE(&fun_clos->obj));
 	if (DUK_HOBJECT_HAS_CREATEARGS(&fun_temp->obj)) {
 		DUK_HOBJECT_SET_CREATEARGS(&fun_clos->obj);
 	}
@@ -317,6 +413,17 @@ void duk_js_push_closure(duk_hthread *thr,
 		}
 	}
 
+#if defined(DUK_USE_LAZY_COMPILE)
+	/* A closure of a function template which hasn't been compiled yet
+	 * shares the template's lazy data and refers to the template, which
+	 * is compiled on the first call, see duk_js_compile_lazy_closure().
+	 */
+	if (DUK_HCOMPILEDFUNCTION_IS_LAZY(fun_temp)) {
+		duk_dup(ctx, -1);
+		duk_def_prop_stridx(ctx, -3, DUK_STRIDX_INT_TEMPLATE, DUK_PROPDESC_FLAGS_C);
+	}
+#endif
+
 	/*
 	 *  "length" maps to number of formals (E5 Section 13.2) for
 	 *  function declarations/expressions (non-bound functions).
@@ -462,12 +569,10 @@ void duk_js_push_closure(duk_hthread *thr,
  */
 
 /* shared helper */
-duk_hobject *duk_create_activation_environment_record(duk_hthread *thr,
-                                                      duk_hobject *func,
-                                                      duk_uint32_t idx_bottom) {
-	duk_context *ctx = (duk_context *) thr;
-	duk_hobject *env;
-	duk_hobject *parent;
+/* Get the environment record a function's own environment record would
+ * be parented to (the scope the function was created in).
+ */
+duk_hobject *duk_js_get_outer_lex_env(duk_hthread *thr, duk_hobject *func) {
 	duk_tval *tv;
 
 	DUK_ASSERT(thr != NULL);
@@ -477,10 +582,23 @@ duk_hobject *duk_create_activation_environment_record(duk_hthread *thr,
 	if (tv) {
 		DUK_ASSERT(DUK_TVAL_IS_OBJECT(tv));
 		DUK_ASSERT(DUK_HOBJECT_IS_ENV(DUK_TVAL_GET_OBJECT(tv)));
-		parent = DUK_TVAL_GET_OBJECT(tv);
+		return DUK_TVAL_GET_OBJECT(tv);
 	} else {
-		parent = thr->builtins[DUK_BIDX_GLOBAL_ENV];
+		return thr->builtins[DUK_BIDX_GLOBAL_ENV];
 	}
+}
+
+duk_hobject *duk_create_activation_environment_record(duk_hthread *thr,
+                                                      duk_hobject *func,
+                                                      duk_uint32_t idx_bottom) {
+	duk_context *ctx = (duk_context *) thr;
+	duk_hobject *env;
+	duk_hobject *parent;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(func != NULL);
+
+	parent = duk_js_get_outer_lex_env(thr, func);
 
 	(void) duk_push_object_helper(ctx,
 	                              DUK_HOBJECT_FLAG_EXTENSIBLE |
@@ -525,6 +643,14 @@ void duk_js_init_activation_environment_records_delayed(duk_hthread *thr,
 	env = duk_create_activation_environment_record(thr, func, act->idx_bottom);
 	DUK_ASSERT(env != NULL);
 
+	if (act->flags & DUK_ACT_FLAG_DELAYED_ARGS) {
+		int idx_bottom = act->idx_bottom;
+		int num_args = DUK_ACT_GET_DELAYED_ARGS(act);
+
+		act->flags &= ~(DUK_ACT_FLAG_DELAYED_ARGS | (DUK_ACT_DELAYED_ARGS_MAX << DUK_ACT_DELAYED_ARGS_SHIFT));
+		duk_create_delayed_arguments_object(thr, func, env, idx_bottom, num_args);
+	}
+
 	DUK_DDD(DUK_DDDPRINT("created delayed fresh env: %!ipO", env));
 #ifdef DUK_USE_DDDPRINT
 	{
@@ -816,7 +942,10 @@ static int duk__getid_activation_regs(duk_hthread *thr,
 	DUK_ASSERT(out != NULL);
 
 	func = act->func;
-	DUK_ASSERT(func != NULL);
+	if (func == NULL) {
+		/* lightfunc, no register bindings */
+		return 0;
+	}
 	DUK_ASSERT(DUK_HOBJECT_HAS_NEWENV(func));
 
 	if (!DUK_HOBJECT_IS_COMPILEDFUNCTION(func)) {
@@ -908,6 +1037,20 @@ static int duk__get_identifier_reference(duk_hthread *thr,
 
 		DUK_DDD(DUK_DDDPRINT("not found in current activation regs"));
 
+		/*
+		 *  A delayed 'arguments' binding lives in the activation's own
+		 *  environment record, so create the record (and the arguments
+		 *  object) now and look up from there.
+		 */
+
+		if ((act->flags & DUK_ACT_FLAG_DELAYED_ARGS) && name == DUK_HTHREAD_STRING_LC_ARGUMENTS(thr)) {
+			DUK_DDD(DUK_DDDPRINT("'arguments' lookup with delayed arguments object, create env"));
+			duk_js_init_activation_environment_records_delayed(thr, act);
+			env = act->lex_env;
+			DUK_ASSERT(env != NULL);
+			goto walk;
+		}
+
 		/*
 		 *  Not found in registers, proceed to the parent record.
 		 *  Here we need to determine what the parent would be,
@@ -930,15 +1073,15 @@ static int duk__get_identifier_reference(duk_hthread *thr,
 		}
 
 		func = act->func;
-		DUK_ASSERT(func != NULL);
-		DUK_ASSERT(DUK_HOBJECT_HAS_NEWENV(func));
+		DUK_ASSERT(func == NULL || DUK_HOBJECT_HAS_NEWENV(func));
 
-		tv = duk_hobject_find_existing_entry_tval_ptr(func, DUK_HTHREAD_STRING_INT_LEXENV(thr));
+		/* lightfuncs have no _lexenv, so they use the global environment */
+		tv = (func != NULL ? duk_hobject_find_existing_entry_tval_ptr(func, DUK_HTHREAD_STRING_INT_LEXENV(thr)) : NULL);
 		if (tv) {
 			DUK_ASSERT(DUK_TVAL_IS_OBJECT(tv));
 			env = DUK_TVAL_GET_OBJECT(tv);
 		} else {
-			DUK_ASSERT(duk_hobject_find_existing_entry_tval_ptr(func, DUK_HTHREAD_STRING_INT_VARENV(thr)) == NULL);
+			DUK_ASSERT(func == NULL || duk_hobject_find_existing_entry_tval_ptr(func, DUK_HTHREAD_STRING_INT_VARENV(thr)) == NULL);
 			env = thr->builtins[DUK_BIDX_GLOBAL_ENV];
 		}
 
@@ -951,6 +1094,7 @@ static int duk__get_identifier_reference(duk_hthread *thr,
 	 *  ('act' is not needed anywhere here.)
 	 */
 
+ walk:
 	sanity = DUK_HOBJECT_PROTOTYPE_CHAIN_SANITY;
 	while (env != NULL) {
 		duk_tval *tv;
@@ -1359,6 +1503,95 @@ void duk_js_putvar_activation(duk_hthread *thr,
 	duk__putvar_helper(thr, act->lex_env, act, name, val, strict);
 }
 
+/*
+ *  GETVAR/PUTVAR inline cache fast path for global variables
+ *
+ *  Identifiers which are not bound before the global environment record
+ *  resolve to properties of the global object.  For these, the bytecode
+ *  executor uses the inline cache entries of the GETVAR/PUTVAR/CSVAR
+ *  instruction to access the global object property directly, see
+ *  duk_hobject_getprop_ic().
+ *
+ *  The scope chain is still checked on every use, but only declarative
+ *  records are accepted (any object environment record other than the
+ *  global one, i.e. a 'with' statement, means the generic path is used).
+ *  Together with the validated cache entries this means that declaring,
+ *  deleting or redefining globals, and shadowing them in a declarative
+ *  record (e.g. by a direct eval), never require explicit invalidation.
+ *
+ *  NULL is returned whenever the generic path is needed.  The returned
+ *  pointer is valid until the next side effect.
+ */
+
+#if defined(DUK_USE_PROPERTY_IC)
+static duk_hobject *duk__getid_global_target(duk_hthread *thr,
+                                             duk_activation *act,
+                                             duk_hstring *name) {
+	duk_hobject *env;
+	duk_hobject *global_env;
+	duk__id_lookup_result ref;
+	duk_tval *tv;
+	duk_uint32_t sanity;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(act != NULL);
+	DUK_ASSERT(name != NULL);
+
+	global_env = thr->builtins[DUK_BIDX_GLOBAL_ENV];
+	env = act->lex_env;
+	if (env == NULL) {
+		/* delayed env case, see duk__get_identifier_reference() */
+		if (name == DUK_HTHREAD_STRING_LC_ARGUMENTS(thr) ||
+		    duk__getid_activation_regs(thr, name, act, &ref)) {
+			return NULL;
+		}
+		env = (act->func != NULL ? duk_js_get_outer_lex_env(thr, act->func) : global_env);
+	}
+
+	sanity = DUK_HOBJECT_PROTOTYPE_CHAIN_SANITY;
+	while (env != global_env) {
+		if (env == NULL ||
+		    DUK_HOBJECT_GET_CLASS_NUMBER(env) != DUK_HOBJECT_CLASS_DECENV ||
+		    sanity-- == 0) {
+			return NULL;
+		}
+		if (!DUK_HOBJECT_HAS_ENVRECCLOSED(env) &&
+		    duk__getid_open_decl_env_regs(thr, name, env, &ref)) {
+			return NULL;
+		}
+		if (duk_hobject_find_existing_entry_tval_ptr(env, name) != NULL) {
+			return NULL;
+		}
+		env = env->prototype;
+	}
+
+	tv = duk_hobject_find_existing_entry_tval_ptr(env, DUK_HTHREAD_STRING_INT_TARGET(thr));
+	DUK_ASSERT(tv != NULL);
+	DUK_ASSERT(DUK_TVAL_IS_OBJECT(tv));
+	return DUK_TVAL_GET_OBJECT(tv);
+}
+
+duk_tval *duk_js_getvar_ic(duk_hthread *thr, duk_activation *act, duk_hstring *name, duk_uint16_t *ic) {
+	duk_hobject *target;
+
+	target = duk__getid_global_target(thr, act, name);
+	if (target == NULL) {
+		return NULL;
+	}
+	return duk_hobject_getprop_ic(thr, target, name, ic);
+}
+
+duk_tval *duk_js_putvar_ic(duk_hthread *thr, duk_activation *act, duk_hstring *name, duk_uint16_t *ic) {
+	duk_hobject *target;
+
+	target = duk__getid_global_target(thr, act, name);
+	if (target == NULL) {
+		return NULL;
+	}
+	return duk_hobject_putprop_ic(thr, target, name, ic);
+}
+#endif  /* DUK_USE_PROPERTY_IC */
+
 /*
  *  DELVAR
  *
@@ -1654,7 +1887,7 @@ static int duk__declvar_helper(duk_hthread *thr,
 			tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(holder, e_idx);
 			DUK_TVAL_SET_TVAL(tv, tv_val);
 			DUK_TVAL_INCREF(thr, tv);
-			DUK_HOBJECT_E_SET_FLAGS(holder, e_idx, prop_flags);
+			DUK_HOBJECT_E_UPDATE_FLAGS(thr, holder, e_idx, prop_flags);
 
 			DUK_DDD(DUK_DDDPRINT("updated global binding, final result: "
 			                     "value -> %!T, prop_flags=0x%08x",
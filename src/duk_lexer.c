@@ -13,7 +13,11 @@
  *  input filled with an invalid codepoint (-1).  The tokenizer can thus
  *  perform multiple character lookups efficiently and with few sanity
  *  checks (such as access outside the end of the input), which keeps the
- *  tokenization code small at the cost of performance.
+ *  tokenization code small.  The window slides over a larger buffer of
+ *  decoded characters so that advancing is cheap.  The most common tokens
+ *  (identifiers, simple string and integer literals, comments) are also
+ *  scanned directly from the input bytes when they are plain ASCII, see
+ *  the ASCII fast paths below.
  * 
  *  Character data in tokens (such as identifier names and string literals)
  *  is encoded into CESU-8 format on-the-fly while parsing the token in
@@ -41,19 +45,9 @@
  *
  *  Future work:
  *
- *    * Make the input window a circular array to avoid copying.  This would
- *      not necessarily complicate the tokenizer much, although it would make
- *      the window fetches more expensive (one AND).
- *
  *    * Make line number tracking optional, as it consumes space.  Also, is
  *      tracking end line really useful for tokens?
  *
- *    * Add a feature flag for disabling UTF-8 decoding of input, as most
- *      source code is ASCII.  Because of Unicode escapes written in ASCII,
- *      this does not allow Unicode support to be removed from e.g.
- *      duk_unicode_is_identifier_start() nor does it allow removal of CESU-8
- *      encoding of e.g. string literals.
- *
  *    * Add a feature flag for disabling Unicode compliance of e.g. identifier
  *      names.  This allows for a build more than a kilobyte smaller, because
  *      Unicode ranges needed by duk_unicode_is_identifier_start() and
@@ -83,7 +77,7 @@
 #define DUK__MAX_RE_DECESC_DIGITS     9
 #define DUK__MAX_RE_QUANT_DIGITS      9   /* Does not allow e.g. 2**31-1, but one more would allow overflows of u32. */
 
-#define DUK__LOOKUP(lex_ctx,index)    ((lex_ctx)->window[(index)])
+#define DUK__LOOKUP(lex_ctx,index)    ((lex_ctx)->window[(index)].codepoint)
 #define DUK__ADVANCE(lex_ctx,count)   duk__advance_chars((lex_ctx), (count))
 #define DUK__INITBUFFER(lex_ctx)      duk__initbuffer((lex_ctx))
 #define DUK__APPENDBUFFER(lex_ctx,x)  duk__appendbuffer((lex_ctx), (int) (x))
@@ -287,37 +281,131 @@ static int duk__read_char(duk_lexer_ctx *lex_ctx) {
 }
 
 /*
- *  Advance lookup window by N characters.  Also used to fill the window
- *  after position is changed (call with count == DUK_LEXER_WINDOW_SIZE).
+ *  Refill the decoded character buffer.  The current window is moved to the
+ *  start of the buffer (one memmove per DUK_LEXER_BUFFER_SIZE characters
+ *  instead of shifting the window on every advance) and more characters
+ *  are decoded after it.
  *
- *  Future work:
- *
- *    * A lot of copying now, perhaps change to circular array or at
- *      least use memcpy().  For memcpy(), putting all elements of the
- *      window (code point, offset, line) into a struct would allow one
- *      memcpy() to slide the window, instead of three separate copys.
+ *  ASCII input is decoded directly in bulk, with inline line tracking.
+ *  Other characters are decoded with duk__read_char(), but only as far as
+ *  needed to fill the lookup window, so that a decoding error is thrown at
+ *  the same point as when decoding characters one at a time.  Positions
+ *  past the end of input also go through duk__read_char() and decode as -1.
  */
 
-static void duk__advance_chars(duk_lexer_ctx *lex_ctx, int count) {
-	int i;
+static void duk__fill_buffer(duk_lexer_ctx *lex_ctx) {
+	duk_lexer_codepoint *cp;
+	duk_lexer_codepoint *cp_end;
+	duk_lexer_codepoint *cp_min;
+	duk_uint8_t *p;
+	duk_uint8_t *p_end;
+	int line;
+	int x;
 
-	DUK_ASSERT(count >= 0 && count <= DUK_LEXER_WINDOW_SIZE);
+	DUK_ASSERT(lex_ctx->window >= lex_ctx->buffer);
+	DUK_ASSERT(lex_ctx->buffer_end >= lex_ctx->window);
 
-	if (count == 0) {
-		/* allowing zero count makes some special caller flows easier */
-		return;
+	if (lex_ctx->window != lex_ctx->buffer) {
+		DUK_MEMMOVE((void *) lex_ctx->buffer,
+		            (void *) lex_ctx->window,
+		            (size_t) (lex_ctx->buffer_end - lex_ctx->window) * sizeof(duk_lexer_codepoint));
+		lex_ctx->buffer_end = lex_ctx->buffer + (lex_ctx->buffer_end - lex_ctx->window);
+		lex_ctx->window = lex_ctx->buffer;
 	}
 
-	for (i = 0; i < DUK_LEXER_WINDOW_SIZE - count; i++) {
-		lex_ctx->offsets[i] = lex_ctx->offsets[i + count];
-		lex_ctx->lines[i] = lex_ctx->lines[i + count];
-		lex_ctx->window[i] = lex_ctx->window[i + count];
+	cp = lex_ctx->buffer_end;
+	cp_end = lex_ctx->buffer + DUK_LEXER_BUFFER_SIZE;
+	cp_min = lex_ctx->buffer + DUK_LEXER_WINDOW_SIZE;
+
+	if (DUK_UNLIKELY(lex_ctx->input_offset < 0)) {
+		/* Never happens in practice, let duk__read_char() deal with it. */
+		p = NULL;
+		p_end = NULL;
+	} else {
+		p = lex_ctx->input + lex_ctx->input_offset;
+		p_end = lex_ctx->input + lex_ctx->input_length;
+	}
+	line = lex_ctx->input_line;
+
+	while (cp < cp_end) {
+		if (p < p_end && (x = (int) *p) < 0x80) {
+			cp->codepoint = x;
+			cp->offset = (int) (p - lex_ctx->input);
+			cp->line = line;
+			p++;
+
+			/* same line tracking as in duk__read_char() */
+			if (x == 0x000a || (x == 0x000d && (p >= p_end || *p != 0x000a))) {
+				line++;
+			}
+		} else if (cp < cp_min) {
+			if (p != NULL) {
+				lex_ctx->input_offset = (int) (p - lex_ctx->input);
+			}
+			lex_ctx->input_line = line;
+			cp->offset = lex_ctx->input_offset;
+			cp->line = line;
+			cp->codepoint = duk__read_char(lex_ctx);
+			if (p != NULL) {
+				p = lex_ctx->input + lex_ctx->input_offset;
+			}
+			line = lex_ctx->input_line;
+		} else {
+			break;
+		}
+		cp++;
 	}
 
-	for (; i < DUK_LEXER_WINDOW_SIZE; i++) {
-		lex_ctx->offsets[i] = lex_ctx->input_offset;
-		lex_ctx->lines[i] = lex_ctx->input_line;
-		lex_ctx->window[i] = duk__read_char(lex_ctx);
+	if (p != NULL) {
+		lex_ctx->input_offset = (int) (p - lex_ctx->input);
+	}
+	lex_ctx->input_line = line;
+	lex_ctx->buffer_end = cp;
+
+	DUK_ASSERT(lex_ctx->buffer_end - lex_ctx->window >= DUK_LEXER_WINDOW_SIZE);
+}
+
+/*
+ *  Advance lookup window by N characters.  The window only needs to be
+ *  moved inside the decoded character buffer, which is refilled when the
+ *  window reaches its end.
+ */
+
+static void duk__advance_chars(duk_lexer_ctx *lex_ctx, int count) {
+	DUK_ASSERT(count >= 0 && count <= DUK_LEXER_WINDOW_SIZE);
+
+	lex_ctx->window += count;
+	if (lex_ctx->window + DUK_LEXER_WINDOW_SIZE > lex_ctx->buffer_end) {
+		duk__fill_buffer(lex_ctx);
+	}
+}
+
+/*
+ *  Advance lookup window to a certain input offset, after a fast path has
+ *  scanned input bytes directly.  If the character at the offset has already
+ *  been decoded, the window is just moved; otherwise decoding restarts from
+ *  the offset, with 'line' as the line number.
+ */
+
+static void duk__advance_to_offset(duk_lexer_ctx *lex_ctx, duk_int_t offset, int line) {
+	duk_int_t n;
+
+	n = offset - lex_ctx->window[0].offset;
+	DUK_ASSERT(n >= 0);
+
+	if (n < (duk_int_t) (lex_ctx->buffer_end - lex_ctx->window) &&
+	    lex_ctx->window[n].offset == offset) {
+		DUK_ASSERT(lex_ctx->window[n].line == line);
+		lex_ctx->window += n;
+		if (lex_ctx->window + DUK_LEXER_WINDOW_SIZE > lex_ctx->buffer_end) {
+			duk__fill_buffer(lex_ctx);
+		}
+	} else {
+		lex_ctx->input_offset = offset;
+		lex_ctx->input_line = line;
+		lex_ctx->window = lex_ctx->buffer;
+		lex_ctx->buffer_end = lex_ctx->buffer;
+		duk__fill_buffer(lex_ctx);
 	}
 }
 
@@ -383,6 +471,8 @@ void duk_lexer_initctx(duk_lexer_ctx *lex_ctx) {
 #ifdef DUK_USE_EXPLICIT_NULL_INIT
 	lex_ctx->thr = NULL;
 	lex_ctx->input = NULL;
+	lex_ctx->window = NULL;
+	lex_ctx->buffer_end = NULL;
 	lex_ctx->buf = NULL;
 #endif
 }
@@ -398,7 +488,9 @@ void duk_lexer_setpoint(duk_lexer_ctx *lex_ctx, duk_lexer_point *pt) {
 	DUK_ASSERT(pt->line >= 1);
 	lex_ctx->input_offset = pt->offset;
 	lex_ctx->input_line = pt->line;
-	duk__advance_chars(lex_ctx, DUK_LEXER_WINDOW_SIZE);  /* fill window */
+	lex_ctx->window = lex_ctx->buffer;
+	lex_ctx->buffer_end = lex_ctx->buffer;
+	duk__fill_buffer(lex_ctx);  /* fill window */
 }
 
 /*
@@ -431,16 +523,16 @@ static int duk__is_hex_digit(int x) {
 
 static int duk__decode_hexesc_from_window(duk_lexer_ctx *lex_ctx, int lookup_offset) {
 	/* validation performed by duk__hexval */
-	return (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset]) << 4) |
-	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 1]));
+	return (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset].codepoint) << 4) |
+	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 1].codepoint));
 }
 
 static int duk__decode_uniesc_from_window(duk_lexer_ctx *lex_ctx, int lookup_offset) {
 	/* validation performed by duk__hexval */
-	return (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset]) << 12) |
-	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 1]) << 8) |
-	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 2]) << 4) |
-	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 3]));
+	return (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset].codepoint) << 12) |
+	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 1].codepoint) << 8) |
+	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 2].codepoint) << 4) |
+	       (duk__hexval(lex_ctx, lex_ctx->window[lookup_offset + 3].codepoint));
 }
 
 /*
@@ -448,12 +540,270 @@ static int duk__decode_uniesc_from_window(duk_lexer_ctx *lex_ctx, int lookup_off
  *  a white space (may be -1 if EOF encountered).
  */
 static void duk__eat_whitespace(duk_lexer_ctx *lex_ctx) {
+	int x;
+
 	/* guaranteed to finish, as EOF (-1) is not a whitespace */
-	while (duk_unicode_is_whitespace(DUK__LOOKUP(lex_ctx, 0))) {
+	for (;;) {
+		x = DUK__LOOKUP(lex_ctx, 0);
+		if (x == 0x20 || x == 0x09) {
+			;  /* common case, no need to call the full check */
+		} else if ((x > 0x20 && x < 0x80) || !duk_unicode_is_whitespace(x)) {
+			break;
+		}
 		DUK__ADVANCE(lex_ctx, 1);
 	}
 }
 
+/*
+ *  ASCII fast paths.
+ *
+ *  Ordinary source code is almost entirely ASCII, so the most common tokens
+ *  are scanned directly from the input bytes, starting from the window start:
+ *  identifiers and string literals are interned from the input without
+ *  going through the temporary buffer, simple integer literals are computed
+ *  without a numconv round trip, and comments are skipped without decoding.
+ *  The window is then moved to the end of the token.
+ *
+ *  A fast path gives up (or, for comments, stops) when it encounters a
+ *  non-ASCII byte, an escape, or anything else not handled, and the token
+ *  is then parsed using the decoded characters as usual.  The fast paths
+ *  thus don't affect the tokens produced, and all errors are thrown from
+ *  the ordinary code paths.
+ */
+
+#define DUK__ISIDPART_ASCII(x) \
+	(((x) >= 'a' && (x) <= 'z') || ((x) >= 'A' && (x) <= 'Z') || \
+	 ((x) >= '0' && (x) <= '9') || (x) == '_' || (x) == '$')
+
+/*
+ *  Find the first byte in [p,p_end[ which is one of 'c1' ... 'c4' or is
+ *  non-ASCII (>= 0x80); returns p_end if there is no such byte.
+ *
+ *  Comment and string literal bodies are typically long runs of bytes
+ *  needing no attention, so with DUK_USE_LEXER_BULK_SCAN they are skipped
+ *  several bytes at a time: 16 bytes per step with SSE2, otherwise one
+ *  machine word per step using the "has zero byte" trick (a byte of
+ *  'w ^ (c * 0x0101...)' is zero where the byte of 'w' equals 'c').  Both
+ *  block tests are exact, so the bytewise loop at the end only needs to
+ *  find the byte inside the block which matched, or handle the tail of
+ *  the input.
+ */
+
+#if defined(DUK_USE_LEXER_BULK_SCAN) && !defined(DUK_USE_LEXER_SSE2)
+#if defined(DUK_USE_64BIT_OPS)
+typedef duk_uint64_t duk__scan_word;
+#else
+typedef duk_uint32_t duk__scan_word;
+#endif
+#define DUK__SCAN_ONES           (((duk__scan_word) ~((duk__scan_word) 0)) / (duk__scan_word) 0xffU)
+#define DUK__SCAN_HIGHS          (DUK__SCAN_ONES << 7)
+#define DUK__SCAN_HASZERO(w)     (((w) - DUK__SCAN_ONES) & ~(w) & DUK__SCAN_HIGHS)
+#endif
+
+static duk_uint8_t *duk__scan_ascii_until(duk_uint8_t *p, duk_uint8_t *p_end, int c1, int c2, int c3, int c4) {
+	int x;
+#if defined(DUK_USE_LEXER_SSE2)
+	__m128i v1, v2, v3, v4;
+	__m128i w, m;
+
+	v1 = _mm_set1_epi8((char) c1);
+	v2 = _mm_set1_epi8((char) c2);
+	v3 = _mm_set1_epi8((char) c3);
+	v4 = _mm_set1_epi8((char) c4);
+	while (p_end - p >= 16) {
+		w = _mm_loadu_si128((const __m128i *) (const void *) p);
+		m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(w, v1), _mm_cmpeq_epi8(w, v2)),
+		                 _mm_or_si128(_mm_cmpeq_epi8(w, v3), _mm_cmpeq_epi8(w, v4)));
+
+		/* non-ASCII bytes have their high bit set in 'w' itself */
+		if (_mm_movemask_epi8(_mm_or_si128(m, w)) != 0) {
+			break;
+		}
+		p += 16;
+	}
+#elif defined(DUK_USE_LEXER_BULK_SCAN)
+	duk__scan_word m1, m2, m3, m4;
+	duk__scan_word w;
+
+	m1 = DUK__SCAN_ONES * (duk__scan_word) c1;
+	m2 = DUK__SCAN_ONES * (duk__scan_word) c2;
+	m3 = DUK__SCAN_ONES * (duk__scan_word) c3;
+	m4 = DUK__SCAN_ONES * (duk__scan_word) c4;
+	while ((duk_size_t) (p_end - p) >= sizeof(w)) {
+		/* memcpy() avoids alignment and aliasing issues, and is
+		 * compiled into a plain load where that is possible.
+		 */
+		DUK_MEMCPY((void *) &w, (const void *) p, sizeof(w));
+		if ((DUK__SCAN_HASZERO(w ^ m1) | DUK__SCAN_HASZERO(w ^ m2) |
+		     DUK__SCAN_HASZERO(w ^ m3) | DUK__SCAN_HASZERO(w ^ m4) |
+		     (w & DUK__SCAN_HIGHS)) != 0) {
+			break;
+		}
+		p += sizeof(w);
+	}
+#endif
+
+	while (p < p_end) {
+		x = (int) *p;
+		if (x == c1 || x == c2 || x == c3 || x == c4 || x >= 0x80) {
+			break;
+		}
+		p++;
+	}
+	return p;
+}
+
+/* Identifier or reserved word without escapes: intern into slot1. */
+static int duk__scan_ascii_identifier(duk_lexer_ctx *lex_ctx) {
+	duk_uint8_t *p_start;
+	duk_uint8_t *p;
+	duk_uint8_t *p_end;
+	int line;
+
+	DUK_ASSERT(DUK__ISIDPART_ASCII(DUK__LOOKUP(lex_ctx, 0)));
+
+	p_start = lex_ctx->input + lex_ctx->window[0].offset;
+	p_end = lex_ctx->input + lex_ctx->input_length;
+	line = lex_ctx->window[0].line;
+
+	p = p_start + 1;
+	while (p < p_end && DUK__ISIDPART_ASCII(*p)) {
+		p++;
+	}
+	if (p < p_end && (*p >= 0x80 || *p == '\\')) {
+		/* non-ASCII IdentifierPart or an escape may follow */
+		return 0;
+	}
+
+	duk_push_lstring((duk_context *) lex_ctx->thr, (const char *) p_start, (duk_size_t) (p - p_start));
+	duk_replace((duk_context *) lex_ctx->thr, lex_ctx->slot1_idx);
+
+	duk__advance_to_offset(lex_ctx, (duk_int_t) (p - lex_ctx->input), line);
+	return 1;
+}
+
+/* Decimal integer literal which is exactly representable (at most 15
+ * digits): compute value, coerce into slot1 like the numconv path.
+ */
+static int duk__scan_ascii_integer(duk_lexer_ctx *lex_ctx, double *out_val) {
+	duk_uint8_t *p_start;
+	duk_uint8_t *p;
+	duk_uint8_t *p_end;
+	int line;
+	double val;
+	int x;
+
+	DUK_ASSERT(DUK__ISDIGIT(DUK__LOOKUP(lex_ctx, 0)));
+
+	p_start = lex_ctx->input + lex_ctx->window[0].offset;
+	p_end = lex_ctx->input + lex_ctx->input_length;
+	line = lex_ctx->window[0].line;
+
+	val = 0.0;
+	p = p_start;
+	while (p < p_end && DUK__ISDIGIT(*p)) {
+		val = val * 10.0 + (double) (*p - '0');
+		p++;
+	}
+	if (p - p_start > 15 ||
+	    (*p_start == '0' && p - p_start > 1)) {
+		/* possibly inexact, or leading zero (octal or error) */
+		return 0;
+	}
+	if (p < p_end) {
+		x = *p;
+		if (x == '.' || x == 'e' || x == 'E' || x == 'x' || x == 'X') {
+			return 0;
+		}
+	}
+
+	duk_push_number((duk_context *) lex_ctx->thr, val);
+	duk_replace((duk_context *) lex_ctx->thr, lex_ctx->slot1_idx);
+
+	duk__advance_to_offset(lex_ctx, (duk_int_t) (p - lex_ctx->input), line);
+	*out_val = val;
+	return 1;
+}
+
+/* String literal without escapes or line terminators: intern into slot1. */
+static int duk__scan_ascii_string(duk_lexer_ctx *lex_ctx, int quote) {
+	duk_uint8_t *p_start;
+	duk_uint8_t *p;
+	duk_uint8_t *p_end;
+	int line;
+
+	DUK_ASSERT(DUK__LOOKUP(lex_ctx, 0) == quote);
+
+	p_start = lex_ctx->input + lex_ctx->window[0].offset + 1;
+	p_end = lex_ctx->input + lex_ctx->input_length;
+	line = lex_ctx->window[0].line;
+
+	p = duk__scan_ascii_until(p_start, p_end, quote, '\\', 0x0a, 0x0d);
+	if (p >= p_end || *p != quote) {
+		/* escape, line terminator, non-ASCII char, or EOF */
+		return 0;
+	}
+
+	duk_push_lstring((duk_context *) lex_ctx->thr, (const char *) p_start, (duk_size_t) (p - p_start));
+	duk_replace((duk_context *) lex_ctx->thr, lex_ctx->slot1_idx);
+
+	duk__advance_to_offset(lex_ctx, (duk_int_t) (p + 1 - lex_ctx->input), line);
+	return 1;
+}
+
+/* Single-line comment: skip ASCII chars up to a line terminator. */
+static void duk__skip_ascii_line_comment(duk_lexer_ctx *lex_ctx) {
+	duk_uint8_t *p;
+	duk_uint8_t *p_end;
+
+	p_end = lex_ctx->input + lex_ctx->input_length;
+	p = duk__scan_ascii_until(lex_ctx->input + lex_ctx->window[0].offset, p_end,
+	                          0x0a, 0x0d, 0x0d, 0x0d);
+
+	duk__advance_to_offset(lex_ctx, (duk_int_t) (p - lex_ctx->input), lex_ctx->window[0].line);
+}
+
+/* Multi-line comment body: skip ASCII chars, tracking line terminators.
+ * Returns 1 if the comment end was reached (and skipped).
+ */
+static int duk__skip_ascii_block_comment(duk_lexer_ctx *lex_ctx, int *out_lineterm) {
+	duk_uint8_t *p;
+	duk_uint8_t *p_end;
+	int line;
+	int x;
+	int found = 0;
+
+	p = lex_ctx->input + lex_ctx->window[0].offset;
+	p_end = lex_ctx->input + lex_ctx->input_length;
+	line = lex_ctx->window[0].line;
+
+	for (;;) {
+		p = duk__scan_ascii_until(p, p_end, '*', 0x0a, 0x0d, 0x0d);
+		if (p >= p_end) {
+			break;
+		}
+		x = *p;
+		if (x >= 0x80) {
+			break;
+		}
+		p++;
+		if (x == '*' && p < p_end && *p == '/') {
+			p++;
+			found = 1;
+			break;
+		}
+		if (x == 0x0a || (x == 0x0d && (p >= p_end || *p != 0x0a))) {
+			line++;
+			*out_lineterm = 1;
+		} else if (x == 0x0d) {
+			*out_lineterm = 1;
+		}
+	}
+
+	duk__advance_to_offset(lex_ctx, (duk_int_t) (p - lex_ctx->input), line);
+	return found;
+}
+
 /*
  *  Parse Ecmascript source InputElementDiv or InputElementRegExp
  *  (E5 Section 7).
@@ -542,8 +892,8 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 	out_token->str1 = NULL;
 	out_token->str2 = NULL;
 	out_token->num_escapes = 0;
-	out_token->start_line = lex_ctx->lines[0];
-	out_token->start_offset = lex_ctx->offsets[0];
+	out_token->start_line = lex_ctx->window[0].line;
+	out_token->start_offset = lex_ctx->window[0].offset;
 	/* out_token->end_line set at exit */
 	/* out_token->lineterm set by caller */
 
@@ -588,6 +938,7 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 
 			/* DUK__ADVANCE(lex_ctx, 2) would be correct here, but it unnecessary */
 			for (;;) {
+				duk__skip_ascii_line_comment(lex_ctx);
 				x = DUK__L0();
 				if (x < 0 || duk_unicode_is_line_terminator(x)) {
 					break;
@@ -602,24 +953,27 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 			 *  automatic semicolon insertion.
 			 */
 
-			duk_uint8_t last_asterisk = 0;
-			advtok = DUK__ADVTOK(0, DUK_TOK_COMMENT);
+			int lineterm = 0;
 			DUK__ADVANCE(lex_ctx, 2);
 			for (;;) {
+				if (duk__skip_ascii_block_comment(lex_ctx, &lineterm)) {
+					break;
+				}
+
+				/* Non-ASCII char or EOF; the char cannot end the comment
+				 * so there's no need to track a preceding asterisk.
+				 */
 				x = DUK__L0();
 				if (x < 0) {
 					DUK_ERROR(lex_ctx->thr, DUK_ERR_SYNTAX_ERROR,
 					          "eof while parsing multiline comment");
 				}
 				DUK__ADVANCE(lex_ctx, 1);
-				if (last_asterisk && x == '/') {
-					break;
-				}
 				if (duk_unicode_is_line_terminator(x)) {
-					advtok = DUK__ADVTOK(0, DUK_TOK_LINETERM);
+					lineterm = 1;
 				}
-				last_asterisk = (x == (int) '*');
 			}
+			advtok = DUK__ADVTOK(0, lineterm ? DUK_TOK_LINETERM : DUK_TOK_COMMENT);
 		} else if (regexp_mode) {
 #ifdef DUK_USE_REGEXP_SUPPORT
 			/*
@@ -907,6 +1261,10 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 		int first = 1;
 		duk_hstring *str;
 
+		if (x < 0x80 && x != '\\' && duk__scan_ascii_identifier(lex_ctx)) {
+			goto identifier_done;
+		}
+
 		DUK__INITBUFFER(lex_ctx);
 		for (;;) {
 			/* re-lookup first char on first loop */
@@ -949,13 +1307,14 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 		}
 
 		duk__internbuffer(lex_ctx, lex_ctx->slot1_idx);
+		DUK__INITBUFFER(lex_ctx);	/* free some memory */
+
+	 identifier_done:
 		out_token->str1 = duk_get_hstring((duk_context *) lex_ctx->thr, lex_ctx->slot1_idx);
 		str = out_token->str1;
 		DUK_ASSERT(str != NULL);
 		out_token->t_nores = DUK_TOK_IDENTIFIER;
 
-		DUK__INITBUFFER(lex_ctx);	/* free some memory */
-
 		/*
 		 *  Interned identifier is compared against reserved words, which are
 		 *  currently interned into the heap context.  See genstrings.py.
@@ -1018,6 +1377,10 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 		                 */
 		int s2n_flags;
 
+		if (x != '.' && duk__scan_ascii_integer(lex_ctx, &val)) {
+			goto number_done;
+		}
+
 		DUK__INITBUFFER(lex_ctx);
 		if (x == '0' && (y == 'x' || y == 'X')) {
 			DUK__APPENDBUFFER(lex_ctx, x);
@@ -1100,6 +1463,7 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 
 		DUK__INITBUFFER(lex_ctx);	/* free some memory */
 
+	 number_done:
 		/* Section 7.8.3 (note): NumericLiteral must be followed by something other than
 		 * IdentifierStart or DecimalDigit.
 		 */
@@ -1114,6 +1478,10 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 		int quote = x;	/* duk_uint8_t type yields larger code */
 		int adv;
 
+		if (duk__scan_ascii_string(lex_ctx, quote)) {
+			goto string_done;
+		}
+
 		DUK__INITBUFFER(lex_ctx);
 		for (;;) {
 			DUK__ADVANCE(lex_ctx, 1);	/* eat opening quote on first loop */
@@ -1249,10 +1617,10 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 		}
 
 		duk__internbuffer(lex_ctx, lex_ctx->slot1_idx);
-		out_token->str1 = duk_get_hstring((duk_context *) lex_ctx->thr, lex_ctx->slot1_idx);
-
 		DUK__INITBUFFER(lex_ctx);	/* free some memory */
 
+	 string_done:
+		out_token->str1 = duk_get_hstring((duk_context *) lex_ctx->thr, lex_ctx->slot1_idx);
 		advtok = DUK__ADVTOK(0, DUK_TOK_STRING);
 	} else if (x < 0) {
 		advtok = DUK__ADVTOK(0, DUK_TOK_EOF);
@@ -1269,7 +1637,7 @@ static void duk__parse_input_element_raw(duk_lexer_ctx *lex_ctx,
 	if (out_token->t_nores < 0) {
 		out_token->t_nores = out_token->t;
 	}
-	out_token->end_line = lex_ctx->lines[0];
+	out_token->end_line = lex_ctx->window[0].line;
 }
 
 /*
@@ -30,12 +30,17 @@ typedef void (*duk_re_range_callback)(void *user, duk_codepoint_t r1, duk_codepo
 
 #define DUK_LEXER_SETPOINT(ctx,pt)    duk_lexer_setpoint((ctx), (pt))
 
-#define DUK_LEXER_GETPOINT(ctx,pt)    do { (pt)->offset = (ctx)->offsets[0]; \
-                                           (pt)->line = (ctx)->lines[0]; } while (0)
+#define DUK_LEXER_GETPOINT(ctx,pt)    do { (pt)->offset = (ctx)->window[0].offset; \
+                                           (pt)->line = (ctx)->window[0].line; } while (0)
 
 /* currently 6 characters of lookup are actually needed (duk_lexer.c) */
 #define DUK_LEXER_WINDOW_SIZE                     8
 
+/* decoded lookahead buffer; the window slides over it and is refilled
+ * (by copying the window to the buffer start) only when it reaches the end
+ */
+#define DUK_LEXER_BUFFER_SIZE                     64
+
 #define DUK_TOK_MINVAL                            0
 
 /* returned after EOF (infinite amount) */
@@ -380,16 +385,25 @@ struct duk_lexer_point {
 	int line;
 };
 
-/* Lexer context.  Same context is used for Ecmascript and Regexp parsing. */
+/* A decoded input character with its input position. */
+struct duk_lexer_codepoint {
+	int codepoint;          /* unicode code point, -1 past end of input */
+	int offset;             /* input byte offset of the char */
+	int line;               /* input line of the char */
+};
+
+/* Lexer context.  Same context is used for Ecmascript and Regexp parsing.
+ * Note: 'window' points into 'buffer', so the context must not be copied.
+ */
 struct duk_lexer_ctx {
 	duk_hthread *thr;                       /* thread; minimizes argument passing */
 
 	duk_uint8_t *input;
 	duk_int_t input_length;
-	int window[DUK_LEXER_WINDOW_SIZE];      /* window of unicode code points */
-	int offsets[DUK_LEXER_WINDOW_SIZE];     /* input byte offset for each char */
-	int lines[DUK_LEXER_WINDOW_SIZE];       /* input lines for each char */
-	int input_offset;                       /* input offset for window leading edge (not window[0]) */
+	duk_lexer_codepoint *window;            /* current lookup window (DUK_LEXER_WINDOW_SIZE chars) inside 'buffer' */
+	duk_lexer_codepoint *buffer_end;        /* end of decoded chars in 'buffer' (exclusive) */
+	duk_lexer_codepoint buffer[DUK_LEXER_BUFFER_SIZE];  /* decoded chars */
+	int input_offset;                       /* input offset for buffer leading edge (not window[0]) */
 	int input_line;                         /* input linenumber at input_offset (not window[0]), init to 1 */
 
 	int slot1_idx;                          /* valstack slot for 1st token value */
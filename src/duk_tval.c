@@ -0,0 +1,42 @@
+/*
+ *  Tagged type helpers which are too large for macros.
+ */
+
+#include "duk_internal.h"
+
+#if defined(DUK_USE_FASTINT)
+
+/* Get a number value as a double, regardless of whether it is stored as
+ * a double or as a fastint.
+ */
+duk_double_t duk_tval_get_number(duk_tval *tv) {
+	DUK_ASSERT(tv != NULL);
+	DUK_ASSERT(DUK_TVAL_IS_NUMBER(tv));
+
+	if (DUK_TVAL_IS_FASTINT(tv)) {
+		return (duk_double_t) DUK_TVAL_GET_FASTINT(tv);
+	}
+	return DUK_TVAL_GET_DOUBLE(tv);
+}
+
+/* Set a number value, using a fastint if the value is a whole number in
+ * the 32-bit signed range and not a negative zero.  Caller must have
+ * normalized a possible NaN, as with DUK_TVAL_SET_NUMBER().
+ */
+void duk_tval_set_number_chkfast(duk_tval *tv, duk_double_t x) {
+	duk_int32_t i;
+
+	DUK_ASSERT(tv != NULL);
+
+	/* NaN fails both comparisons */
+	if (x >= -2147483648.0 && x <= 2147483647.0) {
+		i = (duk_int32_t) x;
+		if ((duk_double_t) i == x && !(i == 0 && DUK_SIGNBIT(x))) {
+			DUK_TVAL_SET_FASTINT(tv, i);
+			return;
+		}
+	}
+	DUK_TVAL_SET_NUMBER(tv, x);
+}
+
+#endif  /* DUK_USE_FASTINT */
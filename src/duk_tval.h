@@ -44,6 +44,28 @@ typedef union duk_double_union duk_tval;
 /* tags */
 #define DUK_TAG_NORMALIZED_NAN    0x7ff8UL   /* the NaN variant we use */
 /* avoid tag 0xfff0, no risk of confusion with negative infinity */
+#if defined(DUK_USE_FASTINT)
+/* Fastint tag must come right after the double range so that a single
+ * comparison covers both number variants, and before heap allocated tags.
+ */
+#define DUK_TAG_FASTINT           0xfff1UL   /* embed: duk_int32_t */
+#define DUK_TAG_UNDEFINED         0xfff2UL   /* embed: 0 or 1 (normal or unused) */
+#define DUK_TAG_NULL              0xfff3UL   /* embed: nothing */
+#define DUK_TAG_BOOLEAN           0xfff4UL   /* embed: 0 or 1 (false or true) */
+/* DUK_TAG_NUMBER would logically go here, but it has multiple 'tags' */
+#define DUK_TAG_POINTER           0xfff5UL   /* embed: void ptr */
+#define DUK_TAG_STRING            0xfff6UL   /* embed: duk_hstring ptr */
+#define DUK_TAG_OBJECT            0xfff7UL   /* embed: duk_hobject ptr */
+#define DUK_TAG_BUFFER            0xfff8UL   /* embed: duk_hbuffer ptr */
+#define DUK_TAG_LIGHTFUNC         0xfff9UL   /* embed: func ptr + 16-bit flags */
+
+/* for convenience */
+#define DUK_XTAG_UNDEFINED_ACTUAL 0xfff20000UL
+#define DUK_XTAG_UNDEFINED_UNUSED 0xfff20001UL
+#define DUK_XTAG_NULL             0xfff30000UL
+#define DUK_XTAG_BOOLEAN_FALSE    0xfff40000UL
+#define DUK_XTAG_BOOLEAN_TRUE     0xfff40001UL
+#else  /* DUK_USE_FASTINT */
 #define DUK_TAG_UNDEFINED         0xfff1UL   /* embed: 0 or 1 (normal or unused) */
 #define DUK_TAG_NULL              0xfff2UL   /* embed: nothing */
 #define DUK_TAG_BOOLEAN           0xfff3UL   /* embed: 0 or 1 (false or true) */
@@ -52,6 +74,7 @@ typedef union duk_double_union duk_tval;
 #define DUK_TAG_STRING            0xfff5UL   /* embed: duk_hstring ptr */
 #define DUK_TAG_OBJECT            0xfff6UL   /* embed: duk_hobject ptr */
 #define DUK_TAG_BUFFER            0xfff7UL   /* embed: duk_hbuffer ptr */
+#define DUK_TAG_LIGHTFUNC         0xfff8UL   /* embed: func ptr + 16-bit flags */
 
 /* for convenience */
 #define DUK_XTAG_UNDEFINED_ACTUAL 0xfff10000UL
@@ -59,6 +82,7 @@ typedef union duk_double_union duk_tval;
 #define DUK_XTAG_NULL             0xfff20000UL
 #define DUK_XTAG_BOOLEAN_FALSE    0xfff30000UL
 #define DUK_XTAG_BOOLEAN_TRUE     0xfff30001UL
+#endif  /* DUK_USE_FASTINT */
 
 #define DUK__TVAL_SET_UNDEFINED_ACTUAL_FULL(v)      DUK_DBLUNION_SET_HIGH32_ZERO_LOW32((v), DUK_XTAG_UNDEFINED_ACTUAL)
 #define DUK__TVAL_SET_UNDEFINED_ACTUAL_NOTFULL(v)   DUK_DBLUNION_SET_HIGH32((v), DUK_XTAG_UNDEFINED_ACTUAL)
@@ -80,6 +104,17 @@ typedef union duk_double_union duk_tval;
 #define DUK__TVAL_SET_NUMBER_FULL(v,val)     DUK_DBLUNION_SET_DOUBLE((v), (val))
 #define DUK__TVAL_SET_NUMBER_NOTFULL(v,val)  DUK_DBLUNION_SET_DOUBLE((v), (val))
 
+#define DUK__TVAL_SET_FASTINT(v,i)  do { \
+		(v)->ui[DUK_DBL_IDX_UI0] = ((duk_uint32_t) DUK_TAG_FASTINT) << 16; \
+		(v)->ui[DUK_DBL_IDX_UI1] = (duk_uint32_t) (i); \
+	} while (0)
+
+/* function pointer in low 32 bits, flags in the 16 bits following the tag */
+#define DUK__TVAL_SET_LIGHTFUNC(v,fp,flags)  do { \
+		(v)->ui[DUK_DBL_IDX_UI0] = (((duk_uint32_t) DUK_TAG_LIGHTFUNC) << 16) | ((duk_uint32_t) (flags)); \
+		(v)->ui[DUK_DBL_IDX_UI1] = (duk_uint32_t) (fp); \
+	} while (0)
+
 /* two casts to avoid gcc warning: "warning: cast from pointer to integer of different size [-Wpointer-to-int-cast]" */
 #ifdef DUK_USE_64BIT_OPS
 #ifdef DUK_USE_DOUBLE_ME
@@ -119,17 +154,29 @@ typedef union duk_double_union duk_tval;
 #define DUK_TVAL_SET_OBJECT(v,h)            DUK__TVAL_SET_TAGGEDPOINTER((v),(h),DUK_TAG_OBJECT)
 #define DUK_TVAL_SET_BUFFER(v,h)            DUK__TVAL_SET_TAGGEDPOINTER((v),(h),DUK_TAG_BUFFER)
 #define DUK_TVAL_SET_POINTER(v,p)           DUK__TVAL_SET_TAGGEDPOINTER((v),(p),DUK_TAG_POINTER)
+#define DUK_TVAL_SET_LIGHTFUNC(v,fp,flags)  DUK__TVAL_SET_LIGHTFUNC((v),(fp),(flags))
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_SET_FASTINT(v,i)           DUK__TVAL_SET_FASTINT((v),(i))
+#endif
 
 #define DUK_TVAL_SET_TVAL(v,x)              do { *(v) = *(x); } while (0)
 
 /* getters */
 #define DUK_TVAL_GET_BOOLEAN(v)             ((int) (v)->us[DUK_DBL_IDX_US1])
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_GET_NUMBER(v)              duk_tval_get_number((v))
+#define DUK_TVAL_GET_DOUBLE(v)              ((v)->d)
+#define DUK_TVAL_GET_FASTINT(v)             ((duk_int32_t) (v)->ui[DUK_DBL_IDX_UI1])
+#else
 #define DUK_TVAL_GET_NUMBER(v)              ((v)->d)
+#endif
 #define DUK_TVAL_GET_STRING(v)              ((duk_hstring *) (v)->vp[DUK_DBL_IDX_VP1])
 #define DUK_TVAL_GET_OBJECT(v)              ((duk_hobject *) (v)->vp[DUK_DBL_IDX_VP1])
 #define DUK_TVAL_GET_BUFFER(v)              ((duk_hbuffer *) (v)->vp[DUK_DBL_IDX_VP1])
 #define DUK_TVAL_GET_POINTER(v)             ((void *) (v)->vp[DUK_DBL_IDX_VP1])
 #define DUK_TVAL_GET_HEAPHDR(v)             ((duk_heaphdr *) (v)->vp[DUK_DBL_IDX_VP1])
+#define DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(v)   ((duk_c_function) (v)->ui[DUK_DBL_IDX_UI1])
+#define DUK_TVAL_GET_LIGHTFUNC_FLAGS(v)     ((duk_small_uint_t) (v)->us[DUK_DBL_IDX_US1])
 
 /* decoding */
 #define DUK_TVAL_GET_TAG(v)                 ((int) (v)->us[DUK_DBL_IDX_US0])
@@ -145,10 +192,20 @@ typedef union duk_double_union duk_tval;
 #define DUK_TVAL_IS_OBJECT(v)               (DUK_TVAL_GET_TAG((v)) == DUK_TAG_OBJECT)
 #define DUK_TVAL_IS_BUFFER(v)               (DUK_TVAL_GET_TAG((v)) == DUK_TAG_BUFFER)
 #define DUK_TVAL_IS_POINTER(v)              (DUK_TVAL_GET_TAG((v)) == DUK_TAG_POINTER)
+#define DUK_TVAL_IS_LIGHTFUNC(v)            (DUK_TVAL_GET_TAG((v)) == DUK_TAG_LIGHTFUNC)
 /* 0xfff0 is -Infinity */
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_IS_NUMBER(v)               (DUK_TVAL_GET_TAG((v)) <= DUK_TAG_FASTINT)
+#define DUK_TVAL_IS_DOUBLE(v)               (DUK_TVAL_GET_TAG((v)) <= 0xfff0UL)
+#define DUK_TVAL_IS_FASTINT(v)              (DUK_TVAL_GET_TAG((v)) == DUK_TAG_FASTINT)
+#else
 #define DUK_TVAL_IS_NUMBER(v)               (DUK_TVAL_GET_TAG((v)) <= 0xfff0UL)
+#endif
 
-#define DUK_TVAL_IS_HEAP_ALLOCATED(v)       (DUK_TVAL_GET_TAG((v)) >= DUK_TAG_STRING)
+/* lightfunc tag comes after the heap allocated range; the range check
+ * compiles to a single unsigned comparison
+ */
+#define DUK_TVAL_IS_HEAP_ALLOCATED(v)       ((duk_uint_t) (DUK_TVAL_GET_TAG((v)) - DUK_TAG_STRING) <= (duk_uint_t) (DUK_TAG_BUFFER - DUK_TAG_STRING))
 
 #else  /* DUK_USE_PACKED_TVAL */
 /* ======================================================================== */
@@ -163,12 +220,20 @@ typedef union duk_double_union duk_tval;
 
 typedef struct duk_tval_struct duk_tval;
 
+/* The tag and the extra field are 16-bit so that they pack into the same
+ * space as a plain int tag did; 'v_extra' is only used by lightfuncs.
+ */
 struct duk_tval_struct {
-	int t;
+	duk_uint16_t t;
+	duk_uint16_t v_extra;
 	union {
 		double d;
 		int i;
+#if defined(DUK_USE_FASTINT)
+		duk_int32_t fi;
+#endif
 		void *voidptr;
+		duk_c_function lightfunc;
 		duk_hstring *hstring;
 		duk_hobject *hobject;
 		duk_hcompiledfunction *hcompiledfunction;
@@ -180,6 +245,17 @@ struct duk_tval_struct {
 };
 
 #define DUK__TAG_NUMBER               0  /* not exposed */
+#if defined(DUK_USE_FASTINT)
+#define DUK_TAG_FASTINT               1
+#define DUK_TAG_UNDEFINED             2
+#define DUK_TAG_NULL                  3
+#define DUK_TAG_BOOLEAN               4
+#define DUK_TAG_POINTER               5
+#define DUK_TAG_STRING                6
+#define DUK_TAG_OBJECT                7
+#define DUK_TAG_BUFFER                8
+#define DUK_TAG_LIGHTFUNC             9
+#else
 #define DUK_TAG_UNDEFINED             1
 #define DUK_TAG_NULL                  2
 #define DUK_TAG_BOOLEAN               3
@@ -187,6 +263,8 @@ struct duk_tval_struct {
 #define DUK_TAG_STRING                5
 #define DUK_TAG_OBJECT                6
 #define DUK_TAG_BUFFER                7
+#define DUK_TAG_LIGHTFUNC             8
+#endif
 
 /* DUK__TAG_NUMBER is intentionally first, as it is the default clause in code
  * to support the 8-byte representation.  Further, it is a non-heap-allocated
@@ -219,6 +297,13 @@ struct duk_tval_struct {
 		(tv)->v.d = (val); \
 	} while (0)
 
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_SET_FASTINT(tv,val)  do { \
+		(tv)->t = DUK_TAG_FASTINT; \
+		(tv)->v.fi = (val); \
+	} while (0)
+#endif
+
 #define DUK_TVAL_SET_STRING(tv,hptr)  do { \
 		(tv)->t = DUK_TAG_STRING; \
 		(tv)->v.hstring = (hptr); \
@@ -239,6 +324,12 @@ struct duk_tval_struct {
 		(tv)->v.voidptr = (hptr); \
 	} while (0)
 
+#define DUK_TVAL_SET_LIGHTFUNC(tv,fp,flags)  do { \
+		(tv)->t = DUK_TAG_LIGHTFUNC; \
+		(tv)->v_extra = (duk_uint16_t) (flags); \
+		(tv)->v.lightfunc = (fp); \
+	} while (0)
+
 #define DUK_TVAL_SET_NAN(tv)  do { \
 		/* in non-packed representation we don't care about which NaN is used */ \
 		(tv)->t = DUK__TAG_NUMBER; \
@@ -249,16 +340,30 @@ struct duk_tval_struct {
 
 /* getters */
 #define DUK_TVAL_GET_BOOLEAN(tv)           ((tv)->v.i)
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_GET_NUMBER(tv)            duk_tval_get_number((tv))
+#define DUK_TVAL_GET_DOUBLE(tv)            ((tv)->v.d)
+#define DUK_TVAL_GET_FASTINT(tv)           ((tv)->v.fi)
+#else
 #define DUK_TVAL_GET_NUMBER(tv)            ((tv)->v.d)
+#endif
 #define DUK_TVAL_GET_STRING(tv)            ((tv)->v.hstring)
 #define DUK_TVAL_GET_OBJECT(tv)            ((tv)->v.hobject)
 #define DUK_TVAL_GET_BUFFER(tv)            ((tv)->v.hbuffer)
 #define DUK_TVAL_GET_POINTER(tv)           ((tv)->v.voidptr)
 #define DUK_TVAL_GET_HEAPHDR(tv)           ((tv)->v.heaphdr)
+#define DUK_TVAL_GET_LIGHTFUNC_FUNCPTR(tv) ((tv)->v.lightfunc)
+#define DUK_TVAL_GET_LIGHTFUNC_FLAGS(tv)   ((duk_small_uint_t) (tv)->v_extra)
 
 /* decoding */
-#define DUK_TVAL_GET_TAG(tv)               ((tv)->t)
+#define DUK_TVAL_GET_TAG(tv)               ((int) (tv)->t)
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_IS_NUMBER(tv)             ((tv)->t == DUK__TAG_NUMBER || (tv)->t == DUK_TAG_FASTINT)
+#define DUK_TVAL_IS_DOUBLE(tv)             ((tv)->t == DUK__TAG_NUMBER)
+#define DUK_TVAL_IS_FASTINT(tv)            ((tv)->t == DUK_TAG_FASTINT)
+#else
 #define DUK_TVAL_IS_NUMBER(tv)             ((tv)->t == DUK__TAG_NUMBER)
+#endif
 #define DUK_TVAL_IS_UNDEFINED(tv)          ((tv)->t == DUK_TAG_UNDEFINED)
 #define DUK_TVAL_IS_UNDEFINED_ACTUAL(tv)   (((tv)->t == DUK_TAG_UNDEFINED) && ((tv)->v.i == 0))
 #define DUK_TVAL_IS_UNDEFINED_UNUSED(tv)   (((tv)->t == DUK_TAG_UNDEFINED) && ((tv)->v.i != 0))
@@ -270,8 +375,9 @@ struct duk_tval_struct {
 #define DUK_TVAL_IS_OBJECT(tv)             ((tv)->t == DUK_TAG_OBJECT)
 #define DUK_TVAL_IS_BUFFER(tv)             ((tv)->t == DUK_TAG_BUFFER)
 #define DUK_TVAL_IS_POINTER(tv)            ((tv)->t == DUK_TAG_POINTER)
+#define DUK_TVAL_IS_LIGHTFUNC(tv)          ((tv)->t == DUK_TAG_LIGHTFUNC)
 
-#define DUK_TVAL_IS_HEAP_ALLOCATED(tv)     ((tv)->t >= DUK_TAG_STRING)
+#define DUK_TVAL_IS_HEAP_ALLOCATED(tv)     ((duk_uint_t) ((tv)->t - DUK_TAG_STRING) <= (duk_uint_t) (DUK_TAG_BUFFER - DUK_TAG_STRING))
 
 #endif  /* DUK_USE_PACKED_TVAL */
 
@@ -282,5 +388,58 @@ struct duk_tval_struct {
 #define DUK_TVAL_SET_BOOLEAN_TRUE(v)        DUK_TVAL_SET_BOOLEAN(v, 1)
 #define DUK_TVAL_SET_BOOLEAN_FALSE(v)       DUK_TVAL_SET_BOOLEAN(v, 0)
 
+/*
+ *  Lightweight functions (lightfuncs)
+ *
+ *  A lightfunc is a Duktape/C function pointer and 16 bits of flags stored
+ *  directly in the tagged value, without a heap allocated function object.
+ *  The flags are packed as follows:
+ *
+ *    bits 15-8: magic value (signed 8-bit)
+ *    bits  7-4: 'length' property value (0-15)
+ *    bits  3-0: nargs (0-14), 15 indicates DUK_VARARGS
+ */
+
+#define DUK_LFUNC_NARGS_VARARGS             0x0f   /* varargs marker */
+#define DUK_LFUNC_NARGS_MIN                 0x00
+#define DUK_LFUNC_NARGS_MAX                 0x0e   /* max, excl. varargs marker */
+#define DUK_LFUNC_LENGTH_MIN                0x00
+#define DUK_LFUNC_LENGTH_MAX                0x0f
+#define DUK_LFUNC_MAGIC_MIN                 (-0x80)
+#define DUK_LFUNC_MAGIC_MAX                 0x7f
+
+#define DUK_LFUNC_FLAGS_GET_MAGIC(lf_flags) \
+	((duk_int32_t) (((lf_flags) >> 8) & 0xff) - (((lf_flags) & 0x8000) ? 0x100 : 0))
+#define DUK_LFUNC_FLAGS_GET_LENGTH(lf_flags) \
+	(((lf_flags) >> 4) & 0x0f)
+#define DUK_LFUNC_FLAGS_GET_NARGS(lf_flags) \
+	((lf_flags) & 0x0f)
+#define DUK_LFUNC_FLAGS_PACK(magic,length,nargs) \
+	(((((duk_small_uint_t) (magic)) & 0xff) << 8) | ((length) << 4) | (nargs))
+
+/*
+ *  Fastint (DUK_USE_FASTINT)
+ *
+ *  A number may be represented either as an IEEE double or as a 32-bit
+ *  signed integer ("fastint").  The two are indistinguishable to user
+ *  code: DUK_TVAL_IS_NUMBER() and DUK_TVAL_GET_NUMBER() accept both, and
+ *  DUK_TVAL_SET_NUMBER() always stores a double.  Fastints are only
+ *  created explicitly by code which knows the value is a whole number in
+ *  the int32 range and not a negative zero, e.g. by overflow checked
+ *  arithmetic in the executor, or by DUK_TVAL_SET_NUMBER_CHKFAST().
+ *
+ *  Without fastint support DUK_TVAL_SET_NUMBER_CHKFAST() is a plain
+ *  DUK_TVAL_SET_NUMBER(); other fastint macros are not defined.
+ */
+
+#if defined(DUK_USE_FASTINT)
+#define DUK_TVAL_SET_NUMBER_CHKFAST(v,d)    duk_tval_set_number_chkfast((v), (d))
+
+duk_double_t duk_tval_get_number(duk_tval *tv);
+void duk_tval_set_number_chkfast(duk_tval *tv, duk_double_t x);
+#else
+#define DUK_TVAL_SET_NUMBER_CHKFAST(v,d)    DUK_TVAL_SET_NUMBER((v), (d))
+#endif
+
 #endif  /* DUK_TVAL_H_INCLUDED */
 
@@ -239,9 +239,22 @@ duk_size_t duk_unicode_unvalidated_utf8_length(duk_uint8_t *data, duk_size_t ble
 	duk_uint8_t *p = data;
 	duk_uint8_t *p_end = data + blen;
 	duk_size_t clen = 0;
+	duk_uint32_t w;
 
 	while (p < p_end) {
-		duk_uint8_t x = *p++;
+		duk_uint8_t x;
+
+		/* ASCII is one char per byte; skip ASCII runs 4 bytes at a time */
+		if (p_end - p >= 4) {
+			DUK_MEMCPY((void *) &w, (const void *) p, 4);
+			if ((w & 0x80808080UL) == 0) {
+				clen += 4;
+				p += 4;
+				continue;
+			}
+		}
+
+		x = *p++;
 		if (x < 0x80 || x >= 0xc0) {
 			/* 10xxxxxx = continuation chars (0x80...0xbf), above
 			 * and below that initial bytes.
@@ -24,6 +24,11 @@
 #      initialization order (and hence enumeration order) of keys can be
 #      controlled.
 #
+#    - A 'feature' key names a DUK_USE_xxx define required for the
+#      property.  The init bitstream always contains the property and
+#      duk_hthread_builtins.c deletes it when the feature is disabled;
+#      ROM objects (DUK_USE_ROM_OBJECTS) are emitted in both variants.
+#
 #    - Some algorithms need to refer to the original, unmodified built-in
 #      functions (like Object.toString).  These should be marked somehow here
 #      and slots in thr->builtins should be allocated for them.
@@ -130,6 +135,24 @@ PROPDESC_FLAG_ENUMERABLE =   (1 << 1)
 PROPDESC_FLAG_CONFIGURABLE = (1 << 2)
 PROPDESC_FLAG_ACCESSOR =     (1 << 3)  # unused now
 
+# ROM built-ins: string hashes are precomputed with a fixed hash seed
+# which must match duk_heap_hashstring(), see romHashString()
+ROM_STRINGS_HASH_SEED = 0x3a9c5e17
+ROM_STRINGS_LOOKUP_BUCKETS = 256  # must be a power of two
+
+# Built-ins which are extended after creation (Duktape.env, initjs, user
+# hooks like Duktape.errCreate and Duktape.Logger.prototype.raw, global
+# variables).  With ROM objects these are created in RAM for each heap,
+# using their ROM objects as templates.  Other ROM objects must not refer
+# to them.
+ROM_RAM_BUILTINS = [
+	'bi_global',
+	'bi_global_env',
+	'bi_duktape',
+	'bi_logger_constructor',
+	'bi_logger_prototype',
+]
+
 # magic values for Date built-in, must match duk_bi_date.c
 BI_DATE_FLAG_NAN_TO_ZERO =        (1 << 0)
 BI_DATE_FLAG_NAN_TO_RANGE_ERROR = (1 << 1)
@@ -210,6 +233,72 @@ def internal(x):
 	# it is converted to \xFF during initialization
 	return '\x00' + x
 
+def romHashString(x):
+	# Must match duk_heap_hashstring() and duk_util_hashbytes() (32-bit
+	# MurmurHash2, with little endian reads) for short strings.
+	M = 0x5bd1e995
+	R = 24
+	mask = 0xffffffff
+
+	if len(x) > 4096:
+		raise Exception('ROM string too long for a precomputed hash: %d bytes' % len(x))
+
+	h = ROM_STRINGS_HASH_SEED  # == (seed ^ len) ^ len
+	i = 0
+	n = len(x)
+	while n >= 4:
+		k = ord(x[i]) | (ord(x[i + 1]) << 8) | (ord(x[i + 2]) << 16) | (ord(x[i + 3]) << 24)
+		k = (k * M) & mask
+		k ^= k >> R
+		k = (k * M) & mask
+		h = (h * M) & mask
+		h ^= k
+		i += 4
+		n -= 4
+	if n >= 3:
+		h ^= ord(x[i + 2]) << 16
+	if n >= 2:
+		h ^= ord(x[i + 1]) << 8
+	if n >= 1:
+		h ^= ord(x[i])
+		h = (h * M) & mask
+	h ^= h >> 13
+	h = (h * M) & mask
+	h ^= h >> 15
+	return h
+
+def romIsArrayIndex(x):
+	# Must match duk_js_to_arrayindex_raw_string()
+	if len(x) == 0 or len(x) > 10:
+		return False
+	if x[0] == '0' and len(x) > 1:
+		return False
+	res = 0
+	for c in x:
+		if c < '0' or c > '9':
+			return False
+		res = res * 10 + ord(c) - ord('0')
+	return res <= 0xffffffff
+
+def romCharLength(x):
+	# Must match duk_unicode_unvalidated_utf8_length()
+	res = 0
+	for c in x:
+		if (ord(c) & 0xc0) != 0x80:
+			res += 1
+	return res
+
+def romCStringLiteral(x):
+	res = '"'
+	for c in x:
+		if c in '"\\?':
+			res += '\\' + c
+		elif ord(c) >= 0x20 and ord(c) <= 0x7e:
+			res += c
+		else:
+			res += '\\%03o' % ord(c)
+	return res + '"'
+
 #
 #  Built-in object descriptions
 #
@@ -319,7 +408,7 @@ bi_object_constructor = {
 	'values': [],
 	'functions': [
 		{ 'name': 'getPrototypeOf',		'native': 'duk_bi_object_getprototype_shared',				'length': 1,	'magic': { 'type': 'plain', 'value': 1 } },
-		{ 'name': 'setPrototypeOf',		'native': 'duk_bi_object_setprototype_shared',				'length': 2,	'magic': { 'type': 'plain', 'value': 1 } },  # ES6
+		{ 'name': 'setPrototypeOf',		'native': 'duk_bi_object_setprototype_shared',				'length': 2,	'magic': { 'type': 'plain', 'value': 1 },	'feature': 'DUK_USE_ES6_OBJECT_SETPROTOTYPEOF' },  # ES6
 		{ 'name': 'getOwnPropertyDescriptor',	'native': 'duk_bi_object_constructor_get_own_property_descriptor',	'length': 2 },
 		{ 'name': 'getOwnPropertyNames',	'native': 'duk_bi_object_constructor_keys_shared',	 		'length': 1,	'magic': { 'type': 'plain', 'value': 0 } },
 		{ 'name': 'create',			'native': 'duk_bi_object_constructor_create',				'length': 2 },
@@ -346,7 +435,8 @@ bi_object_prototype = {
 		# significant because the helper is shared)
 		{ 'name': '__proto__',
 		  'getter': 'duk_bi_object_getprototype_shared',
-		  'setter': 'duk_bi_object_setprototype_shared' }
+		  'setter': 'duk_bi_object_setprototype_shared',
+		  'feature': 'DUK_USE_ES6_OBJECT_PROTO_PROPERTY' }
 	],
 
 	'functions': [
@@ -1135,6 +1225,7 @@ bi_duktape = {
 		{ 'name': 'enc',			'native': 'duk_bi_duktape_object_enc',		'length': 0,	'varargs': True },
 		{ 'name': 'dec',			'native': 'duk_bi_duktape_object_dec',		'length': 0,	'varargs': True },
 		{ 'name': 'compact',			'native': 'duk_bi_duktape_object_compact',	'length': 1 },
+		{ 'name': 'opstats',			'native': 'duk_bi_duktape_object_opstats',		'length': 0,	'feature': 'DUK_USE_OPCODE_STATS' },
 	],
 }
 
@@ -1379,6 +1470,10 @@ class GenBuiltins:
 	count_normal_props = None
 	count_function_props = None
 
+	rom_strings = None
+	rom_string_index = None
+	rom_objects = None
+
 	def __init__(self, build_info=None, initjs_data=None, double_byte_order=None, ext_section_b=None, ext_browser_like=None):
 		self.build_info = build_info
 		self.double_byte_order = double_byte_order
@@ -1400,6 +1495,10 @@ class GenBuiltins:
 		self.count_normal_props = 0
 		self.count_function_props = 0
 
+		self.rom_strings = []
+		self.rom_string_index = {}
+		self.rom_objects = []
+
 	def findBuiltIn(self, id_):
 		for i in self.builtins:
 			if i['id'] == id_:
@@ -1733,6 +1832,435 @@ class GenBuiltins:
 			else:
 				be.bits(0, 1)
 
+	#
+	#  ROM built-ins (DUK_USE_ROM_STRINGS, DUK_USE_ROM_OBJECTS)
+	#
+	#  Built-in strings and objects are emitted as constant C structures
+	#  which all heaps refer to directly.  The structures must match
+	#  duk_heaphdr.h, duk_hstring.h and duk_hobject.h, and the properties
+	#  must match what duk_hthread_builtins.c creates from the bitstream
+	#  (including the post-tweaks) so that e.g. enumeration order is the
+	#  same in both modes.
+	#
+
+	def romStringIndex(self, x):
+		# internal strings have a zero prefix here, 0xff in the heap
+		if isinstance(x, unicode):
+			x = x.encode('utf-8')
+		if len(x) > 0 and x[0] == '\x00':
+			x = '\xff' + x[1:]
+		if not self.rom_string_index.has_key(x):
+			self.rom_string_index[x] = len(self.rom_strings)
+			self.rom_strings.append(x)
+		return self.rom_string_index[x]
+
+	def romStringFlags(self, idx):
+		x = self.rom_strings[idx]
+		flags = [ 'DUK_HTYPE_STRING' ]
+		if romIsArrayIndex(x):
+			flags.append('DUK_HSTRING_FLAG_ARRIDX')
+		if len(x) > 0 and x[0] == '\xff':
+			flags.append('DUK_HSTRING_FLAG_INTERNAL')
+		if idx < len(self.gs.strlist):
+			# same special flags as in duk__init_heap_strings()
+			if self.gs.strlist[idx][1] in [ 'DUK_STRIDX_EVAL', 'DUK_STRIDX_LC_ARGUMENTS' ]:
+				flags.append('DUK_HSTRING_FLAG_EVAL_OR_ARGUMENTS')
+			if idx >= self.gs.idx_start_reserved:
+				flags.append('DUK_HSTRING_FLAG_RESERVED_WORD')
+				if idx >= self.gs.idx_start_strict_reserved:
+					flags.append('DUK_HSTRING_FLAG_STRICT_RESERVED_WORD')
+		return flags
+
+	def romFilterProps(self, specs):
+		res = []
+		for spec in specs:
+			if spec.get('section_b', False) and not self.ext_section_b:
+				continue
+			if spec.get('browser', False) and not self.ext_browser_like:
+				continue
+			res.append(spec)
+		return res
+
+	def romNargs(self, spec, default):
+		if spec.get('varargs', False):
+			return -1
+		return spec.get('nargs', default)
+
+	def romMagic(self, spec):
+		magic = self.resolveMagic(spec.get('magic'))
+		if magic >= 0x8000:
+			magic -= 0x10000  # duk_int16_t
+		return magic
+
+	def romProp(self, name, attrs, type_, value, feature=None):
+		return { 'key': self.romStringIndex(name),
+		         'flags': self.encodePropertyFlags(attrs),
+		         'type': type_,
+		         'value': value,
+		         'feature': feature }
+
+	def romAddObject(self, obj):
+		self.rom_objects.append(obj)
+		return len(self.rom_objects) - 1
+
+	def romAddFunction(self, comment, native, nargs, magic, props):
+		# like duk_push_c_function_noconstruct_noexotic()
+		return self.romAddObject({
+			'comment': comment,
+			'class': 'Function',
+			'flags': [ 'DUK_HOBJECT_FLAG_EXTENSIBLE',
+			           'DUK_HOBJECT_FLAG_NATIVEFUNCTION',
+			           'DUK_HOBJECT_FLAG_NEWENV',
+			           'DUK_HOBJECT_FLAG_STRICT',
+			           'DUK_HOBJECT_FLAG_NOTAIL' ],
+			'prototype': self.builtin_indexes['bi_function_prototype'],
+			'native': native,
+			'nargs': nargs,
+			'magic': magic,
+			'props': props,
+		})
+
+	def romCreateBuiltin(self, bi_id, bi):
+		flags = []
+		if bi.get('extensible', True):
+			flags.append('DUK_HOBJECT_FLAG_EXTENSIBLE')
+		native = None
+		nargs = None
+		magic = None
+		if bi['class'] == 'Function':
+			# like duk_push_c_function_noexotic()
+			if bi.get('constructable', False):
+				flags.append('DUK_HOBJECT_FLAG_CONSTRUCTABLE')
+			flags += [ 'DUK_HOBJECT_FLAG_NATIVEFUNCTION',
+			           'DUK_HOBJECT_FLAG_NEWENV',
+			           'DUK_HOBJECT_FLAG_STRICT',
+			           'DUK_HOBJECT_FLAG_NOTAIL' ]
+			native = bi['native']
+			nargs = self.romNargs(bi, bi['length'])
+			magic = self.romMagic(bi)
+		if bi['class'] == 'Array':
+			flags.append('DUK_HOBJECT_FLAG_EXOTIC_ARRAY')
+		if bi['class'] == 'String':
+			flags.append('DUK_HOBJECT_FLAG_EXOTIC_STRINGOBJ')
+
+		prototype = None
+		if bi.has_key('internal_prototype'):
+			prototype = self.builtin_indexes[bi['internal_prototype']]
+
+		return self.romAddObject({
+			'comment': bi_id,
+			'class': bi['class'],
+			'flags': flags,
+			'prototype': prototype,
+			'native': native,
+			'nargs': nargs,
+			'magic': magic,
+			'props': [],
+		})
+
+	def romInitBuiltinProps(self, bi_id, bi, props):
+		if bi['class'] == 'Function':
+			props.append(self.romProp('name', '', 'string', self.romStringIndex(bi['name'])))
+		if bi.has_key('length'):
+			# Array.prototype 'length' has Array instance attributes
+			attrs = LENGTH_PROPERTY_ATTRIBUTES
+			if bi['class'] == 'Array':
+				attrs = 'w'
+			props.append(self.romProp('length', attrs, 'number', float(bi['length'])))
+		if bi.has_key('external_prototype'):
+			props.append(self.romProp('prototype', '', 'object', self.builtin_indexes[bi['external_prototype']]))
+		if bi.has_key('external_constructor'):
+			props.append(self.romProp('constructor', 'wc', 'object', self.builtin_indexes[bi['external_constructor']]))
+
+		for valspec in self.romFilterProps(bi['values']):
+			name = valspec['name']
+			val = valspec.get('value')  # missing for accessors
+			feature = valspec.get('feature')
+
+			if name == 'length':
+				attrs = LENGTH_PROPERTY_ATTRIBUTES
+			else:
+				attrs = DEFAULT_PROPERTY_ATTRIBUTES
+			attrs = valspec.get('attributes', attrs)
+
+			if isinstance(val, bool):
+				props.append(self.romProp(name, attrs, 'boolean', val, feature))
+			elif val == UNDEFINED:
+				props.append(self.romProp(name, attrs, 'undefined', None, feature))
+			elif isinstance(val, (float, int)):
+				props.append(self.romProp(name, attrs, 'number', float(val), feature))
+			elif isinstance(val, str) or isinstance(val, unicode):
+				props.append(self.romProp(name, attrs, 'string', self.romStringIndex(val), feature))
+			elif isinstance(val, dict) and val['type'] == 'builtin':
+				props.append(self.romProp(name, attrs, 'object', self.builtin_indexes[val['id']], feature))
+			elif val is None and valspec.has_key('getter') and valspec.has_key('setter'):
+				getter = self.romAddFunction('%s: %s getter' % (bi_id, name), valspec['getter'], 0, 0, [])
+				setter = self.romAddFunction('%s: %s setter' % (bi_id, name), valspec['setter'], 1, 0, [])
+				props.append(self.romProp(name, attrs + 'a', 'accessor', (getter, setter), feature))
+			else:
+				raise Exception('unsupported value: %s' % repr(val))
+
+		for funspec in self.romFilterProps(bi['functions']):
+			name = funspec['name']
+			fprops = [ self.romProp('length', '', 'number', float(funspec['length'])),
+			           self.romProp('name', '', 'string', self.romStringIndex(name)) ]
+			func = self.romAddFunction('%s: %s' % (bi_id, name),
+			                           funspec['native'],
+			                           self.romNargs(funspec, funspec['length']),
+			                           self.romMagic(funspec),
+			                           fprops)
+			props.append(self.romProp(name, 'wc', 'object', func, funspec.get('feature')))
+
+		# Post-tweak in duk_hthread_builtins.c: toGMTString is the same
+		# Function object as toUTCString (E5 Section B.2.6).
+		if bi_id == 'bi_date_prototype':
+			for prop in props:
+				if prop['key'] == self.romStringIndex('toUTCString'):
+					props.append(self.romProp('toGMTString', 'wc', 'object', prop['value']))
+					break
+
+	def romCheckObjects(self):
+		ram_indexes = {}
+		for bi_id in ROM_RAM_BUILTINS:
+			ram_indexes[self.builtin_indexes[bi_id]] = True
+
+		for idx, obj in enumerate(self.rom_objects):
+			refs = [ obj['prototype'] ]
+			keys = {}
+			features = {}
+			for prop in obj['props']:
+				if keys.has_key(prop['key']):
+					raise Exception('duplicate key in ROM object %s' % obj['comment'])
+				keys[prop['key']] = True
+				if prop['feature'] is not None:
+					features[prop['feature']] = True
+				if prop['type'] == 'object':
+					refs.append(prop['value'])
+				elif prop['type'] == 'accessor':
+					refs += list(prop['value'])
+			if len(features) > 1:
+				raise Exception('more than one feature dependent property in ROM object %s' % obj['comment'])
+			if ram_indexes.has_key(idx):
+				continue
+			for ref in refs:
+				if ram_indexes.has_key(ref):
+					raise Exception('ROM object %s refers to RAM built-in %s' % (obj['comment'], self.rom_objects[ref]['comment']))
+
+	def processRomBuiltins(self):
+		# Built-in strings first, so that a ROM string index is the same
+		# as the DUK_STRIDX_XXX index.
+		for idx, (s, d) in enumerate(self.gs.strlist):
+			assert(self.romStringIndex(s) == idx)
+
+		# Built-in objects first, so that a ROM object index is the same
+		# as the DUK_BIDX_XXX index.
+		for bi in self.builtins:
+			self.romCreateBuiltin(bi['id'], bi['info'])
+		for idx, bi in enumerate(self.builtins):
+			self.romInitBuiltinProps(bi['id'], bi['info'], self.rom_objects[idx]['props'])
+
+		self.romCheckObjects()
+
+		print '%d ROM strings, %d ROM objects' % (len(self.rom_strings), len(self.rom_objects))
+
+	def romPropValueType(self, prop):
+		if prop is None:
+			return 'duk_rom_propvalue_int'  # unused entry (padding)
+		return {
+			'number': 'duk_rom_propvalue_number',
+			'undefined': 'duk_rom_propvalue_int',
+			'boolean': 'duk_rom_propvalue_int',
+			'string': 'duk_rom_propvalue_ptr',
+			'object': 'duk_rom_propvalue_ptr',
+			'accessor': 'duk_rom_propvalue_accessor',
+		}[prop['type']]
+
+	def romPropValueInit(self, prop):
+		if prop is None:
+			return '{ { DUK_TAG_UNDEFINED, 0, { 0 } } }'
+		t = prop['type']
+		v = prop['value']
+		if t == 'number':
+			# encoding of double must match target architecture byte order
+			bo = self.double_byte_order
+			if bo == 'big':
+				data = struct.pack('>d', v)
+			elif bo == 'little':
+				data = struct.pack('<d', v)
+			elif bo == 'mixed':
+				data = struct.pack('<d', v)
+				data = data[4:8] + data[0:4]
+			else:
+				raise Exception('unsupported byte order: %s' % repr(bo))
+			return '{ { DUK__TAG_NUMBER, 0, { { %s } } } }' % ', '.join([ '0x%02x' % ord(c) for c in data ])
+		elif t == 'undefined':
+			return '{ { DUK_TAG_UNDEFINED, 0, { 0 } } }'
+		elif t == 'boolean':
+			return '{ { DUK_TAG_BOOLEAN, 0, { %d } } }' % (1 if v else 0)
+		elif t == 'string':
+			return '{ { DUK_TAG_STRING, 0, { (void *) &duk_rom_str_%d.hdr } } }' % v
+		elif t == 'object':
+			return '{ { DUK_TAG_OBJECT, 0, { (void *) &duk_rom_obj_%d } } }' % v
+		elif t == 'accessor':
+			return '{ { (duk_hobject *) &duk_rom_obj_%d, (duk_hobject *) &duk_rom_obj_%d } }' % v
+		raise Exception('invalid ROM property type: %s' % t)
+
+	def romObjectType(self, obj):
+		if obj['native'] is not None:
+			return 'duk_hnativefunction'
+		return 'duk_hobject'
+
+	def emitRomObject(self, genc, idx, obj, props):
+		# Entry part only, without a hash part; e_size is kept even so
+		# that there's no padding before the values with layout 1 and
+		# 4-byte pointers.
+		n = len(props)
+		e_size = n + (n & 1)
+		entries = props + [ None ] * (e_size - n)
+
+		if n > 0:
+			keys = []
+			for prop in entries:
+				if prop is None:
+					keys.append('\t\tNULL')
+				else:
+					keys.append('\t\t&duk_rom_str_%d.hdr' % prop['key'])
+
+			genc.emitLine('static const struct {')
+			genc.emitLine('#if defined(DUK_USE_HOBJECT_LAYOUT_1)')
+			genc.emitLine('\tconst duk_hstring *keys[%d];' % e_size)
+			genc.emitLine('#endif')
+			genc.emitLine('\tstruct {')
+			for i, prop in enumerate(entries):
+				genc.emitLine('\t\t%s v%d;' % (self.romPropValueType(prop), i))
+			genc.emitLine('\t} values;')
+			genc.emitLine('#if !defined(DUK_USE_HOBJECT_LAYOUT_1)')
+			genc.emitLine('\tconst duk_hstring *keys[%d];' % e_size)
+			genc.emitLine('#endif')
+			genc.emitLine('\tduk_uint8_t flags[%d];' % e_size)
+			genc.emitLine('} duk_rom_props_%d = {' % idx)
+			genc.emitLine('#if defined(DUK_USE_HOBJECT_LAYOUT_1)')
+			genc.emitLine('\t{\n%s\n\t},' % ',\n'.join(keys))
+			genc.emitLine('#endif')
+			genc.emitLine('\t{\n%s\n\t},' % ',\n'.join([ '\t\t' + self.romPropValueInit(prop) for prop in entries ]))
+			genc.emitLine('#if !defined(DUK_USE_HOBJECT_LAYOUT_1)')
+			genc.emitLine('\t{\n%s\n\t},' % ',\n'.join(keys))
+			genc.emitLine('#endif')
+			genc.emitLine('\t{ %s }' % ', '.join([ '0x%02x' % (prop['flags'] if prop is not None else 0) for prop in entries ]))
+			genc.emitLine('};')
+			p = '(duk_uint8_t *) &duk_rom_props_%d' % idx
+		else:
+			p = 'NULL'
+
+		flags = [ 'DUK_HTYPE_OBJECT' ] + obj['flags'] + [ 'DUK_HOBJECT_CLASS_AS_FLAGS(DUK_HOBJECT_CLASS_%s)' % obj['class'].upper() ]
+		if obj['prototype'] is not None:
+			prototype = '(duk_hobject *) &duk_rom_obj_%d' % obj['prototype']
+		else:
+			prototype = 'NULL'
+		hobject_init = [ 'DUK_HEAPHDR_ROM_INIT(%s)' % ' | '.join(flags),
+		                 p,
+		                 '%d' % e_size,
+		                 '%d' % n,
+		                 '0',  # a_size
+		                 '0',  # h_size, XXX: precomputed hash part for large objects
+		                 prototype ]
+
+		genc.emitLine('const %s duk_rom_obj_%d = {' % (self.romObjectType(obj), idx))
+		if obj['native'] is not None:
+			if obj['nargs'] < 0:
+				nargs = 'DUK_HNATIVEFUNCTION_NARGS_VARARGS'
+			else:
+				nargs = '%d' % obj['nargs']
+			genc.emitLine('\t{\n%s\n\t},' % ',\n'.join([ '\t\t' + x for x in hobject_init ]))
+			genc.emitLine('\t%s,' % obj['native'])
+			genc.emitLine('\t%s,' % nargs)
+			genc.emitLine('\t%d' % obj['magic'])
+		else:
+			genc.emitLine('%s' % ',\n'.join([ '\t' + x for x in hobject_init ]))
+		genc.emitLine('};')
+
+	def emitRomSource(self, genc):
+		genc.emitLine('#if defined(DUK_USE_ROM_STRINGS)')
+		genc.emitLine('/* ROM strings: %d */' % len(self.rom_strings))
+		for idx, x in enumerate(self.rom_strings):
+			genc.emitLine('static const struct { duk_hstring hdr; duk_uint8_t data[%d]; } duk_rom_str_%d = {' % (len(x) + 1, idx))
+			genc.emitLine('\t{ DUK_HEAPHDR_STRING_ROM_INIT(%s), 0x%08xUL, %d, %d },' % \
+				(' | '.join(self.romStringFlags(idx)), romHashString(x), len(x), romCharLength(x)))
+			genc.emitLine('\t%s' % romCStringLiteral(x))
+			genc.emitLine('};')
+		genc.emitLine('')
+
+		genc.emitLine('const duk_hstring * const duk_rom_strings[DUK_HEAP_NUM_STRINGS] = {')
+		for idx in xrange(len(self.gs.strlist)):
+			genc.emitLine('\t&duk_rom_str_%d.hdr,' % idx)
+		genc.emitLine('};')
+		genc.emitLine('')
+
+		# Lookup table for string interning: strings grouped by the low
+		# bits of their hash, see duk__find_matching_rom_string().
+		buckets = [ [] for i in xrange(ROM_STRINGS_LOOKUP_BUCKETS) ]
+		for idx, x in enumerate(self.rom_strings):
+			buckets[romHashString(x) & (ROM_STRINGS_LOOKUP_BUCKETS - 1)].append(idx)
+		genc.emitLine('const duk_hstring * const duk_rom_strings_lookup[%d] = {' % len(self.rom_strings))
+		lookup_index = [ 0 ]
+		for bucket in buckets:
+			for idx in bucket:
+				genc.emitLine('\t&duk_rom_str_%d.hdr,' % idx)
+			lookup_index.append(lookup_index[-1] + len(bucket))
+		genc.emitLine('};')
+		genc.emitArray(lookup_index, 'duk_rom_strings_lookup_index', typename='duk_uint16_t', intvalues=True, const=True)
+		genc.emitLine('#endif  /* DUK_USE_ROM_STRINGS */')
+		genc.emitLine('')
+
+		genc.emitLine('#if defined(DUK_USE_ROM_OBJECTS)')
+		genc.emitLine('/* ROM objects: %d */' % len(self.rom_objects))
+		for idx, obj in enumerate(self.rom_objects):
+			genc.emitLine('extern const %s duk_rom_obj_%d;' % (self.romObjectType(obj), idx))
+		genc.emitLine('')
+		for idx, obj in enumerate(self.rom_objects):
+			genc.emitLine('/* %s */' % obj['comment'])
+			features = [ prop['feature'] for prop in obj['props'] if prop['feature'] is not None ]
+			if len(features) > 0:
+				genc.emitLine('#if defined(%s)' % features[0])
+				self.emitRomObject(genc, idx, obj, obj['props'])
+				genc.emitLine('#else')
+				self.emitRomObject(genc, idx, obj, [ prop for prop in obj['props'] if prop['feature'] is None ])
+				genc.emitLine('#endif')
+			else:
+				self.emitRomObject(genc, idx, obj, obj['props'])
+		genc.emitLine('')
+
+		genc.emitLine('const duk_hobject * const duk_rom_builtins[DUK_NUM_BUILTINS] = {')
+		for idx in xrange(len(self.builtins)):
+			genc.emitLine('\t(const duk_hobject *) &duk_rom_obj_%d,' % idx)
+		genc.emitLine('};')
+		genc.emitLine('const duk_hobject * const duk_rom_objects[DUK_NUM_ROM_OBJECTS] = {')
+		for idx in xrange(len(self.rom_objects)):
+			genc.emitLine('\t(const duk_hobject *) &duk_rom_obj_%d,' % idx)
+		genc.emitLine('};')
+		genc.emitLine('const duk_uint8_t duk_rom_ram_builtins[DUK_ROM_NUM_RAM_BUILTINS] = {')
+		for bi_id in ROM_RAM_BUILTINS:
+			genc.emitLine('\t%s,' % self.generateDefineNames(bi_id)[0])
+		genc.emitLine('};')
+		genc.emitLine('#endif  /* DUK_USE_ROM_OBJECTS */')
+
+	def emitRomHeader(self, genc):
+		genc.emitLine('#if defined(DUK_USE_ROM_STRINGS)')
+		genc.emitLine('extern const duk_hstring * const duk_rom_strings[];')
+		genc.emitLine('extern const duk_hstring * const duk_rom_strings_lookup[];')
+		genc.emitLine('extern const duk_uint16_t duk_rom_strings_lookup_index[];')
+		genc.emitDefine('DUK_ROM_STRINGS_HASH_SEED', '0x%08xUL' % ROM_STRINGS_HASH_SEED)
+		genc.emitDefine('DUK_ROM_STRINGS_LOOKUP_BUCKETS', ROM_STRINGS_LOOKUP_BUCKETS)
+		genc.emitDefine('DUK_NUM_ROM_STRINGS', len(self.rom_strings))
+		genc.emitLine('#endif  /* DUK_USE_ROM_STRINGS */')
+		genc.emitLine('#if defined(DUK_USE_ROM_OBJECTS)')
+		genc.emitLine('extern const duk_hobject * const duk_rom_builtins[];')
+		genc.emitLine('extern const duk_hobject * const duk_rom_objects[];')
+		genc.emitLine('extern const duk_uint8_t duk_rom_ram_builtins[];')
+		genc.emitDefine('DUK_NUM_ROM_OBJECTS', len(self.rom_objects))
+		genc.emitDefine('DUK_ROM_NUM_RAM_BUILTINS', len(ROM_RAM_BUILTINS))
+		genc.emitLine('#endif  /* DUK_USE_ROM_OBJECTS */')
+
 	def processBuiltins(self):
 		# finalize built-in data
 		bi_duktape = self.findBuiltIn('bi_duktape')['info']
@@ -1760,16 +2288,25 @@ class GenBuiltins:
 
 		self.init_data = be.getByteString()
 
+		self.processRomBuiltins()
+
 		print '%d bytes of built-in init data, %d built-in objects, %d normal props, %d func props, %d initjs data bytes' % \
 			(len(self.init_data), self.count_builtins, self.count_normal_props, self.count_function_props, len(self.initjs_data))
 
 	def emitSource(self, genc):
+		genc.emitLine('#if !defined(DUK_USE_ROM_STRINGS)')
 		self.gs.emitStringsData(genc)
+		genc.emitLine('#endif  /* !DUK_USE_ROM_STRINGS */')
 
 		genc.emitLine('')
 		self.writeNativeFuncArray(genc)
 		genc.emitLine('')
+		genc.emitLine('#if !defined(DUK_USE_ROM_OBJECTS)')
 		genc.emitArray(self.init_data, 'duk_builtins_data', typename='duk_uint8_t', intvalues=True, const=True)
+		genc.emitLine('#endif  /* !DUK_USE_ROM_OBJECTS */')
+		genc.emitLine('')
+		self.emitRomSource(genc)
+		genc.emitLine('')
 		genc.emitLine('#ifdef DUK_USE_BUILTIN_INITJS')
 		genc.emitArray(self.initjs_data, 'duk_initjs_data', typename='duk_uint8_t', intvalues=True, const=True)
 		genc.emitLine('#endif  /* DUK_USE_BUILTIN_INITJS */')
@@ -1779,12 +2316,15 @@ class GenBuiltins:
 
 		genc.emitLine('')
 		genc.emitLine('extern const duk_c_function duk_bi_native_functions[];')
+		genc.emitLine('#if !defined(DUK_USE_ROM_OBJECTS)')
 		genc.emitLine('extern const duk_uint8_t duk_builtins_data[];')
+		genc.emitLine('#endif  /* !DUK_USE_ROM_OBJECTS */')
 		genc.emitLine('#ifdef DUK_USE_BUILTIN_INITJS')
 		genc.emitLine('extern const duk_uint8_t duk_initjs_data[];')
 		genc.emitLine('#endif  /* DUK_USE_BUILTIN_INITJS */')
 		genc.emitLine('')
 		genc.emitDefine('DUK_BUILTINS_DATA_LENGTH', len(self.init_data))
+		genc.emitDefine('DUK_NUM_BI_NATIVE_FUNCTIONS', len(self.native_func_list))
 		genc.emitLine('#ifdef DUK_USE_BUILTIN_INITJS')
 		genc.emitDefine('DUK_BUILTIN_INITJS_DATA_LENGTH', len(self.initjs_data))
 		genc.emitLine('#endif  /* DUK_USE_BUILTIN_INITJS */')
@@ -1795,6 +2335,8 @@ class GenBuiltins:
 		genc.emitLine('')
 		genc.emitDefine('DUK_NUM_BUILTINS', len(self.builtins))
 		genc.emitLine('')
+		self.emitRomHeader(genc)
+		genc.emitLine('')
 
 #
 #  Main
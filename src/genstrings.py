@@ -552,6 +552,7 @@ duk_string_list = [
 	mkstr("varenv", internal=True, custom=True),
 	mkstr("source", internal=True, custom=True),
 	mkstr("pc2line", internal=True, custom=True),
+	mkstr("template", internal=True, custom=True),	# template of a lazily compiled closure
 
 	# internal properties for thread objects
 
@@ -572,6 +573,9 @@ duk_string_list = [
 	mkstr("target", internal=True, custom=True),	# [[ProxyTarget]]
 	mkstr("handler", internal=True, custom=True),	# [[ProxyHandler]]
 
+	# internal properties for the heap object
+	mkstr("profile", internal=True, custom=True),	# sampling profiler samples
+
 	# internal properties for declarative environment records
 	mkstr("callee", internal=True, custom=True),	# to access varmap
 	mkstr("thread", internal=True, custom=True),	# to identify valstack
@@ -603,6 +607,7 @@ duk_string_list = [
 	mkstr("jx", custom=True),       # enc/dec alg
 	mkstr("jc", custom=True),       # enc/dec alg
 	mkstr("compact", custom=True),
+	mkstr("opstats", custom=True),
 
 	# Buffer constructor
 
@@ -1105,7 +1110,9 @@ class GenStrings:
 		genc.emitLine(' */')
 
 	def emitStringsHeader(self, genc):
+		genc.emitLine('#if !defined(DUK_USE_ROM_STRINGS)')
 		genc.emitLine('extern const duk_uint8_t duk_strings_data[];')
+		genc.emitLine('#endif  /* !DUK_USE_ROM_STRINGS */')
 		genc.emitLine('')
 		genc.emitDefine('DUK_STRDATA_DATA_LENGTH', len(self.strdata))
 		genc.emitDefine('DUK_STRDATA_MAX_STRLEN', self.maxlen)
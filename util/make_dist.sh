@@ -61,6 +61,7 @@ for i in	\
 	duk_alloc_torture.c	\
 	duk_api_internal.h	\
 	duk_api_buffer.c	\
+	duk_api_bytecode.c	\
 	duk_api.c		\
 	duk_api_call.c		\
 	duk_api_codec.c		\
@@ -110,12 +111,14 @@ for i in	\
 	duk_hbuffer_ops.c	\
 	duk_hcompiledfunction.h	\
 	duk_heap_alloc.c	\
+	duk_heap_compcache.c	\
 	duk_heap.h		\
 	duk_heap_hashstring.c	\
 	duk_heaphdr.h		\
 	duk_heap_markandsweep.c	\
 	duk_heap_memory.c	\
 	duk_heap_misc.c		\
+	duk_heap_snapshot.c	\
 	duk_heap_refcount.c	\
 	duk_heap_stringcache.c	\
 	duk_heap_stringtable.c	\
@@ -128,6 +131,7 @@ for i in	\
 	duk_hobject_misc.c	\
 	duk_hobject_pc2line.c	\
 	duk_hobject_props.c	\
+	duk_hobject_shape.c	\
 	duk_hstring.h		\
 	duk_hstring_misc.c	\
 	duk_hthread_alloc.c	\
@@ -142,6 +146,7 @@ for i in	\
 	duk_js_compiler.c	\
 	duk_js_compiler.h	\
 	duk_js_executor.c	\
+	duk_js_jit.c		\
 	duk_js.h		\
 	duk_json.h		\
 	duk_js_ops.c		\
@@ -153,6 +158,7 @@ for i in	\
 	duk_regexp_compiler.c	\
 	duk_regexp_executor.c	\
 	duk_regexp.h		\
+	duk_tval.c		\
 	duk_tval.h		\
 	duk_unicode.h		\
 	duk_unicode_support.c	\
@@ -0,0 +1,30 @@
+#!/usr/bin/python
+#
+#  Time a command multiple times and report the minimum, maximum and
+#  average wall clock time.  Used for running perf-testcases, e.g.:
+#
+#    $ python util/time_multi.py --count 5 ./duk perf-testcases/test-loop-empty.js
+#
+
+import os, sys, time, subprocess, optparse
+
+def main():
+	parser = optparse.OptionParser()
+	parser.add_option('--count', type='int', dest='count', default=3)
+	(opts, args) = parser.parse_args()
+
+	times = []
+	for i in xrange(opts.count):
+		start = time.time()
+		ret = subprocess.call(args, stdout=open(os.devnull, 'wb'))
+		end = time.time()
+		if ret != 0:
+			print('command failed: %r -> %d' % (args, ret))
+			sys.exit(1)
+		times.append(end - start)
+
+	print('min=%.3f max=%.3f avg=%.3f (count %d): %s' % \
+	      (min(times), max(times), sum(times) / len(times), len(times), ' '.join(args)))
+
+if __name__ == '__main__':
+	main()